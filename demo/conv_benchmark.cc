@@ -0,0 +1,76 @@
+//
+// times the im2col + gemm of a large convolution with and without huge pages
+// and reports the dTLB counters of both runs
+//
+
+#include <chrono>
+#include <iostream>
+
+#include "tensor/tensor.h"
+#include "utils/memory.h"
+#include "utils/perf.h"
+
+using DTensor = tensor::Tensor<double>;
+
+double elapsed_ms(const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void run_conv(const DTensor &input, const DTensor &kernel, const size_t &repeats, const std::string &name,
+              utils::perf::PerfCounters &counters) {
+  // cached blocks were allocated under the previous policy
+  utils::memory::get_allocator()->trim();
+
+  double im2col_ms = 0, gemm_ms = 0;
+  counters.start();
+  for (size_t ix = 0; ix < repeats; ++ix) {
+    auto start = std::chrono::steady_clock::now();
+    DTensor col_image = tensor::im2col_chw(input, 3, 3, 1, 1);
+    im2col_ms += elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    DTensor output = col_image.dot(kernel);
+    gemm_ms += elapsed_ms(start);
+  }
+  counters.stop();
+
+  std::cout << name << "\tim2col " << im2col_ms / repeats << " ms\tgemm " << gemm_ms / repeats << " ms" << std::endl;
+  std::cout << "\t" << counters.to_string() << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 1 && argc != 6) {
+    throw std::invalid_argument("Usage: conv_benchmark [batch channels height width repeats]");
+  }
+
+  size_t batch = 8, channels = 64, height = 64, width = 64, repeats = 5;
+  if (argc == 6) {
+    try {
+      batch = std::stoul(argv[1]);
+      channels = std::stoul(argv[2]);
+      height = std::stoul(argv[3]);
+      width = std::stoul(argv[4]);
+      repeats = std::stoul(argv[5]);
+    } catch (const std::exception &ex) {
+      throw std::runtime_error(std::string("Failed to convert the arguments... ") + ex.what());
+    }
+  }
+
+  // opened before the worker threads exist, so that they are counted too
+  utils::perf::PerfCounters counters;
+
+  DTensor input({batch, channels, height, width});
+  input.normal_init(0., 1., 0);
+  DTensor kernel({channels * 9, channels});
+  kernel.normal_init(0., 0.1, 1);
+
+  size_t col_bytes = batch * (height - 2) * (width - 2) * channels * 9 * sizeof(double);
+  std::cout << "[INFO] im2col buffer of " << (col_bytes >> 20) << " MB" << std::endl;
+
+  size_t threshold = utils::memory::get_huge_page_threshold();
+  utils::memory::set_huge_page_threshold(0);
+  run_conv(input, kernel, repeats, "4K pages", counters);
+  utils::memory::set_huge_page_threshold(threshold == 0 ? utils::memory::DEFAULT_HUGE_PAGE_THRESHOLD : threshold);
+  run_conv(input, kernel, repeats, "2M pages", counters);
+  return 0;
+}
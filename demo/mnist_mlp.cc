@@ -40,6 +40,11 @@ void train(const size_t &batch_size,
     ), labels);
 
   auto optim = optimizer::Adam(loss, batch_size);
+  // the forward pass in topological order, evaluated once per node
+  ExecutionPlan plan = Graph::get_instanceof_global_graph()->compile({&loss});
+  // release the activations as soon as forward and backward are done with them
+  std::cout << "[INFO] " << plan.plan_memory().to_string() << std::endl;
+  optim.set_plan(plan);
 
   std::cout << "[INFO] Started training!!!" << std::endl;
 
@@ -50,10 +55,10 @@ void train(const size_t &batch_size,
     while (train_data_set.has_next()) {
       paired_train_data = train_data_set.get_next();
       // forward
-      x.assign_value(paired_train_data.first);
-      labels.assign_value(paired_train_data.second);
+      x.assign_value(paired_train_data.first.cast<DScalar>());
+      labels.assign_value(paired_train_data.second.cast<DScalar>());
       optim.zero_grad();
-      loss.forward();
+      plan.forward();
 
       // backward
       optim.step();
@@ -71,12 +76,12 @@ void train(const size_t &batch_size,
 
     // evaluation
     double acc = 0;
-    tensor::Tensor<double> preds;
+    DTensor preds;
     while (test_data_set.has_next()) {
       paired_test_data = test_data_set.get_next();
-      x.assign_value(paired_test_data.first);
-      labels.assign_value(paired_test_data.second);
-      loss.forward();
+      x.assign_value(paired_test_data.first.cast<DScalar>());
+      labels.assign_value(paired_test_data.second.cast<DScalar>());
+      plan.forward();
 
       preds = loss.get_probs().arg_amax(1);
       acc += metric::accuracy(preds, labels.get_value(), false);
@@ -0,0 +1,128 @@
+//
+// trains the mlp of mnist_mlp.cc, quantizes it into int8 after training and
+// reports accuracy and latency of both against each other
+//
+
+#include <chrono>
+
+#include "tensor/tensor.h"
+#include "data/dataset.h"
+#include "autodiff/graph.h"
+#include "autodiff/metric/metric.h"
+#include "autodiff/layer/layer.h"
+#include "autodiff/layer/quantization.h"
+#include "autodiff/optimizer/optimizer.h"
+
+using namespace auto_diff;
+
+// number of training batches the activation ranges are calibrated on
+const size_t CALIBRATION_BATCHES = 20;
+
+double elapsed_ms(const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void train_and_quantize(const size_t &batch_size,
+                        const int &epoch,
+                        const std::string &train_data_path,
+                        const std::string &test_data_path) {
+  auto train_data_set = data::CsvDataset(train_data_path, 0, batch_size, ",", true);
+  auto test_data_set = data::CsvDataset(test_data_path, 0, batch_size, ",", true, false);
+  DataPair paired_data;
+
+  size_t output_dim = train_data_set.get_label_count();
+
+  Variable x = Variable({batch_size, 784});
+  Variable labels = Variable({batch_size, output_dim});
+
+  layer::Dense dense_layer_1(784, 120, "relu");
+  layer::Dense dense_layer_2(120, 24, "relu");
+  layer::Dense dense_layer_3(24, output_dim, "none");
+
+  auto &logits = dense_layer_3(dense_layer_2(dense_layer_1(x)));
+  auto loss = functional::cross_entropy_with_softmax(logits, labels);
+  auto optim = optimizer::Adam(loss, batch_size);
+
+  std::cout << "[INFO] Started training!!!" << std::endl;
+  for (int cur_epoch = 0; cur_epoch < epoch; ++cur_epoch) {
+    while (train_data_set.has_next()) {
+      paired_data = train_data_set.get_next();
+      x.assign_value(paired_data.first.cast<DScalar>());
+      labels.assign_value(paired_data.second.cast<DScalar>());
+      optim.zero_grad();
+      loss.forward();
+      optim.step();
+    }
+    train_data_set.reset_iterator();
+  }
+
+  // calibration
+  layer::Calibrator calibrator({&dense_layer_1, &dense_layer_2, &dense_layer_3});
+  for (size_t ix = 0; ix < CALIBRATION_BATCHES && train_data_set.has_next(); ++ix) {
+    paired_data = train_data_set.get_next();
+    x.assign_value(paired_data.first.cast<DScalar>());
+    logits.forward();
+    calibrator.observe();
+  }
+  layer::QuantizedSequential quantized(calibrator);
+
+  // evaluation, only the forward pass up to the logits is timed
+  double float_acc = 0, int8_acc = 0, float_ms = 0, int8_ms = 0;
+  size_t n_batches = 0;
+  while (test_data_set.has_next()) {
+    paired_data = test_data_set.get_next();
+    DTensor inputs = paired_data.first.cast<DScalar>();
+    DTensor targets = paired_data.second.cast<DScalar>();
+
+    auto start = std::chrono::steady_clock::now();
+    x.assign_value(inputs);
+    logits.forward();
+    float_ms += elapsed_ms(start);
+    float_acc += metric::accuracy(logits.get_value().arg_amax(1), targets, false);
+
+    start = std::chrono::steady_clock::now();
+    DTensor int8_logits = quantized.forward(inputs);
+    int8_ms += elapsed_ms(start);
+    int8_acc += metric::accuracy(int8_logits.arg_amax(1), targets, false);
+    ++n_batches;
+  }
+
+  size_t float_bytes = 0;
+  for (auto layer_ptr : std::vector<layer::Layer *>{&dense_layer_1, &dense_layer_2, &dense_layer_3}) {
+    for (auto param_ptr : layer_ptr->get_param_ptr_list()) {
+      float_bytes += param_ptr->get_value_size() * sizeof(DScalar);
+    }
+  }
+
+  size_t n_samples = test_data_set.get_data_count();
+  n_batches = std::max<size_t>(n_batches, 1);
+  std::cout << "model\taccuracy\tms/batch\tweight bytes" << std::endl;
+  std::cout << "fp" << sizeof(DScalar) * 8 << "\t" << float_acc / n_samples << "\t" << float_ms / n_batches
+            << "\t" << float_bytes << std::endl;
+  std::cout << "int8\t" << int8_acc / n_samples << "\t" << int8_ms / n_batches
+            << "\t" << quantized.get_weight_bytes() << std::endl;
+
+  Graph::clear_graph();
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 5) {
+    throw std::invalid_argument("Invalid number of arguments for training! 4 Needed...");
+  }
+
+  size_t batch_size;
+  int epoch;
+  std::string train_data_path, test_data_path;
+
+  try {
+    batch_size = std::stoi(argv[1]);
+    epoch = std::stoi(argv[2]);
+    train_data_path = argv[3];
+    test_data_path = argv[4];
+  } catch (const std::exception &ex) {
+    throw std::runtime_error(std::string("Failed to convert the arguments... ") + ex.what());
+  }
+
+  train_and_quantize(batch_size, epoch, train_data_path, test_data_path);
+  return 0;
+}
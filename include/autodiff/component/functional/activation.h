@@ -16,6 +16,8 @@ class Sigmoid : public Node {
   Sigmoid(Node *parent_ptr, Graph *g = nullptr, const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_parent_value_needed_for_backward() const override { return false; };
+  bool can_run_in_place() const override { return true; };
 };
 
 class ReLU : public Node {
@@ -24,6 +26,36 @@ class ReLU : public Node {
   ReLU(Node *parent_ptr, Graph *g = nullptr, const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_parent_value_needed_for_backward() const override { return false; };
+  bool can_run_in_place() const override { return true; };
+};
+
+class Tanh : public Node {
+ public:
+  Tanh() : Node(NodeType::ADG_TANH_TYPE) {};
+  Tanh(Node *parent_ptr, Graph *g = nullptr, const std::string &name = "");
+  void do_forward() override;
+  DTensor do_backward(Node *parent_ptr) override;
+  bool is_parent_value_needed_for_backward() const override { return false; };
+  bool can_run_in_place() const override { return true; };
+};
+
+class GELU : public Node {
+ public:
+  GELU() : Node(NodeType::ADG_GELU_TYPE) {};
+  GELU(Node *parent_ptr, Graph *g = nullptr, const std::string &name = "");
+  void do_forward() override;
+  DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+};
+
+class SiLU : public Node {
+ public:
+  SiLU() : Node(NodeType::ADG_SILU_TYPE) {};
+  SiLU(Node *parent_ptr, Graph *g = nullptr, const std::string &name = "");
+  void do_forward() override;
+  DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
 };
 
 Sigmoid &sigmoid(const Node &parent, Graph *g = nullptr,
@@ -32,6 +64,15 @@ Sigmoid &sigmoid(const Node &parent, Graph *g = nullptr,
 ReLU &relu(const Node &parent, Graph *g = nullptr,
            const std::string &name = "");
 
+Tanh &tanh(const Node &parent, Graph *g = nullptr,
+           const std::string &name = "");
+
+GELU &gelu(const Node &parent, Graph *g = nullptr,
+           const std::string &name = "");
+
+SiLU &silu(const Node &parent, Graph *g = nullptr,
+           const std::string &name = "");
+
 }
 }
 
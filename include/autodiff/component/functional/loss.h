@@ -19,6 +19,10 @@ class CrossEntropyWithSoftMax : public Node {
   DTensor get_probs();
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
+  size_t get_cache_bytes() const override;
+  void clear_cache() override;
 
  private:
   static inline double epsilon_ = 1e-9;
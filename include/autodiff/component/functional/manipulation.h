@@ -17,6 +17,9 @@ class Reshape : public Node {
           const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
+  bool can_run_in_place() const override { return true; };
 
  private:
   tensor::TensorShape new_shape_;
@@ -29,6 +32,8 @@ class Pad2D : public Node {
         Graph *g = nullptr, const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
  private :
   double pad_value_;
   std::vector<std::pair<size_t, size_t>> padding_;
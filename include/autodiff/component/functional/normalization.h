@@ -22,6 +22,10 @@ class BatchNorm2D : public Node {
               const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
+  size_t get_cache_bytes() const override;
+  void clear_cache() override;
 
   DTensor get_moving_mean();
   DTensor get_moving_var();
@@ -16,6 +16,8 @@ class ReduceSum : public Node {
   ReduceSum(Node *parent_ptr, Graph *g = nullptr, const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
 };
 
 class ReduceMean : public Node {
@@ -25,6 +27,8 @@ class ReduceMean : public Node {
              const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
 
  private:
   double multiplier_;
@@ -17,6 +17,8 @@ class Add : public Node {
       const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
 };
 
 // add a vector to a matrix with the same size in the last dim
@@ -27,6 +29,8 @@ class MatAddVec : public Node {
             const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
 
  private:
   size_t axis_;
@@ -39,6 +43,7 @@ class VecDot : public Node {
          const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
 };
 
 class MatMul : public Node {
@@ -48,6 +53,7 @@ class MatMul : public Node {
          const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
 };
 
 class MatSum : public Node {
@@ -57,6 +63,8 @@ class MatSum : public Node {
          const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
 };
 
 class PointMul : public Node {
@@ -66,6 +74,7 @@ class PointMul : public Node {
            const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
 };
 
 Add &add(const Node &parent1, const Node &parent2, Graph *g = nullptr,
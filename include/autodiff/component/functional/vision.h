@@ -25,11 +25,15 @@ class Conv2D : public Node {
          const std::string &name = "");
   void do_forward() override;
   DTensor do_backward(Node *parent_ptr) override;
+  bool is_value_needed_for_backward() const override { return false; };
+  bool is_parent_value_needed_for_backward() const override { return false; };
+  size_t get_cache_bytes() const override;
+  void clear_cache() override;
 
  private:
   size_t out_c_, out_h_, out_w_, residual_h_, residual_w_;
   DTensor col_image_, col_kernel_;
-  std::vector<size_t> kernel_shape_;
+  tensor::TensorShape kernel_shape_;
   std::array<size_t, 2> strides_;
 
   DTensor im2col_hwc(const DTensor &input,
@@ -37,11 +41,6 @@ class Conv2D : public Node {
                      const size_t &kw,
                      const size_t &sh,
                      const size_t &sw);
-  DTensor im2col_chw(const DTensor &input,
-                     const size_t &kh,
-                     const size_t &kw,
-                     const size_t &sh,
-                     const size_t &sw);
 
 };
 
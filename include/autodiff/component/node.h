@@ -1,6 +1,9 @@
 #ifndef ADGC_AUTODIFF_NODE_H_
 #define ADGC_AUTODIFF_NODE_H_
 
+#include <functional>
+#include <numeric>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -14,7 +17,16 @@ namespace auto_diff {
 
 class Graph;
 
-typedef tensor::Tensor<double> DTensor;
+// element type of the values and gradients in the graph,
+// float when built with the USE_FLOAT32 option
+#ifdef ADGC_USE_FLOAT32_
+typedef float DScalar;
+#else
+typedef double DScalar;
+#endif
+typedef tensor::Tensor<DScalar> DTensor;
+
+inline const DTensor EMPTY_DTENSOR = {{1}};
 
 class Node {
  public:
@@ -37,10 +49,27 @@ class Node {
   virtual void forward();
   virtual DTensor backward(Node *result);
 
+  // release_value hands the buffer of the value back and marks it released,
+  // the shape stays readable for the backward pass of the children but
+  // get_value() throws until the node is evaluated again
+  void release_value();
+  // what the backward pass reads besides the gradient, the memory planner
+  // releases the values as soon as nothing reads them any more
+  virtual bool is_value_needed_for_backward() const { return true; };
+  virtual bool is_parent_value_needed_for_backward() const { return true; };
+  // bytes of the tensors cached by the forward pass for the backward one
+  virtual size_t get_cache_bytes() const { return 0; };
+  virtual void clear_cache() {};
+  // true for elementwise ops able to overwrite the value of their parent
+  virtual bool can_run_in_place() const { return false; };
+
   inline std::string get_type() const { return type_; }
   inline std::string get_name() const { return name_; }
   inline std::string get_full_name() const { return type_ + "_" + name_; }
-  inline Node *get_ptr() { return unique_ptr_; }
+  inline Node *get_ptr() const { return unique_ptr_; }
+  // the index of the node in its graph, dense from 0 in the order the nodes
+  // were added, see NodeTable
+  inline size_t get_id() const { return unique_ptr_->id_; }
   inline const Graph *get_graph() const { return unique_ptr_->graph_; }
   inline std::vector<Node *> get_children() const {
     return unique_ptr_->children_;
@@ -48,17 +77,37 @@ class Node {
   inline std::vector<Node *> get_parents() const {
     return unique_ptr_->parents_;
   }
-  inline DTensor get_value() const { return unique_ptr_->value_; }
+  inline DTensor get_value() const {
+    if (unique_ptr_->is_value_released_) {
+      throw adg_exception::NodeValueError("Node >> get_value : the value of " + get_full_name() +
+        " was released by a memory plan");
+    }
+    if (unique_ptr_->is_value_half_) {
+      return unique_ptr_->half_value_.cast<DScalar>();
+    }
+    return unique_ptr_->value_;
+  }
+  // in-place access to the value, e.g. for optimizers; the buffer is only
+  // copied if a tensor returned by get_value() still shares it
+  DTensor &get_mutable_value();
   inline bool is_value_empty() const { return unique_ptr_->empty_value_; };
+  inline bool is_value_released() const { return unique_ptr_->is_value_released_; };
   inline bool is_grad_empty() const { return unique_ptr_->empty_jacobi_; };
   inline size_t get_value_size() const {
-    return unique_ptr_->value_.get_size();
+    if (unique_ptr_->is_value_released_) {
+      return std::accumulate(unique_ptr_->released_shape_.begin(), unique_ptr_->released_shape_.end(), size_t(1),
+                             std::multiplies<size_t>());
+    }
+    return unique_ptr_->is_value_half_ ? unique_ptr_->half_value_.get_size() : unique_ptr_->value_.get_size();
   }
-  inline tensor::TensorShape get_value_shape() const {
-    return unique_ptr_->value_.get_shape();
+  inline const tensor::TensorShape &get_value_shape() const {
+    if (unique_ptr_->is_value_released_) {
+      return unique_ptr_->released_shape_;
+    }
+    return unique_ptr_->is_value_half_ ? unique_ptr_->half_value_.get_shape() : unique_ptr_->value_.get_shape();
   }
   inline size_t get_value_dim() const {
-    return unique_ptr_->value_.get_dim();
+    return get_value_shape().size();
   }
   inline void set_backward_version(int version) {
     unique_ptr_->backward_version_ = version;
@@ -70,7 +119,7 @@ class Node {
   // inline void set_graph(Graph *graph) { graph_ = graph; }
   inline void clear_jacobi() {
     if (!unique_ptr_->is_grad_empty()) {
-      unique_ptr_->jacobi_ = tensor::EMPTY;
+      unique_ptr_->jacobi_ = EMPTY_DTENSOR;
       unique_ptr_->empty_jacobi_ = true;
     }
   }
@@ -90,6 +139,9 @@ class Node {
 
   friend void graph_reset_node_name(Node *node, const std::string &name,
                                     Graph *graph);
+  friend class Graph;
+  friend class ExecutionPlan;
+  friend class MemoryPlan;
 
  protected:
   std::string type_;
@@ -99,16 +151,93 @@ class Node {
   bool requires_grad_;
   DTensor value_;
   bool empty_value_;
+  // the forward value is kept here instead of value_ when the graph runs in
+  // mixed precision, see Graph::set_mixed_precision
+  tensor::Tensor<tensor::bfloat16> half_value_;
+  bool is_value_half_ = false;
+  // set by release_value, the shape of the value is kept aside
+  bool is_value_released_ = false;
+  tensor::TensorShape released_shape_;
   DTensor jacobi_;
   bool empty_jacobi_;
   Graph *graph_;
   Node *unique_ptr_; // use this as the reference to the unique node pointer
+  size_t id_ = 0;
+  // allocated by Graph::create, the graph destroys it
+  bool in_arena_ = false;
   int backward_version_;
-
+  // only set while a planned evaluation may take the parent's buffer
+  bool in_place_ = false;
+
+  // evaluate computes the value from the values of the parents once,
+  // in_place lets it overwrite the value of its parent
+  void evaluate(bool in_place = false);
+  // the value of a parent for do_forward, its buffer is handed over when
+  // this node runs in place
+  DTensor take_parent_value(const size_t &index);
   virtual void do_forward() = 0;                 // compute value
   virtual DTensor do_backward(Node *parent) = 0; // compute jacobian
 };
 
+/*
+  NodeTable keeps a value per node in a vector indexed by the node ids, for
+  bookkeeping like the gradients and moments of optimizers without hashing
+  the node names. The ids are only unique within one graph and are given out
+  again after Graph::remove_all, so a table is cleared along with the graph.
+*/
+template<typename T>
+class NodeTable {
+ public:
+  NodeTable() {};
+
+  inline bool contains(const Node *node_ptr) const {
+    size_t id = node_ptr->get_id();
+    return id < entries_.size() && entries_[id].has_value();
+  }
+  // operator[] adds a default constructed value for a new node
+  inline T &operator[](const Node *node_ptr) {
+    std::optional<T> &entry = get_slot(node_ptr);
+    if (!entry.has_value()) {
+      entry.emplace();
+    }
+    return *entry;
+  }
+  // emplace constructs the value of the node from the arguments, replacing
+  // the one there
+  template<typename... Args>
+  inline T &emplace(const Node *node_ptr, Args &&...args) {
+    return get_slot(node_ptr).emplace(std::forward<Args>(args)...);
+  }
+  inline T &at(const Node *node_ptr) {
+    if (!contains(node_ptr)) {
+      throw adg_exception::NodeNotFoundError("NodeTable >> at : no entry for node " + node_ptr->get_full_name());
+    }
+    return *entries_[node_ptr->get_id()];
+  }
+  inline void erase(const Node *node_ptr) {
+    if (contains(node_ptr)) {
+      entries_[node_ptr->get_id()].reset();
+    }
+  }
+  // clear keeps the slots, the next round of the same nodes doesn't allocate them again
+  inline void clear() {
+    for (auto &entry : entries_) {
+      entry.reset();
+    }
+  }
+
+ private:
+  std::vector<std::optional<T>> entries_;
+
+  inline std::optional<T> &get_slot(const Node *node_ptr) {
+    size_t id = node_ptr->get_id();
+    if (id >= entries_.size()) {
+      entries_.resize(id + 1);
+    }
+    return entries_[id];
+  }
+};
+
 } // namespace auto_diff
 
 #include "autodiff/graph.h"
@@ -37,6 +37,10 @@ class Parameter : public Node {
 
   inline void set_trainable(bool is_trainable) { unique_ptr_->set_requires_grad(is_trainable); };
   inline bool is_trainable() { return unique_ptr_->is_requires_grad(); };
+  // init refills the value with "xavier_uniform", "xavier_normal",
+  // "kaiming_uniform" or "kaiming_normal", see tensor/extension.h
+  void init(const std::string &method, const size_t &fan_in, const size_t &fan_out,
+            const size_t &seed = SIZE_MAX);
 
  protected:
   void do_forward() override {}; // do nothing
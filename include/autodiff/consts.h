@@ -34,6 +34,9 @@ struct NodeType {
   // activation
   static inline const std::string ADG_SIGMOID_TYPE = "F_sigmoid";
   static inline const std::string ADG_RELU_TYPE = "F_relu";
+  static inline const std::string ADG_TANH_TYPE = "F_tanh";
+  static inline const std::string ADG_GELU_TYPE = "F_gelu";
+  static inline const std::string ADG_SILU_TYPE = "F_silu";
 
   // loss
   static inline const std::string ADG_CROSS_ENTROPY_SOFTMAX_TYPE =
@@ -2,10 +2,15 @@
 #define ADGC_AUTODIFF_GRAPH_H_
 
 #include <stdlib.h>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "autodiff/consts.h"
+#include "autodiff/memory_planner.h"
 #include "utils/utils.h"
 
 #ifdef ADGC_ENABLE_GRAPHVIZ_
@@ -19,6 +24,89 @@ class Node;
 typedef std::vector<Node *>::iterator NodeIterator;
 typedef std::pair<NodeIterator, NodeIterator> NodeIteratorPair;
 
+/*
+  ParallelPolicy splits the threads an execution plan runs on between the
+  two kinds of parallelism: up to inter_op_threads nodes whose inputs are
+  ready run at once, and the MKL calls of each of them get intra_op_threads
+  threads. One inter-op thread is the serial executor, which leaves MKL as
+  it is configured.
+*/
+struct ParallelPolicy {
+  size_t inter_op_threads = 1;
+  size_t intra_op_threads = 1;
+
+  // split runs as many nodes at once as the plan has side by side, up to
+  // the threads of the runtime, and divides the threads left among them;
+  // num_threads 0 takes the size of the runtime
+  static ParallelPolicy split(const size_t &max_width, size_t num_threads = 0);
+};
+
+/*
+  ExecutionPlan is the forward pass of a set of output nodes flattened in
+  topological order, see Graph::compile. Running it evaluates every node
+  between the leaves and the outputs exactly once, parents before children,
+  without recursion and without looking at which values are already there;
+  it is meant to be built once and run every step after the inputs are
+  assigned. It holds raw pointers, compile again after nodes are added to
+  or removed from the graph.
+  backward walks the same nodes once in reverse from a scalar output. Every
+  node pushes the products of its gradient with its local derivatives into
+  the gradient buffers of its parents, which accumulate them in place, and
+  drops its own gradient right after; only the leaves asked for and the
+  output keep theirs.
+  With a parallel policy both passes run on the dependency graph of the
+  plan instead: a node is queued as soon as its parents are evaluated, or
+  as soon as its children have passed their gradients back, and the
+  runtime picks queued nodes up on as many threads as the policy allows.
+  The buffers of a memory plan are released once all the steps up to their
+  last one are done, which is when the serial executor would have.
+*/
+class ExecutionPlan {
+ public:
+  ExecutionPlan() {};
+
+  void forward() const;
+  // backward needs the forward values, the gradients end up in the leaves
+  // given, which get zeros if the output doesn't depend on them
+  void backward(const std::vector<Node *> &leaves) const;
+  // plan_memory works out when each value, gradient and forward cache of the
+  // nodes is read for the last time, forward and backward release them from
+  // then on; the values of the inner nodes are gone after a run, except for
+  // the outputs
+  const MemoryPlan &plan_memory(bool with_backward = true);
+  inline const MemoryPlan &get_memory_plan() const { return memory_plan_; };
+  inline void set_parallel_policy(const ParallelPolicy &policy) { policy_ = policy; };
+  inline const ParallelPolicy &get_parallel_policy() const { return policy_; };
+  // the most nodes at the same depth, which may run at once
+  size_t get_max_width() const;
+  // the nodes evaluated, in order; variables and parameters are not part of it
+  inline const std::vector<Node *> &get_nodes() const { return nodes_; };
+  inline const std::vector<Node *> &get_outputs() const { return outputs_; };
+
+ private:
+  friend class Graph;
+  std::vector<Node *> nodes_;
+  std::vector<Node *> outputs_;
+  // positions in nodes_ of the distinct parents and children of each node
+  // that are part of the plan, the edges of the dependency graph
+  std::vector<std::vector<size_t>> plan_parents_;
+  std::vector<std::vector<size_t>> plan_children_;
+  MemoryPlan memory_plan_;
+  bool is_memory_planned_ = false;
+  ParallelPolicy policy_;
+
+  // backward_node passes the gradient of the node at ix back to its parents;
+  // with locks given, they guard the accumulation into the parents
+  void backward_node(const size_t &ix, const std::vector<bool> &needs_grad, const std::vector<bool> &kept,
+                     std::vector<std::mutex> *locks) const;
+  // run_parallel runs task on every node once all the nodes it depends on
+  // are done, in the reverse direction for backward, and releases the
+  // memory plan's steps in order once they are all done
+  void run_parallel(bool is_backward, const std::function<void(size_t)> &task) const;
+  // whether the node at ix takes the buffer of its parent in this plan
+  inline bool is_in_place(const size_t &ix) const { return is_memory_planned_ && memory_plan_.is_in_place(ix); };
+};
+
 class Graph {
  public:
   Graph();
@@ -29,18 +117,27 @@ class Graph {
   Graph &operator=(const Graph &&other) = delete;
 
   ~Graph();
+  // create constructs a node in the arena of the graph, which destroys it in
+  // remove_all or its destructor; the arguments go to the constructor and
+  // must register the node in this graph
+  template<typename T, typename... Args>
+  T *create(Args &&...args);
   std::string add_node(Node *node, const std::string &type,
                        const std::string &name);
   void add_relation(const std::string &parent_name,
                     const std::string &child_name);
   Node *get_ptr_of(const std::string &node_name);
   bool contains_node(const std::string &full_node_name) const;
+  // compile sorts the nodes the outputs depend on into an execution plan
+  ExecutionPlan compile(const std::vector<Node *> &outputs);
   void backward(Node &result);
   void zero_grad();
   void clear_all_value();
   void remove_all();
 
   inline std::vector<Node *> get_node_list() const { return node_ptr_list_; };
+  // the node ids are below this, see Node::get_id
+  inline size_t get_num_nodes() const { return node_ptr_list_.size(); };
   inline NodeIteratorPair get_node_iterators() {
     return {node_ptr_list_.begin(), node_ptr_list_.end()};
   }
@@ -51,10 +148,20 @@ class Graph {
   inline void train() { stage_flag_ = GraphStageFlag::train; }
   inline void eval() { stage_flag_ = GraphStageFlag::eval; };
   inline GraphStageFlag stage() { return stage_flag_; };
+  // in mixed precision the inner nodes keep their forward values in bfloat16
+  // until the backward pass, variables and parameters stay in DScalar
+  inline void set_mixed_precision(bool mixed_precision) { mixed_precision_ = mixed_precision; };
+  inline bool is_mixed_precision() const { return mixed_precision_; };
+  // the gradient backward starts from, set by optimizers scaling the loss
+  inline void set_loss_scale(const double &loss_scale) { loss_scale_ = loss_scale; };
+  inline double get_loss_scale() const { return loss_scale_; };
 
   static Graph *get_instanceof_global_graph();
   static void clear_graph(Graph *graph = nullptr);
   static Node *get_ptr_of(const std::string &node_name, Graph *graph_ptr);
+  static inline Graph *get_graph_or_global(Graph *graph_ptr) {
+    return graph_ptr == nullptr ? get_instanceof_global_graph() : graph_ptr;
+  }
   static inline void delete_global_graph() {
     if (global_graph != nullptr) {
       delete global_graph;
@@ -69,12 +176,46 @@ class Graph {
 
  private:
   std::string graph_name_;
+  // indexed by the node ids
   std::vector<Node *> node_ptr_list_;
+  // the nodes given a name, to catch duplicated names; unnamed nodes are
+  // only looked up by a scan, see find_node
   std::unordered_map<std::string, Node *> node_ptr_dict_;
+  // nodes are bump allocated from fixed size chunks, the bigger ones get a
+  // chunk of their own in arena_big_chunks_
+  std::vector<std::unique_ptr<char[]>> arena_chunks_;
+  std::vector<std::unique_ptr<char[]>> arena_big_chunks_;
+  size_t arena_offset_ = 0;
+  std::vector<Node *> arena_nodes_;
   utils::TypeCounter type_counter_;
   GraphStageFlag stage_flag_;
+  bool mixed_precision_ = false;
+  double loss_scale_ = 1.;
 
+  // find_node returns the node of the full name, nullptr if there is none
+  Node *find_node(const std::string &full_node_name) const;
+  void *allocate_node(const size_t &bytes, const size_t &alignment);
+  void adopt_node(Node *node_ptr, const size_t &bytes);
+  // drop_nodes_from unregisters the nodes from the id on and the object of
+  // the given bytes, whose construction failed
+  void drop_nodes_from(const size_t &id, const void *object, const size_t &bytes);
+  void destroy_arena();
 };
 
+template<typename T, typename... Args>
+T *Graph::create(Args &&...args) {
+  void *buffer = allocate_node(sizeof(T), alignof(T));
+  size_t n_nodes = node_ptr_list_.size();
+  T *node_ptr;
+  try {
+    node_ptr = new(buffer) T(std::forward<Args>(args)...);
+  } catch (...) {
+    drop_nodes_from(n_nodes, buffer, sizeof(T));
+    throw;
+  }
+  adopt_node(node_ptr, sizeof(T));
+  return node_ptr;
+}
+
 } // namespace auto_diff
 #endif
\ No newline at end of file
@@ -36,6 +36,9 @@ class Conv2D : public Layer {
   Node &operator()(const Node &input);
   void assign_weight(const DTensor &value);
   void assign_bias(const DTensor &value);
+  // paddings order : {top, bottom, left, right}
+  inline std::array<size_t, 4> get_padding() const { return padding_; };
+  inline std::array<size_t, 2> get_stride() const { return stride_; };
 
  private:
   size_t input_channel_, output_channel_;
@@ -43,6 +46,7 @@ class Conv2D : public Layer {
   std::array<size_t, 2> stride_;
 
   void check_input(const Node &input);
+  std::pair<size_t, size_t> get_fans() const override;
 };
 }
 }
@@ -25,6 +25,7 @@ class Dense : public Layer {
   size_t input_channel_, output_channel_;
 
   void check_input(const Node &input);
+  std::pair<size_t, size_t> get_fans() const override;
 };
 
 } // namespace layer
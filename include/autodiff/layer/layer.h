@@ -16,18 +16,28 @@ class Layer {
   ~Layer() {};
 
   void freeze();
+  // init_weight refills the kernel with an initializer of Parameter::init,
+  // kaiming ones suit relu layers and xavier ones tanh or sigmoid layers
+  void init_weight(const std::string &method, const size_t &seed = SIZE_MAX);
   std::vector<Parameter *> get_param_ptr_list() const;
   void set_config(const std::string &key, const std::string &value);
   std::string get_config(const std::string &key);
+  // the input and output nodes of the last call, read to calibrate the layer
+  inline Node *get_input_node() const { return input_ptr_; };
+  inline Node *get_output_node() const { return output_ptr_; };
 
  protected:
   std::string layer_name_;
   Graph *graph_;
   std::unordered_map<std::string, std::string> configs_;
   std::vector<Parameter *> params_ptr_list_;
+  Node *input_ptr_ = nullptr;
+  Node *output_ptr_ = nullptr;
 
   void add_param(Parameter *param_ptr);
   virtual Node *use_activation(Node *input);
+  // the fan in and fan out of an entry of the kernel, for init_weight
+  virtual std::pair<size_t, size_t> get_fans() const;
 };
 
 } // namespace layer
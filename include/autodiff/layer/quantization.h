@@ -0,0 +1,121 @@
+#ifndef ADGC_INCLUDE_AUTODIFF_LAYER_QUANTIZATION_H_
+#define ADGC_INCLUDE_AUTODIFF_LAYER_QUANTIZATION_H_
+
+#include <memory>
+
+#include "autodiff/layer/layer.h"
+
+namespace auto_diff {
+namespace layer {
+
+// symmetric int8 quantization: x = q * scale with q in [-127, 127]
+tensor::Tensor<int8_t> quantize(const DTensor &value, const double &scale);
+DTensor dequantize(const tensor::Tensor<int8_t> &value, const double &scale);
+
+/*
+  Calibrator records the ranges of the values going into and out of a chain
+  of trained layers. Run the graph forward on a few representative batches
+  and call observe() after each pass; the largest magnitude seen at a node
+  becomes 127 in int8.
+*/
+class Calibrator {
+ public:
+  Calibrator(const std::vector<Layer *> &layers);
+
+  void observe();
+  double get_input_scale(const size_t &index) const;
+  double get_output_scale(const size_t &index) const;
+  inline size_t get_size() const { return layers_.size(); };
+  inline Layer *get_layer(const size_t &index) const { return layers_[index]; };
+
+ private:
+  std::vector<Layer *> layers_;
+  std::vector<double> input_ranges_, output_ranges_;
+};
+
+/*
+  QuantizedLayer is the int8 inference form of a trained layer. Weights are
+  quantized with one scale per output channel and stored as [k, c_out]; the
+  input comes in as int8 at the calibrated input scale. Products are summed
+  in int32 and the epilogue
+    y = activation(acc * input_scale * weight_scale[c] + bias[c])
+  is applied while the result is stored, either requantized to int8 at the
+  output scale for the next layer or as DScalar after the last one.
+*/
+class QuantizedLayer {
+ public:
+  virtual ~QuantizedLayer() {};
+
+  tensor::Tensor<int8_t> forward(const tensor::Tensor<int8_t> &input) const;
+  DTensor forward_float(const tensor::Tensor<int8_t> &input) const;
+  size_t get_weight_bytes() const;
+  inline double get_input_scale() const { return input_scale_; };
+  inline double get_output_scale() const { return output_scale_; };
+
+ protected:
+  enum class Activation { none, relu, sigmoid, tanh, gelu, silu };
+
+  size_t output_channel_;
+  double input_scale_, output_scale_;
+  Activation activation_;
+  bool channels_first_ = false;
+  tensor::Tensor<int8_t> weight_;
+  std::vector<float> multipliers_, bias_;
+
+  QuantizedLayer(Layer &layer, const double &input_scale, const double &output_scale);
+  void set_weight(const DTensor &weight);
+  void set_bias(const DTensor &bias);
+
+  // the int32 products shaped [n_batch, n_rows, c_out]
+  virtual tensor::Tensor<int32_t> accumulate(const tensor::Tensor<int8_t> &input) const = 0;
+  virtual tensor::TensorShape get_output_shape(const tensor::TensorShape &input_shape) const = 0;
+
+  template<typename oType>
+  tensor::Tensor<oType> epilogue(const tensor::Tensor<int8_t> &input) const;
+};
+
+class QuantizedDense : public QuantizedLayer {
+ public:
+  // output_scale 0 is for a last layer run with forward_float
+  QuantizedDense(Dense &dense, const double &input_scale, const double &output_scale = 0);
+
+ protected:
+  tensor::Tensor<int32_t> accumulate(const tensor::Tensor<int8_t> &input) const override;
+  tensor::TensorShape get_output_shape(const tensor::TensorShape &input_shape) const override;
+};
+
+class QuantizedConv2D : public QuantizedLayer {
+ public:
+  QuantizedConv2D(Conv2D &conv, const double &input_scale, const double &output_scale = 0);
+
+ protected:
+  std::array<size_t, 4> padding_;
+  std::array<size_t, 2> stride_, kernel_size_;
+
+  tensor::Tensor<int32_t> accumulate(const tensor::Tensor<int8_t> &input) const override;
+  tensor::TensorShape get_output_shape(const tensor::TensorShape &input_shape) const override;
+  tensor::Tensor<int8_t> pad(const tensor::Tensor<int8_t> &input) const;
+};
+
+/*
+  QuantizedSequential runs a calibrated chain of Dense and Conv2D layers in
+  int8 end to end: the input is quantized once, every layer hands int8 to the
+  next one and only the last layer writes DScalar. Inputs of more than two
+  dims are flattened before a Dense layer.
+*/
+class QuantizedSequential {
+ public:
+  QuantizedSequential(const Calibrator &calibrator);
+
+  DTensor forward(const DTensor &input) const;
+  size_t get_weight_bytes() const;
+
+ private:
+  std::vector<std::unique_ptr<QuantizedLayer>> layers_;
+  std::vector<bool> flatten_input_;
+};
+
+} // namespace layer
+} // namespace auto_diff
+
+#endif //ADGC_INCLUDE_AUTODIFF_LAYER_QUANTIZATION_H_
@@ -0,0 +1,73 @@
+#ifndef ADGC_AUTODIFF_MEMORY_PLANNER_H_
+#define ADGC_AUTODIFF_MEMORY_PLANNER_H_
+
+#include <string>
+#include <vector>
+
+namespace auto_diff {
+
+class Node;
+
+/*
+  MemoryPlan is worked out from an execution plan before it runs. The steps
+  are the forward evaluations of the nodes in order, followed by their
+  backward steps in reverse when the plan is trained; every value, gradient
+  and forward cache of the inner nodes is live from the step producing it to
+  the last step reading it, which depends on what the backward of each op
+  needs (see Node::is_value_needed_for_backward). Buffers whose live ranges
+  don't overlap share a slot of one arena, the slots are packed greedily from
+  the biggest buffer down. An activation whose input dies with it takes over
+  the input's buffer, see Node::can_run_in_place.
+  While the plan runs, each buffer is handed back to the allocator right
+  after its last step, so the caching allocator serves the later buffers of
+  the same slot from it; the outputs and the leaves are never released.
+*/
+struct MemoryBlock {
+  enum Kind { VALUE, GRAD, CACHE };
+
+  Node *node_ptr;
+  Kind kind;
+  size_t bytes;
+  // the first and the last step the buffer is live in
+  size_t first, last;
+  // where the slot of the buffer starts in the arena
+  size_t offset = 0;
+  // shares the buffer of the value of the first parent
+  bool in_place = false;
+};
+
+class MemoryPlan {
+ public:
+  MemoryPlan() {};
+
+  // nodes are the inner nodes of the execution plan in topological order
+  static MemoryPlan build(const std::vector<Node *> &nodes, const std::vector<Node *> &outputs, bool with_backward);
+
+  // release drops the buffers whose last step it is
+  void release(const size_t &step) const;
+
+  inline const std::vector<MemoryBlock> &get_blocks() const { return blocks_; };
+  // the arena size the buffers fit in with the planned sharing
+  inline size_t get_peak_bytes() const { return peak_bytes_; };
+  // the bytes of all the buffers, as if each of them had its own
+  inline size_t get_total_bytes() const { return total_bytes_; };
+  inline size_t get_num_steps() const { return releases_.size(); };
+  inline bool is_with_backward() const { return with_backward_; };
+  // whether the node at the forward step overwrites the value of its parent
+  inline bool is_in_place(const size_t &step) const { return in_place_[step]; };
+  std::string to_string() const;
+
+ private:
+  std::vector<MemoryBlock> blocks_;
+  // indices of the blocks released after each step
+  std::vector<std::vector<size_t>> releases_;
+  // by forward step, kept with the plan as other plans may run the same nodes
+  std::vector<bool> in_place_;
+  size_t peak_bytes_ = 0;
+  size_t total_bytes_ = 0;
+  bool with_backward_ = false;
+};
+
+} // namespace auto_diff
+
+#endif //ADGC_AUTODIFF_MEMORY_PLANNER_H_
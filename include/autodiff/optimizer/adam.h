@@ -18,10 +18,10 @@ class Adam : public Optimizer {
 
  private:
   double beta1_, beta2_, beta1_power_, beta2_power_, weight_decay_, epsilon_;
-  std::unordered_map<std::string, DTensor> moments_table_;
+  NodeTable<DTensor> first_moments_, second_moments_;
 
   void update(); // update the gradient to parameters
-  DTensor update_moments(const std::string &node_name, const DTensor &grad);
+  DTensor update_moments(const Node *node_ptr, const DTensor &grad);
 };
 } // namespace optimizer
 } // namespace auto_diff
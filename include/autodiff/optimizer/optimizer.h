@@ -18,20 +18,34 @@ class Optimizer {
   void zero_grad();
   void step();
   void set_requires_grads_for_all();
+  // the loss is multiplied by loss_scale before backward so that small
+  // gradients survive low precision, they are divided back before the
+  // update and a step with a non-finite gradient is skipped; a dynamic scale
+  // halves after such a step and doubles after a run of finite ones
+  void set_loss_scale(const double &loss_scale, bool dynamic = true);
+  inline double get_loss_scale() const { return loss_scale_; };
+  // backward runs on the plan given instead of one compiled from the target,
+  // so that it follows the memory plan of the forward pass
+  void set_plan(const ExecutionPlan &plan);
 
  protected:
   Graph *graph_;
   Node *target_node_ptr_;
-  std::unordered_map<std::string, DTensor>
-    acc_grads_; // accumulated mini-batch gradients
+  NodeTable<DTensor> acc_grads_; // accumulated mini-batch gradients
   double learning_rate_;
   bool get_all_grads_;
   std::vector<Node *> trainable_params_list_;
+  // compiled from the target along with the list of parameters unless set
+  ExecutionPlan backward_plan_;
+  double loss_scale_ = 1.;
+  bool dynamic_loss_scale_ = false;
+  size_t n_finite_steps_ = 0;
 
   void agg_trainable_params();
   DTensor get_gradient(Node *node_ptr); // get the mini-batched average gradient
   virtual void update() = 0;            // update the gradient to parameters
   void propagate();                     // do forward propagation and backward
+  bool unscale_grads();                 // false if a gradient is not finite
 };
 } // namespace optimizer
 } // namespace auto_diff
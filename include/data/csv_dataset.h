@@ -39,7 +39,7 @@ class CsvDataset {
   std::vector<std::function<void(tensor::Tensor<double> &)>>
     transforms_; // transform functions should look like [](Tensor& ts) ( ts = ...; )
 
-  void read_line(const std::string &sep);
+  void read_line(const std::string &line, const std::string &sep, const size_t &row_index);
   void do_shuffle(unsigned long seed = 0);
   void do_transform(tensor::Tensor<double> &);
 };
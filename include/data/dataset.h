@@ -22,5 +22,6 @@ typedef std::pair<tensor::Tensor<double>, tensor::Tensor<double>> DataPair;
 
 #include "image_dataset.h"
 #include "csv_dataset.h"
+#include "npy_dataset.h"
 
 #endif //ADGC_DATA_DATASET_H_
@@ -0,0 +1,44 @@
+#ifndef ADGC_DATA_NPY_DATASET_H_
+#define ADGC_DATA_NPY_DATASET_H_
+
+#include "dataset.h"
+#include "tensor/io.h"
+
+namespace auto_diff {
+namespace data {
+
+/*
+  NpyDataset serves batches of a feature array [n, ...] and a label array [n]
+  saved with np.save. Both files are memory mapped, float64 features are used
+  in place and only the rows of a batch are copied; other element types are
+  converted to double once on load.
+*/
+class NpyDataset {
+ public:
+  NpyDataset(const std::string &features_path,
+             const std::string &labels_path,
+             const size_t &batch_size = 8,
+             bool to_one_hot = false,
+             bool shuffle = true,
+             unsigned long shuffle_seed = 0);
+  bool has_next() const;
+  DataPair get_next();
+  void reset_iterator();
+  void reset_iterator(bool shuffle);
+
+  inline size_t get_label_count() const { return nlabels_; };
+  inline size_t get_data_count() const { return shuffle_indices_.size(); };
+
+ private:
+  bool shuffle_, to_one_hot_;
+  size_t batch_size_, shuffle_seed_, nlabels_, iter_index_;
+  tensor::Tensor<double> features_, labels_;
+  std::vector<size_t> shuffle_indices_;
+
+  void do_shuffle(unsigned long seed = 0);
+};
+
+}
+}
+
+#endif //ADGC_DATA_NPY_DATASET_H_
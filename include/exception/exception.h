@@ -93,6 +93,12 @@ class DividingZeroException : public TensorException {
   DividingZeroException(const std::string msg) : TensorException(msg) {};
 };
 
+class TensorIOError : public TensorException {
+ public:
+  TensorIOError() : TensorException("TensorIOError") {};
+  TensorIOError(const std::string &msg) : TensorException(msg) {};
+};
+
 class NonImplementedException : public AutoDiffGraphException {
  public:
   NonImplementedException()
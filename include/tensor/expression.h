@@ -0,0 +1,223 @@
+//
+// Lazy elementwise expressions over tensors
+//
+
+#ifndef ADGC_INCLUDE_TENSOR_EXPRESSION_H_
+#define ADGC_INCLUDE_TENSOR_EXPRESSION_H_
+
+#include <cmath>
+
+#include "tensor.h"
+
+/*
+  Arithmetic on tensor::lazy(...) builds an expression tree at compile time
+  instead of computing anything, e.g.
+
+    DTensor m = tensor::lazy(m) * beta + tensor::lazy(grad) * (1 - beta);
+
+  The tree is evaluated in one fused loop when it gets assigned to a tensor,
+  so a chain of n operations reads its inputs once and writes one result,
+  instead of allocating and writing n temporaries.
+
+  The operands are referenced, not copied: materialize an expression before
+  the tensors it was built from go away, don't keep it in an auto variable.
+  Operands need the same shape, scalars are repeated; use the eager
+  Tensor methods for broadcasting.
+*/
+
+namespace tensor {
+namespace expr {
+
+// at least this many elements per thread before evaluation is split up
+const size_t PARALLEL_MIN_CHUNK = 1 << 15;
+
+template<typename Derived>
+class Expression {
+ public:
+  inline const Derived &self() const { return static_cast<const Derived &>(*this); }
+  inline const TensorShape &get_shape() const { return self().get_shape(); }
+  inline size_t get_size() const { return self().get_size(); }
+};
+
+// TensorTerm is a leaf reading a tensor, strided views are packed once
+template<typename dType>
+class TensorTerm : public Expression<TensorTerm<dType>> {
+ public:
+  typedef dType value_type;
+
+  explicit TensorTerm(const Tensor<dType> &ts) : shape_(ts.get_shape()), size_(ts.get_size()) {
+    if (ts.is_contiguous()) {
+      values_ = ts.get_tensor_const_ptr();
+    } else {
+      packed_ = std::make_shared<Tensor<dType>>(ts.contiguous());
+      values_ = packed_->get_tensor_const_ptr();
+    }
+  }
+
+  inline dType operator[](const size_t &ix) const { return values_[ix]; }
+  inline const TensorShape &get_shape() const { return shape_; }
+  inline size_t get_size() const { return size_; }
+
+ private:
+  const dType *values_;
+  TensorShape shape_;
+  size_t size_;
+  std::shared_ptr<Tensor<dType>> packed_;
+};
+
+template<typename Op, typename E>
+class UnaryExpression : public Expression<UnaryExpression<Op, E>> {
+ public:
+  typedef typename E::value_type value_type;
+
+  UnaryExpression(const E &operand, const Op &op) : operand_(operand), op_(op) {}
+
+  inline value_type operator[](const size_t &ix) const { return op_(operand_[ix]); }
+  inline const TensorShape &get_shape() const { return operand_.get_shape(); }
+  inline size_t get_size() const { return operand_.get_size(); }
+
+ private:
+  E operand_;
+  Op op_;
+};
+
+template<typename Op, typename L, typename R>
+class BinaryExpression : public Expression<BinaryExpression<Op, L, R>> {
+ public:
+  typedef typename L::value_type value_type;
+
+  BinaryExpression(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+    if (lhs_.get_shape() != rhs_.get_shape()) {
+      throw adg_exception::MismatchTensorShapeError(
+        "Expression >> get mismatched shapes: " + utils::vector_to_str(lhs_.get_shape()) +
+          " and " + utils::vector_to_str(rhs_.get_shape()));
+    }
+  }
+
+  inline value_type operator[](const size_t &ix) const { return Op()(lhs_[ix], rhs_[ix]); }
+  inline const TensorShape &get_shape() const { return lhs_.get_shape(); }
+  inline size_t get_size() const { return lhs_.get_size(); }
+
+ private:
+  L lhs_;
+  R rhs_;
+};
+
+// ScalarExpression applies a binary op between each entry and a constant
+template<typename Op, typename E, bool scalar_first>
+class ScalarExpression : public Expression<ScalarExpression<Op, E, scalar_first>> {
+ public:
+  typedef typename E::value_type value_type;
+
+  ScalarExpression(const E &operand, const value_type &scalar) : operand_(operand), scalar_(scalar) {}
+
+  inline value_type operator[](const size_t &ix) const {
+    if constexpr (scalar_first) {
+      return Op()(scalar_, operand_[ix]);
+    } else {
+      return Op()(operand_[ix], scalar_);
+    }
+  }
+  inline const TensorShape &get_shape() const { return operand_.get_shape(); }
+  inline size_t get_size() const { return operand_.get_size(); }
+
+ private:
+  E operand_;
+  value_type scalar_;
+};
+
+// evaluate writes every entry of the expression into dest
+template<typename E>
+void evaluate(const Expression<E> &expression, typename E::value_type *dest) {
+  const E &expr = expression.self();
+  utils::threads::parallel_for(0, expr.get_size(), PARALLEL_MIN_CHUNK,
+                               [&expr, dest](size_t begin, size_t end) {
+                                 for (size_t ix = begin; ix < end; ++ix) {
+                                   dest[ix] = expr[ix];
+                                 }
+                               });
+}
+
+template<typename E>
+Tensor<typename E::value_type> eval(const Expression<E> &expression) {
+  return Tensor<typename E::value_type>(expression);
+}
+
+#define ADGC_EXPRESSION_BINARY_OP_(OP, FUNCTOR)                                                   \
+  template<typename L, typename R>                                                                \
+  BinaryExpression<FUNCTOR<typename L::value_type>, L, R>                                         \
+  operator OP(const Expression<L> &lhs, const Expression<R> &rhs) {                               \
+    return {lhs.self(), rhs.self()};                                                              \
+  }                                                                                               \
+  template<typename E>                                                                            \
+  ScalarExpression<FUNCTOR<typename E::value_type>, E, false>                                     \
+  operator OP(const Expression<E> &lhs, const typename E::value_type &rhs) {                      \
+    return {lhs.self(), rhs};                                                                     \
+  }                                                                                               \
+  template<typename E>                                                                            \
+  ScalarExpression<FUNCTOR<typename E::value_type>, E, true>                                      \
+  operator OP(const typename E::value_type &lhs, const Expression<E> &rhs) {                      \
+    return {rhs.self(), lhs};                                                                     \
+  }
+
+ADGC_EXPRESSION_BINARY_OP_(+, std::plus)
+ADGC_EXPRESSION_BINARY_OP_(-, std::minus)
+ADGC_EXPRESSION_BINARY_OP_(*, std::multiplies)
+ADGC_EXPRESSION_BINARY_OP_(/, std::divides)
+
+#undef ADGC_EXPRESSION_BINARY_OP_
+
+#define ADGC_EXPRESSION_UNARY_FUNC_(NAME, BODY)                                                   \
+  template<typename E>                                                                            \
+  auto NAME(const Expression<E> &operand) {                                                       \
+    typedef typename E::value_type value_type;                                                    \
+    auto op = [](const value_type &x) -> value_type { return BODY; };                             \
+    return UnaryExpression<decltype(op), E>(operand.self(), op);                                  \
+  }
+
+ADGC_EXPRESSION_UNARY_FUNC_(operator-, -x)
+ADGC_EXPRESSION_UNARY_FUNC_(sqrt, std::sqrt(x))
+ADGC_EXPRESSION_UNARY_FUNC_(square, x * x)
+ADGC_EXPRESSION_UNARY_FUNC_(exp, std::exp(x))
+ADGC_EXPRESSION_UNARY_FUNC_(log, std::log(x))
+ADGC_EXPRESSION_UNARY_FUNC_(abs, std::abs(x))
+
+#undef ADGC_EXPRESSION_UNARY_FUNC_
+
+// map applies any elementwise function, e.g. a clamp, inside the fused loop
+template<typename E, typename Func>
+UnaryExpression<Func, E> map(const Expression<E> &operand, const Func &func) {
+  return {operand.self(), func};
+}
+
+} // namespace expr
+
+// lazy is the entry point turning a tensor into an expression leaf
+template<typename dType>
+inline expr::TensorTerm<dType> lazy(const Tensor<dType> &ts) {
+  return expr::TensorTerm<dType>(ts);
+}
+
+template<typename dType>
+template<typename E>
+Tensor<dType>::Tensor(const expr::Expression<E> &expression)
+  : Tensor<dType>(uninitialized(expression.get_shape())) {
+  expr::evaluate(expression, get_tensor_ptr());
+}
+
+// the result is written in place when the shape is kept, a tensor referenced
+// by the expression itself can be overwritten since every entry only
+// depends on the same entry of the operands
+template<typename dType>
+template<typename E>
+Tensor<dType> &Tensor<dType>::operator=(const expr::Expression<E> &expression) {
+  if (shape_ != expression.get_shape()) {
+    *this = uninitialized(expression.get_shape());
+  }
+  expr::evaluate(expression, get_tensor_ptr());
+  return *this;
+}
+
+} // namespace tensor
+
+#endif //ADGC_INCLUDE_TENSOR_EXPRESSION_H_
@@ -19,11 +19,27 @@ Tensor<dType> pad2d(const Tensor<dType> &src_tensor,
                     const std::vector<std::pair<size_t, size_t>> &paddings,
                     const dType &value = 0);
 
+// pad2d into out, which keeps its buffer like the out variants of Tensor
+template<typename dType>
+void pad2d(const Tensor<dType> &src_tensor,
+           const std::vector<std::pair<size_t, size_t>> &paddings,
+           const dType &value,
+           Tensor<dType> &out);
+
 template<typename dType>
 Tensor<dType> dilate2d(const Tensor<dType> &src_tensor,
                        const std::array<size_t, 2> &gaps,
                        const dType &value = 0);
 
+// im2col_chw lays out the kh x kw windows of a [b, c, h, w] tensor as rows,
+// result shape: [b, out_h * out_w, c * kh * kw]
+template<typename dType>
+Tensor<dType> im2col_chw(const Tensor<dType> &input,
+                         const size_t &kh,
+                         const size_t &kw,
+                         const size_t &sh,
+                         const size_t &sw);
+
 template<typename dType>
 void reverse(Tensor<dType> &ts, const size_t &axis);
 
@@ -33,19 +49,84 @@ dType squared_sum(const Tensor<dType> &ts);
 template<typename dType>
 Tensor<dType> sqrt(const Tensor<dType> &ts);
 
+template<typename dType>
+void sqrt(const Tensor<dType> &ts, Tensor<dType> &out);
+
+template<typename dType>
+void sqrt_(Tensor<dType> &ts);
+
 template<typename dType>
 Tensor<dType> square(const Tensor<dType> &ts);
 
+template<typename dType>
+void square(const Tensor<dType> &ts, Tensor<dType> &out);
+
+template<typename dType>
+void square_(Tensor<dType> &ts);
+
 template<typename dType>
 Tensor<dType> add_vec(const Tensor<dType> &lt,
                       const Tensor<dType> &rt,
                       const size_t &axis);
 
+template<typename dType>
+void add_vec(const Tensor<dType> &lt,
+             const Tensor<dType> &rt,
+             const size_t &axis,
+             Tensor<dType> &out);
+
+// add_vec_ adds the vector vec to mat along the axis in place
+template<typename dType>
+void add_vec_(Tensor<dType> &mat,
+              const Tensor<dType> &vec,
+              const size_t &axis);
+
 template<typename dType>
 Tensor<dType> pmul_vec(const Tensor<dType> &lt,
                        const Tensor<dType> &rt,
                        const size_t &axis);
 
+template<typename dType>
+void pmul_vec(const Tensor<dType> &lt,
+              const Tensor<dType> &rt,
+              const size_t &axis,
+              Tensor<dType> &out);
+
+template<typename dType>
+void pmul_vec_(Tensor<dType> &mat,
+               const Tensor<dType> &vec,
+               const size_t &axis);
+
+// axpby computes y = alpha * x + beta * y in place, x and y of one shape
+template<typename dType>
+void axpby(const dType &alpha,
+           const Tensor<dType> &x,
+           const dType &beta,
+           Tensor<dType> &y);
+
+/*
+  Weight initializers, filling ts in place. fan_in and fan_out count the
+  inputs and outputs an entry connects, a convolution kernel includes its
+  window in both. Xavier (Glorot) keeps the variance at
+  2 / (fan_in + fan_out) for tanh and sigmoid layers, Kaiming (He) at
+  2 / fan_in for relu ones; gain scales the standard deviation.
+*/
+template<typename dType>
+void xavier_uniform_(Tensor<dType> &ts, const size_t &fan_in, const size_t &fan_out,
+                     const double &gain = 1., const size_t &seed = SIZE_MAX);
+
+template<typename dType>
+void xavier_normal_(Tensor<dType> &ts, const size_t &fan_in, const size_t &fan_out,
+                    const double &gain = 1., const size_t &seed = SIZE_MAX);
+
+template<typename dType>
+void kaiming_uniform_(Tensor<dType> &ts, const size_t &fan_in,
+                      const double &gain = M_SQRT2, const size_t &seed = SIZE_MAX);
+
+template<typename dType>
+void kaiming_normal_(Tensor<dType> &ts, const size_t &fan_in,
+                     const double &gain = M_SQRT2, const size_t &seed = SIZE_MAX);
+
 template<typename dType>
 Tensor<dType> dot(const Tensor<dType> &lt,
                   const Tensor<dType> &rt) {
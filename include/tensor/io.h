@@ -0,0 +1,142 @@
+#ifndef ADGC_INCLUDE_TENSOR_IO_H_
+#define ADGC_INCLUDE_TENSOR_IO_H_
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensor.h"
+
+namespace tensor {
+namespace io {
+
+/*
+  Reading and writing tensors in the .npy and .npz formats of NumPy.
+  Files are memory mapped on load and a C ordered array whose element type
+  matches is wrapped as the tensor storage without copying; the mapping is
+  private, so writes to such a tensor never reach the file. Arrays of
+  another element type are converted while they are copied out, Fortran
+  ordered ones come back as transposed views.
+  bfloat16 has no NumPy type of its own and is stored as raw 2-byte values
+  ('|V2'), view them as ml_dtypes.bfloat16 on the Python side.
+*/
+
+// the header of one .npy array
+struct NpyHeader {
+  std::string descr;
+  bool fortran_order = false;
+  TensorShape shape;
+  // bytes from the start of the array to its first element
+  size_t data_offset = 0;
+};
+
+// the NumPy type string of an element type, like "<f8" for double
+template<typename dType>
+std::string get_descr();
+
+// size in bytes of an element of the NumPy type string, 0 when unsupported
+size_t get_descr_size(const std::string &descr);
+
+NpyHeader parse_npy_header(const char *data, const size_t &size);
+std::string make_npy_header(const std::string &descr, const TensorShape &shape);
+
+// FileBuffer holds the bytes of a whole file, memory mapped or read in
+class FileBuffer {
+ public:
+  static std::shared_ptr<FileBuffer> open(const std::string &path, bool use_mmap = true);
+  ~FileBuffer();
+
+  FileBuffer(const FileBuffer &) = delete;
+  FileBuffer &operator=(const FileBuffer &) = delete;
+
+  inline char *data() const { return data_; };
+  inline size_t size() const { return size_; };
+  inline bool is_mapped() const { return mapped_; };
+
+ private:
+  FileBuffer() {};
+
+  char *data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+};
+
+// from_npy turns the .npy array at data into a tensor, it is wrapped without
+// a copy when the buffer is mapped and the element type matches
+template<typename dType>
+Tensor<dType> from_npy(const std::shared_ptr<FileBuffer> &buffer, const size_t &offset, const size_t &size);
+
+template<typename dType>
+void save_npy(const std::string &path, const Tensor<dType> &ts);
+
+template<typename dType>
+Tensor<dType> load_npy(const std::string &path, bool use_mmap = true);
+
+// NpzWriter writes the arrays uncompressed, as np.savez does
+class NpzWriter {
+ public:
+  explicit NpzWriter(const std::string &path);
+  ~NpzWriter();
+
+  template<typename dType>
+  void add(const std::string &name, const Tensor<dType> &ts);
+  // close writes the central directory, it is called by the destructor
+  void close();
+
+ private:
+  struct Entry {
+    std::string name;
+    uint32_t crc;
+    uint64_t size, offset;
+  };
+
+  std::string path_;
+  std::FILE *file_;
+  uint64_t position_ = 0;
+  std::vector<Entry> entries_;
+
+  void add_bytes(const std::string &name, const std::string &header, const char *data, const size_t &size);
+  void write(const void *data, const size_t &size);
+};
+
+// NpzReader lists the arrays of an .npz archive, compressed archives written
+// by np.savez_compressed are not supported
+class NpzReader {
+ public:
+  explicit NpzReader(const std::string &path, bool use_mmap = true);
+
+  std::vector<std::string> get_names() const;
+  bool contains(const std::string &name) const;
+  // the NumPy type string of an array
+  std::string get_descr(const std::string &name) const;
+  template<typename dType>
+  Tensor<dType> get(const std::string &name) const;
+
+ private:
+  struct Entry {
+    size_t offset, size;
+  };
+
+  std::string path_;
+  std::shared_ptr<FileBuffer> buffer_;
+  // keyed by the array name, without the .npy suffix
+  std::map<std::string, Entry> entries_;
+
+  const Entry &get_entry(const std::string &name) const;
+};
+
+template<typename dType>
+void save_npz(const std::string &path, const std::map<std::string, Tensor<dType>> &tensors);
+
+template<typename dType>
+std::map<std::string, Tensor<dType>> load_npz(const std::string &path, bool use_mmap = true);
+
+} // namespace io
+} // namespace tensor
+
+#include "tensor/io.tcc"
+
+#endif //ADGC_INCLUDE_TENSOR_IO_H_
@@ -9,18 +9,21 @@
 // Mapper is the class used to instantiate a function
 // applied to every entry in the tensor
 
-#define ADGC_MAX_MAPPER_THREADS_ 3
-
 namespace tensor {
 
+// entries per thread below which a map is not worth splitting up
+const size_t MAPPER_MIN_CHUNK = 1 << 14;
+
 template <typename dType> class Mapper {
 public:
   Mapper(){};
   Mapper(const std::function<void(dType &)> &func);
   Mapper(const std::function<void(dType &, const size_t &)> &func);
 
-  void run(dType *p_tensor, const size_t &size,
-           utils::threads::ThreadPool *p_pool = nullptr);
+  // run applies the function to size entries, in contiguous chunks on the
+  // shared thread pool when parallel is set, the function must only touch
+  // the entry it is given
+  void run(dType *p_tensor, const size_t &size, bool parallel = true) const;
 
 private:
   std::function<void(dType &, const size_t &)> task_;
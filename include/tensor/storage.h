@@ -0,0 +1,61 @@
+#ifndef ADGC_TENSOR_STORAGE_H_
+#define ADGC_TENSOR_STORAGE_H_
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include "utils/memory.h"
+
+namespace tensor {
+
+// Storage is the flat buffer behind a tensor, its memory comes from the
+// allocator returned by utils::memory::get_allocator() unless it wraps an
+// external buffer
+template<typename dType>
+class Storage {
+  static_assert(std::is_trivially_copyable_v<dType>,
+                "Storage only holds trivially copyable element types");
+
+ public:
+  // the elements are zero filled
+  explicit Storage(const size_t &size);
+  Storage(const size_t &size, const dType &value);
+  Storage(const size_t &size, const dType *values);
+  ~Storage();
+
+  Storage(const Storage<dType> &) = delete;
+  Storage<dType> &operator=(const Storage<dType> &) = delete;
+
+  // the elements are left uninitialized, only for buffers that get fully overwritten
+  static std::shared_ptr<Storage<dType>> make_uninitialized(const size_t &size);
+  // wrap uses an external buffer like a memory-mapped file without copying,
+  // owner is released together with the storage and should free the buffer,
+  // a null owner leaves the buffer to the caller
+  static std::shared_ptr<Storage<dType>> wrap(dType *data, const size_t &size,
+                                              std::shared_ptr<void> owner = nullptr);
+
+  inline dType *data() { return data_; };
+  inline const dType *data() const { return data_; };
+  inline dType *begin() { return data_; };
+  inline dType *end() { return data_ + size_; };
+  inline size_t size() const { return size_; };
+
+ private:
+  struct UninitializedTag {};
+  Storage(const size_t &size, UninitializedTag);
+  Storage(dType *data, const size_t &size, std::shared_ptr<void> owner);
+
+  dType *data_;
+  size_t size_;
+  // null for a wrapped buffer
+  utils::memory::Allocator *allocator_;
+  std::shared_ptr<void> owner_;
+};
+
+} // namespace tensor
+
+#include "tensor/storage.tcc"
+
+#endif
@@ -5,7 +5,9 @@
 #include <algorithm>
 #include <chrono>
 #include <cstring>
+#include <functional>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <string>
 #include <vector>
@@ -14,22 +16,32 @@
 
 #include "exception/exception.h"
 #include "mapper.h"
+#include "storage.h"
 #include "utils/math_utils.h"
+#include "utils/random.h"
+#include "utils/small_vector.h"
 #include "utils/thread.h"
 #include "utils/utils.h"
 
 namespace tensor {
 
-typedef std::vector<size_t> TensorShape;
-typedef std::vector<size_t> TensorIndex;
+// shapes, strides, indices and axis lists are kept inline without heap
+// allocations, a tensor has at most utils::MAX_RANK axes
+typedef utils::Dims TensorShape;
+typedef utils::Dims TensorIndex;
+typedef utils::Dims TensorAxes;
 typedef std::vector<std::array<size_t, 3>> TensorSlice;
-template<typename dType> using TensorIterator = std::vector<dType>::iterator;
+template<typename dType> using TensorIterator = dType *;
+
+// 16-bit element types, computed in float, see utils/half.h
+using utils::bfloat16;
+using utils::float16;
 
 const TensorShape EMPTY_SHAPE = {0};
 
-#if ADGC_MULTI_THREADS_NUM_
-static const size_t MAX_THREAD_NUM = 4;
-#endif
+namespace expr {
+template<typename Derived> class Expression;
+}
 
 template<typename dType>
 class Tensor {
@@ -43,13 +55,25 @@ class Tensor {
   Tensor(const TensorShape &shape, const std::vector<dType> &&values);
   Tensor(const Tensor<dType> &another);
   Tensor(const Tensor<dType> &&another);
+  // a tensor whose values are not initialized, for results that get fully overwritten
+  static Tensor<dType> uninitialized(const TensorShape &shape);
+  // a packed tensor on an existing storage, e.g. one wrapping a memory-mapped
+  // file; writes go through detach() like for any other tensor
+  static Tensor<dType> from_storage(const TensorShape &shape, std::shared_ptr<Storage<dType>> storage,
+                                    const size_t &offset = 0);
+  // materialize a lazy expression, see expression.h
+  template<typename E>
+  Tensor(const expr::Expression<E> &expression);
 
   // operator overload
   Tensor<dType> &operator=(const Tensor<dType> &bt);
+  template<typename E>
+  Tensor<dType> &operator=(const expr::Expression<E> &expression);
   bool operator==(const Tensor<dType> &bt) const;
   bool operator!=(const Tensor<dType> &bt) const;
   Tensor<dType> operator[](const size_t &id) const;
   Tensor<dType> operator[](const std::vector<size_t> &slice_indice) const;
+  Tensor<dType> operator[](const TensorIndex &slice_indice) const;
   Tensor<dType> operator-() const;
   Tensor<dType> operator/(const dType &denom) const;
   Tensor<dType> &operator+=(const Tensor<dType> &bt);
@@ -66,12 +90,27 @@ class Tensor {
   void map(Mapper<dType> &&mapper);
   void map(const std::function<void(dType &)> &func);
 
+  // take, slice, operator[] and the transposes return views sharing the
+  // storage of this tensor; call copy() or contiguous() to get a packed one
   Tensor<dType> take(const size_t &axis, const std::vector<size_t> &slice_indices) const;
   Tensor<dType> slice(const TensorSlice &slice) const;
   Tensor<dType> t() const;
   Tensor<dType> transpose() const;
   Tensor<dType> transpose(const size_t &axis_a, const size_t &axis_b) const;
+  // permute reorders all the axes, axis ix of the result is axes[ix] of this
+  Tensor<dType> permute(const TensorAxes &axes) const;
   Tensor<dType> copy() const;
+  Tensor<dType> contiguous() const;
+  bool is_contiguous() const;
+  // broadcast_to returns a view repeating this tensor along new leading axes
+  // and axes of size 1, the repeated axes get stride 0
+  Tensor<dType> broadcast_to(const TensorShape &shape) const;
+  // reduce_to_shape sums a broadcast result back to the shape of an operand
+  Tensor<dType> reduce_to_shape(const TensorShape &shape) const;
+  // copies of a tensor share one buffer until one of them writes to it,
+  // detach makes this tensor own a packed buffer right away
+  void detach();
+  inline bool is_shared() const { return tensor_.use_count() > 1; };
 
   Tensor<dType> dot(const Tensor<dType> &bt) const;
   Tensor<dType> multiply(const dType &multiplier) const;
@@ -81,53 +120,122 @@ class Tensor {
   Tensor<dType> add(const Tensor<dType> &bt) const;
   Tensor<dType> add(const dType &number) const;
   Tensor<dType> sub(const Tensor<dType> &bt) const;
+  // reductions take one axis, SIZE_MAX for all of them, or a list of axes
   Tensor<dType> sum(const size_t &axis = SIZE_MAX, bool keep_dim = false) const;
+  Tensor<dType> sum(const TensorAxes &axes, bool keep_dim = false) const;
   Tensor<dType> mean(const size_t &axis = SIZE_MAX, bool keep_dim = false) const;
+  Tensor<dType> mean(const TensorAxes &axes, bool keep_dim = false) const;
   Tensor<dType> max(const size_t &axis = SIZE_MAX, bool keep_dim = false) const;
+  Tensor<dType> max(const TensorAxes &axes, bool keep_dim = false) const;
+  Tensor<dType> min(const size_t &axis = SIZE_MAX, bool keep_dim = false) const;
+  Tensor<dType> min(const TensorAxes &axes, bool keep_dim = false) const;
+  Tensor<dType> var(const size_t &axis = SIZE_MAX, bool keep_dim = false) const;
+  Tensor<dType> var(const TensorAxes &axes, bool keep_dim = false) const;
+
+  // out variants write the result into out, which keeps its buffer when it
+  // is not shared and has the right size, see resize(); an out that is one
+  // of the operands gets a new buffer, use the in-place variants for that
+  void dot(const Tensor<dType> &bt, Tensor<dType> &out) const;
+  void multiply(const dType &multiplier, Tensor<dType> &out) const;
+  void multiply(const Tensor<dType> &bt, Tensor<dType> &out) const;
+  void div(const dType &denom, Tensor<dType> &out) const;
+  void div(const Tensor<dType> &bt, Tensor<dType> &out) const;
+  void add(const Tensor<dType> &bt, Tensor<dType> &out) const;
+  void add(const dType &number, Tensor<dType> &out) const;
+  void sub(const Tensor<dType> &bt, Tensor<dType> &out) const;
+  void sum(const size_t &axis, bool keep_dim, Tensor<dType> &out) const;
+  void sum(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const;
+  void mean(const size_t &axis, bool keep_dim, Tensor<dType> &out) const;
+  void mean(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const;
+  void max(const size_t &axis, bool keep_dim, Tensor<dType> &out) const;
+  void max(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const;
+  void min(const size_t &axis, bool keep_dim, Tensor<dType> &out) const;
+  void min(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const;
+  void var(const size_t &axis, bool keep_dim, Tensor<dType> &out) const;
+  void var(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const;
+
+  // in-place variants write into this tensor, bt is broadcast to its shape
+  Tensor<dType> &add_(const Tensor<dType> &bt);
+  Tensor<dType> &add_(const dType &number);
+  Tensor<dType> &sub_(const Tensor<dType> &bt);
+  Tensor<dType> &sub_(const dType &number);
+  Tensor<dType> &multiply_(const Tensor<dType> &bt);
+  Tensor<dType> &multiply_(const dType &multiplier);
+  Tensor<dType> &div_(const Tensor<dType> &bt);
+  Tensor<dType> &div_(const dType &denom);
+
+  // resize turns this tensor into a packed one of the given shape to be
+  // overwritten, the buffer is kept when it is not shared and has the same
+  // size, otherwise a new uninitialized one is allocated
+  void resize(const TensorShape &shape);
   Tensor<dType> arg_amax(const size_t &axis = SIZE_MAX, bool keep_dim = false) const;
+  // random fills drawn in parallel from utils::random::Philox, the same seed
+  // gives the same values for any number of threads; SIZE_MAX draws from the
+  // process wide seed, see utils::random::manual_seed
   void normal_init(double loc = 0., double scale = 1., size_t seed = SIZE_MAX);
+  void uniform_init(double low = 0., double high = 1., size_t seed = SIZE_MAX);
+  void bernoulli_init(double p = 0.5, size_t seed = SIZE_MAX);
 
   TensorShape get_dot_shape(const Tensor<dType> &bt) const;
 
+  // cast converts every entry with static_cast, values out of the range
+  // of an integer type are not clamped
+  template<typename oType>
+  Tensor<oType> cast() const;
   Tensor<int32_t> to_int() const;
+  Tensor<int8_t> to_int8() const;
+  Tensor<uint8_t> to_uint8() const;
   Tensor<float> to_float() const;
   Tensor<double> to_double() const;
+  Tensor<bfloat16> to_bfloat16() const;
+  Tensor<float16> to_float16() const;
 
   inline size_t get_shape(const size_t &axis) const {
     assert(axis < dim_);
     return shape_[axis];
   };
-  inline TensorShape get_shape() const { return shape_; };
+  inline const TensorShape &get_shape() const { return shape_; };
   inline size_t get_size() const { return size_; };
   inline size_t get_dim() const { return dim_; };
   inline size_t get_stride(const size_t &axis) {
     assert(axis < dim_);
     return strides_[axis];
   };
-  inline TensorShape get_strides() const { return strides_; };
+  inline const TensorShape &get_strides() const { return strides_; };
+  inline size_t get_offset() const { return offset_; };
   inline std::string to_string() const { return do_to_string(); };
-  inline std::vector<dType> to_vector() const {
-    return *static_cast<std::vector<dType> *>(tensor_.get());
-  };
+  std::vector<dType> to_vector() const;
+  // the raw pointer only walks the elements in order when is_contiguous()
   inline const dType *get_tensor_const_ptr() const {
-    return &*tensor_->begin();
+    return &*tensor_->begin() + offset_;
   };
+  // writable access detaches the storage first
   inline TensorIterator<dType> get_iterator() {
-    return tensor_->begin();
+    detach();
+    return tensor_->begin() + offset_;
   }
 
   static Tensor<dType> kron(const Tensor<dType> &lt, const Tensor<dType> &rt);
   static Tensor<dType> concat(const std::vector<Tensor<dType>> &tensors, const size_t &axis);
   static size_t get_coordinate_at_axis(const size_t &ind, const size_t &axis,
                                        const TensorShape &strides);
+  // numpy rules: shapes are aligned to the right, and each pair of
+  // dimensions has to be equal or contain a 1
+  static TensorShape broadcast_shape(const TensorShape &lhs, const TensorShape &rhs);
 
  protected:
-  // store tensor as a vector, wrapped in shared_ptr for easy copy
-  std::shared_ptr<std::vector<dType>> tensor_;
+  // tensors of other element types take shortcuts through each other
+  template<typename oType> friend class Tensor;
+
+  // store tensor as a flat buffer, wrapped in shared_ptr for easy copy,
+  // writes go through detach() so a shared buffer is never modified
+  std::shared_ptr<Storage<dType>> tensor_;
   TensorShape shape_;
   TensorShape strides_;
   size_t size_;
   size_t dim_;
+  // position of the first element inside tensor_, non-zero for views
+  size_t offset_ = 0;
 
   bool is_shape_valid(const TensorShape &shape) const;
   bool is_index_valid(const TensorIndex &index) const;
@@ -135,25 +243,42 @@ class Tensor {
   // helper functions
   TensorIterator<dType> get_iterator(const TensorIndex &index);
   const TensorIterator<dType> get_const_iterator(const TensorIndex &index) const;
-  void slice_recursive_copy(const size_t &depth, const size_t &cur_axis, const TensorSlice &slice,
-                            const dType *src_ptr, dType *dest_ptr, size_t &dest_index) const;
-  static size_t get_index_after_transpose(const size_t &arr_ind,
-                                          const size_t &axis_a,
-                                          const size_t &axis_b,
-                                          const TensorShape &ori_strides,
-                                          const TensorShape &new_strides);
   static size_t get_index_after_concat(
     const size_t &ind, const size_t &axis, const size_t &offset_at_axis,
     const TensorShape &ori_strides, const TensorShape &new_strides);
-  inline dType *get_tensor_ptr() { return &*tensor_->begin(); };
+  inline dType *get_tensor_ptr() {
+    detach();
+    return &*tensor_->begin() + offset_;
+  };
+  Tensor<dType> make_view(const TensorShape &shape, const TensorShape &strides,
+                          const size_t &offset) const;
+  void make_contiguous();
+  // strides to read this tensor as if it had the broadcast shape
+  TensorShape get_broadcast_strides(const TensorShape &shape) const;
+  // an out of one of the operands cannot be resized before they are read
+  inline bool is_operand(const Tensor<dType> &out, const Tensor<dType> &bt) const {
+    return &out == this || &out == &bt;
+  };
+  template<typename BinaryOp>
+  void broadcast_op(const Tensor<dType> &bt, BinaryOp op, Tensor<dType> &out) const;
+  template<typename BinaryOp>
+  void broadcast_op_inplace(const Tensor<dType> &bt, BinaryOp op);
+  template<typename BinaryOp>
+  void scalar_op(const dType &number, BinaryOp op, Tensor<dType> &out) const;
+  template<typename BinaryOp>
+  void scalar_op_inplace(const dType &number, BinaryOp op);
+  TensorAxes get_axes(const size_t &axis) const;
+  utils::DimMask get_reduce_mask(const TensorAxes &axes) const;
+  TensorShape get_reduced_shape(const utils::DimMask &reduce_mask, bool keep_dim) const;
+  template<typename Reducer>
+  void reduce(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const;
+  bool get_gemm_operand(utils::math::GemmOperand<dType> &operand) const;
 
   // impl functions
   void do_shape_update(const TensorShape &shape, const size_t &keep_size = 0);
-  void do_transpose(const size_t &axis_a, const size_t &axis_b,
-                    Tensor<dType> &dest_tensor) const;
   inline std::string do_to_string() const {
-    dType *raw_tensor_ptr = &*tensor_->begin();
-    return utils::multi_array_to_str(shape_, raw_tensor_ptr);
+    Tensor<dType> packed = contiguous();
+    return utils::multi_array_to_str(shape_, packed.get_tensor_const_ptr());
   }
 };
 
@@ -193,10 +318,8 @@ class Ranges : public Tensor<dType> {
   Ranges() {};
   Ranges(const TensorShape &shape, const dType &init)
     : Tensor<dType>(std::move(shape)) {
-    size_t size = Tensor<dType>::get_size();
-    dType *val = new dType[size];
-    std::iota(val, val + size, init);
-    memcpy(Tensor<dType>::get_tensor_ptr(), val, sizeof(dType) * size);
+    dType *val = Tensor<dType>::get_tensor_ptr();
+    std::iota(val, val + Tensor<dType>::get_size(), init);
   }
 };
 
@@ -211,5 +334,6 @@ static const Tensor<double> EMPTY = {{1}};
 #include "tensor/tensor_manip.tcc"
 #include "tensor/tensor_numeric.tcc"
 #include "tensor/extension.h"
+#include "tensor/expression.h"
 
 #endif
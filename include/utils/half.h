@@ -0,0 +1,156 @@
+#ifndef ADGC_UTILS_HALF_H_
+#define ADGC_UTILS_HALF_H_
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+
+namespace utils {
+
+// bit level conversions, float is rounded to the nearest even value
+inline uint16_t float_to_bfloat16_bits(const float &value) {
+  uint32_t bits = std::bit_cast<uint32_t>(value);
+  if ((bits & 0x7fffffff) > 0x7f800000) {
+    // keep NaN a quiet NaN instead of rounding it into infinity
+    return static_cast<uint16_t>((bits >> 16) | 0x0040);
+  }
+  bits += 0x7fff + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+inline float bfloat16_bits_to_float(const uint16_t &bits) {
+  return std::bit_cast<float>(static_cast<uint32_t>(bits) << 16);
+}
+
+inline uint16_t float_to_float16_bits(const float &value) {
+  uint32_t bits = std::bit_cast<uint32_t>(value);
+  uint32_t sign = (bits >> 16) & 0x8000;
+  bits &= 0x7fffffff;
+
+  if (bits >= 0x7f800000) {
+    // infinity, or NaN with a mantissa bit set
+    return static_cast<uint16_t>(sign | 0x7c00 | (bits > 0x7f800000 ? 0x0200 : 0));
+  }
+  if (bits >= 0x477ff000) {
+    // 65520 and above round to infinity
+    return static_cast<uint16_t>(sign | 0x7c00);
+  }
+  if (bits < 0x38800000) {
+    // below 2^-14 the result is subnormal, adding 0.5 leaves the rounded
+    // multiple of 2^-24 in the low bits of the float
+    float shifted = std::bit_cast<float>(bits) + 0.5f;
+    return static_cast<uint16_t>(sign | (std::bit_cast<uint32_t>(shifted) - 0x3f000000));
+  }
+  // rebias the exponent from 127 to 15 and round the 13 dropped bits
+  bits += 0xc8000fff + ((bits >> 13) & 1);
+  return static_cast<uint16_t>(sign | (bits >> 13));
+}
+
+inline float float16_bits_to_float(const uint16_t &bits) {
+  uint32_t sign = static_cast<uint32_t>(bits & 0x8000) << 16;
+  uint32_t exponent = (bits >> 10) & 0x1f;
+  uint32_t mantissa = bits & 0x3ff;
+
+  if (exponent == 0x1f) {
+    return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+  }
+  if (exponent == 0) {
+    // zero or subnormal, mantissa * 2^-24
+    float magnitude = static_cast<float>(mantissa) * 5.9604644775390625e-08f;
+    return sign ? -magnitude : magnitude;
+  }
+  return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+/*
+  bfloat16 and float16 are 16-bit storage types. bfloat16 keeps the exponent
+  of a float with 8 bits of precision, float16 is the IEEE half with 11 bits
+  of precision and a largest value of 65504.
+  Arithmetic between two of them is done in float and rounded once; mixed
+  with other numbers they convert to float, and converting back is explicit.
+*/
+struct bfloat16 {
+  uint16_t bits;
+
+  bfloat16() = default;
+  template<typename T>
+  requires std::is_convertible_v<T, float>
+  explicit bfloat16(const T &value) : bits(float_to_bfloat16_bits(static_cast<float>(value))) {}
+
+  inline operator float() const { return bfloat16_bits_to_float(bits); }
+
+  static inline bfloat16 from_bits(const uint16_t &bits) {
+    bfloat16 result;
+    result.bits = bits;
+    return result;
+  }
+};
+
+struct float16 {
+  uint16_t bits;
+
+  float16() = default;
+  template<typename T>
+  requires std::is_convertible_v<T, float>
+  explicit float16(const T &value) : bits(float_to_float16_bits(static_cast<float>(value))) {}
+
+  inline operator float() const { return float16_bits_to_float(bits); }
+
+  static inline float16 from_bits(const uint16_t &bits) {
+    float16 result;
+    result.bits = bits;
+    return result;
+  }
+};
+
+template<typename dType>
+concept half_precision = std::same_as<dType, bfloat16> || std::same_as<dType, float16>;
+
+template<half_precision dType>
+inline dType operator+(const dType &lhs, const dType &rhs) {
+  return dType(static_cast<float>(lhs) + static_cast<float>(rhs));
+}
+
+template<half_precision dType>
+inline dType operator-(const dType &lhs, const dType &rhs) {
+  return dType(static_cast<float>(lhs) - static_cast<float>(rhs));
+}
+
+template<half_precision dType>
+inline dType operator*(const dType &lhs, const dType &rhs) {
+  return dType(static_cast<float>(lhs) * static_cast<float>(rhs));
+}
+
+template<half_precision dType>
+inline dType operator/(const dType &lhs, const dType &rhs) {
+  return dType(static_cast<float>(lhs) / static_cast<float>(rhs));
+}
+
+template<half_precision dType>
+inline dType operator-(const dType &value) {
+  // flip the sign bit only, like the negation of a float
+  return dType::from_bits(value.bits ^ 0x8000);
+}
+
+template<half_precision dType>
+inline dType &operator+=(dType &lhs, const dType &rhs) { return lhs = lhs + rhs; }
+
+template<half_precision dType>
+inline dType &operator-=(dType &lhs, const dType &rhs) { return lhs = lhs - rhs; }
+
+template<half_precision dType>
+inline dType &operator*=(dType &lhs, const dType &rhs) { return lhs = lhs * rhs; }
+
+template<half_precision dType>
+inline dType &operator/=(dType &lhs, const dType &rhs) { return lhs = lhs / rhs; }
+
+template<half_precision dType>
+inline std::ostream &operator<<(std::ostream &os, const dType &value) {
+  return os << static_cast<float>(value);
+}
+
+} // namespace utils
+
+#endif
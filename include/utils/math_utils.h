@@ -4,26 +4,131 @@
 #include <mkl.h>
 #include <cmath>
 #include <cstdlib>
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <vector>
+
+#include "utils/small_vector.h"
 
 #include "exception/exception.h"
+#include "half.h"
 #include "thread.h"
 #include "utils.h"
 
 namespace utils {
 namespace math {
 
+// element types without BLAS kernels, served by plain loops
+template<typename dType>
+concept loop_kernel_type = std::integral<dType> || half_precision<dType>;
+
+// convert casts a run of entries into another element type
+template<typename sType, typename dType>
+void convert(const size_t &size, const sType *src, dType *dest);
+
 template<typename dType>
 void tensor_gemm(const size_t &size_a, const size_t &size_b,
                  const size_t &size_c, const size_t &M, const size_t &N,
                  const size_t &K, const dType *mat_a, const dType *mat_b,
                  dType *mat_c);
 
+// GemmOperand describes the matrices on one side of a batched product:
+// they are read transposed when trans is set, ld is the distance between
+// two rows and batch_stride the one between two matrices, 0 to repeat one
+template<typename dType>
+struct GemmOperand {
+  const dType *data;
+  bool trans;
+  size_t ld;
+  size_t batch_stride;
+};
+
+// tensor_gemm computes n_blocks products op(A) * op(B) into packed [M, N] blocks of C
+template<typename dType>
+void tensor_gemm(const size_t &n_blocks, const size_t &M, const size_t &N, const size_t &K,
+                 const GemmOperand<dType> &lhs, const GemmOperand<dType> &rhs, dType *mat_c);
+
 template<typename dType>
 void tensor_kron_product(const size_t &size_a, const size_t &size_b,
                          const size_t &row_a, const size_t &col_a,
                          const size_t &row_b, const size_t &col_b,
                          const dType *mat_a, const dType *mat_b, dType *mat_c);
+
+template<typename dType>
+void strided_copy(const Dims &shape,
+                  const Dims &src_strides, const dType *src,
+                  const Dims &dest_strides, dType *dest);
+
+template<typename dType, typename BinaryOp>
+void broadcast_binary(const Dims &shape,
+                      const Dims &lhs_strides, const dType *lhs,
+                      const Dims &rhs_strides, const dType *rhs,
+                      const Dims &dest_strides, dType *dest,
+                      BinaryOp op);
+
+// reducers for reduce(), fold values with combine starting from identity
+template<typename dType> struct SumReducer;
+template<typename dType> struct MaxReducer;
+template<typename dType> struct MinReducer;
+
+template<typename dType, typename Reducer>
+void reduce(const Dims &shape, const DimMask &reduce_mask,
+            const dType *src, dType *dest);
+
+template<typename dType, typename Compare>
+void arg_reduce(const size_t &outer, const size_t &len, const size_t &inner,
+                const dType *src, dType *dest, Compare better);
+
+/*
+  Activation kernels. Each forward and backward is one pass over the data:
+  the entries go in blocks small enough to stay in L1 through the chained
+  VML calls (exp, tanh, erf) and the arithmetic around them, and the blocks
+  are spread over the thread runtime. Backward kernels write the gradient of
+  the input from the gradient of the output, reading y or x as each needs.
+*/
+template<std::floating_point dType>
+void relu_forward(const size_t &size, const dType *x, dType *y);
+template<std::floating_point dType>
+void relu_backward(const size_t &size, const dType *y, const dType *grad, dType *dx);
+
+template<std::floating_point dType>
+void leaky_relu_forward(const size_t &size, const dType *x, const dType &alpha, dType *y);
+template<std::floating_point dType>
+void leaky_relu_backward(const size_t &size, const dType *x, const dType *grad, const dType &alpha, dType *dx);
+
+template<std::floating_point dType>
+void sigmoid_forward(const size_t &size, const dType *x, dType *y);
+template<std::floating_point dType>
+void sigmoid_backward(const size_t &size, const dType *y, const dType *grad, dType *dx);
+
+template<std::floating_point dType>
+void tanh_forward(const size_t &size, const dType *x, dType *y);
+template<std::floating_point dType>
+void tanh_backward(const size_t &size, const dType *y, const dType *grad, dType *dx);
+
+// gelu(x) = x * Φ(x) with the exact normal cdf
+template<std::floating_point dType>
+void gelu_forward(const size_t &size, const dType *x, dType *y);
+template<std::floating_point dType>
+void gelu_backward(const size_t &size, const dType *x, const dType *grad, dType *dx);
+
+// silu(x) = x * sigmoid(x)
+template<std::floating_point dType>
+void silu_forward(const size_t &size, const dType *x, dType *y);
+template<std::floating_point dType>
+void silu_backward(const size_t &size, const dType *x, const dType *grad, dType *dx);
+
+// softmax along rows of n_cols entries, exp(x) / (sum + epsilon)
+template<std::floating_point dType>
+void softmax(const size_t &n_rows, const size_t &n_cols, const dType *x, const dType &epsilon, dType *y);
+
+// y = -log(x + epsilon)
+template<std::floating_point dType>
+void negative_log(const size_t &size, const dType *x, const dType &epsilon, dType *y);
 } // namespace math
 } // namespace utils
 
@@ -0,0 +1,115 @@
+#ifndef ADGC_UTILS_MEMORY_H_
+#define ADGC_UTILS_MEMORY_H_
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace utils {
+namespace memory {
+
+// every buffer handed out is aligned for AVX-512 loads and MKL
+const size_t MEMORY_ALIGNMENT = 64;
+
+/*
+  Buffers of at least the huge page threshold, im2col images and gemm outputs
+  of big convolutions for instance, are aligned to 2 MB and advised to the
+  kernel as transparent huge pages, so that streaming over hundreds of MB
+  does not miss the dTLB every 4 KB. The threshold is read from the
+  ADGC_HUGE_PAGE_THRESHOLD environment variable (in bytes) when set, 0 turns
+  huge pages off. Only has an effect on Linux.
+*/
+const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+const size_t DEFAULT_HUGE_PAGE_THRESHOLD = size_t(4) << 20;
+
+struct AllocatorStats {
+  size_t hits = 0;         // requests served from a free list
+  size_t misses = 0;       // requests that went to the system allocator
+  size_t bytes_cached = 0; // bytes kept in free lists, released by trim()
+  size_t bytes_in_use = 0; // bytes currently handed out
+};
+
+// Allocator is the interface tensor storage gets its buffers from
+class Allocator {
+ public:
+  virtual ~Allocator() {};
+  virtual void *allocate(const size_t &bytes) = 0;
+  virtual void deallocate(void *ptr, const size_t &bytes) = 0;
+  virtual AllocatorStats get_stats() const { return {}; };
+  virtual void trim() {};
+};
+
+// AlignedAllocator goes to the system allocator for every request
+class AlignedAllocator : public Allocator {
+ public:
+  void *allocate(const size_t &bytes) override;
+  void deallocate(void *ptr, const size_t &bytes) override;
+  AllocatorStats get_stats() const override;
+
+ private:
+  std::atomic<size_t> misses_ = 0;
+  std::atomic<size_t> bytes_in_use_ = 0;
+};
+
+/*
+  CachingAllocator rounds requests up to power-of-two size classes and keeps
+  freed blocks in per-thread free lists, so a training step allocating the
+  same temporaries again and again is served without malloc and page faults.
+  Blocks larger than the biggest class are not cached.
+*/
+class CachingAllocator : public Allocator {
+ public:
+  explicit CachingAllocator(const size_t &max_cached_bytes_per_thread = DEFAULT_MAX_CACHED_BYTES);
+  ~CachingAllocator() override;
+
+  void *allocate(const size_t &bytes) override;
+  void deallocate(void *ptr, const size_t &bytes) override;
+  AllocatorStats get_stats() const override;
+  // trim releases the cached blocks of all threads back to the system
+  void trim() override;
+
+  static constexpr size_t MIN_CLASS_SHIFT = 6;  // 64 bytes
+  static constexpr size_t MAX_CLASS_SHIFT = 28; // 256 MB
+  static constexpr size_t DEFAULT_MAX_CACHED_BYTES = size_t(1) << 30;
+
+ private:
+  struct ThreadCache {
+    std::mutex mutex;
+    std::vector<void *> free_lists[MAX_CLASS_SHIFT + 1];
+    size_t bytes_cached = 0;
+    CachingAllocator *owner = nullptr; // reset when the allocator goes away
+  };
+
+  ThreadCache *get_thread_cache();
+  // expects the mutex of the cache to be held
+  void release_blocks(ThreadCache &cache);
+  static size_t get_size_class(const size_t &bytes);
+
+  size_t id_;
+  size_t max_cached_bytes_;
+  std::mutex registry_mutex_;
+  std::vector<std::shared_ptr<ThreadCache>> caches_;
+
+  std::atomic<size_t> hits_ = 0;
+  std::atomic<size_t> misses_ = 0;
+  std::atomic<size_t> bytes_cached_ = 0;
+  std::atomic<size_t> bytes_in_use_ = 0;
+};
+
+void *aligned_malloc(const size_t &bytes);
+void aligned_free(void *ptr);
+
+size_t get_huge_page_threshold();
+void set_huge_page_threshold(const size_t &bytes);
+
+// the allocator used by new tensors, a process wide CachingAllocator by default;
+// set_allocator(nullptr) restores the default one
+Allocator *get_allocator();
+void set_allocator(Allocator *allocator);
+
+} // namespace memory
+} // namespace utils
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef ADGC_UTILS_PERF_H_
+#define ADGC_UTILS_PERF_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace utils {
+namespace perf {
+
+/*
+  PerfCounters reads the hardware counters of the calling thread and of the
+  threads it starts afterwards through perf_event_open on Linux, used by
+  the benchmarks to see how many dTLB misses and page faults a kernel costs.
+  Threads running before the counters are opened are not counted, so open
+  them before the thread runtime and BLAS start theirs. Counters the kernel or the CPU
+  does not offer (in containers or with perf_event_paranoid > 2) stay
+  unavailable and read as 0.
+*/
+class PerfCounters {
+ public:
+  enum Event { dtlb_loads = 0, dtlb_load_misses, page_faults, n_events };
+
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  // start resets the counters and starts counting, stop freezes them
+  void start();
+  void stop();
+
+  bool is_available(const Event &event) const;
+  uint64_t get(const Event &event) const;
+  // dtlb load misses per thousand dtlb loads
+  double get_dtlb_miss_rate() const;
+  // one line like "dTLB loads 1000, dTLB load misses 12 (12.0 per mille), page faults 3"
+  std::string to_string() const;
+
+ private:
+  std::array<int, n_events> fds_;
+  std::array<uint64_t, n_events> counts_;
+};
+
+} // namespace perf
+} // namespace utils
+
+#endif //ADGC_UTILS_PERF_H_
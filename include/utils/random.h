@@ -0,0 +1,77 @@
+#ifndef ADGC_UTILS_RANDOM_H_
+#define ADGC_UTILS_RANDOM_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "thread.h"
+
+namespace utils {
+namespace random {
+
+/*
+  Philox is the counter-based generator Philox4x32-10 of Salmon et al.: the
+  block at index i is a keyed hash of i, so any part of a sequence can be
+  produced without stepping through the ones before it. Fills split their
+  blocks across threads and give the same values for any number of threads.
+  The stream picks one of 2^64 independent sequences for the same seed.
+*/
+class Philox {
+ public:
+  explicit Philox(const uint64_t &seed, const uint64_t &stream = 0)
+    : key_{uint32_t(seed), uint32_t(seed >> 32)}, stream_(stream) {};
+
+  // the four random words of the block at index
+  inline std::array<uint32_t, 4> operator()(const uint64_t &index) const {
+    std::array<uint32_t, 4> counter = {uint32_t(index), uint32_t(index >> 32), uint32_t(stream_),
+                                       uint32_t(stream_ >> 32)};
+    uint32_t key_0 = key_[0], key_1 = key_[1];
+    for (int round = 0; round < 10; ++round) {
+      uint64_t product_0 = uint64_t(MULTIPLIER_0) * counter[0];
+      uint64_t product_1 = uint64_t(MULTIPLIER_1) * counter[2];
+      counter = {uint32_t(product_1 >> 32) ^ counter[1] ^ key_0, uint32_t(product_1),
+                 uint32_t(product_0 >> 32) ^ counter[3] ^ key_1, uint32_t(product_0)};
+      key_0 += WEYL_0;
+      key_1 += WEYL_1;
+    }
+    return counter;
+  }
+
+ private:
+  static constexpr uint32_t MULTIPLIER_0 = 0xD2511F53, MULTIPLIER_1 = 0xCD9E8D57;
+  static constexpr uint32_t WEYL_0 = 0x9E3779B9, WEYL_1 = 0xBB67AE85;
+
+  uint32_t key_[2];
+  uint64_t stream_;
+};
+
+// a word mapped into the open interval (0, 1)
+inline double to_unit(const uint32_t &word) {
+  return (word + 0.5) * (1. / 4294967296.);
+}
+
+// get_generator returns a generator for the seed, SIZE_MAX takes the next
+// stream of the process wide seed so that unseeded fills still differ
+Philox get_generator(const size_t &seed = SIZE_MAX);
+// manual_seed sets the process wide seed and starts its streams over,
+// it is 0 until set
+void manual_seed(const uint64_t &seed);
+
+// fills of size entries, split across threads in blocks of four values
+template<typename dType>
+void fill_uniform(const size_t &size, const Philox &generator, const double &low, const double &high, dType *dest);
+template<typename dType>
+void fill_normal(const size_t &size, const Philox &generator, const double &mean, const double &stddev, dType *dest);
+// 1 with probability p, 0 otherwise
+template<typename dType>
+void fill_bernoulli(const size_t &size, const Philox &generator, const double &p, dType *dest);
+
+} // namespace random
+} // namespace utils
+
+#include "utils/random.tcc"
+
+#endif //ADGC_UTILS_RANDOM_H_
@@ -0,0 +1,192 @@
+#ifndef ADGC_UTILS_SMALL_VECTOR_H_
+#define ADGC_UTILS_SMALL_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace utils {
+
+/*
+  SmallVector keeps up to N trivially copyable values inline and never goes
+  to the heap, it is meant for shapes, strides and indices of tensors that
+  are created and copied all the time. The interface follows std::vector as
+  far as those need it; growing past N throws std::length_error.
+*/
+template<typename T, size_t N>
+class SmallVector {
+  static_assert(std::is_trivially_copyable_v<T>, "SmallVector only holds trivially copyable values");
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = T *;
+  using const_iterator = const T *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  SmallVector() = default;
+  explicit SmallVector(const size_t &count, const T &value = T()) { assign(count, value); };
+  SmallVector(std::initializer_list<T> values) { assign(values.begin(), values.end()); };
+  template<std::input_iterator It>
+  SmallVector(It first, It last) { assign(first, last); };
+  SmallVector(const std::vector<T> &values) { assign(values.begin(), values.end()); };
+
+  explicit operator std::vector<T>() const { return std::vector<T>(begin(), end()); };
+
+  void assign(const size_t &count, const T &value) {
+    check_capacity(count);
+    std::fill_n(data_, count, value);
+    size_ = count;
+  }
+
+  template<std::input_iterator It>
+  void assign(It first, It last) {
+    size_ = 0;
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  inline size_t size() const { return size_; };
+  inline bool empty() const { return size_ == 0; };
+  static constexpr size_t capacity() { return N; };
+  static constexpr size_t max_size() { return N; };
+  // nothing to reserve, only checks the capacity
+  void reserve(const size_t &count) const { check_capacity(count); };
+
+  inline T *data() { return data_; };
+  inline const T *data() const { return data_; };
+  inline iterator begin() { return data_; };
+  inline iterator end() { return data_ + size_; };
+  inline const_iterator begin() const { return data_; };
+  inline const_iterator end() const { return data_ + size_; };
+  inline const_iterator cbegin() const { return data_; };
+  inline const_iterator cend() const { return data_ + size_; };
+  inline reverse_iterator rbegin() { return reverse_iterator(end()); };
+  inline reverse_iterator rend() { return reverse_iterator(begin()); };
+  inline const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); };
+  inline const_reverse_iterator rend() const { return const_reverse_iterator(begin()); };
+
+  inline T &operator[](const size_t &index) { return data_[index]; };
+  inline const T &operator[](const size_t &index) const { return data_[index]; };
+  T &at(const size_t &index) {
+    check_index(index);
+    return data_[index];
+  }
+  const T &at(const size_t &index) const {
+    check_index(index);
+    return data_[index];
+  }
+  inline T &front() { return data_[0]; };
+  inline const T &front() const { return data_[0]; };
+  inline T &back() { return data_[size_ - 1]; };
+  inline const T &back() const { return data_[size_ - 1]; };
+
+  void push_back(const T &value) {
+    check_capacity(size_ + 1);
+    data_[size_++] = value;
+  }
+
+  template<typename... Args>
+  T &emplace_back(Args &&... args) {
+    check_capacity(size_ + 1);
+    data_[size_] = T(std::forward<Args>(args)...);
+    return data_[size_++];
+  }
+
+  inline void pop_back() { --size_; };
+  inline void clear() { size_ = 0; };
+
+  void resize(const size_t &count, const T &value = T()) {
+    check_capacity(count);
+    if (count > size_) {
+      std::fill(data_ + size_, data_ + count, value);
+    }
+    size_ = count;
+  }
+
+  iterator insert(const_iterator pos, const T &value) {
+    return insert(pos, 1, value);
+  }
+
+  iterator insert(const_iterator pos, const size_t &count, const T &value) {
+    iterator gap = open_gap(pos, count);
+    std::fill_n(gap, count, value);
+    return gap;
+  }
+
+  template<std::forward_iterator It>
+  iterator insert(const_iterator pos, It first, It last) {
+    iterator gap = open_gap(pos, std::distance(first, last));
+    std::copy(first, last, gap);
+    return gap;
+  }
+
+  iterator insert(const_iterator pos, std::initializer_list<T> values) {
+    return insert(pos, values.begin(), values.end());
+  }
+
+  iterator erase(const_iterator pos) {
+    return erase(pos, pos + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    iterator dest = begin() + (first - cbegin());
+    std::copy(last, cend(), dest);
+    size_ -= last - first;
+    return dest;
+  }
+
+  friend bool operator==(const SmallVector &lhs, const SmallVector &rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+  friend bool operator==(const SmallVector &lhs, const std::vector<T> &rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+ private:
+  T data_[N];
+  size_t size_ = 0;
+
+  static void check_capacity(const size_t &count) {
+    if (count > N) {
+      throw std::length_error("SmallVector >> more than " + std::to_string(N) + " values");
+    }
+  }
+
+  void check_index(const size_t &index) const {
+    if (index >= size_) {
+      throw std::out_of_range("SmallVector >> index " + std::to_string(index) + " out of range");
+    }
+  }
+
+  // moves the values from pos on back by count and returns the gap
+  iterator open_gap(const_iterator pos, const size_t &count) {
+    size_t offset = pos - cbegin();
+    check_capacity(size_ + count);
+    std::copy_backward(data_ + offset, data_ + size_, data_ + size_ + count);
+    size_ += count;
+    return data_ + offset;
+  }
+};
+
+// shapes and strides of tensors and the strided kernels have at most MAX_RANK axes
+const size_t MAX_RANK = 8;
+typedef SmallVector<size_t, MAX_RANK> Dims;
+typedef SmallVector<bool, MAX_RANK> DimMask;
+
+} // namespace utils
+
+#endif //ADGC_UTILS_SMALL_VECTOR_H_
@@ -1,9 +1,13 @@
 #ifndef ADGC_UTILS_THREADS_H_
 #define ADGC_UTILS_THREADS_H_
 
+#include <atomic>
 #include <condition_variable>
+#include <exception>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <shared_mutex>
@@ -14,7 +18,8 @@
 namespace utils {
 namespace threads {
 
-// ThreadPool creates a bunch of threads and manages multi-thread tasks
+// ThreadPool creates a bunch of threads and manages multi-thread tasks,
+// the library itself schedules onto the shared runtime below instead
 class ThreadPool {
   /*
   Credit: https://stackoverflow.com/questions/15752659/thread-pooling-in-c11
@@ -38,6 +43,76 @@ private:
   std::queue<std::function<void()>> jobs_;
 };
 
+/*
+  The runtime is one process-wide set of worker threads, each owning a deque
+  of tasks. A worker pushes and pops its own tasks at the back and steals
+  from the front of the others when it runs dry; tasks coming from other
+  threads are dealt round-robin. Threads waiting for tasks help running
+  them, so nested waits cannot deadlock the workers.
+  Worker threads and parallel chunks run MKL single-threaded, so that the
+  library threads and MKL's own do not oversubscribe the cores.
+*/
+
+// get_num_threads returns how many threads the runtime runs tasks on,
+// the calling thread included
+size_t get_num_threads();
+
+// set_num_threads resizes the runtime, 1 runs everything on the calling
+// thread. Starts with ADGC_NUM_THREADS from the environment when set,
+// else the hardware concurrency capped by ADGC_MULTI_THREADS_NUM_.
+// Must not be called while tasks are running.
+void set_num_threads(const size_t &num_threads);
+
+// MklThreadsScope sets how many threads the MKL calls of the current thread
+// use while it lives, 0 leaves them as they are
+class MklThreadsScope {
+ public:
+  explicit MklThreadsScope(const size_t &num_threads);
+  MklThreadsScope(const MklThreadsScope &) = delete;
+  ~MklThreadsScope();
+
+ private:
+  // negative when nothing was changed
+  int previous_ = -1;
+};
+
+// schedule queues a task on the runtime without a way to wait for it,
+// prefer TaskGroup or submit
+void schedule(std::function<void()> task);
+
+// TaskGroup runs tasks on the runtime and waits for all of them,
+// the first exception thrown by a task is rethrown by wait()
+class TaskGroup {
+ public:
+  TaskGroup() {};
+  TaskGroup(const TaskGroup &) = delete;
+  ~TaskGroup();
+  void run(std::function<void()> task);
+  void wait();
+
+ private:
+  std::atomic<size_t> pending_ = 0;
+  std::exception_ptr error_ = nullptr;
+  std::mutex mutex_;
+  std::condition_variable done_;
+};
+
+// submit runs func on the runtime and returns a future of its result
+template<typename Func>
+std::future<std::invoke_result_t<Func>> submit(Func func) {
+  auto task = std::make_shared<std::packaged_task<std::invoke_result_t<Func>()>>(std::move(func));
+  auto result = task->get_future();
+  schedule([task] { (*task)(); });
+  return result;
+}
+
+// parallel_for splits [begin, end) into contiguous chunks of at least
+// min_chunk items and runs body(chunk_begin, chunk_end) on the runtime,
+// the calling thread takes the first chunk and waits for the others.
+// Nested calls from inside a chunk run serially on the current thread.
+void parallel_for(const size_t &begin, const size_t &end, const size_t &min_chunk,
+                  const std::function<void(size_t, size_t)> &body);
+
 // ConcurrentCounter not used
 template <typename K> class ConcurrentCounter {
 public:
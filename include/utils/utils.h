@@ -1,12 +1,16 @@
 #ifndef ADGC_UTILS_UTILS_H_
 #define ADGC_UTILS_UTILS_H_
 
+#include <algorithm>
 #include <sstream>
 #include <unordered_map>
 #include <vector>
 #include <regex>
 #include <string>
 #include <fstream>
+#include <utility>
+
+#include "utils/small_vector.h"
 
 namespace utils {
 
@@ -16,30 +20,44 @@ std::string array_to_str(size_t m, size_t n, T *p, std::string name = "");
 
 // print the tensor recursively from the innermost axis to the outermost
 template<typename T>
-std::string multi_array_to_str(const std::vector<size_t> &shape, T *arr_p,
+std::string multi_array_to_str(const Dims &shape, T *arr_p,
                                const std::string &name = "");
 
 template<typename T>
 void multi_array_to_str_helper(size_t rank, size_t cur_axis,
-                               const std::vector<size_t> &shape,
-                               const std::vector<size_t> &axis_inc, T *p_start,
+                               const Dims &shape,
+                               const Dims &axis_inc, T *p_start,
                                T *p_end, std::stringstream &out);
 
+// TypeCounter counts per type, there are only a handful of them, which are
+// looked up by a linear scan instead of being hashed
 class TypeCounter {
  public:
   inline size_t inc(const std::string &type) {
-    if (counter_.find(type) == counter_.end()) {
-      counter_[type] = 1;
+    auto iter = find(type);
+    if (iter == counter_.end()) {
+      counter_.emplace_back(type, 1);
       return 0;
-    } else {
-      return counter_[type]++;
     }
+    return iter->second++;
+  }
+
+  inline size_t get(const std::string &type) const {
+    auto iter = find(type);
+    return iter == counter_.end() ? 0 : iter->second;
   }
 
   inline void clear() { counter_.clear(); }
 
  private:
-  std::unordered_map<std::string, size_t> counter_;
+  std::vector<std::pair<std::string, size_t>> counter_;
+
+  inline std::vector<std::pair<std::string, size_t>>::const_iterator find(const std::string &type) const {
+    return std::find_if(counter_.begin(), counter_.end(), [&type](const auto &item) { return item.first == type; });
+  }
+  inline std::vector<std::pair<std::string, size_t>>::iterator find(const std::string &type) {
+    return std::find_if(counter_.begin(), counter_.end(), [&type](const auto &item) { return item.first == type; });
+  }
 };
 
 void read_lines_from_file(const char *file_name, std::vector<std::string> &output_vec);
@@ -8,6 +8,37 @@ namespace auto_diff {
 
 namespace functional {
 
+namespace {
+
+typedef void (*ForwardKernel)(const size_t &, const DScalar *, DScalar *);
+typedef void (*BackwardKernel)(const size_t &, const DScalar *, const DScalar *, DScalar *);
+
+// values may be strided views, the kernels of utils::math read packed entries;
+// in_place is set when the memory planner handed the node the buffer of its
+// parent, which is then overwritten with the result
+DTensor apply_forward(DTensor input, ForwardKernel kernel, bool in_place = false) {
+  if (in_place && !input.is_shared() && input.is_contiguous()) {
+    kernel(input.get_size(), input.get_tensor_const_ptr(), &*input.get_iterator());
+    return input;
+  }
+  DTensor x = input.contiguous();
+  DTensor result = DTensor::uninitialized(x.get_shape());
+  kernel(x.get_size(), x.get_tensor_const_ptr(), &*result.get_iterator());
+  return result;
+}
+
+// value is x or y, whichever the kernel computes the derivative from
+DTensor apply_backward(const DTensor &value, const DTensor &grad, BackwardKernel kernel) {
+  DTensor packed_value = value.contiguous();
+  DTensor packed_grad = grad.contiguous();
+  DTensor result = DTensor::uninitialized(packed_value.get_shape());
+  kernel(packed_value.get_size(), packed_value.get_tensor_const_ptr(), packed_grad.get_tensor_const_ptr(),
+         &*result.get_iterator());
+  return result;
+}
+
+}
+
 // class implementations:
 //
 
@@ -22,8 +53,7 @@ void Sigmoid::do_forward() {
     throw adg_exception::FunctionalParentsUnsetException(
       "Logistic >> do_forward");
   }
-  value_ = parents_[0]->get_value().copy();
-  value_.map([](double &val) { val = utils::math::sigmoid(val); });
+  value_ = apply_forward(take_parent_value(0), utils::math::sigmoid_forward<DScalar>, in_place_);
 };
 
 DTensor Sigmoid::do_backward(Node *parent_ptr) {
@@ -32,10 +62,8 @@ DTensor Sigmoid::do_backward(Node *parent_ptr) {
       "Sigmoid >> do_backward");
   }
 
-  DTensor ones = tensor::Ones(get_value_shape());
-  DTensor sigmoid_backward =
-    tensor::multiply(value_, tensor::sub(ones, value_));
-  return sigmoid_backward.multiply(get_grad());
+  // sigmoid' = y * (1 - y)
+  return apply_backward(get_value(), get_grad(), utils::math::sigmoid_backward<DScalar>);
 }
 
 ReLU::ReLU(Node *parent_ptr, Graph *g, const std::string &name)
@@ -49,8 +77,7 @@ void ReLU::do_forward() {
     throw adg_exception::FunctionalParentsUnsetException("ReLU >> do_forward");
   }
 
-  value_ = parents_[0]->get_value().copy();
-  value_.map([](double &val) { val = utils::math::relu(val); });
+  value_ = apply_forward(take_parent_value(0), utils::math::relu_forward<DScalar>, in_place_);
 }
 
 DTensor ReLU::do_backward(Node *parent_ptr) {
@@ -58,32 +85,106 @@ DTensor ReLU::do_backward(Node *parent_ptr) {
     throw adg_exception::FunctionalParentsUnsetException("ReLU >> do_backward");
   }
 
-  DTensor relu_backward = value_.copy();
-  relu_backward.map([](double &val) {
-    if (val > 0.0) {
-      val = 1.0;
-    } else {
-      val = 0.0;
-    }
-  });
-  return relu_backward.multiply(get_grad());
+  // the gradient passes where y > 0
+  return apply_backward(get_value(), get_grad(), utils::math::relu_backward<DScalar>);
+}
+
+Tanh::Tanh(Node *parent_ptr, Graph *g, const std::string &name)
+  : Node(NodeType::ADG_TANH_TYPE, {parent_ptr}, name, g) {
+  set_backward_version(1);
+  value_ = DTensor(parent_ptr->get_value_shape());
+}
+
+void Tanh::do_forward() {
+  if (parents_.empty()) {
+    throw adg_exception::FunctionalParentsUnsetException("Tanh >> do_forward");
+  }
+
+  value_ = apply_forward(take_parent_value(0), utils::math::tanh_forward<DScalar>, in_place_);
+}
+
+DTensor Tanh::do_backward(Node *parent_ptr) {
+  if (parents_.empty()) {
+    throw adg_exception::FunctionalParentsUnsetException("Tanh >> do_backward");
+  }
+
+  // tanh' = 1 - y^2
+  return apply_backward(get_value(), get_grad(), utils::math::tanh_backward<DScalar>);
+}
+
+GELU::GELU(Node *parent_ptr, Graph *g, const std::string &name)
+  : Node(NodeType::ADG_GELU_TYPE, {parent_ptr}, name, g) {
+  set_backward_version(1);
+  value_ = DTensor(parent_ptr->get_value_shape());
+}
+
+void GELU::do_forward() {
+  if (parents_.empty()) {
+    throw adg_exception::FunctionalParentsUnsetException("GELU >> do_forward");
+  }
+
+  value_ = apply_forward(parents_[0]->get_value(), utils::math::gelu_forward<DScalar>);
+}
+
+DTensor GELU::do_backward(Node *parent_ptr) {
+  if (parents_.empty()) {
+    throw adg_exception::FunctionalParentsUnsetException("GELU >> do_backward");
+  }
+
+  // the derivative needs x, y alone does not determine it
+  return apply_backward(parents_[0]->get_value(), get_grad(), utils::math::gelu_backward<DScalar>);
+}
+
+SiLU::SiLU(Node *parent_ptr, Graph *g, const std::string &name)
+  : Node(NodeType::ADG_SILU_TYPE, {parent_ptr}, name, g) {
+  set_backward_version(1);
+  value_ = DTensor(parent_ptr->get_value_shape());
+}
+
+void SiLU::do_forward() {
+  if (parents_.empty()) {
+    throw adg_exception::FunctionalParentsUnsetException("SiLU >> do_forward");
+  }
+
+  value_ = apply_forward(parents_[0]->get_value(), utils::math::silu_forward<DScalar>);
+}
+
+DTensor SiLU::do_backward(Node *parent_ptr) {
+  if (parents_.empty()) {
+    throw adg_exception::FunctionalParentsUnsetException("SiLU >> do_backward");
+  }
+
+  return apply_backward(parents_[0]->get_value(), get_grad(), utils::math::silu_backward<DScalar>);
 }
 
 //
 // function implementations:
 
 Sigmoid &sigmoid(const Node &parent, Graph *g, const std::string &name) {
-  Sigmoid *node_ptr =
-    new Sigmoid(Graph::get_ptr_of(parent.get_full_name(), g), g, name);
-  return *node_ptr;
+  g = Graph::get_graph_or_global(g);
+  return *g->create<Sigmoid>(parent.get_ptr(), g, name);
 }
 
 ReLU &relu(const Node &parent, Graph *g, const std::string &name) {
-  ReLU *node_ptr =
-    new ReLU(Graph::get_ptr_of(parent.get_full_name(), g), g, name);
-  return *node_ptr;
+  g = Graph::get_graph_or_global(g);
+  return *g->create<ReLU>(parent.get_ptr(), g, name);
 }
 
+Tanh &tanh(const Node &parent, Graph *g, const std::string &name) {
+  g = Graph::get_graph_or_global(g);
+  return *g->create<Tanh>(parent.get_ptr(), g, name);
 }
 
-}
\ No newline at end of file
+GELU &gelu(const Node &parent, Graph *g, const std::string &name) {
+  g = Graph::get_graph_or_global(g);
+  return *g->create<GELU>(parent.get_ptr(), g, name);
+}
+
+SiLU &silu(const Node &parent, Graph *g, const std::string &name) {
+  g = Graph::get_graph_or_global(g);
+  return *g->create<SiLU>(parent.get_ptr(), g, name);
+}
+
+}
+
+}
@@ -20,19 +20,11 @@ CrossEntropyWithSoftMax::CrossEntropyWithSoftMax(Node *parent_ptr,
 }
 
 DTensor CrossEntropyWithSoftMax::softmax(const DTensor &input) {
-  DTensor output = input.copy();
-
-  output.map(
-    [](double &val) { val = std::exp(std::min(val, 100.0)); }); // [N, d]
-  size_t dim = output.get_dim();
-  size_t ncol = output.get_shape()[dim - 1];
-
-  DTensor exp_sum = output.sum(dim - 1).add(epsilon_); // [N]
-  output.map(tensor::Mapper<double>(
-    [&exp_sum, &ncol](double &val, const size_t &index) {
-      size_t row_id = index / ncol;
-      val /= exp_sum.get_value({row_id});
-    }));
+  DTensor packed = input.contiguous();
+  DTensor output = DTensor::uninitialized(packed.get_shape()); // [N, d]
+  size_t ncol = packed.get_shape()[packed.get_dim() - 1];
+  utils::math::softmax(packed.get_size() / ncol, ncol, packed.get_tensor_const_ptr(),
+                       DScalar(epsilon_), &*output.get_iterator());
   return output;
 }
 
@@ -43,13 +35,24 @@ void CrossEntropyWithSoftMax::do_forward() {
   }
 
   probs_ = softmax(parents_[0]->get_value()); // shape: [N, D]
-  neg_log_probs_ = probs_.copy();
-  neg_log_probs_.map([](double &val) { val = -std::log(val + epsilon_); });
+  neg_log_probs_ = DTensor::uninitialized(probs_.get_shape());
+  utils::math::negative_log(probs_.get_size(), probs_.get_tensor_const_ptr(),
+                            DScalar(epsilon_), &*neg_log_probs_.get_iterator());
   // sum_i { - yi * log(pi) }
   value_ =
     tensor::sum(tensor::multiply(parents_[1]->get_value(), neg_log_probs_));
 }
 
+size_t CrossEntropyWithSoftMax::get_cache_bytes() const {
+  // the probabilities and their negative logs
+  return 2 * sizeof(DScalar) * parents_[0]->get_value_size();
+}
+
+void CrossEntropyWithSoftMax::clear_cache() {
+  probs_ = EMPTY_DTENSOR;
+  neg_log_probs_ = EMPTY_DTENSOR;
+}
+
 DTensor CrossEntropyWithSoftMax::do_backward(Node *parent_ptr) {
   if (parents_.empty()) {
     throw adg_exception::FunctionalParentsUnsetException(
@@ -71,10 +74,10 @@ DTensor CrossEntropyWithSoftMax::do_backward(Node *parent_ptr) {
 DTensor CrossEntropyWithSoftMax::get_probs() {
   if (this != unique_ptr_) {
     auto real_ptr = dynamic_cast<CrossEntropyWithSoftMax *>(unique_ptr_);
-    return real_ptr->probs_.copy();
+    return real_ptr->probs_;
   }
 
-  return probs_.copy();
+  return probs_;
 }
 
 
@@ -84,12 +87,9 @@ CrossEntropyWithSoftMax &cross_entropy_with_softmax(const Node &input,
                                                     const Variable &labels,
                                                     Graph *g,
                                                     const std::string &name) {
-  Node *parent_ptr = Graph::get_ptr_of(input.get_full_name(), g);
-  Variable *label_ptr =
-    dynamic_cast<Variable *>(Graph::get_ptr_of(labels.get_full_name(), g));
-  CrossEntropyWithSoftMax *node_ptr =
-    new CrossEntropyWithSoftMax(parent_ptr, label_ptr, g, name);
-  return *node_ptr;
+  g = Graph::get_graph_or_global(g);
+  Variable *label_ptr = dynamic_cast<Variable *>(labels.get_ptr());
+  return *g->create<CrossEntropyWithSoftMax>(input.get_ptr(), label_ptr, g, name);
 }
 
 }
@@ -24,7 +24,8 @@ Reshape::Reshape(Node *parent_ptr, const tensor::TensorShape &shape, Graph *g,
 }
 
 void Reshape::do_forward() {
-  value_ = parents_[0]->get_value().copy();
+  // shares the parent's buffer, nothing is copied unless the parent is a strided view
+  value_ = parents_[0]->get_value();
   value_.reshape(new_shape_);
 }
 
@@ -49,7 +50,7 @@ Pad2D::Pad2D(Node *parent_ptr, const std::vector<std::pair<size_t, size_t>> &pad
 }
 
 void Pad2D::do_forward() {
-  value_ = tensor::pad2d(parents_[0]->get_value(), padding_, pad_value_);
+  value_ = tensor::pad2d(parents_[0]->get_value(), padding_, DScalar(pad_value_));
 }
 
 DTensor Pad2D::do_backward(Node *parent_ptr) {
@@ -33,6 +33,7 @@ BatchNorm2D::BatchNorm2D(Node *input_ptr,
   }
 
   cached_tensors_.resize(2);
+  value_ = DTensor(input_ptr->get_value_shape());
 
   moving_mean_ = DTensor(gamma->get_value_shape());
   moving_var_ = DTensor(gamma->get_value_shape());
@@ -49,15 +50,12 @@ void BatchNorm2D::do_forward() {
     }
     assert(size_bhw_ == input_tensor.get_size() / input_tensor.get_shape(1));
 
-    mean = input_tensor.sum(3).sum(2).sum(0).div(size_bhw_);
-    DTensor sample_var_all = tensor::square(tensor::add_vec(input_tensor, -mean, 1));
-    var = sample_var_all.sum(3).sum(2).sum(0).div(size_bhw_);
+    mean = input_tensor.mean({0, 2, 3});
+    var = input_tensor.var({0, 2, 3});
 
     // update moving averages
-    moving_mean_ = tensor::add(moving_mean_.multiply(momentum_),
-                               mean.multiply(1 - momentum_));
-    moving_var_ = tensor::add(moving_var_.multiply(momentum_),
-                              var.multiply(1 - momentum_));
+    moving_mean_ = tensor::lazy(moving_mean_) * momentum_ + tensor::lazy(mean) * (1 - momentum_);
+    moving_var_ = tensor::lazy(moving_var_) * momentum_ + tensor::lazy(var) * (1 - momentum_);
   } else {
     // use Bessel correction
     mean = moving_mean_.multiply(size_bhw_ / (size_bhw_ - 1));
@@ -65,8 +63,7 @@ void BatchNorm2D::do_forward() {
   }
 
   // get the normalized input, (x - mu) / sqrt(var + eps)
-  DTensor inverse_std_err = tensor::sqrt(var.add(epsilon_));
-  inverse_std_err.map([](double &val) { val = 1. / val; });
+  DTensor inverse_std_err = 1. / tensor::expr::sqrt(tensor::lazy(var) + epsilon_);
   DTensor input_unbiased = tensor::add_vec(input_tensor, -mean, 1);
   DTensor input_normed = tensor::pmul_vec(input_unbiased, inverse_std_err, 1);
 
@@ -83,17 +80,30 @@ void BatchNorm2D::do_forward() {
     1);
 }
 
+size_t BatchNorm2D::get_cache_bytes() const {
+  if (graph_->stage() != GraphStageFlag::train) {
+    return 0;
+  }
+  // the normalized input and the inverse standard deviations
+  return sizeof(DScalar) * (parents_[0]->get_value_size() + parents_[1]->get_value_size());
+}
+
+void BatchNorm2D::clear_cache() {
+  cached_tensors_[0] = EMPTY_DTENSOR;
+  cached_tensors_[1] = EMPTY_DTENSOR;
+}
+
 DTensor BatchNorm2D::do_backward(Node *parent_ptr) {
   DTensor grad = get_grad();
 
   if (parent_ptr == parents_[1]) {
     // dgamma = grad pmul
-    return grad.multiply(cached_tensors_[0]).sum(3).sum(2).sum(0);
+    return grad.multiply(cached_tensors_[0]).sum({0, 2, 3});
   }
 
   if (parent_ptr == parents_[2]) {
     // dbeta = sum(grad)
-    return grad.sum(3).sum(2).sum(0);
+    return grad.sum({0, 2, 3});
   }
 
   // dx
@@ -103,8 +113,8 @@ DTensor BatchNorm2D::do_backward(Node *parent_ptr) {
   // https://zhuanlan.zhihu.com/p/45614576
   DTensor d_xn = tensor::pmul_vec(grad, parents_[1]->get_value(), 1);
   DTensor d_x = d_xn.multiply(size_bhw_);
-  d_x = tensor::add_vec(d_x, -d_xn.sum(3).sum(2).sum(0), 1);
-  DTensor d_xxn = cached_xn.multiply(d_xn).sum(3).sum(2).sum(0);
+  d_x = tensor::add_vec(d_x, -d_xn.sum({0, 2, 3}), 1);
+  DTensor d_xxn = cached_xn.multiply(d_xn).sum({0, 2, 3});
   d_x = d_x.sub(tensor::pmul_vec(cached_xn, d_xxn, 1));
   d_x = tensor::pmul_vec(d_x.div(size_bhw_), cached_inverse_se, 1);
   return d_x;
@@ -52,15 +52,13 @@ DTensor ReduceMean::do_backward(Node *parent_ptr) {
 // function implementations:
 
 ReduceSum &reduce_sum(const Node &input, Graph *g, const std::string &name) {
-  ReduceSum *node_ptr =
-    new ReduceSum(Graph::get_ptr_of(input.get_full_name(), g), g, name);
-  return *node_ptr;
+  g = Graph::get_graph_or_global(g);
+  return *g->create<ReduceSum>(input.get_ptr(), g, name);
 }
 
 ReduceMean &reduce_mean(const Node &input, Graph *g, const std::string &name) {
-  ReduceMean *node_ptr =
-    new ReduceMean(Graph::get_ptr_of(input.get_full_name(), g), g, name);
-  return *node_ptr;
+  g = Graph::get_graph_or_global(g);
+  return *g->create<ReduceMean>(input.get_ptr(), g, name);
 }
 }
 }
\ No newline at end of file
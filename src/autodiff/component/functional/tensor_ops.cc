@@ -10,39 +10,42 @@ Add::Add(Node *parent1_ptr, Node *parent2_ptr, Graph *g,
          const std::string &name)
   : Node(NodeType::ADG_ADD_TYPE, {parent1_ptr, parent2_ptr}, name, g) {
   set_backward_version(1);
-  // accept two matrices with same size
-  // or a matrix along with a value
-  if (parents_[0]->get_value_shape() != parents_[1]->get_value_shape()) {
-    if (parents_[0]->get_value_size() != 1 &&
-      parents_[1]->get_value_size() != 1) {
+  // accept two tensors with broadcastable shapes
+  // or a tensor along with a value
+  tensor::TensorShape shape_1 = parents_[0]->get_value_shape();
+  tensor::TensorShape shape_2 = parents_[1]->get_value_shape();
+  if (shape_1 == shape_2 || parents_[1]->get_value_size() == 1) {
+    value_ = DTensor(shape_1);
+  } else if (parents_[0]->get_value_size() == 1) {
+    value_ = DTensor(shape_2);
+  } else {
+    try {
+      value_ = DTensor(DTensor::broadcast_shape(shape_1, shape_2));
+    } catch (const adg_exception::MismatchTensorShapeError &) {
       throw adg_exception::MismatchNodeValueShapeError("Add >> Add");
     }
-
-    if (parents_[0]->get_value_size() == 1) {
-      // let the second shape be of shape 1
-      std::iter_swap(parents_.begin(), parents_.begin() + 1);
-    }
   }
-
-  value_ = DTensor(parents_[0]->get_value_shape());
 };
 
 void Add::do_forward() {
-  if (parents_[1]->get_value_size() == 1) {
-    value_ =
-      parents_[0]->get_value().add(parents_[1]->get_value().get_value({0}));
-    return;
+  const DTensor &value_1 = parents_[0]->get_value();
+  const DTensor &value_2 = parents_[1]->get_value();
+  if (value_1.get_shape() != value_2.get_shape()) {
+    if (value_2.get_size() == 1) {
+      value_1.add(value_2.get_value(), value_);
+      return;
+    }
+    if (value_1.get_size() == 1) {
+      value_2.add(value_1.get_value(), value_);
+      return;
+    }
   }
-  value_ = parents_[0]->get_value().add(parents_[1]->get_value());
+  value_1.add(value_2, value_);
 }
 
 DTensor Add::do_backward(Node *parent_ptr) {
-  if (parents_[1]->get_value_size() == 1 && parent_ptr == parents_[1]) {
-//    return tensor::Ones({1, get_value_size()});
-    return jacobi_.sum();;
-  }
-//  return tensor::Eye(get_value_size());
-  return jacobi_;
+  // sum the grad over the axes the parent was broadcast along
+  return get_grad().reduce_to_shape(parent_ptr->get_value_shape());
 }
 
 MatAddVec::MatAddVec(Node *parent1_ptr, Node *parent2_ptr, const size_t &axis, Graph *g,
@@ -96,26 +99,11 @@ DTensor MatAddVec::do_backward(Node *parent_ptr) {
     return get_grad();
   }
 
-  // sum over the grads just like forward
-  DTensor result(parent_ptr->get_value_shape());
-  tensor::TensorIterator<double> result_iter = result.get_iterator();
-
-  size_t matrix_stride = parents_[0]->get_value().get_stride(axis_);
-  size_t matrix_size = parents_[0]->get_value_size();
-  const double *grad_values = get_grad().get_tensor_const_ptr();
-
-  size_t matrix_index = 0, vector_index = 0;
-  double const_one = 1;
-  while (matrix_index < matrix_size) {
-    *(result_iter + vector_index) += cblas_ddot(matrix_stride,
-                                                &const_one,
-                                                0,
-                                                &grad_values[matrix_index],
-                                                1);
-    vector_index = (vector_index + 1) % result.get_size();
-    matrix_index += matrix_stride;
-  }
-
+  // sum over the grads along all the axes the vector was broadcast along
+  tensor::TensorShape vec_shape(parents_[0]->get_value().get_dim(), 1);
+  vec_shape[axis_] = parent_ptr->get_value_size();
+  DTensor result = get_grad().reduce_to_shape(vec_shape);
+  result.reshape(parent_ptr->get_value_shape());
   return result;
 }
 
@@ -179,7 +167,8 @@ MatMul::MatMul(Node *parent1_ptr, Node *parent2_ptr, Graph *g,
 }
 
 void MatMul::do_forward() {
-  value_ = tensor::dot(parents_[0]->get_value(), parents_[1]->get_value());
+  // written into the buffer of the last pass when it is still held
+  parents_[0]->get_value().dot(parents_[1]->get_value(), value_);
 }
 
 DTensor MatMul::do_backward(Node *parent_ptr) {
@@ -209,23 +198,17 @@ DTensor MatMul::do_backward(Node *parent_ptr) {
     // A [M, N]
     // B [N, K]
     // grad [M, K]
-    // dA = grad dot B.T
+    // dA = grad dot B.T, the transpose is a view read by gemm directly
     res = grad.dot(parents_[1]->get_value().t());
   } else {
-    // dB = A.T dot grad
-//    DTensor grad = get_grad();
-//    DTensor left_tensor = parents_[0]->get_value();
-//    size_t left_ncols = parents_[1]->get_value_shape()[0];
-//    size_t grad_ncols = parents_[1]->get_value_shape()[1];
-//    left_tensor.reshape({left_tensor.get_size() / left_ncols, left_ncols});
-//    grad.reshape({grad.get_size() / grad_ncols, grad_ncols});
-//    res = left_tensor.t().dot(grad);   // [3, 2, 3]
-    // dB = A.T dot grad
-    size_t left_dim = parents_[0]->get_value_dim();
-    res = parents_[0]->get_value().transpose(left_dim - 1, left_dim - 2).dot(grad); // [3, 2, 3]
-    while (res.get_dim() > 2) {
-      res = res.sum(0);
-    }
+    // dB = A.T dot grad, summed over the batch axes: stacking the batches
+    // of A and grad along the rows gives the sum in a single product
+    DTensor left_tensor = parents_[0]->get_value();
+    size_t left_ncols = parents_[1]->get_value_shape()[0];
+    size_t grad_ncols = parents_[1]->get_value_shape()[1];
+    left_tensor.reshape({left_tensor.get_size() / left_ncols, left_ncols});
+    grad.reshape({grad.get_size() / grad_ncols, grad_ncols});
+    res = left_tensor.t().dot(grad);
   }
   return res;
 }
@@ -239,9 +222,9 @@ MatSum::MatSum(const std::vector<Node *> &parents, Graph *g,
       "MatSum >> MatSum: get empty parents");
   }
 
-  std::vector<size_t> shape = parents[0]->get_value_shape();
+  tensor::TensorShape shape = parents[0]->get_value_shape();
   for (auto parent_ptr : parents) {
-    std::vector<size_t> tmp_shape = parent_ptr->get_value_shape();
+    tensor::TensorShape tmp_shape = parent_ptr->get_value_shape();
     if (tmp_shape != shape) {
       throw adg_exception::MismatchNodeValueShapeError(
         "MatSum >> MatSum: inconsistent shape among parents, expected " +
@@ -254,9 +237,9 @@ MatSum::MatSum(const std::vector<Node *> &parents, Graph *g,
 }
 
 void MatSum::do_forward() {
-  value_ = tensor::Zeros(parents_[0]->get_value_shape());
-  for (auto parent_ptr : parents_) {
-    value_ = value_.add(parent_ptr->get_value());
+  value_ = parents_[0]->get_value().copy();
+  for (size_t ix = 1; ix < parents_.size(); ++ix) {
+    value_.add_(parents_[ix]->get_value());
   }
 }
 
@@ -275,7 +258,7 @@ PointMul::PointMul(Node *parent_ptr1, Node *parent_ptr2, Graph *g, const std::st
 }
 
 void PointMul::do_forward() {
-  value_ = parents_[0]->get_value().multiply(parents_[1]->get_value());
+  parents_[0]->get_value().multiply(parents_[1]->get_value(), value_);
 }
 
 DTensor PointMul::do_backward(Node *parent_ptr) {
@@ -291,56 +274,41 @@ DTensor PointMul::do_backward(Node *parent_ptr) {
 
 Add &add(const Node &parent1, const Node &parent2, Graph *g,
          const std::string &name) {
-  Add *node_ptr =
-    new Add(Graph::get_ptr_of(parent1.get_full_name(), g),
-            Graph::get_ptr_of(parent2.get_full_name(), g), g, name);
-  return *node_ptr;
+  g = Graph::get_graph_or_global(g);
+  return *g->create<Add>(parent1.get_ptr(), parent2.get_ptr(), g, name);
 }
 
 VecDot &vecdot(const Node &parent1, const Node &parent2, Graph *g,
                const std::string &name) {
-  VecDot *node_ptr =
-    new VecDot(Graph::get_ptr_of(parent1.get_full_name(), g),
-               Graph::get_ptr_of(parent2.get_full_name(), g), g, name);
-  return *node_ptr;
+  g = Graph::get_graph_or_global(g);
+  return *g->create<VecDot>(parent1.get_ptr(), parent2.get_ptr(), g, name);
 }
 
 MatMul &matmul(const Node &parent1, const Node &parent2, Graph *g,
                const std::string &name) {
-  MatMul *node_ptr =
-    new MatMul(Graph::get_ptr_of(parent1.get_full_name(), g),
-               Graph::get_ptr_of(parent2.get_full_name(), g), g, name);
-  return *node_ptr;
+  g = Graph::get_graph_or_global(g);
+  return *g->create<MatMul>(parent1.get_ptr(), parent2.get_ptr(), g, name);
 }
 
 MatSum &matsum(const std::vector<Node *> &parents_ptr, Graph *g,
                const std::string &name) {
-  MatSum *node_ptr = new MatSum(parents_ptr, g, name);
-  return *node_ptr;
+  g = Graph::get_graph_or_global(g);
+  return *g->create<MatSum>(parents_ptr, g, name);
 }
 
 MatSum &matsum(const Node &parent_1, const Node &parent_2, Graph *g,
                const std::string &name) {
-  return matsum({Graph::get_ptr_of(parent_1.get_full_name(), g),
-                 Graph::get_ptr_of(parent_2.get_full_name(), g)},
-                g, name);
+  return matsum({parent_1.get_ptr(), parent_2.get_ptr()}, g, name);
 }
 
 MatSum &matsum(const Node &parent_1, const Node &parent_2, const Node &parent_3,
                Graph *g, const std::string &name) {
-  return matsum({Graph::get_ptr_of(parent_1.get_full_name(), g),
-                 Graph::get_ptr_of(parent_2.get_full_name(), g),
-                 Graph::get_ptr_of(parent_3.get_full_name(), g)},
-                g, name);
+  return matsum({parent_1.get_ptr(), parent_2.get_ptr(), parent_3.get_ptr()}, g, name);
 }
 
 MatSum &matsum(const Node &parent_1, const Node &parent_2, const Node &parent_3,
                const Node &parent_4, Graph *g, const std::string &name) {
-  return matsum({Graph::get_ptr_of(parent_1.get_full_name(), g),
-                 Graph::get_ptr_of(parent_2.get_full_name(), g),
-                 Graph::get_ptr_of(parent_3.get_full_name(), g),
-                 Graph::get_ptr_of(parent_4.get_full_name(), g)},
-                g, name);
+  return matsum({parent_1.get_ptr(), parent_2.get_ptr(), parent_3.get_ptr(), parent_4.get_ptr()}, g, name);
 }
 
 }
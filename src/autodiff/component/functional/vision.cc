@@ -58,24 +58,36 @@ Conv2D::Conv2D(Node *input_ptr,
 }
 
 void Conv2D::do_forward() {
-  col_kernel_ = parents_[1]->get_value().copy();
+  col_kernel_ = parents_[1]->get_value();
   col_kernel_.reshape({kernel_shape_[0], kernel_shape_[1] * kernel_shape_[2] * kernel_shape_[3]});
   // shape: [cout,  cin * kw * kh]
 
-  col_image_ = im2col_chw(parents_[0]->get_value(),
-                          kernel_shape_[2],
-                          kernel_shape_[3],
-                          strides_[0],
-                          strides_[1]); // shape: [B, (h - kh) * (w - kw), cin * kh * kw]
+  col_image_ = tensor::im2col_chw(parents_[0]->get_value(),
+                                  kernel_shape_[2],
+                                  kernel_shape_[3],
+                                  strides_[0],
+                                  strides_[1]); // shape: [B, (h - kh) * (w - kw), cin * kh * kw]
 
-  value_ = col_image_.dot(col_kernel_.t()); // shape: [B, (h-kh)*(w-kw), c_out]
-  value_ = value_.transpose(1, 2);
+  // kernel dot image.T gives the output channels first, the transposed
+  // image view is read by gemm without a copy
+  value_ = col_kernel_.dot(col_image_.transpose(1, 2)); // shape: [B, c_out, (h-kh)*(w-kw)]
   value_.reshape({parents_[0]->get_value_shape()[0], out_c_, out_h_, out_w_});
 }
 
+size_t Conv2D::get_cache_bytes() const {
+  // the im2col image, the kernel is a view of the parameter
+  size_t n_batch = parents_[0]->get_value_shape()[0];
+  return sizeof(DScalar) * n_batch * out_h_ * out_w_ * kernel_shape_[1] * kernel_shape_[2] * kernel_shape_[3];
+}
+
+void Conv2D::clear_cache() {
+  col_image_ = EMPTY_DTENSOR;
+  col_kernel_ = EMPTY_DTENSOR;
+}
+
 DTensor Conv2D::do_backward(Node *parent_ptr) {
   // grad shape [b, cout, h, w]
-  DTensor grad = get_grad().copy();
+  DTensor grad = get_grad();
   size_t n_batch = grad.get_shape()[0];
   DTensor result;
 
@@ -93,20 +105,18 @@ DTensor Conv2D::do_backward(Node *parent_ptr) {
     {kernel_shape_[2] - 1, kernel_shape_[3] - 1});
 
   // then, reverse each column of col_kernel
-  col_kernel_ = parents_[1]->get_value().copy(); // [cout, cin, kh, kw]
-  col_kernel_ = col_kernel_.transpose(0, 1);  // [cin, cout, kh, w]
+  col_kernel_ = parents_[1]->get_value().transpose(0, 1);  // [cin, cout, kh, w]
   col_kernel_.reshape({kernel_shape_[1], kernel_shape_[0], kernel_shape_[2] * kernel_shape_[3]});  // [cin, cout, kh*kw]
   tensor::reverse(col_kernel_, 2);  // shape: [cin, cout, kh * kw]
   col_kernel_.reshape({kernel_shape_[1], kernel_shape_[0] * kernel_shape_[2] * kernel_shape_[3]});
 
   // do the convolution between grad and col_kernel
-  DTensor im2col = im2col_chw(transformed_grad,
-                              kernel_shape_[2],
-                              kernel_shape_[3],
-                              1,
-                              1);  // shape: [B, h * w, cout * kh * kw]
-  result = im2col.dot(col_kernel_.t()); // [B, h * w, cin]
-  result = result.transpose(1, 2);
+  DTensor im2col = tensor::im2col_chw(transformed_grad,
+                                      kernel_shape_[2],
+                                      kernel_shape_[3],
+                                      1,
+                                      1);  // shape: [B, h * w, cout * kh * kw]
+  result = col_kernel_.dot(im2col.transpose(1, 2)); // [B, cin, h * w]
   if (residual_h_ || residual_w_) {
     // (h - kh) was not divided by stride, the h and w is not restored yet
     tensor::TensorShape target_shape = parent_ptr->get_value_shape();
@@ -124,18 +134,21 @@ DTensor Conv2D::im2col_hwc(const DTensor &input,
                            const size_t &sh,
                            const size_t &sw) {
   // input : [b, h, w, c]
+  if (!input.is_contiguous()) {
+    return im2col_hwc(input.contiguous(), kh, kw, sh, sw);
+  }
+
   tensor::TensorShape shape = input.get_shape();
-  std::vector<size_t> input_strides = input.get_strides();
+  const tensor::TensorShape &input_strides = input.get_strides();
   size_t n_channels = shape[3];
   size_t n_batchs = shape[0];
 
   size_t window_size = kh * kw;
 
-  auto col_image_values =
-    std::vector<double>(n_batchs * out_h_ * out_w_ * window_size * n_channels);
+  DTensor col_image = DTensor({n_batchs * out_h_ * out_w_, kw * kh * n_channels});
 
-  const double *input_tensor_ptr = input.get_tensor_const_ptr();
-  double *col_image_ptr = &col_image_values[0];
+  const DScalar *input_tensor_ptr = input.get_tensor_const_ptr();
+  DScalar *col_image_ptr = &*col_image.get_iterator();
 
   size_t ib, ih, iw, iih, iiw;
   size_t cur_src_index, in_window_index;
@@ -147,11 +160,11 @@ DTensor Conv2D::im2col_hwc(const DTensor &input,
         while (in_window_index < window_size) {
           iih = in_window_index / kw;
           iiw = in_window_index % kw;
-          cblas_dcopy(n_channels,
-                      input_tensor_ptr + cur_src_index + iih * input_strides[1] + iiw * input_strides[2],
-                      1,
-                      col_image_ptr + in_window_index,
-                      window_size);
+          utils::math::strided_copy_1d(n_channels,
+                                       input_tensor_ptr + cur_src_index + iih * input_strides[1] + iiw * input_strides[2],
+                                       1,
+                                       col_image_ptr + in_window_index,
+                                       window_size);
           ++in_window_index;
         }
         col_image_ptr += n_channels * window_size;
@@ -159,59 +172,7 @@ DTensor Conv2D::im2col_hwc(const DTensor &input,
     }
   }
 
-  return DTensor({n_batchs * out_h_ * out_w_, kw * kh * n_channels},
-                 std::move(col_image_values));
-}
-
-DTensor Conv2D::im2col_chw(const DTensor &input,
-                           const size_t &kh,
-                           const size_t &kw,
-                           const size_t &sh,
-                           const size_t &sw) {
-  // input : [b, c, h, w]
-  tensor::TensorShape shape = input.get_shape();
-  std::vector<size_t> input_strides = input.get_strides();
-  size_t n_channels = shape[1];
-  size_t n_batchs = shape[0];
-
-  size_t window_size = kh * kw;
-
-  size_t out_h = (shape[2] - kh) / sh + 1;
-  size_t out_w = (shape[3] - kw) / sw + 1;
-
-  std::vector<double> col_image_vec = std::vector<double>(n_batchs * out_h * out_w * window_size * n_channels);
-  const double *input_tensor_ptr = input.get_tensor_const_ptr();
-  double *col_image_ptr = &col_image_vec[0];
-
-  size_t ib, ic, ih, iw, iih, iiw;
-  size_t cur_src_index, in_window_index, cur_dest_index;
-  size_t dest_stride = window_size * n_channels;
-  size_t dest_b_stride = dest_stride * out_h * out_w;
-  size_t max_dest_ind = 0;
-  for (ib = 0; ib < shape[0]; ++ib) {
-    for (ic = 0; ic < shape[1]; ++ic) {
-      cur_dest_index = ib * dest_b_stride + ic * window_size;
-      cur_src_index = ib * input_strides[0] + ic * input_strides[1];
-      for (ih = 0; ih <= shape[2] - kh; ih += sh) {
-        for (iw = 0; iw <= shape[3] - kw; iw += sw) {
-          in_window_index = 0;
-          while (in_window_index < window_size) {
-            iih = in_window_index / kw;
-            iiw = in_window_index % kw;
-            *(col_image_ptr + cur_dest_index + in_window_index) =
-              *(input_tensor_ptr + cur_src_index + (ih + iih) * input_strides[2] + (iw + iiw) * input_strides[3]);
-            ++in_window_index;
-          }
-          cur_dest_index += dest_stride;
-          max_dest_ind = std::max(max_dest_ind, cur_dest_index);
-        }
-      }
-    }
-  }
-
-  DTensor result = DTensor({n_batchs, out_h * out_w, kw * kh * n_channels},
-                           col_image_ptr);
-  return result;
+  return col_image;
 }
 
 }
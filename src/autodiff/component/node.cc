@@ -6,8 +6,8 @@ Node::Node() : Node(NodeType::ADG_UNKNOWN_TYPE) {}
 
 Node::Node(const std::string &type, const std::string &name, Graph *graph)
   : type_(type), empty_jacobi_(true), empty_value_(true), backward_version_(0), requires_grad_(false) {
-  value_ = tensor::EMPTY;
-  jacobi_ = tensor::EMPTY;
+  value_ = EMPTY_DTENSOR;
+  jacobi_ = EMPTY_DTENSOR;
   unique_ptr_ = this;
   if (graph == nullptr) {
     graph_ = Graph::get_instanceof_global_graph();
@@ -21,8 +21,8 @@ Node::Node(const std::string &type, const std::string &name, Graph *graph)
 Node::Node(const std::string &type, const std::vector<Node *> &parents,
            const std::string &name, Graph *graph)
   : type_(type), empty_jacobi_(true), empty_value_(true), backward_version_(0) {
-  value_ = tensor::EMPTY;
-  jacobi_ = tensor::EMPTY;
+  value_ = EMPTY_DTENSOR;
+  jacobi_ = EMPTY_DTENSOR;
   unique_ptr_ = this;
   if (graph == nullptr) {
     graph_ = Graph::get_instanceof_global_graph();
@@ -84,9 +84,61 @@ void Node::forward() {
       // let them do it first!
       parent_ptr->forward();
     }
-    this->do_forward(); // compute is an abstract function
+  }
+  evaluate();
+}
+
+void Node::evaluate(bool in_place) {
+  if (!parents_.empty()) {
+    in_place_ = in_place;
+    try {
+      do_forward(); // compute is an abstract function
+    } catch (...) {
+      in_place_ = false;
+      throw;
+    }
+    in_place_ = false;
   }
   empty_value_ = false;
+  is_value_released_ = false;
+
+  if (graph_->is_mixed_precision() && type_ != NodeType::ADG_VARIABLE_TYPE &&
+    type_ != NodeType::ADG_PARAMETER_TYPE) {
+    // keep the value for the children and the backward pass in bfloat16,
+    // leaves hold the inputs and master weights and stay in DScalar
+    half_value_ = value_.cast<tensor::bfloat16>();
+    value_ = EMPTY_DTENSOR;
+    is_value_half_ = true;
+  }
+}
+
+DTensor Node::take_parent_value(const size_t &index) {
+  Node *parent_ptr = parents_[index];
+  DTensor value = parent_ptr->get_value();
+  if (in_place_) {
+    // leaves this node the only holder of the buffer
+    parent_ptr->release_value();
+  }
+  return value;
+}
+
+void Node::release_value() {
+  if (this != unique_ptr_) {
+    unique_ptr_->release_value();
+    return;
+  }
+
+  if (is_value_released_) {
+    return;
+  }
+  released_shape_ = get_value_shape();
+  value_ = EMPTY_DTENSOR;
+  if (is_value_half_) {
+    half_value_ = tensor::Tensor<tensor::bfloat16>();
+    is_value_half_ = false;
+  }
+  empty_value_ = true;
+  is_value_released_ = true;
 }
 
 DTensor Node::backward(Node *result) {
@@ -98,9 +150,10 @@ DTensor Node::backward(Node *result) {
 
   if (is_grad_empty()) {
     if (unique_ptr_ == result->unique_ptr_) {
-      jacobi_ = tensor::Ones({get_value_size(), 1});
+      // the seed is the loss scale, 1 unless an optimizer scales the loss
+      jacobi_ = DTensor({get_value_size(), 1}, DScalar(graph_->get_loss_scale()));
     } else {
-      jacobi_ = tensor::Zeros({get_value_size(), 1});
+      jacobi_ = DTensor({get_value_size(), 1}, DScalar(0));
 
 #if ADG_DEBUG_GLOABL_BOOL_
       for (auto child_ptr : children_) {
@@ -162,7 +215,7 @@ DTensor Node::backward(Node *result) {
 DTensor Node::get_grad(bool reshaped) const {
   if (reshaped) {
     DTensor jacobi_cp = unique_ptr_->jacobi_;
-    jacobi_cp.reshape(unique_ptr_->value_.get_shape());
+    jacobi_cp.reshape(get_value_shape());
     return jacobi_cp;
   }
   return unique_ptr_->jacobi_;
@@ -174,8 +227,13 @@ void Node::clear_value(bool recursive) {
     return;
   }
 
-  value_ = tensor::EMPTY;
+  value_ = EMPTY_DTENSOR;
   empty_value_ = true;
+  is_value_released_ = false;
+  if (is_value_half_) {
+    half_value_ = tensor::Tensor<tensor::bfloat16>();
+    is_value_half_ = false;
+  }
 
   if (recursive) {
     for (auto child_ptr : children_) {
@@ -184,6 +242,20 @@ void Node::clear_value(bool recursive) {
   }
 }
 
+DTensor &Node::get_mutable_value() {
+  if (unique_ptr_->is_value_released_) {
+    throw adg_exception::NodeValueError("Node >> get_mutable_value : the value of " + get_full_name() +
+      " was released by a memory plan");
+  }
+  if (unique_ptr_->is_value_half_) {
+    // back to full precision before it gets modified
+    unique_ptr_->value_ = unique_ptr_->half_value_.cast<DScalar>();
+    unique_ptr_->half_value_ = tensor::Tensor<tensor::bfloat16>();
+    unique_ptr_->is_value_half_ = false;
+  }
+  return unique_ptr_->value_;
+}
+
 void Node::assign_value(const DTensor &value, bool check_shape) {
   if (this != unique_ptr_) {
     unique_ptr_->assign_value(value, check_shape);
@@ -30,7 +30,7 @@ Variable::Variable(const tensor::TensorShape &shape,
 }
 
 DTensor Variable::do_backward(Node *parent_ptr) {
-  return tensor::EMPTY;
+  return EMPTY_DTENSOR;
 } // do nothing
 
 Parameter::Parameter() {};
@@ -43,6 +43,25 @@ Parameter::Parameter(const tensor::TensorShape &shape, const std::string &name,
   value_.normal_init(0., 0.001);
 }
 
-DTensor Parameter::do_backward(Node *parent) { return tensor::EMPTY; }
+void Parameter::init(const std::string &method, const size_t &fan_in, const size_t &fan_out, const size_t &seed) {
+  if (fan_in == 0 || fan_out == 0) {
+    throw adg_exception::InvalidNodeArgumentError("Parameter >> init: fans must be positive");
+  }
+  DTensor value = DTensor::uninitialized(get_value_shape());
+  if (method == "xavier_uniform") {
+    tensor::xavier_uniform_(value, fan_in, fan_out, 1., seed);
+  } else if (method == "xavier_normal") {
+    tensor::xavier_normal_(value, fan_in, fan_out, 1., seed);
+  } else if (method == "kaiming_uniform") {
+    tensor::kaiming_uniform_(value, fan_in, M_SQRT2, seed);
+  } else if (method == "kaiming_normal") {
+    tensor::kaiming_normal_(value, fan_in, M_SQRT2, seed);
+  } else {
+    throw adg_exception::InvalidNodeArgumentError("Parameter >> init: unknown initializer " + method);
+  }
+  assign_value(value);
+}
+
+DTensor Parameter::do_backward(Node *parent) { return EMPTY_DTENSOR; }
 
 } // namespace auto_diff
@@ -1,79 +1,177 @@
 #include "autodiff/graph.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include "autodiff/component/node.h"
 #include "autodiff/component/variable.h"
 
 namespace auto_diff {
 
+// bytes of a chunk of the node arena
+const size_t NODE_ARENA_CHUNK_SIZE = 64 * 1024;
+
 Graph::Graph() : stage_flag_(GraphStageFlag::train) {};
 
 Graph::Graph(const std::string &name) : graph_name_(name), stage_flag_(GraphStageFlag::train) {}
 
-Graph::~Graph() {}
+Graph::~Graph() { destroy_arena(); }
 
 void Graph::remove_all() {
-  // delete all node pointers by graph
-  // don't delete nodes elsewhere
-  for (auto map_iter = node_ptr_dict_.begin(); map_iter != node_ptr_dict_.end();
-       ++map_iter) {
-    if (map_iter->second->get_type() != NodeType::ADG_VARIABLE_TYPE) {
-      delete map_iter->second;
+  // delete the nodes created by new except for the variables, which are
+  // owned by the caller, and destroy the ones in the arena
+  for (auto node_ptr : node_ptr_list_) {
+    if (!node_ptr->in_arena_ && node_ptr->get_type() != NodeType::ADG_VARIABLE_TYPE) {
+      delete node_ptr;
     }
   }
+  destroy_arena();
   node_ptr_list_.clear();
   node_ptr_dict_.clear();
   type_counter_.clear();
 }
 
-std::string Graph::add_node(Node *node, const std::string &type,
-                            const std::string &name) {
-  std::string valid_node_name = name;
+void *Graph::allocate_node(const size_t &bytes, const size_t &alignment) {
+  auto align_up = [&alignment](char *ptr) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+    return ptr + (alignment - address % alignment) % alignment;
+  };
 
-  if (valid_node_name == "") {
-    // use type counter to generate a incremental id as node name
-    std::string id_as_name = std::to_string(type_counter_.inc(type));
-    valid_node_name = id_as_name;
+  if (bytes + alignment > NODE_ARENA_CHUNK_SIZE / 4) {
+    // a chunk of its own, kept apart from the ones being bump allocated
+    arena_big_chunks_.emplace_back(new char[bytes + alignment]);
+    return align_up(arena_big_chunks_.back().get());
   }
 
-  std::string full_node_name = type + "_" + valid_node_name;
+  char *ptr = nullptr;
+  if (!arena_chunks_.empty()) {
+    ptr = align_up(arena_chunks_.back().get() + arena_offset_);
+  }
+  if (ptr == nullptr || ptr + bytes > arena_chunks_.back().get() + NODE_ARENA_CHUNK_SIZE) {
+    arena_chunks_.emplace_back(new char[NODE_ARENA_CHUNK_SIZE]);
+    ptr = align_up(arena_chunks_.back().get());
+  }
+  arena_offset_ = ptr + bytes - arena_chunks_.back().get();
+  return ptr;
+}
 
-  if (contains_node(full_node_name)) {
+void Graph::adopt_node(Node *node_ptr, const size_t &bytes) {
+  if (node_ptr->graph_ != this) {
+    Graph *other = node_ptr->graph_;
+    size_t id = node_ptr->id_;
+    std::string full_name = node_ptr->get_full_name();
+    node_ptr->~Node();
+    other->drop_nodes_from(id, node_ptr, bytes);
+    throw adg_exception::MismatchRegisterdGraphError(
+      "Graph >> create : node " + full_name + " is registered in another graph");
+  }
+  node_ptr->in_arena_ = true;
+  arena_nodes_.emplace_back(node_ptr);
+}
+
+void Graph::drop_nodes_from(const size_t &id, const void *object, const size_t &bytes) {
+  std::vector<Node *> dropped;
+  if (id < node_ptr_list_.size()) {
+    dropped.assign(node_ptr_list_.begin() + id, node_ptr_list_.end());
+    node_ptr_list_.resize(id);
+  }
+  // the object is matched by its address range, its constructor may have
+  // failed before it was added to the graph
+  uintptr_t object_begin = reinterpret_cast<uintptr_t>(object);
+  auto is_dropped = [&dropped, object_begin, &bytes](Node *node_ptr) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(node_ptr);
+    return (address >= object_begin && address < object_begin + bytes) ||
+      std::find(dropped.begin(), dropped.end(), node_ptr) != dropped.end();
+  };
+  std::erase_if(node_ptr_dict_, [&is_dropped](const auto &item) { return is_dropped(item.second); });
+  // the parents got them as children before their constructors failed
+  for (auto node_ptr : node_ptr_list_) {
+    std::erase_if(node_ptr->children_, is_dropped);
+  }
+}
+
+void Graph::destroy_arena() {
+  for (auto node_ptr : arena_nodes_) {
+    node_ptr->~Node();
+  }
+  arena_nodes_.clear();
+  arena_chunks_.clear();
+  arena_big_chunks_.clear();
+  arena_offset_ = 0;
+}
+
+std::string Graph::add_node(Node *node, const std::string &type,
+                            const std::string &name) {
+  // a generated name is the count of the unnamed nodes of the type so far
+  auto is_generated = [this, &type](const std::string &node_name) {
+    if (node_name.empty() || node_name.size() > 19 || (node_name[0] == '0' && node_name.size() > 1) ||
+      !std::all_of(node_name.begin(), node_name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+      return false;
+    }
+    return std::stoull(node_name) < type_counter_.get(type);
+  };
+
+  std::string valid_node_name = name;
+  if (valid_node_name == "") {
+    // use type counter to generate a incremental id as node name, only
+    // checked against the names given explicitly
+    valid_node_name = std::to_string(type_counter_.inc(type));
+    if (!node_ptr_dict_.empty() && node_ptr_dict_.contains(type + "_" + valid_node_name)) {
+      throw adg_exception::DuplicateNodeNameError(
+        "Found duplicated node names: " + type + "_" + valid_node_name);
+    }
+  } else if (is_generated(valid_node_name) ||
+    !node_ptr_dict_.try_emplace(type + "_" + valid_node_name, node).second) {
     throw adg_exception::DuplicateNodeNameError(
-      "Found duplicated node names: " + full_node_name);
+      "Found duplicated node names: " + type + "_" + valid_node_name);
   }
 
-  node_ptr_dict_[full_node_name] = node;
+  node->id_ = node_ptr_list_.size();
   node_ptr_list_.emplace_back(node);
   return valid_node_name;
 }
 
 void Graph::add_relation(const std::string &parent_name,
                          const std::string &child_name) {
-  auto parent_iter = node_ptr_dict_.find(parent_name);
-  auto child_iter = node_ptr_dict_.find(child_name);
+  Node *parent_ptr = find_node(parent_name);
+  Node *child_ptr = find_node(child_name);
 
-  if (parent_iter == node_ptr_dict_.end()) {
+  if (parent_ptr == nullptr) {
     throw adg_exception::NodeNotFoundError(
       "Graph >> add_relation : parent node " + parent_name + " not found\n");
   }
-  if (child_iter == node_ptr_dict_.end()) {
+  if (child_ptr == nullptr) {
     throw adg_exception::NodeNotFoundError(
       "Graph >> add_relation : child node " + child_name + " not found\n");
   }
 
-  parent_iter->second->add_children(child_iter->second);
-  child_iter->second->add_parent(parent_iter->second);
+  parent_ptr->add_children(child_ptr);
+  child_ptr->add_parent(parent_ptr);
 }
 
 Node *Graph::get_ptr_of(const std::string &node_name) {
-  if (!contains_node(node_name)) {
+  Node *node_ptr = find_node(node_name);
+  if (node_ptr == nullptr) {
     throw adg_exception::NodeNotFoundError("Graph >> get_ptr_of : node " +
       node_name + " not found\n");
   }
-  return node_ptr_dict_.find(node_name)->second;
+  return node_ptr;
 }
 
 bool Graph::contains_node(const std::string &full_node_name) const {
-  return node_ptr_dict_.find(full_node_name) != node_ptr_dict_.end();
+  return find_node(full_node_name) != nullptr;
+}
+
+Node *Graph::find_node(const std::string &full_node_name) const {
+  auto dict_iter = node_ptr_dict_.find(full_node_name);
+  if (dict_iter != node_ptr_dict_.end()) {
+    return dict_iter->second;
+  }
+  // the unnamed nodes are not in the map, lookups by name are rare enough
+  // to scan them instead of hashing every node as it is added
+  auto list_iter = std::find_if(node_ptr_list_.begin(), node_ptr_list_.end(),
+                                [&full_node_name](Node *node_ptr) { return node_ptr->get_full_name() == full_node_name; });
+  return list_iter == node_ptr_list_.end() ? nullptr : *list_iter;
 }
 
 void Graph::backward(Node &result) {
@@ -81,6 +179,7 @@ void Graph::backward(Node &result) {
     throw adg_exception::GradError("Target is not scalar!");
   }
 
+  std::vector<Node *> leaves;
   for (auto node_ptr : node_ptr_list_) {
     if (node_ptr->get_type() == NodeType::ADG_VARIABLE_TYPE ||
       node_ptr->get_type() == NodeType::ADG_PARAMETER_TYPE) {
@@ -90,9 +189,312 @@ void Graph::backward(Node &result) {
           continue;
         }
       }
-      node_ptr->backward(result.get_ptr());
+      leaves.emplace_back(node_ptr);
+    }
+  }
+  compile({result.get_ptr()}).backward(leaves);
+}
+
+ExecutionPlan Graph::compile(const std::vector<Node *> &outputs) {
+  ExecutionPlan plan;
+  std::vector<bool> visited(node_ptr_list_.size());
+  // iterative depth-first search over the parents, a node is placed after
+  // all of its parents are
+  struct Frame {
+    Node *node_ptr;
+    std::vector<Node *> parents;
+    size_t next_parent = 0;
+  };
+  std::vector<Frame> stack;
+  for (auto output_ptr : outputs) {
+    Node *root = output_ptr->get_ptr();
+    if (root->get_graph() != this) {
+      throw adg_exception::MismatchRegisterdGraphError(
+        "Graph >> compile : node " + root->get_full_name() + " belongs to another graph");
+    }
+    plan.outputs_.emplace_back(root);
+    if (visited[root->id_]) {
+      continue;
+    }
+    visited[root->id_] = true;
+    stack.push_back({root, root->get_parents()});
+    while (!stack.empty()) {
+      Frame &frame = stack.back();
+      if (frame.next_parent < frame.parents.size()) {
+        Node *parent_ptr = frame.parents[frame.next_parent++];
+        if (!visited[parent_ptr->id_]) {
+          visited[parent_ptr->id_] = true;
+          stack.push_back({parent_ptr, parent_ptr->get_parents()});
+        }
+        continue;
+      }
+      if (!frame.parents.empty()) {
+        plan.nodes_.emplace_back(frame.node_ptr);
+      }
+      stack.pop_back();
+    }
+  }
+
+  const size_t NOT_PLANNED = std::numeric_limits<size_t>::max();
+  std::vector<size_t> position_of(node_ptr_list_.size(), NOT_PLANNED);
+  size_t n_nodes = plan.nodes_.size();
+  plan.plan_parents_.resize(n_nodes);
+  plan.plan_children_.resize(n_nodes);
+  for (size_t ix = 0; ix < n_nodes; ++ix) {
+    position_of[plan.nodes_[ix]->id_] = ix;
+    for (auto parent_ptr : plan.nodes_[ix]->parents_) {
+      size_t parent_ix = position_of[parent_ptr->id_];
+      std::vector<size_t> &parents = plan.plan_parents_[ix];
+      // a node may take the same parent twice
+      if (parent_ix != NOT_PLANNED && std::find(parents.begin(), parents.end(), parent_ix) == parents.end()) {
+        parents.emplace_back(parent_ix);
+        plan.plan_children_[parent_ix].emplace_back(ix);
+      }
+    }
+  }
+  return plan;
+}
+
+ParallelPolicy ParallelPolicy::split(const size_t &max_width, size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = utils::threads::get_num_threads();
+  }
+  ParallelPolicy policy;
+  policy.inter_op_threads = std::max<size_t>(std::min(max_width, num_threads), 1);
+  policy.intra_op_threads = std::max<size_t>(num_threads / policy.inter_op_threads, 1);
+  return policy;
+}
+
+size_t ExecutionPlan::get_max_width() const {
+  // the depth of a node is one more than the deepest of its parents
+  std::vector<size_t> depth(nodes_.size()), n_at_depth(nodes_.size() + 1);
+  size_t max_width = 0;
+  for (size_t ix = 0; ix < nodes_.size(); ++ix) {
+    for (auto parent_ix : plan_parents_[ix]) {
+      depth[ix] = std::max(depth[ix], depth[parent_ix] + 1);
+    }
+    max_width = std::max(max_width, ++n_at_depth[depth[ix]]);
+  }
+  return max_width;
+}
+
+void ExecutionPlan::run_parallel(bool is_backward, const std::function<void(size_t)> &task) const {
+  size_t n_nodes = nodes_.size();
+  const std::vector<std::vector<size_t>> &dependencies = is_backward ? plan_children_ : plan_parents_;
+  const std::vector<std::vector<size_t>> &dependents = is_backward ? plan_parents_ : plan_children_;
+  // backward runs the steps n to 2n - 1, from the last node to the first
+  auto step_of = [n_nodes, is_backward](const size_t &ix) { return is_backward ? 2 * n_nodes - 1 - ix : ix; };
+  size_t first_step = is_backward ? n_nodes : 0;
+  bool is_releasing = is_memory_planned_ && (!is_backward || memory_plan_.is_with_backward());
+
+  std::mutex mutex;
+  std::deque<size_t> ready;
+  std::vector<size_t> n_waiting(n_nodes);
+  std::vector<bool> step_done(n_nodes);
+  size_t next_release = 0;
+  bool is_failed = false;
+  for (size_t ix = 0; ix < n_nodes; ++ix) {
+    n_waiting[ix] = dependencies[ix].size();
+    if (n_waiting[ix] == 0) {
+      ready.emplace_back(ix);
+    }
+  }
+
+  /*
+    A lane takes ready nodes until none is left and then returns instead of
+    waiting for more: lanes are runtime tasks, which the nested wait of a
+    node can pick up on the same thread, so a lane blocking there would wait
+    for the node below it on the stack. Instead, a lane unblocking more nodes
+    than it takes hands them to new lanes, up to inter_op_threads at once;
+    since the lane queueing a node goes on taking nodes, none is left behind.
+  */
+  size_t max_lanes = std::max<size_t>(policy_.inter_op_threads, 1), n_lanes = 1;
+  utils::threads::TaskGroup group;
+  std::function<void()> run_lane;
+  auto start_lanes = [&](std::unique_lock<std::mutex> &lock) {
+    size_t n_new = ready.size() > 1 ? std::min(ready.size() - 1, max_lanes - n_lanes) : 0;
+    n_lanes += n_new;
+    // without workers, the runtime runs them right away on this thread
+    lock.unlock();
+    for (size_t lane = 0; lane < n_new; ++lane) {
+      group.run(run_lane);
+    }
+    lock.lock();
+  };
+  run_lane = [&] {
+    utils::threads::MklThreadsScope mkl_scope(policy_.intra_op_threads);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!ready.empty() && !is_failed) {
+      size_t ix = ready.front();
+      ready.pop_front();
+      lock.unlock();
+      try {
+        task(ix);
+      } catch (...) {
+        lock.lock();
+        is_failed = true;
+        --n_lanes;
+        throw;
+      }
+      lock.lock();
+
+      for (auto dependent_ix : dependents[ix]) {
+        if (--n_waiting[dependent_ix] == 0) {
+          ready.emplace_back(dependent_ix);
+        }
+      }
+      // a buffer is free once every step up to its last one is
+      step_done[step_of(ix) - first_step] = true;
+      while (next_release < n_nodes && step_done[next_release]) {
+        if (is_releasing) {
+          memory_plan_.release(first_step + next_release);
+        }
+        ++next_release;
+      }
+      start_lanes(lock);
+    }
+    --n_lanes;
+  };
+
+  std::exception_ptr error = nullptr;
+  try {
+    std::unique_lock<std::mutex> lock(mutex);
+    start_lanes(lock);
+    lock.unlock();
+    run_lane();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // the other lanes use the state above, wait for them before leaving
+  try {
+    group.wait();
+  } catch (...) {
+    if (error == nullptr) {
+      error = std::current_exception();
+    }
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+void ExecutionPlan::forward() const {
+  if (policy_.inter_op_threads > 1) {
+    run_parallel(false, [this](const size_t &ix) { nodes_[ix]->evaluate(is_in_place(ix)); });
+    return;
+  }
+  for (size_t ix = 0; ix < nodes_.size(); ++ix) {
+    nodes_[ix]->evaluate(is_in_place(ix));
+    if (is_memory_planned_) {
+      memory_plan_.release(ix);
+    }
+  }
+}
+
+void ExecutionPlan::backward(const std::vector<Node *> &leaves) const {
+  if (outputs_.size() != 1 || outputs_[0]->get_value_size() != 1) {
+    throw adg_exception::GradError("ExecutionPlan >> backward : expect a single scalar output");
+  }
+  if (is_memory_planned_ && !memory_plan_.is_with_backward()) {
+    throw adg_exception::GradError(
+      "ExecutionPlan >> backward : the memory plan releases the values the backward pass needs, "
+      "plan it with backward");
+  }
+  Node *result = outputs_[0];
+
+  // a node needs a gradient if one of the leaves is among its ancestors,
+  // both are looked up by the node ids
+  std::vector<bool> kept(result->graph_->get_num_nodes());
+  for (auto leaf_ptr : leaves) {
+    if (leaf_ptr->get_graph() != result->graph_) {
+      throw adg_exception::MismatchRegisterdGraphError(
+        "ExecutionPlan >> backward : leaf " + leaf_ptr->get_full_name() + " belongs to another graph");
+    }
+    kept[leaf_ptr->get_id()] = true;
+    leaf_ptr->clear_jacobi();
+  }
+  std::vector<bool> needs_grad = kept;
+  for (auto node_ptr : nodes_) {
+    node_ptr->clear_jacobi();
+    for (auto parent_ptr : node_ptr->parents_) {
+      if (needs_grad[parent_ptr->id_]) {
+        needs_grad[node_ptr->id_] = true;
+        break;
+      }
     }
   }
+
+  // the seed is the loss scale, 1 unless an optimizer scales the loss
+  result->jacobi_ = DTensor(result->get_value_shape(), DScalar(result->graph_->get_loss_scale()));
+  result->empty_jacobi_ = false;
+
+  if (policy_.inter_op_threads > 1) {
+    // nodes sharing a parent may pass their gradients to it at once
+    std::vector<std::mutex> locks(std::min<size_t>(result->graph_->get_num_nodes(), 64));
+    run_parallel(true, [&](const size_t &ix) { backward_node(ix, needs_grad, kept, &locks); });
+  } else {
+    // children come after their parents in the plan, so a node has got all
+    // of its gradient by the time the reverse sweep reaches it
+    bool is_releasing = is_memory_planned_ && memory_plan_.is_with_backward();
+    for (size_t ix = nodes_.size(); ix-- > 0;) {
+      backward_node(ix, needs_grad, kept, nullptr);
+      if (is_releasing) {
+        memory_plan_.release(2 * nodes_.size() - 1 - ix);
+      }
+    }
+  }
+
+  for (auto leaf_ptr : leaves) {
+    if (leaf_ptr->is_grad_empty()) {
+      Node *unique_ptr = leaf_ptr->get_ptr();
+      unique_ptr->jacobi_ = DTensor(unique_ptr->get_value_shape(), DScalar(0));
+      unique_ptr->empty_jacobi_ = false;
+    }
+  }
+}
+
+void ExecutionPlan::backward_node(const size_t &ix, const std::vector<bool> &needs_grad,
+                                  const std::vector<bool> &kept, std::vector<std::mutex> *locks) const {
+  Node *node_ptr = nodes_[ix];
+  if (!needs_grad[node_ptr->id_]) {
+    return;
+  }
+
+  for (auto parent_ptr : node_ptr->parents_) {
+    if (!needs_grad[parent_ptr->id_]) {
+      continue;
+    }
+    DTensor contrib = node_ptr->do_backward(parent_ptr);
+    if (node_ptr->backward_version_ == 0) {
+      // the old convention returns the jacobian, [parent_size, child_size]
+      DTensor grad = node_ptr->jacobi_;
+      grad.reshape({grad.get_size(), 1});
+      contrib = contrib.dot(grad);
+    }
+    contrib.reshape(parent_ptr->get_value_shape());
+
+    std::unique_lock<std::mutex> lock;
+    if (locks != nullptr) {
+      lock = std::unique_lock<std::mutex>((*locks)[parent_ptr->id_ % locks->size()]);
+    }
+    if (parent_ptr->empty_jacobi_) {
+      parent_ptr->jacobi_ = contrib;
+      parent_ptr->empty_jacobi_ = false;
+    } else {
+      parent_ptr->jacobi_.add_(contrib);
+    }
+  }
+
+  // all the parents have consumed it
+  if (node_ptr != outputs_[0] && !kept[node_ptr->id_]) {
+    node_ptr->clear_jacobi();
+  }
+}
+
+const MemoryPlan &ExecutionPlan::plan_memory(bool with_backward) {
+  memory_plan_ = MemoryPlan::build(nodes_, outputs_, with_backward);
+  is_memory_planned_ = true;
+  return memory_plan_;
 }
 
 Node *Graph::get_ptr_of(const std::string &node_name, Graph *graph_ptr) {
@@ -117,7 +519,7 @@ void Graph::clear_graph(Graph *graph) {
     global_graph->remove_all();
     global_graph = nullptr;
   } else {
-    if (!graph->node_ptr_dict_.empty()) {
+    if (!graph->node_ptr_list_.empty()) {
       graph->remove_all();
     }
     delete graph;
@@ -151,12 +553,10 @@ void Graph::visualize(const std::string &file_name) {
     return name_to_agnode[node_name];
   };
 
-  for (auto map_iter = node_ptr_dict_.begin(); map_iter != node_ptr_dict_.end();
-       ++map_iter) {
-    std::string full_node_name = map_iter->first;
+  for (auto cur_node : node_ptr_list_) {
+    std::string full_node_name = cur_node->get_full_name();
     Agnode_t *cur_agnode_t =
-      get_agnode_t(full_node_name, map_iter->second->get_type());
-    Node *cur_node = map_iter->second;
+      get_agnode_t(full_node_name, cur_node->get_type());
 
     Agnode_t *child_agnode_t;
     for (auto child_ptr : cur_node->get_children()) {
@@ -27,13 +27,14 @@ Conv2D::Conv2D(const size_t &input_channel,
     throw adg_exception::LayerParameterError("Conv2D receives a 0 stride...");
   }
 
-  Parameter *kernel_p = new Parameter({output_channel_, input_channel_, kernel_size[0], kernel_size[1]},
-                                      layer_name_ + "_kernel", graph_);
+  Parameter *kernel_p = graph_->create<Parameter>(
+    tensor::TensorShape{output_channel_, input_channel_, kernel_size[0], kernel_size[1]},
+    layer_name_ + "_kernel", graph_);
   add_param(kernel_p);
 
   if (use_bias) {
-    Parameter *bias_p = new Parameter({output_channel_},
-                                      layer_name_ + "_bias", graph_);
+    Parameter *bias_p = graph_->create<Parameter>(tensor::TensorShape{output_channel_},
+                                                   layer_name_ + "_bias", graph_);
     add_param(bias_p);
   }
 
@@ -79,13 +80,14 @@ Conv2D::Conv2D(const size_t &input_channel,
     }
   }
 
-  Parameter *kernel_p = new Parameter({output_channel_, input_channel_, kernel_size[0], kernel_size[1]},
-                                      layer_name_ + "_kernel", graph_);
+  Parameter *kernel_p = graph_->create<Parameter>(
+    tensor::TensorShape{output_channel_, input_channel_, kernel_size[0], kernel_size[1]},
+    layer_name_ + "_kernel", graph_);
   add_param(kernel_p);
 
   if (use_bias) {
-    Parameter *bias_p = new Parameter({output_channel_},
-                                      layer_name_ + "_bias", graph_);
+    Parameter *bias_p = graph_->create<Parameter>(tensor::TensorShape{output_channel_},
+                                                   layer_name_ + "_bias", graph_);
     add_param(bias_p);
   }
 
@@ -110,27 +112,29 @@ Parameter &Conv2D::get_bias() {
 Node &Conv2D::operator()(const Node &input) {
   check_input(input);
 
-  Node *input_ptr = Graph::get_ptr_of(input.get_full_name(), graph_);
+  Node *input_ptr = input.get_ptr();
   Node *output_ptr = input_ptr;
 
   if (padding_ != std::array<size_t, 4>({0, 0, 0, 0})) {
-    output_ptr = new functional::Pad2D(output_ptr,
-                                       {{padding_[0], padding_[1]}, {padding_[2], padding_[3]}},
-                                       0,
-                                       graph_,
-                                       layer_name_ + "_pad2d");
+    std::vector<std::pair<size_t, size_t>> padding = {{padding_[0], padding_[1]}, {padding_[2], padding_[3]}};
+    output_ptr = graph_->create<functional::Pad2D>(output_ptr,
+                                                   padding,
+                                                   0,
+                                                   graph_,
+                                                   layer_name_ + "_pad2d");
   }
 
-  Parameter weight = get_weight();
   output_ptr =
-    new functional::Conv2D(output_ptr, &weight, stride_, graph_, layer_name_ + "_conv2d");
+    graph_->create<functional::Conv2D>(output_ptr, &get_weight(), stride_, graph_, layer_name_ + "_conv2d");
 
   if (params_ptr_list_.size() == 2) {
-    Parameter bias = get_bias();
-    output_ptr = new functional::MatAddVec(output_ptr, &bias, 1, graph_, layer_name_ + "_mataddvec");
+    output_ptr = graph_->create<functional::MatAddVec>(output_ptr, &get_bias(), 1, graph_,
+                                                       layer_name_ + "_mataddvec");
   }
 
   output_ptr = use_activation(output_ptr);
+  input_ptr_ = input_ptr;
+  output_ptr_ = output_ptr;
 
   return *output_ptr;
 }
@@ -158,6 +162,13 @@ void Conv2D::check_input(const Node &input) {
   }
 }
 
+std::pair<size_t, size_t> Conv2D::get_fans() const {
+  // kernel : [c_out, c_in, kh, kw]
+  const tensor::TensorShape &kernel_shape = params_ptr_list_[0]->get_value_shape();
+  size_t window_size = kernel_shape[2] * kernel_shape[3];
+  return {input_channel_ * window_size, output_channel_ * window_size};
+}
+
 void Conv2D::assign_weight(const DTensor &value) {
   Parameter weight = get_weight();
   weight.assign_value(value);
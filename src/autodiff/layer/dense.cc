@@ -7,12 +7,12 @@ namespace layer {
 Dense::Dense(const size_t &input_channel, const size_t &output_channel,
              const std::string &activation, bool use_bias, Graph *graph)
   : Layer(LayerType::ADG_LAYER_DENSE, graph), input_channel_(input_channel), output_channel_(output_channel) {
-  Parameter *kernel_p = new Parameter({input_channel_, output_channel_},
-                                      layer_name_ + "_kernel", graph_);
+  Parameter *kernel_p = graph_->create<Parameter>(tensor::TensorShape{input_channel_, output_channel_},
+                                                 layer_name_ + "_kernel", graph_);
   add_param(kernel_p);
 
   if (use_bias) {
-    Parameter *bias_p = new Parameter({1}, layer_name_ + "_bias", graph_);
+    Parameter *bias_p = graph_->create<Parameter>(tensor::TensorShape{1}, layer_name_ + "_bias", graph_);
     add_param(bias_p);
   }
 
@@ -23,17 +23,17 @@ Dense::Dense(const size_t &input_channel, const size_t &output_channel,
 Node &Dense::operator()(const Node &input) {
   check_input(input);
 
-  Node *input_ptr = Graph::get_ptr_of(input.get_full_name(), graph_);
-  Parameter weight = get_weight();
+  Node *input_ptr = input.get_ptr();
   Node *output =
-    new functional::MatMul(input_ptr, &weight, graph_, layer_name_ + "_matmul");
+    graph_->create<functional::MatMul>(input_ptr, &get_weight(), graph_, layer_name_ + "_matmul");
 
   if (params_ptr_list_.size() == 2) {
-    Parameter bias = get_bias();
-    output = new functional::Add(output, &bias);
+    output = graph_->create<functional::Add>(output, &get_bias(), graph_, layer_name_ + "_add");
   }
 
   output = use_activation(output);
+  input_ptr_ = input_ptr;
+  output_ptr_ = output;
 
   return *output;
 }
@@ -69,6 +69,10 @@ Parameter &Dense::get_bias() {
   return *params_ptr_list_[1];
 }
 
+std::pair<size_t, size_t> Dense::get_fans() const {
+  return {input_channel_, output_channel_};
+}
+
 void Dense::assign_weight(const DTensor &value) {
   Parameter weight = get_weight();
   weight.assign_value(value);
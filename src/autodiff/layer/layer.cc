@@ -33,6 +33,15 @@ void Layer::freeze() {
   }
 }
 
+void Layer::init_weight(const std::string &method, const size_t &seed) {
+  auto [fan_in, fan_out] = get_fans();
+  params_ptr_list_[0]->init(method, fan_in, fan_out, seed);
+}
+
+std::pair<size_t, size_t> Layer::get_fans() const {
+  throw adg_exception::LayerParameterError("layer " + layer_name_ + " has no kernel to initialize");
+}
+
 void Layer::add_param(Parameter *param_ptr) {
   params_ptr_list_.emplace_back(param_ptr);
 }
@@ -41,9 +50,15 @@ Node *Layer::use_activation(Node *input) {
   std::string activation = get_config("activation");
   Node *output = input;
   if (activation == "relu") {
-    output = new functional::ReLU(input, graph_, layer_name_ + "_relu");
+    output = graph_->create<functional::ReLU>(input, graph_, layer_name_ + "_relu");
   } else if (activation == "sigmoid") {
-    output = new functional::Sigmoid(input, graph_, layer_name_ + "_sigmoid");
+    output = graph_->create<functional::Sigmoid>(input, graph_, layer_name_ + "_sigmoid");
+  } else if (activation == "tanh") {
+    output = graph_->create<functional::Tanh>(input, graph_, layer_name_ + "_tanh");
+  } else if (activation == "gelu") {
+    output = graph_->create<functional::GELU>(input, graph_, layer_name_ + "_gelu");
+  } else if (activation == "silu") {
+    output = graph_->create<functional::SiLU>(input, graph_, layer_name_ + "_silu");
   } else if (activation == "none") {
     // do nothing
   } else {
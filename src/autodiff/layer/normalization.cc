@@ -19,12 +19,12 @@ BatchNorm2D::BatchNorm2D(const size_t &num_channel,
     throw adg_exception::LayerParameterError("layer >> BatchNorm2D: get invalid num_channel");
   }
 
-  Parameter *gamma_p = new Parameter({num_channel_},
-                                     layer_name_ + "_gamma", graph_);
+  Parameter *gamma_p = graph_->create<Parameter>(tensor::TensorShape{num_channel_},
+                                                layer_name_ + "_gamma", graph_);
   add_param(gamma_p);
 
-  Parameter *beta_p = new Parameter({num_channel_},
-                                    layer_name_ + "_beta", graph_);
+  Parameter *beta_p = graph_->create<Parameter>(tensor::TensorShape{num_channel_},
+                                               layer_name_ + "_beta", graph_);
   add_param(beta_p);
 }
 
@@ -47,14 +47,14 @@ Parameter &BatchNorm2D::get_bias() {
 Node &BatchNorm2D::operator()(const Node &input) {
   check_input(input);
 
-  Node *input_ptr = Graph::get_ptr_of(input.get_full_name(), graph_);
+  Node *input_ptr = input.get_ptr();
 
   Parameter &gamma = get_weight();
   Parameter &beta = get_bias();
   bn_node_ptr_ =
-    new functional::BatchNorm2D(input_ptr, &gamma, &beta,
-                                epsilon_, momentum_, graph_,
-                                layer_name_ + "_batchnorm2d");
+    graph_->create<functional::BatchNorm2D>(input_ptr, &gamma, &beta,
+                                            epsilon_, momentum_, graph_,
+                                            layer_name_ + "_batchnorm2d");
 
   return *bn_node_ptr_;
 }
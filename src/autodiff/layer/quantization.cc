@@ -0,0 +1,359 @@
+#include "autodiff/layer/quantization.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utils/thread.h"
+
+namespace auto_diff {
+namespace layer {
+
+// at least this many entries per thread before a quantization pass is split
+const size_t QUANTIZE_MIN_CHUNK = 1 << 14;
+
+namespace {
+
+inline int8_t round_to_int8(const float &value) {
+  return static_cast<int8_t>(std::clamp(std::lrint(value), -127L, 127L));
+}
+
+double max_magnitude(const DTensor &value) {
+  if (!value.is_contiguous()) {
+    return max_magnitude(value.contiguous());
+  }
+
+  double result = 0;
+  const DScalar *value_ptr = value.get_tensor_const_ptr();
+  for (size_t ix = 0; ix < value.get_size(); ++ix) {
+    result = std::max(result, std::abs(static_cast<double>(value_ptr[ix])));
+  }
+  return result;
+}
+
+// a range maps onto [-127, 127], an all zero range keeps scale 1
+inline double range_to_scale(const double &range) {
+  return range > 0 ? range / 127. : 1.;
+}
+
+}
+
+tensor::Tensor<int8_t> quantize(const DTensor &value, const double &scale) {
+  if (!value.is_contiguous()) {
+    return quantize(value.contiguous(), scale);
+  }
+
+  auto result = tensor::Tensor<int8_t>::uninitialized(value.get_shape());
+  const DScalar *src_ptr = value.get_tensor_const_ptr();
+  int8_t *dest_ptr = &*result.get_iterator();
+  float inv_scale = static_cast<float>(1. / scale);
+  utils::threads::parallel_for(0, value.get_size(), QUANTIZE_MIN_CHUNK, [&](size_t begin, size_t end) {
+    for (size_t ix = begin; ix < end; ++ix) {
+      dest_ptr[ix] = round_to_int8(static_cast<float>(src_ptr[ix]) * inv_scale);
+    }
+  });
+  return result;
+}
+
+DTensor dequantize(const tensor::Tensor<int8_t> &value, const double &scale) {
+  if (!value.is_contiguous()) {
+    return dequantize(value.contiguous(), scale);
+  }
+
+  DTensor result = DTensor::uninitialized(value.get_shape());
+  const int8_t *src_ptr = value.get_tensor_const_ptr();
+  DScalar *dest_ptr = &*result.get_iterator();
+  utils::threads::parallel_for(0, value.get_size(), QUANTIZE_MIN_CHUNK, [&](size_t begin, size_t end) {
+    for (size_t ix = begin; ix < end; ++ix) {
+      dest_ptr[ix] = static_cast<DScalar>(src_ptr[ix] * scale);
+    }
+  });
+  return result;
+}
+
+Calibrator::Calibrator(const std::vector<Layer *> &layers)
+  : layers_(layers), input_ranges_(layers.size(), 0), output_ranges_(layers.size(), 0) {
+  if (layers_.empty()) {
+    throw adg_exception::LayerParameterError("Calibrator receives no layers...");
+  }
+}
+
+void Calibrator::observe() {
+  for (size_t ix = 0; ix < layers_.size(); ++ix) {
+    Node *input_ptr = layers_[ix]->get_input_node();
+    Node *output_ptr = layers_[ix]->get_output_node();
+    if (input_ptr == nullptr || output_ptr == nullptr) {
+      throw adg_exception::LayerParameterError(
+        "Calibrator >> observe: a layer has not been called on any input yet...");
+    }
+    if (output_ptr->is_value_empty()) {
+      throw adg_exception::LayerParameterError(
+        "Calibrator >> observe: run the graph forward before observing...");
+    }
+    input_ranges_[ix] = std::max(input_ranges_[ix], max_magnitude(input_ptr->get_value()));
+    output_ranges_[ix] = std::max(output_ranges_[ix], max_magnitude(output_ptr->get_value()));
+  }
+}
+
+double Calibrator::get_input_scale(const size_t &index) const {
+  return range_to_scale(input_ranges_.at(index));
+}
+
+double Calibrator::get_output_scale(const size_t &index) const {
+  return range_to_scale(output_ranges_.at(index));
+}
+
+QuantizedLayer::QuantizedLayer(Layer &layer, const double &input_scale, const double &output_scale)
+  : input_scale_(input_scale), output_scale_(output_scale) {
+  if (input_scale_ <= 0 || output_scale_ < 0) {
+    throw adg_exception::LayerParameterError("QuantizedLayer receives a negative scale...");
+  }
+
+  std::string activation = layer.get_config("activation");
+  if (activation == "relu") {
+    activation_ = Activation::relu;
+  } else if (activation == "sigmoid") {
+    activation_ = Activation::sigmoid;
+  } else if (activation == "tanh") {
+    activation_ = Activation::tanh;
+  } else if (activation == "gelu") {
+    activation_ = Activation::gelu;
+  } else if (activation == "silu") {
+    activation_ = Activation::silu;
+  } else {
+    activation_ = Activation::none;
+  }
+}
+
+void QuantizedLayer::set_weight(const DTensor &weight) {
+  // weight : [k, c_out], every column gets its own scale
+  DTensor packed = weight.contiguous();
+  size_t n_rows = packed.get_shape()[0];
+  output_channel_ = packed.get_shape()[1];
+
+  std::vector<double> ranges(output_channel_, 0);
+  const DScalar *src_ptr = packed.get_tensor_const_ptr();
+  for (size_t ix = 0; ix < n_rows; ++ix) {
+    for (size_t iy = 0; iy < output_channel_; ++iy) {
+      ranges[iy] = std::max(ranges[iy], std::abs(static_cast<double>(src_ptr[ix * output_channel_ + iy])));
+    }
+  }
+
+  weight_ = tensor::Tensor<int8_t>::uninitialized({n_rows, output_channel_});
+  int8_t *dest_ptr = &*weight_.get_iterator();
+  multipliers_.resize(output_channel_);
+  for (size_t iy = 0; iy < output_channel_; ++iy) {
+    double weight_scale = range_to_scale(ranges[iy]);
+    multipliers_[iy] = static_cast<float>(input_scale_ * weight_scale);
+    for (size_t ix = 0; ix < n_rows; ++ix) {
+      size_t index = ix * output_channel_ + iy;
+      dest_ptr[index] = round_to_int8(static_cast<float>(src_ptr[index] / weight_scale));
+    }
+  }
+  bias_.assign(output_channel_, 0.f);
+}
+
+void QuantizedLayer::set_bias(const DTensor &bias) {
+  // a bias of size 1 is shared by all channels like the one of Dense
+  if (bias.get_size() != 1 && bias.get_size() != output_channel_) {
+    throw adg_exception::LayerParameterError(
+      "QuantizedLayer >> set_bias: expect a bias of size 1 or " + std::to_string(output_channel_));
+  }
+
+  DTensor packed = bias.contiguous();
+  const DScalar *bias_ptr = packed.get_tensor_const_ptr();
+  for (size_t ix = 0; ix < output_channel_; ++ix) {
+    bias_[ix] = static_cast<float>(bias_ptr[packed.get_size() == 1 ? 0 : ix]);
+  }
+}
+
+template<typename oType>
+tensor::Tensor<oType> QuantizedLayer::epilogue(const tensor::Tensor<int8_t> &input) const {
+  tensor::Tensor<int32_t> acc = accumulate(input);
+  size_t n_rows = acc.get_shape()[1];
+  size_t n_total_rows = acc.get_shape()[0] * n_rows;
+
+  auto result = tensor::Tensor<oType>::uninitialized(get_output_shape(input.get_shape()));
+  const int32_t *acc_ptr = acc.get_tensor_const_ptr();
+  oType *result_ptr = &*result.get_iterator();
+  float inv_output_scale = output_scale_ > 0 ? static_cast<float>(1. / output_scale_) : 0.f;
+
+  utils::threads::parallel_for(0, n_total_rows, std::max<size_t>(1, QUANTIZE_MIN_CHUNK / output_channel_),
+                               [&](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; ++row) {
+      const int32_t *acc_row = acc_ptr + row * output_channel_;
+      size_t ib = row / n_rows, ir = row % n_rows;
+      for (size_t ic = 0; ic < output_channel_; ++ic) {
+        float value = static_cast<float>(acc_row[ic]) * multipliers_[ic] + bias_[ic];
+        if (activation_ == Activation::relu) {
+          value = std::max(value, 0.f);
+        } else if (activation_ == Activation::sigmoid) {
+          value = utils::math::sigmoid(value);
+        } else if (activation_ == Activation::tanh) {
+          value = std::tanh(value);
+        } else if (activation_ == Activation::gelu) {
+          value = utils::math::gelu(value);
+        } else if (activation_ == Activation::silu) {
+          value = utils::math::silu(value);
+        }
+
+        // convolutions are stored channels first: [b, c_out, rows]
+        size_t index = channels_first_ ? (ib * output_channel_ + ic) * n_rows + ir : row * output_channel_ + ic;
+        if constexpr (std::is_same_v<oType, int8_t>) {
+          result_ptr[index] = round_to_int8(value * inv_output_scale);
+        } else {
+          result_ptr[index] = static_cast<oType>(value);
+        }
+      }
+    }
+  });
+  return result;
+}
+
+tensor::Tensor<int8_t> QuantizedLayer::forward(const tensor::Tensor<int8_t> &input) const {
+  if (output_scale_ == 0) {
+    throw adg_exception::LayerParameterError(
+      "QuantizedLayer >> forward: no output scale, use forward_float instead...");
+  }
+  return epilogue<int8_t>(input);
+}
+
+DTensor QuantizedLayer::forward_float(const tensor::Tensor<int8_t> &input) const {
+  return epilogue<DScalar>(input);
+}
+
+size_t QuantizedLayer::get_weight_bytes() const {
+  return weight_.get_size() * sizeof(int8_t) + (multipliers_.size() + bias_.size()) * sizeof(float);
+}
+
+QuantizedDense::QuantizedDense(Dense &dense, const double &input_scale, const double &output_scale)
+  : QuantizedLayer(dense, input_scale, output_scale) {
+  set_weight(dense.get_weight().get_value());  // [in, out]
+  if (dense.get_param_ptr_list().size() == 2) {
+    set_bias(dense.get_bias().get_value());
+  }
+}
+
+tensor::Tensor<int32_t> QuantizedDense::accumulate(const tensor::Tensor<int8_t> &input) const {
+  if (!input.is_contiguous()) {
+    return accumulate(input.contiguous());
+  }
+
+  size_t n_input_channel = weight_.get_shape()[0];
+  if (input.get_dim() != 2 || input.get_shape()[1] != n_input_channel) {
+    throw adg_exception::MismatchTensorShapeError(
+      "QuantizedDense >> invalid input shape " + utils::vector_to_str(input.get_shape()));
+  }
+
+  size_t n_batch = input.get_shape()[0];
+  auto acc = tensor::Tensor<int32_t>::uninitialized({1, n_batch, output_channel_});
+  utils::math::gemm_accumulate(false, false, n_batch, output_channel_, n_input_channel,
+                               input.get_tensor_const_ptr(), n_input_channel,
+                               weight_.get_tensor_const_ptr(), output_channel_,
+                               &*acc.get_iterator(), output_channel_);
+  return acc;
+}
+
+tensor::TensorShape QuantizedDense::get_output_shape(const tensor::TensorShape &input_shape) const {
+  return {input_shape[0], output_channel_};
+}
+
+QuantizedConv2D::QuantizedConv2D(Conv2D &conv, const double &input_scale, const double &output_scale)
+  : QuantizedLayer(conv, input_scale, output_scale), padding_(conv.get_padding()), stride_(conv.get_stride()) {
+  // kernel : [c_out, c_in, kh, kw] -> [c_in * kh * kw, c_out], matching the rows of im2col_chw
+  DTensor kernel = conv.get_weight().get_value();
+  tensor::TensorShape kernel_shape = kernel.get_shape();
+  kernel_size_ = {kernel_shape[2], kernel_shape[3]};
+  kernel.reshape({kernel_shape[0], kernel_shape[1] * kernel_shape[2] * kernel_shape[3]});
+  set_weight(kernel.transpose(0, 1));
+  if (conv.get_param_ptr_list().size() == 2) {
+    set_bias(conv.get_bias().get_value());
+  }
+  channels_first_ = true;
+}
+
+tensor::Tensor<int8_t> QuantizedConv2D::pad(const tensor::Tensor<int8_t> &input) const {
+  if (padding_ == std::array<size_t, 4>({0, 0, 0, 0})) {
+    return input;
+  }
+  return tensor::pad2d(input, {{padding_[0], padding_[1]}, {padding_[2], padding_[3]}}, int8_t(0));
+}
+
+tensor::Tensor<int32_t> QuantizedConv2D::accumulate(const tensor::Tensor<int8_t> &input) const {
+  size_t n_window = weight_.get_shape()[0];
+  if (input.get_dim() != 4 || input.get_shape()[1] * kernel_size_[0] * kernel_size_[1] != n_window) {
+    throw adg_exception::MismatchTensorShapeError(
+      "QuantizedConv2D >> invalid input shape " + utils::vector_to_str(input.get_shape()));
+  }
+
+  // the windows of the whole batch are stacked into one gemm
+  tensor::Tensor<int8_t> col_image = tensor::im2col_chw(pad(input),
+                                                        kernel_size_[0],
+                                                        kernel_size_[1],
+                                                        stride_[0],
+                                                        stride_[1]); // [B, out_h * out_w, cin * kh * kw]
+  size_t n_batch = col_image.get_shape()[0];
+  size_t n_rows = col_image.get_shape()[1];
+  auto acc = tensor::Tensor<int32_t>::uninitialized({n_batch, n_rows, output_channel_});
+  utils::math::gemm_accumulate(false, false, n_batch * n_rows, output_channel_, n_window,
+                               col_image.get_tensor_const_ptr(), n_window,
+                               weight_.get_tensor_const_ptr(), output_channel_,
+                               &*acc.get_iterator(), output_channel_);
+  return acc;
+}
+
+tensor::TensorShape QuantizedConv2D::get_output_shape(const tensor::TensorShape &input_shape) const {
+  size_t padded_h = input_shape[2] + padding_[0] + padding_[1];
+  size_t padded_w = input_shape[3] + padding_[2] + padding_[3];
+  return {input_shape[0],
+          output_channel_,
+          (padded_h - kernel_size_[0]) / stride_[0] + 1,
+          (padded_w - kernel_size_[1]) / stride_[1] + 1};
+}
+
+QuantizedSequential::QuantizedSequential(const Calibrator &calibrator) {
+  size_t n_layers = calibrator.get_size();
+  for (size_t ix = 0; ix < n_layers; ++ix) {
+    Layer *layer_ptr = calibrator.get_layer(ix);
+    double input_scale = calibrator.get_input_scale(ix);
+    // a layer hands its output over in the scale the next one reads it with
+    double output_scale = ix + 1 < n_layers ? calibrator.get_input_scale(ix + 1) : 0;
+
+    if (auto dense_ptr = dynamic_cast<Dense *>(layer_ptr)) {
+      layers_.emplace_back(new QuantizedDense(*dense_ptr, input_scale, output_scale));
+      flatten_input_.push_back(true);
+    } else if (auto conv_ptr = dynamic_cast<Conv2D *>(layer_ptr)) {
+      layers_.emplace_back(new QuantizedConv2D(*conv_ptr, input_scale, output_scale));
+      flatten_input_.push_back(false);
+    } else {
+      throw adg_exception::LayerParameterError(
+        "QuantizedSequential only supports Dense and Conv2D layers...");
+    }
+  }
+}
+
+DTensor QuantizedSequential::forward(const DTensor &input) const {
+  tensor::Tensor<int8_t> value = quantize(input, layers_[0]->get_input_scale());
+  for (size_t ix = 0; ix < layers_.size(); ++ix) {
+    if (flatten_input_[ix] && value.get_dim() > 2) {
+      size_t n_batch = value.get_shape()[0];
+      value = value.contiguous();
+      value.reshape({n_batch, value.get_size() / n_batch});
+    }
+    if (ix + 1 == layers_.size()) {
+      return layers_[ix]->forward_float(value);
+    }
+    value = layers_[ix]->forward(value);
+  }
+  return EMPTY_DTENSOR;
+}
+
+size_t QuantizedSequential::get_weight_bytes() const {
+  size_t result = 0;
+  for (auto &layer_ptr : layers_) {
+    result += layer_ptr->get_weight_bytes();
+  }
+  return result;
+}
+
+} // namespace layer
+} // namespace auto_diff
@@ -0,0 +1,219 @@
+#include "autodiff/memory_planner.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "autodiff/component/node.h"
+#include "utils/memory.h"
+
+namespace auto_diff {
+
+namespace {
+
+size_t align_bytes(const size_t &bytes) {
+  const size_t alignment = utils::memory::MEMORY_ALIGNMENT;
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+// blocks sharing one buffer, an in-place activation and its input
+struct BlockGroup {
+  size_t bytes, first, last;
+  std::vector<size_t> blocks;
+  size_t offset = 0;
+};
+
+}
+
+MemoryPlan MemoryPlan::build(const std::vector<Node *> &nodes, const std::vector<Node *> &outputs, bool with_backward) {
+  MemoryPlan plan;
+  plan.with_backward_ = with_backward;
+  size_t n_nodes = nodes.size();
+  size_t n_steps = with_backward ? 2 * n_nodes : n_nodes;
+  plan.releases_.resize(n_steps);
+  plan.in_place_.resize(n_nodes);
+  if (n_nodes == 0) {
+    return plan;
+  }
+
+  // the forward step of each node of the plan and whether it's an output,
+  // by node id
+  const size_t NOT_PLANNED = std::numeric_limits<size_t>::max();
+  size_t n_graph_nodes = nodes[0]->graph_->get_num_nodes();
+  std::vector<size_t> step_of(n_graph_nodes, NOT_PLANNED);
+  for (size_t ix = 0; ix < n_nodes; ++ix) {
+    step_of[nodes[ix]->id_] = ix;
+  }
+  std::vector<bool> kept(n_graph_nodes);
+  for (auto output_ptr : outputs) {
+    kept[output_ptr->get_id()] = true;
+  }
+  // the backward pass visits the nodes in reverse
+  auto backward_step = [n_nodes](const size_t &step) { return 2 * n_nodes - 1 - step; };
+
+  std::vector<BlockGroup> groups;
+  auto add_block = [&](Node *node_ptr, MemoryBlock::Kind kind, const size_t &bytes, size_t first, size_t last) {
+    bool is_kept = kept[node_ptr->id_];
+    if (is_kept) {
+      last = n_steps - 1;
+    } else {
+      plan.releases_[last].emplace_back(plan.blocks_.size());
+    }
+    groups.push_back({bytes, first, last, {plan.blocks_.size()}});
+    plan.blocks_.push_back({node_ptr, kind, bytes, first, last});
+    return plan.blocks_.size() - 1;
+  };
+
+  std::vector<size_t> value_block(n_nodes);
+  for (size_t ix = 0; ix < n_nodes; ++ix) {
+    Node *node_ptr = nodes[ix];
+    size_t last = ix;
+    for (auto child_ptr : node_ptr->children_) {
+      size_t child_step = step_of[child_ptr->id_];
+      if (child_step == NOT_PLANNED) {
+        // not run by this plan
+        continue;
+      }
+      last = std::max(last, child_step);
+      if (with_backward && child_ptr->is_parent_value_needed_for_backward()) {
+        last = std::max(last, backward_step(child_step));
+      }
+    }
+    if (with_backward && node_ptr->is_value_needed_for_backward()) {
+      last = std::max(last, backward_step(ix));
+    }
+    size_t scalar_size = node_ptr->graph_->is_mixed_precision() ? sizeof(tensor::bfloat16) : sizeof(DScalar);
+    value_block[ix] = add_block(node_ptr, MemoryBlock::VALUE, node_ptr->get_value_size() * scalar_size, ix, last);
+
+    size_t cache_bytes = node_ptr->get_cache_bytes();
+    if (cache_bytes) {
+      add_block(node_ptr, MemoryBlock::CACHE, cache_bytes, ix, with_backward ? backward_step(ix) : ix);
+    }
+  }
+
+  if (with_backward) {
+    for (size_t ix = 0; ix < n_nodes; ++ix) {
+      Node *node_ptr = nodes[ix];
+      // the first child visited in backward starts the gradient, the output
+      // gets its seed before the sweep
+      size_t first = n_nodes;
+      if (!kept[node_ptr->id_]) {
+        first = backward_step(ix);
+        for (auto child_ptr : node_ptr->children_) {
+          size_t child_step = step_of[child_ptr->id_];
+          if (child_step != NOT_PLANNED) {
+            first = std::min(first, backward_step(child_step));
+          }
+        }
+      }
+      add_block(node_ptr, MemoryBlock::GRAD, node_ptr->get_value_size() * sizeof(DScalar), first, backward_step(ix));
+    }
+  }
+
+  // an activation overwrites the value of its parent if nothing else reads
+  // it, the parent's buffer is freed at the same step anyway; groups are
+  // indexed like the blocks until they get merged
+  std::vector<size_t> group_of = value_block;
+  for (size_t ix = 0; ix < n_nodes; ++ix) {
+    Node *node_ptr = nodes[ix];
+    if (!node_ptr->can_run_in_place()) {
+      continue;
+    }
+    Node *parent_ptr = node_ptr->parents_[0];
+    size_t parent_step = step_of[parent_ptr->id_];
+    if (parent_step == NOT_PLANNED || kept[parent_ptr->id_] || parent_ptr->children_.size() != 1 ||
+      parent_ptr->is_value_needed_for_backward()) {
+      continue;
+    }
+    MemoryBlock &parent_block = plan.blocks_[value_block[parent_step]];
+    MemoryBlock &block = plan.blocks_[value_block[ix]];
+    if (parent_block.last != ix || parent_block.bytes != block.bytes) {
+      continue;
+    }
+
+    plan.in_place_[ix] = true;
+    block.in_place = true;
+    // the parent's group takes the blocks of this one over, this group stays empty
+    BlockGroup &parent_group = groups[group_of[parent_step]];
+    BlockGroup &group = groups[group_of[ix]];
+    parent_group.last = std::max(parent_group.last, group.last);
+    parent_group.blocks.insert(parent_group.blocks.end(), group.blocks.begin(), group.blocks.end());
+    group.blocks.clear();
+    group_of[ix] = group_of[parent_step];
+  }
+
+  // greedy by size: the biggest group goes first into the lowest offset
+  // that doesn't overlap a placed group live at the same time
+  std::vector<size_t> order(groups.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&groups](const size_t &a, const size_t &b) {
+    return groups[a].bytes > groups[b].bytes;
+  });
+  std::vector<size_t> placed;
+  std::vector<std::pair<size_t, size_t>> taken;
+  for (auto group_ix : order) {
+    BlockGroup &group = groups[group_ix];
+    if (group.blocks.empty()) {
+      continue;
+    }
+    size_t size = align_bytes(group.bytes);
+    taken.clear();
+    for (auto placed_ix : placed) {
+      const BlockGroup &other = groups[placed_ix];
+      if (other.first <= group.last && group.first <= other.last) {
+        taken.emplace_back(other.offset, other.offset + align_bytes(other.bytes));
+      }
+    }
+    std::sort(taken.begin(), taken.end());
+    size_t offset = 0;
+    for (const auto &[begin, end] : taken) {
+      if (begin >= offset + size) {
+        break;
+      }
+      offset = std::max(offset, end);
+    }
+    group.offset = offset;
+    plan.peak_bytes_ = std::max(plan.peak_bytes_, offset + size);
+    placed.emplace_back(group_ix);
+  }
+
+  for (const auto &group : groups) {
+    for (auto block_ix : group.blocks) {
+      plan.blocks_[block_ix].offset = group.offset;
+    }
+  }
+  for (const auto &block : plan.blocks_) {
+    plan.total_bytes_ += align_bytes(block.bytes);
+  }
+  return plan;
+}
+
+void MemoryPlan::release(const size_t &step) const {
+  if (step >= releases_.size()) {
+    return;
+  }
+  for (auto block_ix : releases_[step]) {
+    const MemoryBlock &block = blocks_[block_ix];
+    switch (block.kind) {
+      case MemoryBlock::VALUE:
+        block.node_ptr->release_value();
+        break;
+      case MemoryBlock::GRAD:
+        block.node_ptr->clear_jacobi();
+        break;
+      case MemoryBlock::CACHE:
+        block.node_ptr->clear_cache();
+        break;
+    }
+  }
+}
+
+std::string MemoryPlan::to_string() const {
+  size_t n_in_place = std::count_if(blocks_.begin(), blocks_.end(),
+                                    [](const MemoryBlock &block) { return block.in_place; });
+  return "MemoryPlan: " + std::to_string(blocks_.size()) + " buffers over " + std::to_string(releases_.size()) +
+    " steps, planned peak " + std::to_string(peak_bytes_) + " bytes, " + std::to_string(total_bytes_) +
+    " bytes without sharing, " + std::to_string(n_in_place) + " in place";
+}
+
+} // namespace auto_diff
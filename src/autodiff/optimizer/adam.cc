@@ -13,7 +13,8 @@ Adam::Adam(const Node &target,
 void Adam::reset_state() {
   beta1_power_ = 1.;
   beta2_power_ = 1.;
-  moments_table_.clear();
+  first_moments_.clear();
+  second_moments_.clear();
 }
 
 void Adam::update() {
@@ -21,15 +22,15 @@ void Adam::update() {
     if (node_ptr->get_type() == NodeType::ADG_PARAMETER_TYPE) {
       DTensor grad = get_gradient(node_ptr);
 
+      DTensor &value = node_ptr->get_mutable_value();
       if (weight_decay_ >= 0) {
         // g = g + lambda * theta
-        grad += node_ptr->get_value().multiply(weight_decay_);
+        grad = tensor::lazy(grad) + tensor::lazy(value) * weight_decay_;
       }
 
-      DTensor moment = update_moments(node_ptr->get_full_name(), grad);
+      DTensor moment = update_moments(node_ptr, grad);
 
-      DTensor value = node_ptr->get_value(); // shallow copy of value tensor
-      value -= moment.multiply(learning_rate_);
+      value = tensor::lazy(value) - tensor::lazy(moment) * learning_rate_;
     }
   }
 
@@ -37,37 +38,25 @@ void Adam::update() {
   beta2_power_ *= beta2_;
 }
 
-DTensor Adam::update_moments(const std::string &node_name,
+DTensor Adam::update_moments(const Node *node_ptr,
                              const DTensor &grad) {
-  std::string first_moment_key = node_name + ":FIRST";
-  std::string second_moment_key = node_name + ":SECOND";
-
-  DTensor first_moment, second_moment;
-  if (moments_table_.find(first_moment_key) == moments_table_.end()) {
-    first_moment = DTensor(grad.get_shape());
-  } else {
-    first_moment = moments_table_[first_moment_key].multiply(beta1_);
-  }
-  if (moments_table_.find(second_moment_key) == moments_table_.end()) {
-    second_moment = DTensor(grad.get_shape());
-  } else {
-    second_moment = moments_table_[second_moment_key].multiply(beta2_);
+  if (!first_moments_.contains(node_ptr)) {
+    first_moments_.emplace(node_ptr, grad.get_shape());
+    second_moments_.emplace(node_ptr, grad.get_shape());
   }
-
-  // m = beta * m + (1 - beta) * g
-  first_moment += grad.multiply(1 - beta1_);
-  second_moment += grad.multiply(grad).multiply(1 - beta2_);
-  moments_table_[first_moment_key] = first_moment;
-  moments_table_[second_moment_key] = second_moment;
-
-  // normalize the moving average moments
-  first_moment = first_moment.multiply(1. / (1 - beta1_power_ * beta1_));
-  second_moment = second_moment.multiply(1. / (1 - beta2_power_ * beta2_));
-  second_moment += epsilon_;
-  second_moment = tensor::sqrt(second_moment);
-
-  // get the self-adaptive gradients
-  return tensor::div(first_moment, second_moment);
+  DTensor &first_moment = first_moments_[node_ptr];
+  DTensor &second_moment = second_moments_[node_ptr];
+
+  // m = beta * m + (1 - beta) * g, updated in place
+  auto g = tensor::lazy(grad);
+  first_moment = tensor::lazy(first_moment) * beta1_ + g * (1 - beta1_);
+  second_moment = tensor::lazy(second_moment) * beta2_ + g * g * (1 - beta2_);
+
+  // normalize the moving average moments and get the self-adaptive gradients
+  double first_scale = 1. / (1 - beta1_power_ * beta1_);
+  double second_scale = 1. / (1 - beta2_power_ * beta2_);
+  return DTensor(tensor::lazy(first_moment) * first_scale /
+    tensor::expr::sqrt(tensor::lazy(second_moment) * second_scale + epsilon_));
 }
 
 } // namespace optimizer
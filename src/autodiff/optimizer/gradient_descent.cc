@@ -12,8 +12,8 @@ void GradientDescent::update() {
     if (node_ptr->get_type() == NodeType::ADG_PARAMETER_TYPE) {
       DTensor grad = get_gradient(node_ptr);
 
-      DTensor value = node_ptr->get_value(); // shallow copy of value tensor
-      value -= grad.multiply(learning_rate_);
+      DTensor &value = node_ptr->get_mutable_value();
+      tensor::axpby(DScalar(-learning_rate_), grad, DScalar(1), value);
     }
   }
 }
@@ -3,6 +3,9 @@
 namespace auto_diff {
 namespace optimizer {
 
+// finite steps in a row before a dynamic loss scale is doubled
+const size_t LOSS_SCALE_GROWTH_INTERVAL = 2000;
+
 Optimizer::Optimizer(const Node &target,
                      const double &learning_rate, Graph *graph)
   : learning_rate_(learning_rate) {
@@ -11,7 +14,11 @@ Optimizer::Optimizer(const Node &target,
   } else {
     graph_ = graph;
   }
-  target_node_ptr_ = Graph::get_ptr_of(target.get_full_name(), graph_);
+  if (target.get_graph() != graph_) {
+    throw adg_exception::MismatchRegisterdGraphError(
+      "Optimizer >> target " + target.get_full_name() + " does not belong to the graph of the optimizer");
+  }
+  target_node_ptr_ = target.get_ptr();
 }
 
 void Optimizer::zero_grad() { graph_->zero_grad(); }
@@ -21,11 +28,58 @@ void Optimizer::step() {
     agg_trainable_params();
   }
 
+  graph_->set_loss_scale(loss_scale_);
   propagate();
-  update();
+  graph_->set_loss_scale(1.);
+  if (unscale_grads()) {
+    update();
+  }
   acc_grads_.clear();
 }
 
+void Optimizer::set_plan(const ExecutionPlan &plan) {
+  if (plan.get_outputs().size() != 1 || plan.get_outputs()[0] != target_node_ptr_) {
+    throw adg_exception::InvalidNodeArgumentError("Optimizer >> set_plan : the plan should have the target as its output");
+  }
+  backward_plan_ = plan;
+}
+
+void Optimizer::set_loss_scale(const double &loss_scale, bool dynamic) {
+  loss_scale_ = loss_scale;
+  dynamic_loss_scale_ = dynamic;
+  n_finite_steps_ = 0;
+}
+
+bool Optimizer::unscale_grads() {
+  if (loss_scale_ == 1. && !dynamic_loss_scale_) {
+    return true;
+  }
+
+  bool finite = true;
+  for (auto *node_ptr : trainable_params_list_) {
+    if (!acc_grads_.contains(node_ptr)) {
+      continue;
+    }
+    DTensor &grad = acc_grads_[node_ptr];
+    grad.multiply_(DScalar(1. / loss_scale_));
+    const DScalar *grad_ptr = grad.get_tensor_const_ptr();
+    finite = finite && std::all_of(grad_ptr, grad_ptr + grad.get_size(),
+                                   [](const DScalar &value) { return std::isfinite(value); });
+  }
+
+  if (!dynamic_loss_scale_) {
+    return finite;
+  }
+  if (!finite) {
+    loss_scale_ = std::max(loss_scale_ / 2, 1.);
+    n_finite_steps_ = 0;
+  } else if (++n_finite_steps_ == LOSS_SCALE_GROWTH_INTERVAL) {
+    loss_scale_ *= 2;
+    n_finite_steps_ = 0;
+  }
+  return finite;
+}
+
 void Optimizer::agg_trainable_params() {
   NodeIteratorPair node_iterators = graph_->get_node_iterators();
 
@@ -44,6 +98,9 @@ void Optimizer::agg_trainable_params() {
 
     trainable_params_list_.emplace_back(node_ptr);
   }
+  if (backward_plan_.get_outputs().empty()) {
+    backward_plan_ = graph_->compile({target_node_ptr_});
+  }
 }
 
 void Optimizer::set_requires_grads_for_all() {
@@ -51,20 +108,18 @@ void Optimizer::set_requires_grads_for_all() {
 }
 
 DTensor Optimizer::get_gradient(Node *node_ptr) {
-  return acc_grads_.at(node_ptr->get_full_name());
+  return acc_grads_.at(node_ptr);
 }
 
 void Optimizer::propagate() {
-  // backward is done here
-  // node_iterators: pair of <begin_iterator, end_iterator>
+  // backward is done here, in one reverse sweep over the plan
+  backward_plan_.backward(trainable_params_list_);
   for (auto *node_ptr : trainable_params_list_) {
-    node_ptr->backward(target_node_ptr_);
     DTensor grad = node_ptr->get_grad();
-    auto acc_grads_iter = acc_grads_.find(node_ptr->get_full_name());
-    if (acc_grads_iter == acc_grads_.end()) {
-      acc_grads_[node_ptr->get_full_name()] = grad;
+    if (!acc_grads_.contains(node_ptr)) {
+      acc_grads_.emplace(node_ptr, grad);
     } else {
-      acc_grads_iter->second += grad;
+      acc_grads_[node_ptr] += grad;
     }
   }
 }
@@ -7,6 +7,9 @@
 namespace auto_diff {
 namespace data {
 
+// lines parsed per thread at least, before the parsing is split
+const size_t PARSE_MIN_CHUNK = 256;
+
 CsvDataset::CsvDataset(const std::string &path,
                        const size_t &label_index,
                        const size_t &batch_size,
@@ -23,21 +26,32 @@ CsvDataset::CsvDataset(const std::string &path,
   file_reader_ = std::ifstream(path);
 
   std::regex blank("\\s*");
+  std::vector<std::string> lines;
+  while (std::getline(file_reader_, buffer_)) {
+    if (std::regex_match(buffer_, blank)) {
+      break;
+    }
+    lines.emplace_back(std::move(buffer_));
+  }
+  file_reader_.close();
+
+  // the lines are parsed on the thread runtime, each one into its own row
+  if (!lines.empty()) {
+    column_size_ = utils::str_split(lines[0], sep).size();
+  }
+  data_.resize(lines.size());
+  labels_.resize(lines.size());
   try {
-    while (std::getline(file_reader_, buffer_)) {
-      if (std::regex_match(buffer_, blank)) {
-        break;
+    utils::threads::parallel_for(0, lines.size(), PARSE_MIN_CHUNK, [&](size_t begin, size_t end) {
+      for (size_t ix = begin; ix < end; ++ix) {
+        read_line(lines[ix], sep, ix);
       }
-      read_line(sep);
-    }
+    });
   } catch (const adg_exception::DatasetError &ex) {
-    file_reader_.close();
     throw adg_exception::DatasetError(
       std::string("Error when reading from the dataset files... message: \n") + ex.what());
   }
 
-  file_reader_.close();
-
   std::iota(shuffle_indices_.begin(), shuffle_indices_.end(), 0);
   if (shuffle_) {
     do_shuffle();
@@ -45,12 +59,8 @@ CsvDataset::CsvDataset(const std::string &path,
   nlabels_ = std::unordered_set<double>(labels_.begin(), labels_.end()).size();
 }
 
-void CsvDataset::read_line(const std::string &sep) {
-  auto splitted = utils::str_split(buffer_, sep);
-
-  if (!column_size_) {
-    column_size_ = splitted.size();
-  }
+void CsvDataset::read_line(const std::string &line, const std::string &sep, const size_t &row_index) {
+  auto splitted = utils::str_split(line, sep);
 
   std::vector<double> row(column_size_ - 1);
   for (int ix = 0, iy = 0; ix < column_size_; ++ix) {
@@ -59,8 +69,8 @@ void CsvDataset::read_line(const std::string &sep) {
     }
     row[iy++] = std::stod(splitted[ix]);
   }
-  data_.emplace_back(row);
-  labels_.emplace_back(std::stod(splitted[label_index_]));
+  data_[row_index] = std::move(row);
+  labels_[row_index] = std::stod(splitted[label_index_]);
 }
 
 bool CsvDataset::has_next() const {
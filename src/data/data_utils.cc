@@ -15,7 +15,7 @@ tensor::Tensor<double> to_one_hot(const size_t &label_num, const tensor::Tensor<
 
   tensor::Tensor<double> result({label_tensor.get_size(), label_num}, 0.);
   for (size_t ix = 0; ix < label_tensor.get_size(); ++ix) {
-    size_t label_ind = label_tensor.get_value();
+    size_t label_ind = label_tensor.get_value({ix});
     result.set_value({ix, label_ind}, 1.);
   }
   return result;
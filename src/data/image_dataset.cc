@@ -77,15 +77,28 @@ bool ImageDataset::has_next() const {
 }
 
 DataPair ImageDataset::get_next() {
-  size_t counter = 0;
-  std::vector<tensor::Tensor<double>> feature_tensors;
+  std::vector<std::string> batch_files;
   std::vector<tensor::Tensor<double>> label_tensors;
-
-  while (image_iter_ != img_file_list_.end() && counter++ < batch_size_) {
-    feature_tensors.emplace_back(image_to_tensor(read_image(*(image_iter_++))));  // shape {1, h, w, c}
+  while (image_iter_ != img_file_list_.end() && batch_files.size() < batch_size_) {
+    batch_files.emplace_back(*(image_iter_++));
     label_tensors.emplace_back(std::vector<size_t>(1, 1), *(label_iter_++)); // shape {1}
   }
 
+  // images of a batch are decoded on the thread runtime, the transforms
+  // are user code and run afterwards on this thread
+  std::vector<tensor::Tensor<double>> feature_tensors(batch_files.size());
+  utils::threads::parallel_for(0, batch_files.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t ix = begin; ix < end; ++ix) {
+      std::unique_ptr<Image> img(read_image(batch_files[ix]));
+      feature_tensors[ix] = image_to_tensor(img.get());  // shape {1, h, w, c}
+    }
+  });
+  if (!transforms_.empty()) {
+    for (auto &feature : feature_tensors) {
+      do_transform(feature);
+    }
+  }
+
   return DataPair({tensor::Tensor<double>::concat(feature_tensors, 0),
                    tensor::Tensor<double>::concat(label_tensors, 0)});
 }
@@ -104,11 +117,7 @@ tensor::Tensor<double> ImageDataset::image_to_tensor(Image *img) {
   // tensor should have dim of [1, H, W, C] for convenient concat...
   size_t size = img->height_ * img->width_ * img->channels_;
   std::vector<double> result_data(img->data_, img->data_ + size);
-  tensor::Tensor<double> result({1, img->height_, img->width_, img->channels_}, std::move(result_data));
-  if (!transforms_.empty()) {
-    do_transform(result);
-  }
-  return result;
+  return tensor::Tensor<double>({1, img->height_, img->width_, img->channels_}, std::move(result_data));
 }
 
 void ImageDataset::reset_iterator() {
@@ -0,0 +1,76 @@
+#include "data/npy_dataset.h"
+
+namespace auto_diff {
+namespace data {
+
+NpyDataset::NpyDataset(const std::string &features_path,
+                       const std::string &labels_path,
+                       const size_t &batch_size,
+                       bool to_one_hot,
+                       bool shuffle,
+                       unsigned long shuffle_seed)
+  : shuffle_(shuffle),
+    to_one_hot_(to_one_hot),
+    batch_size_(batch_size),
+    shuffle_seed_(shuffle_seed),
+    nlabels_(0),
+    iter_index_(0) {
+  try {
+    features_ = tensor::io::load_npy<double>(features_path);
+    labels_ = tensor::io::load_npy<double>(labels_path);
+  } catch (const adg_exception::TensorIOError &ex) {
+    throw adg_exception::DatasetError(
+      std::string("Error when reading from the dataset files... message: \n") + ex.what());
+  }
+
+  if (features_.get_shape(0) != labels_.get_size()) {
+    throw adg_exception::DatasetError(
+      "NpyDataset >> got " + std::to_string(features_.get_shape(0)) + " samples and " +
+        std::to_string(labels_.get_size()) + " labels");
+  }
+  labels_.reshape({labels_.get_size()});
+
+  shuffle_indices_.resize(labels_.get_size());
+  std::iota(shuffle_indices_.begin(), shuffle_indices_.end(), 0);
+  if (shuffle_) {
+    do_shuffle(shuffle_seed_);
+  }
+
+  const double *label_ptr = labels_.get_tensor_const_ptr();
+  nlabels_ = std::unordered_set<double>(label_ptr, label_ptr + labels_.get_size()).size();
+}
+
+bool NpyDataset::has_next() const {
+  return iter_index_ < shuffle_indices_.size();
+}
+
+DataPair NpyDataset::get_next() {
+  size_t end = std::min(iter_index_ + batch_size_, shuffle_indices_.size());
+  std::vector<size_t> batch_indices(shuffle_indices_.begin() + iter_index_, shuffle_indices_.begin() + end);
+  iter_index_ = end;
+
+  tensor::Tensor<double> batch_labels = labels_.take(0, batch_indices);
+  if (to_one_hot_) {
+    batch_labels = to_one_hot(nlabels_, batch_labels);
+  }
+  return DataPair({features_.take(0, batch_indices), batch_labels});
+}
+
+void NpyDataset::reset_iterator() {
+  reset_iterator(shuffle_);
+}
+
+void NpyDataset::reset_iterator(bool shuffle) {
+  if (shuffle) {
+    do_shuffle(shuffle_seed_);
+  }
+  iter_index_ = 0;
+}
+
+void NpyDataset::do_shuffle(unsigned long seed) {
+  auto rng = std::default_random_engine(seed);
+  std::shuffle(std::begin(shuffle_indices_), std::end(shuffle_indices_), rng);
+}
+
+}
+}
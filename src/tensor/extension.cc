@@ -16,6 +16,10 @@ Tensor<double> dilate2d(const Tensor<double> &src_tensor,
     return src_tensor;
   }
 
+  if (!src_tensor.is_contiguous()) {
+    return dilate2d(src_tensor.contiguous(), gaps, value);
+  }
+
   size_t dim = src_tensor.get_dim();
   tensor::TensorShape src_shape = src_tensor.get_shape();
   size_t src_nrow = src_shape[dim - 2];
@@ -57,6 +61,10 @@ Tensor<float> dilate2d(const Tensor<float> &src_tensor,
     return src_tensor;
   }
 
+  if (!src_tensor.is_contiguous()) {
+    return dilate2d(src_tensor.contiguous(), gaps, value);
+  }
+
   size_t dim = src_tensor.get_dim();
   tensor::TensorShape src_shape = src_tensor.get_shape();
   size_t src_nrow = src_shape[dim - 2];
@@ -90,237 +98,130 @@ Tensor<float> dilate2d(const Tensor<float> &src_tensor,
 
 template<>
 double squared_sum(const Tensor<double> &ts) {
+  if (!ts.is_contiguous()) {
+    return squared_sum(ts.contiguous());
+  }
   return cblas_ddot(ts.get_size(), ts.get_tensor_const_ptr(), 1, ts.get_tensor_const_ptr(), 1);
 }
 
 template<>
 float squared_sum(const Tensor<float> &ts) {
+  if (!ts.is_contiguous()) {
+    return squared_sum(ts.contiguous());
+  }
   return cblas_sdot(ts.get_size(), ts.get_tensor_const_ptr(), 1, ts.get_tensor_const_ptr(), 1);
 }
 
 template<>
-Tensor<float> sqrt(const Tensor<float> &ts) {
-  Tensor<float> result(ts.get_shape());
-  vsSqrt(ts.get_size(), ts.get_tensor_const_ptr(), &*result.get_iterator());
-  return result;
-}
-
-template<>
-Tensor<double> sqrt(const Tensor<double> &ts) {
-  Tensor<double> result(ts.get_shape());
-  vdSqrt(ts.get_size(), ts.get_tensor_const_ptr(), &*result.get_iterator());
-  return result;
+void sqrt_(Tensor<float> &ts) {
+  float *ptr = &*ts.get_iterator();
+  vsSqrt(ts.get_size(), ptr, ptr);
 }
 
 template<>
-Tensor<float> add_vec(const Tensor<float> &lt,
-                      const Tensor<float> &rt,
-                      const size_t &axis) {
-  Tensor<float> vec, mat;
-  if (lt.get_dim() == 1) {
-    vec = lt;
-    mat = rt;
-  } else if (rt.get_dim() == 1) {
-    vec = rt;
-    mat = lt;
-  } else {
-    throw adg_exception::InvalidTensorShapeException("Tensor >> add_vec: expect one operand with dim 1...");
+void sqrt(const Tensor<float> &ts, Tensor<float> &out) {
+  if (&out == &ts) {
+    sqrt_(out);
+    return;
   }
-
-  if (mat.get_shape(axis) != vec.get_size()) {
-    throw adg_exception::MismatchTensorShapeError(
-      "Tensor >> add_vec: expect two operands to have matched size in the axis...");
+  if (!ts.is_contiguous()) {
+    sqrt(ts.contiguous(), out);
+    return;
   }
 
-  Tensor<float> result = mat.copy();
-
-  float *result_ptr = &*result.get_iterator();
-  const float *vector_ptr = vec.get_tensor_const_ptr();
-  size_t mat_stride = result.get_stride(axis);
-  size_t vec_size = vec.get_size();
+  out.resize(ts.get_shape());
+  vsSqrt(ts.get_size(), ts.get_tensor_const_ptr(), &*out.get_iterator());
+}
 
-  size_t matrix_index = 0, vector_index = 0;
-  if (axis == mat.get_dim() - 1) {
-    while (matrix_index < mat.get_size()) {
-      vsAdd(vec_size, vector_ptr, result_ptr + matrix_index, result_ptr + matrix_index);
-      matrix_index += vec_size;
-    }
-  } else {
-    while (matrix_index < mat.get_size()) {
-      cblas_saxpy(mat_stride,
-                  1.0,
-                  vector_ptr + vector_index,
-                  0,
-                  result_ptr + matrix_index,
-                  1);
-      vector_index = (vector_index + 1) % vec_size;
-      matrix_index += mat_stride;
-    }
-  }
+template<>
+Tensor<float> sqrt(const Tensor<float> &ts) {
+  Tensor<float> result = Tensor<float>::uninitialized(ts.get_shape());
+  sqrt(ts, result);
   return result;
 }
 
 template<>
-Tensor<double> add_vec(const Tensor<double> &lt,
-                       const Tensor<double> &rt,
-                       const size_t &axis) {
-  Tensor<double> vec, mat;
-  if (lt.get_dim() == 1) {
-    vec = lt;
-    mat = rt;
-  } else if (rt.get_dim() == 1) {
-    vec = rt;
-    mat = lt;
-  } else {
-    throw adg_exception::InvalidTensorShapeException("Tensor >> add_vec: expect one operand with dim 1...");
-  }
+void sqrt_(Tensor<double> &ts) {
+  double *ptr = &*ts.get_iterator();
+  vdSqrt(ts.get_size(), ptr, ptr);
+}
 
-  if (mat.get_shape(axis) != vec.get_size()) {
-    throw adg_exception::MismatchTensorShapeError(
-      "Tensor >> add_vec: expect two operands to have matched size in the axis...");
+template<>
+void sqrt(const Tensor<double> &ts, Tensor<double> &out) {
+  if (&out == &ts) {
+    sqrt_(out);
+    return;
   }
-
-  Tensor<double> result = mat.copy();
-
-  double *result_ptr = &*result.get_iterator();
-  const double *vector_ptr = vec.get_tensor_const_ptr();
-  size_t mat_stride = result.get_stride(axis);
-  size_t vec_size = vec.get_size();
-
-  size_t matrix_index = 0, vector_index = 0;
-  if (axis == mat.get_dim() - 1) {
-    while (matrix_index < mat.get_size()) {
-      vdAdd(vec_size, vector_ptr, result_ptr + matrix_index, result_ptr + matrix_index);
-      matrix_index += vec_size;
-    }
-  } else {
-    while (matrix_index < mat.get_size()) {
-      cblas_daxpy(mat_stride,
-                  1.0,
-                  vector_ptr + vector_index,
-                  0,
-                  result_ptr + matrix_index,
-                  1);
-      vector_index = (vector_index + 1) % vec_size;
-      matrix_index += mat_stride;
-    }
+  if (!ts.is_contiguous()) {
+    sqrt(ts.contiguous(), out);
+    return;
   }
-  return result;
+
+  out.resize(ts.get_shape());
+  vdSqrt(ts.get_size(), ts.get_tensor_const_ptr(), &*out.get_iterator());
 }
 
 template<>
-Tensor<float> square(const Tensor<float> &ts) {
-  Tensor<float> result(ts.get_shape());
-  vsSqr(ts.get_size(), ts.get_tensor_const_ptr(), &*result.get_iterator());
+Tensor<double> sqrt(const Tensor<double> &ts) {
+  Tensor<double> result = Tensor<double>::uninitialized(ts.get_shape());
+  sqrt(ts, result);
   return result;
 }
 
 template<>
-Tensor<double> square(const Tensor<double> &ts) {
-  Tensor<double> result(ts.get_shape());
-  vdSqr(ts.get_size(), ts.get_tensor_const_ptr(), &*result.get_iterator());
-  return result;
+void square_(Tensor<float> &ts) {
+  float *ptr = &*ts.get_iterator();
+  vsSqr(ts.get_size(), ptr, ptr);
 }
 
 template<>
-Tensor<float> pmul_vec(const Tensor<float> &lt,
-                       const Tensor<float> &rt,
-                       const size_t &axis) {
-  Tensor<float> vec, mat;
-  if (lt.get_dim() == 1) {
-    vec = lt;
-    mat = rt;
-  } else if (rt.get_dim() == 1) {
-    vec = rt;
-    mat = lt;
-  } else {
-    throw adg_exception::InvalidTensorShapeException("Tensor >> pmul_vec: expect one operand with dim 1...");
+void square(const Tensor<float> &ts, Tensor<float> &out) {
+  if (&out == &ts) {
+    square_(out);
+    return;
   }
-
-  if (mat.get_shape(axis) != vec.get_size()) {
-    throw adg_exception::MismatchTensorShapeError(
-      "Tensor >> pmul_vec: expect two operands to have matched size in the axis...");
+  if (!ts.is_contiguous()) {
+    square(ts.contiguous(), out);
+    return;
   }
 
-  Tensor<float> result = mat.copy();
-
-  float *result_ptr = &*result.get_iterator();
-  const float *vector_ptr = vec.get_tensor_const_ptr();
-  size_t mat_stride = result.get_stride(axis);
-  size_t vec_size = vec.get_size();
+  out.resize(ts.get_shape());
+  vsSqr(ts.get_size(), ts.get_tensor_const_ptr(), &*out.get_iterator());
+}
 
-  size_t matrix_index = 0, vector_index = 0;
-  if (axis == mat.get_dim() - 1) {
-    while (matrix_index < mat.get_size()) {
-      vsMul(vec_size, vector_ptr, result_ptr + matrix_index, result_ptr + matrix_index);
-      matrix_index += vec_size;
-    }
-  } else {
-    float const_zero = 0;
-    while (matrix_index < mat.get_size()) {
-      cblas_saxpby(mat_stride,
-                   1.,
-                   &const_zero,
-                   0,
-                   *(vector_ptr + vector_index),
-                   result_ptr + matrix_index,
-                   1);
-      vector_index = (vector_index + 1) % vec_size;
-      matrix_index += mat_stride;
-    }
-  }
+template<>
+Tensor<float> square(const Tensor<float> &ts) {
+  Tensor<float> result = Tensor<float>::uninitialized(ts.get_shape());
+  square(ts, result);
   return result;
 }
 
 template<>
-Tensor<double> pmul_vec(const Tensor<double> &lt,
-                        const Tensor<double> &rt,
-                        const size_t &axis) {
-  Tensor<double> vec, mat;
-  if (lt.get_dim() == 1) {
-    vec = lt;
-    mat = rt;
-  } else if (rt.get_dim() == 1) {
-    vec = rt;
-    mat = lt;
-  } else {
-    throw adg_exception::InvalidTensorShapeException("Tensor >> pmul_vec: expect one operand with dim 1...");
-  }
+void square_(Tensor<double> &ts) {
+  double *ptr = &*ts.get_iterator();
+  vdSqr(ts.get_size(), ptr, ptr);
+}
 
-  if (mat.get_shape(axis) != vec.get_size()) {
-    throw adg_exception::MismatchTensorShapeError(
-      "Tensor >> pmul_vec: expect two operands to have matched size in the axis...");
+template<>
+void square(const Tensor<double> &ts, Tensor<double> &out) {
+  if (&out == &ts) {
+    square_(out);
+    return;
+  }
+  if (!ts.is_contiguous()) {
+    square(ts.contiguous(), out);
+    return;
   }
 
-  Tensor<double> result = mat.copy();
-
-  double *result_ptr = &*result.get_iterator();
-  const double *vector_ptr = vec.get_tensor_const_ptr();
-  size_t mat_stride = result.get_stride(axis);
-  size_t vec_size = vec.get_size();
+  out.resize(ts.get_shape());
+  vdSqr(ts.get_size(), ts.get_tensor_const_ptr(), &*out.get_iterator());
+}
 
-  size_t matrix_index = 0, vector_index = 0;
-  if (axis == mat.get_dim() - 1) {
-    while (matrix_index < mat.get_size()) {
-      vdMul(vec_size, vector_ptr, result_ptr + matrix_index, result_ptr + matrix_index);
-      matrix_index += vec_size;
-    }
-  } else {
-    double const_zero = 0;
-    while (matrix_index < mat.get_size()) {
-      cblas_daxpby(mat_stride,
-                   1.,
-                   &const_zero,
-                   0,
-                   *(vector_ptr + vector_index),
-                   result_ptr + matrix_index,
-                   1);
-      vector_index = (vector_index + 1) % vec_size;
-      matrix_index += mat_stride;
-    }
-  }
+template<>
+Tensor<double> square(const Tensor<double> &ts) {
+  Tensor<double> result = Tensor<double>::uninitialized(ts.get_shape());
+  square(ts, result);
   return result;
-
 }
 
 }
\ No newline at end of file
@@ -14,22 +14,33 @@ template<typename dType>
 Tensor<dType> pad2d(const Tensor<dType> &src_tensor,
                     const std::vector<std::pair<size_t, size_t>> &paddings,
                     const dType &value) {
+  Tensor<dType> result({1});
+  pad2d(src_tensor, paddings, value, result);
+  return result;
+}
+
+template<typename dType>
+void pad2d(const Tensor<dType> &src_tensor,
+           const std::vector<std::pair<size_t, size_t>> &paddings,
+           const dType &value,
+           Tensor<dType> &out) {
+  if (!src_tensor.is_contiguous() || &src_tensor == &out) {
+    pad2d(src_tensor.copy(), paddings, value, out);
+    return;
+  }
+
   size_t dim = src_tensor.get_dim();
   TensorShape result_shape = src_tensor.get_shape();
   result_shape[dim - 1] += paddings[1].first + paddings[1].second;
   result_shape[dim - 2] += paddings[0].first + paddings[0].second;
 
-  size_t new_size = 1;
-  std::vector<size_t> new_strides(dim);
-  for (int ix = dim - 1; ix >= 0; --ix) {
-    new_strides[ix] = new_size;
-    new_size *= result_shape[ix];
-  }
-
-  auto result_values = std::vector<dType>(new_size, value);
+  out.resize(result_shape);
+  size_t new_size = out.get_size();
+  TensorShape new_strides = out.get_strides();
 
-  dType *dest_ptr = &*result_values.begin();
+  dType *dest_ptr = &*out.get_iterator();
   const dType *src_ptr = src_tensor.get_tensor_const_ptr();
+  std::fill_n(dest_ptr, new_size, value);
 
   size_t src_column_size = src_tensor.get_shape()[dim - 1];
   size_t dest_index = 0, src_index = 0, dest_offset, src_offset;
@@ -50,9 +61,59 @@ Tensor<dType> pad2d(const Tensor<dType> &src_tensor,
     dest_index += dest_inc;
     src_index += src_inc;
   }
+}
 
-  Tensor<dType> result(result_shape, result_values);
-  return result;
+template<typename dType>
+Tensor<dType> im2col_chw(const Tensor<dType> &input,
+                         const size_t &kh,
+                         const size_t &kw,
+                         const size_t &sh,
+                         const size_t &sw) {
+  // input : [b, c, h, w]
+  if (!input.is_contiguous()) {
+    return im2col_chw(input.contiguous(), kh, kw, sh, sw);
+  }
+
+  TensorShape shape = input.get_shape();
+  const TensorShape &input_strides = input.get_strides();
+  size_t n_channels = shape[1];
+  size_t n_batchs = shape[0];
+
+  size_t window_size = kh * kw;
+
+  size_t out_h = (shape[2] - kh) / sh + 1;
+  size_t out_w = (shape[3] - kw) / sw + 1;
+
+  // every entry is written below
+  Tensor<dType> col_image = Tensor<dType>::uninitialized({n_batchs, out_h * out_w, kw * kh * n_channels});
+  const dType *input_tensor_ptr = input.get_tensor_const_ptr();
+  dType *col_image_ptr = &*col_image.get_iterator();
+
+  size_t ib, ic, ih, iw, iih, iiw;
+  size_t cur_src_index, in_window_index, cur_dest_index;
+  size_t dest_stride = window_size * n_channels;
+  size_t dest_b_stride = dest_stride * out_h * out_w;
+  for (ib = 0; ib < shape[0]; ++ib) {
+    for (ic = 0; ic < shape[1]; ++ic) {
+      cur_dest_index = ib * dest_b_stride + ic * window_size;
+      cur_src_index = ib * input_strides[0] + ic * input_strides[1];
+      for (ih = 0; ih <= shape[2] - kh; ih += sh) {
+        for (iw = 0; iw <= shape[3] - kw; iw += sw) {
+          in_window_index = 0;
+          while (in_window_index < window_size) {
+            iih = in_window_index / kw;
+            iiw = in_window_index % kw;
+            *(col_image_ptr + cur_dest_index + in_window_index) =
+              *(input_tensor_ptr + cur_src_index + (ih + iih) * input_strides[2] + (iw + iiw) * input_strides[3]);
+            ++in_window_index;
+          }
+          cur_dest_index += dest_stride;
+        }
+      }
+    }
+  }
+
+  return col_image;
 }
 
 template<typename dType>
@@ -63,6 +124,10 @@ void reverse(Tensor<dType> &ts, const size_t &axis) {
     throw adg_exception::AxisOutOfRangeError("reverse : reversed axis out of range ...");
   }
 
+  if (!ts.is_contiguous()) {
+    ts = ts.contiguous();
+  }
+
   auto shape = ts.get_shape();
   auto strides = ts.get_strides();
 
@@ -87,20 +152,129 @@ void reverse(Tensor<dType> &ts, const size_t &axis) {
 
 template<typename dType>
 Tensor<dType> div(const Tensor<dType>& lt, const Tensor<dType>&rt) {
-  if (lt.get_shape() != rt.get_shape()) {
+  return lt.div(rt);
+}
+
+// vec_along_axis views a vector as a tensor of the same dim as mat, with
+// every axis but the given one of size 1, ready to be broadcast against mat
+template<typename dType>
+Tensor<dType> vec_along_axis(const Tensor<dType> &vec,
+                             const Tensor<dType> &mat,
+                             const size_t &axis,
+                             const std::string &op_name) {
+  if (axis >= mat.get_dim() || mat.get_shape(axis) != vec.get_size()) {
     throw adg_exception::MismatchTensorShapeError(
-      "Tensor >> div: MismatchTensorShapeError: get shape " +
-        utils::vector_to_str(lt.get_shape()) + " and " +
-        utils::vector_to_str(rt.get_shape()));
+      "Tensor >> " + op_name + ": expect two operands to have matched size in the axis...");
   }
 
-  Tensor<dType> result(lt.get_shape());
-  dType *result_ptr = &*result.get_iterator();
-  utils::math::elementwise_divide(lt.get_size(), lt.get_tensor_const_ptr(),
-                                  rt.get_tensor_const_ptr(),
-                                  result_ptr);
+  TensorShape vec_shape(mat.get_dim(), 1);
+  vec_shape[axis] = vec.get_size();
+  Tensor<dType> result = vec;
+  result.reshape(vec_shape);
   return result;
 }
 
+template<typename dType>
+Tensor<dType> add_vec(const Tensor<dType> &lt,
+                      const Tensor<dType> &rt,
+                      const size_t &axis) {
+  Tensor<dType> result({1});
+  add_vec(lt, rt, axis, result);
+  return result;
+}
+
+template<typename dType>
+void add_vec(const Tensor<dType> &lt,
+             const Tensor<dType> &rt,
+             const size_t &axis,
+             Tensor<dType> &out) {
+  if (lt.get_dim() == 1) {
+    rt.add(vec_along_axis(lt, rt, axis, "add_vec"), out);
+    return;
+  } else if (rt.get_dim() == 1) {
+    lt.add(vec_along_axis(rt, lt, axis, "add_vec"), out);
+    return;
+  }
+  throw adg_exception::InvalidTensorShapeException("Tensor >> add_vec: expect one operand with dim 1...");
+}
 
-}
\ No newline at end of file
+template<typename dType>
+void add_vec_(Tensor<dType> &mat,
+              const Tensor<dType> &vec,
+              const size_t &axis) {
+  mat.add_(vec_along_axis(vec, mat, axis, "add_vec_"));
+}
+
+template<typename dType>
+Tensor<dType> pmul_vec(const Tensor<dType> &lt,
+                       const Tensor<dType> &rt,
+                       const size_t &axis) {
+  Tensor<dType> result({1});
+  pmul_vec(lt, rt, axis, result);
+  return result;
+}
+
+template<typename dType>
+void pmul_vec(const Tensor<dType> &lt,
+              const Tensor<dType> &rt,
+              const size_t &axis,
+              Tensor<dType> &out) {
+  if (lt.get_dim() == 1) {
+    rt.multiply(vec_along_axis(lt, rt, axis, "pmul_vec"), out);
+    return;
+  } else if (rt.get_dim() == 1) {
+    lt.multiply(vec_along_axis(rt, lt, axis, "pmul_vec"), out);
+    return;
+  }
+  throw adg_exception::InvalidTensorShapeException("Tensor >> pmul_vec: expect one operand with dim 1...");
+}
+
+template<typename dType>
+void pmul_vec_(Tensor<dType> &mat,
+               const Tensor<dType> &vec,
+               const size_t &axis) {
+  mat.multiply_(vec_along_axis(vec, mat, axis, "pmul_vec_"));
+}
+
+template<typename dType>
+void axpby(const dType &alpha,
+           const Tensor<dType> &x,
+           const dType &beta,
+           Tensor<dType> &y) {
+  if (x.get_shape() != y.get_shape()) {
+    throw adg_exception::MismatchTensorShapeError(
+      "Tensor >> axpby: expect x and y of the same shape, got " + utils::vector_to_str(x.get_shape()) +
+        " and " + utils::vector_to_str(y.get_shape()));
+  }
+
+  // y is detached first, so x cannot be a view of the buffer written to
+  dType *dest_ptr = &*y.get_iterator();
+  Tensor<dType> packed = x.contiguous();
+  utils::math::axpby(y.get_size(), alpha, packed.get_tensor_const_ptr(), beta, dest_ptr);
+}
+
+template<typename dType>
+void xavier_uniform_(Tensor<dType> &ts, const size_t &fan_in, const size_t &fan_out,
+                     const double &gain, const size_t &seed) {
+  double bound = gain * std::sqrt(6. / (fan_in + fan_out));
+  ts.uniform_init(-bound, bound, seed);
+}
+
+template<typename dType>
+void xavier_normal_(Tensor<dType> &ts, const size_t &fan_in, const size_t &fan_out,
+                    const double &gain, const size_t &seed) {
+  ts.normal_init(0., gain * std::sqrt(2. / (fan_in + fan_out)), seed);
+}
+
+template<typename dType>
+void kaiming_uniform_(Tensor<dType> &ts, const size_t &fan_in, const double &gain, const size_t &seed) {
+  double bound = gain * std::sqrt(3. / fan_in);
+  ts.uniform_init(-bound, bound, seed);
+}
+
+template<typename dType>
+void kaiming_normal_(Tensor<dType> &ts, const size_t &fan_in, const double &gain, const size_t &seed) {
+  ts.normal_init(0., gain / std::sqrt(double(fan_in)), seed);
+}
+
+}
@@ -0,0 +1,490 @@
+#include "tensor/io.h"
+
+#include <array>
+#include <bit>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tensor {
+namespace io {
+
+static_assert(std::endian::native == std::endian::little,
+              "npy and zip fields are read and written as little endian");
+
+const char NPY_MAGIC[] = "\x93NUMPY";
+const size_t NPY_MAGIC_SIZE = 6;
+// numpy pads the header so that the data starts 64-byte aligned
+const size_t NPY_HEADER_ALIGNMENT = 64;
+
+const uint32_t ZIP_LOCAL_HEADER_SIGNATURE = 0x04034b50;
+const uint32_t ZIP_CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+const uint32_t ZIP_END_SIGNATURE = 0x06054b50;
+const uint32_t ZIP64_END_SIGNATURE = 0x06064b50;
+const uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+const uint16_t ZIP64_EXTRA_ID = 0x0001;
+// 1980-01-01, the earliest date a zip entry can have
+const uint16_t ZIP_DOS_DATE = 0x21;
+
+template<typename T>
+T read_le(const char *data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+template<typename T>
+void append_le(std::string &bytes, const T &value) {
+  bytes.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+uint32_t crc32(const char *data, const size_t &size, uint32_t crc = 0) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> result;
+    for (uint32_t ix = 0; ix < 256; ++ix) {
+      uint32_t value = ix;
+      for (int bit = 0; bit < 8; ++bit) {
+        value = (value & 1) ? 0xedb88320 ^ (value >> 1) : value >> 1;
+      }
+      result[ix] = value;
+    }
+    return result;
+  }();
+
+  crc = ~crc;
+  for (size_t ix = 0; ix < size; ++ix) {
+    crc = table[(crc ^ static_cast<uint8_t>(data[ix])) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+size_t get_descr_size(const std::string &descr) {
+  static const std::map<std::string, size_t> sizes = {
+    {"<f8", 8}, {"<f4", 4}, {"<f2", 2}, {"|V2", 2},
+    {"<i8", 8}, {"<i4", 4}, {"<i2", 2}, {"|i1", 1},
+    {"<u8", 8}, {"<u4", 4}, {"<u2", 2}, {"|u1", 1}, {"|b1", 1}};
+  auto iter = sizes.find(descr);
+  return iter == sizes.end() ? 0 : iter->second;
+}
+
+// find_header_value returns the position right after the colon following key
+size_t find_header_value(const std::string &dict, const std::string &key) {
+  for (const char quote : {'\'', '"'}) {
+    size_t pos = dict.find(quote + key + quote);
+    if (pos != std::string::npos) {
+      pos = dict.find(':', pos + key.size() + 2);
+      if (pos != std::string::npos) {
+        return dict.find_first_not_of(' ', pos + 1);
+      }
+    }
+  }
+  throw adg_exception::TensorIOError("TensorIOError >> npy header has no " + key);
+}
+
+NpyHeader parse_npy_header(const char *data, const size_t &size) {
+  if (size < NPY_MAGIC_SIZE + 4 || memcmp(data, NPY_MAGIC, NPY_MAGIC_SIZE) != 0) {
+    throw adg_exception::TensorIOError("TensorIOError >> not an npy array");
+  }
+
+  size_t dict_begin, dict_size;
+  uint8_t major_version = data[NPY_MAGIC_SIZE];
+  if (major_version == 1) {
+    dict_begin = NPY_MAGIC_SIZE + 4;
+    dict_size = read_le<uint16_t>(data + NPY_MAGIC_SIZE + 2);
+  } else if (major_version == 2 || major_version == 3) {
+    dict_begin = NPY_MAGIC_SIZE + 6;
+    dict_size = size < dict_begin ? 0 : read_le<uint32_t>(data + NPY_MAGIC_SIZE + 2);
+  } else {
+    throw adg_exception::TensorIOError(
+      "TensorIOError >> unsupported npy version " + std::to_string(major_version));
+  }
+  if (dict_begin + dict_size > size) {
+    throw adg_exception::TensorIOError("TensorIOError >> the npy header is truncated");
+  }
+
+  std::string dict(data + dict_begin, dict_size);
+  NpyHeader header;
+  header.data_offset = dict_begin + dict_size;
+
+  size_t pos = find_header_value(dict, "descr");
+  if (pos == std::string::npos || (dict[pos] != '\'' && dict[pos] != '"')) {
+    throw adg_exception::TensorIOError("TensorIOError >> structured npy arrays are not supported");
+  }
+  header.descr = dict.substr(pos + 1, dict.find(dict[pos], pos + 1) - pos - 1);
+  // byte order of the native and the single byte types is spelled in two ways
+  if (header.descr.size() == 3 && (header.descr[0] == '=' || header.descr[0] == '<' || header.descr[0] == '|')) {
+    header.descr[0] = (header.descr[2] == '1' || header.descr[1] == 'V') ? '|' : '<';
+  }
+  if (get_descr_size(header.descr) == 0) {
+    throw adg_exception::TensorIOError("TensorIOError >> unsupported numpy type " + header.descr);
+  }
+
+  pos = find_header_value(dict, "fortran_order");
+  header.fortran_order = dict.compare(pos, 4, "True") == 0;
+
+  pos = find_header_value(dict, "shape");
+  size_t end = dict.find(')', pos);
+  if (dict[pos] != '(' || end == std::string::npos) {
+    throw adg_exception::TensorIOError("TensorIOError >> invalid npy shape");
+  }
+  for (auto &dim : utils::str_split(dict.substr(pos + 1, end - pos - 1), ",")) {
+    if (dim.find_first_not_of(' ') != std::string::npos) {
+      header.shape.emplace_back(std::stoull(dim));
+    }
+  }
+  if (header.shape.empty()) {
+    // a numpy scalar
+    header.shape.emplace_back(1);
+  }
+  return header;
+}
+
+std::string make_npy_header(const std::string &descr, const TensorShape &shape) {
+  std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (";
+  for (size_t ix = 0; ix < shape.size(); ++ix) {
+    dict += std::to_string(shape[ix]) + (shape.size() == 1 ? "," : ix + 1 < shape.size() ? ", " : "");
+  }
+  dict += "), }";
+
+  // version 1 stores the header length in 2 bytes, version 2 in 4
+  size_t preamble_size = NPY_MAGIC_SIZE + 4;
+  size_t total_size = (preamble_size + dict.size() + 1 + NPY_HEADER_ALIGNMENT - 1) / NPY_HEADER_ALIGNMENT * NPY_HEADER_ALIGNMENT;
+  uint8_t major_version = 1;
+  if (total_size - preamble_size > UINT16_MAX) {
+    major_version = 2;
+    preamble_size += 2;
+    total_size = (preamble_size + dict.size() + 1 + NPY_HEADER_ALIGNMENT - 1) / NPY_HEADER_ALIGNMENT * NPY_HEADER_ALIGNMENT;
+  }
+  dict.append(total_size - preamble_size - dict.size() - 1, ' ');
+  dict += '\n';
+
+  std::string header(NPY_MAGIC, NPY_MAGIC_SIZE);
+  header += static_cast<char>(major_version);
+  header += '\0';
+  if (major_version == 1) {
+    append_le(header, static_cast<uint16_t>(dict.size()));
+  } else {
+    append_le(header, static_cast<uint32_t>(dict.size()));
+  }
+  return header + dict;
+}
+
+std::shared_ptr<FileBuffer> FileBuffer::open(const std::string &path, bool use_mmap) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  struct stat file_stat;
+  if (fd < 0 || fstat(fd, &file_stat) != 0) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    throw adg_exception::TensorIOError("TensorIOError >> cannot open " + path);
+  }
+
+  std::shared_ptr<FileBuffer> buffer(new FileBuffer());
+  buffer->size_ = file_stat.st_size;
+  if (buffer->size_ == 0) {
+    ::close(fd);
+    throw adg_exception::TensorIOError("TensorIOError >> " + path + " is empty");
+  }
+
+  if (use_mmap) {
+    // a private writable mapping: pages written through a tensor are copied
+    // by the kernel and the file stays untouched
+    void *mapped = mmap(nullptr, buffer->size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      buffer->data_ = static_cast<char *>(mapped);
+      buffer->mapped_ = true;
+      ::close(fd);
+      return buffer;
+    }
+  }
+
+  // read the file in when it is not to be or cannot be mapped
+  buffer->data_ = static_cast<char *>(std::malloc(buffer->size_));
+  size_t read_size = 0;
+  while (buffer->data_ != nullptr && read_size < buffer->size_) {
+    ssize_t count = ::read(fd, buffer->data_ + read_size, buffer->size_ - read_size);
+    if (count <= 0) {
+      break;
+    }
+    read_size += count;
+  }
+  ::close(fd);
+  if (read_size != buffer->size_) {
+    throw adg_exception::TensorIOError("TensorIOError >> failed to read " + path);
+  }
+  return buffer;
+}
+
+FileBuffer::~FileBuffer() {
+  if (mapped_) {
+    munmap(data_, size_);
+  } else {
+    std::free(data_);
+  }
+}
+
+NpzWriter::NpzWriter(const std::string &path) : path_(path) {
+  file_ = std::fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    throw adg_exception::TensorIOError("TensorIOError >> cannot open " + path + " for writing");
+  }
+}
+
+NpzWriter::~NpzWriter() {
+  if (file_ != nullptr) {
+    try {
+      close();
+    } catch (const adg_exception::TensorIOError &) {
+      // nothing more can be done for a broken archive in a destructor
+    }
+  }
+}
+
+void NpzWriter::write(const void *data, const size_t &size) {
+  if (std::fwrite(data, 1, size, file_) != size) {
+    throw adg_exception::TensorIOError("TensorIOError >> failed to write " + path_);
+  }
+  position_ += size;
+}
+
+void NpzWriter::add_bytes(const std::string &name, const std::string &header, const char *data, const size_t &size) {
+  if (file_ == nullptr) {
+    throw adg_exception::TensorIOError("TensorIOError >> " + path_ + " is already closed");
+  }
+
+  Entry entry = {name + ".npy", crc32(data, size, crc32(header.data(), header.size())),
+                 header.size() + size, position_};
+  // sizes that do not fit into 32 bits go into a zip64 extra field
+  bool zip64 = entry.size >= UINT32_MAX;
+
+  std::string local;
+  append_le(local, ZIP_LOCAL_HEADER_SIGNATURE);
+  append_le(local, uint16_t(zip64 ? 45 : 20));
+  append_le(local, uint16_t(0)); // flags
+  append_le(local, uint16_t(0)); // stored
+  append_le(local, uint16_t(0)); // time
+  append_le(local, ZIP_DOS_DATE);
+  append_le(local, entry.crc);
+  append_le(local, uint32_t(zip64 ? UINT32_MAX : entry.size));
+  append_le(local, uint32_t(zip64 ? UINT32_MAX : entry.size));
+  append_le(local, uint16_t(entry.name.size()));
+  append_le(local, uint16_t(zip64 ? 20 : 0));
+  local += entry.name;
+  if (zip64) {
+    append_le(local, ZIP64_EXTRA_ID);
+    append_le(local, uint16_t(16));
+    append_le(local, entry.size);
+    append_le(local, entry.size);
+  }
+
+  write(local.data(), local.size());
+  write(header.data(), header.size());
+  write(data, size);
+  entries_.emplace_back(std::move(entry));
+}
+
+void NpzWriter::close() {
+  if (file_ == nullptr) {
+    return;
+  }
+
+  uint64_t directory_offset = position_;
+  for (const auto &entry : entries_) {
+    bool large_size = entry.size >= UINT32_MAX;
+    bool large_offset = entry.offset >= UINT32_MAX;
+    uint16_t extra_size = (large_size ? 16 : 0) + (large_offset ? 8 : 0);
+
+    std::string central;
+    append_le(central, ZIP_CENTRAL_HEADER_SIGNATURE);
+    append_le(central, uint16_t(45)); // made by
+    append_le(central, uint16_t(extra_size ? 45 : 20));
+    append_le(central, uint16_t(0)); // flags
+    append_le(central, uint16_t(0)); // stored
+    append_le(central, uint16_t(0)); // time
+    append_le(central, ZIP_DOS_DATE);
+    append_le(central, entry.crc);
+    append_le(central, uint32_t(large_size ? UINT32_MAX : entry.size));
+    append_le(central, uint32_t(large_size ? UINT32_MAX : entry.size));
+    append_le(central, uint16_t(entry.name.size()));
+    append_le(central, uint16_t(extra_size ? extra_size + 4 : 0));
+    append_le(central, uint16_t(0)); // comment
+    append_le(central, uint16_t(0)); // disk
+    append_le(central, uint16_t(0)); // internal attributes
+    append_le(central, uint32_t(0)); // external attributes
+    append_le(central, uint32_t(large_offset ? UINT32_MAX : entry.offset));
+    central += entry.name;
+    if (extra_size) {
+      append_le(central, ZIP64_EXTRA_ID);
+      append_le(central, extra_size);
+      if (large_size) {
+        append_le(central, entry.size);
+        append_le(central, entry.size);
+      }
+      if (large_offset) {
+        append_le(central, entry.offset);
+      }
+    }
+    write(central.data(), central.size());
+  }
+
+  uint64_t directory_size = position_ - directory_offset;
+  uint64_t n_entries = entries_.size();
+  bool zip64 = directory_offset >= UINT32_MAX || n_entries >= UINT16_MAX;
+  std::string end;
+  if (zip64) {
+    uint64_t zip64_end_offset = position_;
+    append_le(end, ZIP64_END_SIGNATURE);
+    append_le(end, uint64_t(44));
+    append_le(end, uint16_t(45));
+    append_le(end, uint16_t(45));
+    append_le(end, uint32_t(0));
+    append_le(end, uint32_t(0));
+    append_le(end, n_entries);
+    append_le(end, n_entries);
+    append_le(end, directory_size);
+    append_le(end, directory_offset);
+    append_le(end, ZIP64_LOCATOR_SIGNATURE);
+    append_le(end, uint32_t(0));
+    append_le(end, zip64_end_offset);
+    append_le(end, uint32_t(1));
+  }
+  append_le(end, ZIP_END_SIGNATURE);
+  append_le(end, uint16_t(0));
+  append_le(end, uint16_t(0));
+  append_le(end, uint16_t(zip64 ? UINT16_MAX : n_entries));
+  append_le(end, uint16_t(zip64 ? UINT16_MAX : n_entries));
+  append_le(end, uint32_t(zip64 ? UINT32_MAX : directory_size));
+  append_le(end, uint32_t(zip64 ? UINT32_MAX : directory_offset));
+  append_le(end, uint16_t(0)); // comment
+  write(end.data(), end.size());
+
+  bool closed = std::fclose(file_) == 0;
+  file_ = nullptr;
+  if (!closed) {
+    throw adg_exception::TensorIOError("TensorIOError >> failed to write " + path_);
+  }
+}
+
+NpzReader::NpzReader(const std::string &path, bool use_mmap) : path_(path) {
+  buffer_ = FileBuffer::open(path, use_mmap);
+  const char *data = buffer_->data();
+  size_t size = buffer_->size();
+  auto invalid = [&path](const std::string &reason) {
+    return adg_exception::TensorIOError("TensorIOError >> " + path + " is not a valid npz archive, " + reason);
+  };
+
+  // the end record is followed by a comment of at most 64k
+  const size_t end_size = 22;
+  if (size < end_size) {
+    throw invalid("too short");
+  }
+  size_t end_pos = size - end_size;
+  while (read_le<uint32_t>(data + end_pos) != ZIP_END_SIGNATURE) {
+    if (end_pos == 0 || size - end_pos > end_size + UINT16_MAX) {
+      throw invalid("no end of central directory");
+    }
+    --end_pos;
+  }
+
+  uint64_t n_entries = read_le<uint16_t>(data + end_pos + 10);
+  uint64_t directory_offset = read_le<uint32_t>(data + end_pos + 16);
+  if (directory_offset == UINT32_MAX || n_entries == UINT16_MAX) {
+    const size_t locator_size = 20;
+    if (end_pos < locator_size || read_le<uint32_t>(data + end_pos - locator_size) != ZIP64_LOCATOR_SIGNATURE) {
+      throw invalid("no zip64 end locator");
+    }
+    uint64_t zip64_end_pos = read_le<uint64_t>(data + end_pos - locator_size + 8);
+    if (zip64_end_pos + 56 > size || read_le<uint32_t>(data + zip64_end_pos) != ZIP64_END_SIGNATURE) {
+      throw invalid("no zip64 end of central directory");
+    }
+    n_entries = read_le<uint64_t>(data + zip64_end_pos + 32);
+    directory_offset = read_le<uint64_t>(data + zip64_end_pos + 48);
+  }
+
+  size_t pos = directory_offset;
+  for (uint64_t ix = 0; ix < n_entries; ++ix) {
+    if (pos + 46 > size || read_le<uint32_t>(data + pos) != ZIP_CENTRAL_HEADER_SIGNATURE) {
+      throw invalid("broken central directory");
+    }
+    uint16_t method = read_le<uint16_t>(data + pos + 10);
+    uint64_t stored_size = read_le<uint32_t>(data + pos + 20);
+    uint64_t original_size = read_le<uint32_t>(data + pos + 24);
+    uint16_t name_size = read_le<uint16_t>(data + pos + 28);
+    uint16_t extra_size = read_le<uint16_t>(data + pos + 30);
+    uint16_t comment_size = read_le<uint16_t>(data + pos + 32);
+    uint64_t local_offset = read_le<uint32_t>(data + pos + 42);
+    if (pos + 46 + name_size + extra_size > size) {
+      throw invalid("broken central directory");
+    }
+    std::string name(data + pos + 46, name_size);
+
+    // zip64 sizes and offsets replace the saturated 32-bit fields in order
+    const char *extra = data + pos + 46 + name_size;
+    for (size_t extra_pos = 0; extra_pos + 4 <= extra_size;) {
+      uint16_t id = read_le<uint16_t>(extra + extra_pos);
+      uint16_t field_size = read_le<uint16_t>(extra + extra_pos + 2);
+      if (id == ZIP64_EXTRA_ID) {
+        const char *field = extra + extra_pos + 4;
+        if (original_size == UINT32_MAX) {
+          original_size = read_le<uint64_t>(field);
+          field += 8;
+        }
+        if (stored_size == UINT32_MAX) {
+          stored_size = read_le<uint64_t>(field);
+          field += 8;
+        }
+        if (local_offset == UINT32_MAX) {
+          local_offset = read_le<uint64_t>(field);
+        }
+      }
+      extra_pos += 4 + field_size;
+    }
+    pos += 46 + name_size + extra_size + comment_size;
+
+    if (method != 0) {
+      throw invalid(name + " is compressed, only archives written by np.savez can be read");
+    }
+    if (local_offset + 30 > size || read_le<uint32_t>(data + local_offset) != ZIP_LOCAL_HEADER_SIGNATURE) {
+      throw invalid("broken local header of " + name);
+    }
+    size_t data_offset = local_offset + 30 + read_le<uint16_t>(data + local_offset + 26) +
+      read_le<uint16_t>(data + local_offset + 28);
+    if (data_offset + stored_size > size) {
+      throw invalid(name + " is truncated");
+    }
+
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0) {
+      name.resize(name.size() - 4);
+    }
+    entries_[name] = {data_offset, stored_size};
+  }
+}
+
+std::vector<std::string> NpzReader::get_names() const {
+  std::vector<std::string> names;
+  for (const auto &[name, entry] : entries_) {
+    names.emplace_back(name);
+  }
+  return names;
+}
+
+bool NpzReader::contains(const std::string &name) const {
+  return entries_.find(name) != entries_.end();
+}
+
+std::string NpzReader::get_descr(const std::string &name) const {
+  const Entry &entry = get_entry(name);
+  return parse_npy_header(buffer_->data() + entry.offset, entry.size).descr;
+}
+
+const NpzReader::Entry &NpzReader::get_entry(const std::string &name) const {
+  auto iter = entries_.find(name);
+  if (iter == entries_.end()) {
+    throw adg_exception::TensorIOError("TensorIOError >> " + path_ + " has no array " + name);
+  }
+  return iter->second;
+}
+
+} // namespace io
+} // namespace tensor
@@ -0,0 +1,175 @@
+#include "tensor/io.h"
+
+namespace tensor {
+namespace io {
+
+template<>
+inline std::string get_descr<double>() { return "<f8"; }
+
+template<>
+inline std::string get_descr<float>() { return "<f4"; }
+
+template<>
+inline std::string get_descr<int32_t>() { return "<i4"; }
+
+template<>
+inline std::string get_descr<int8_t>() { return "|i1"; }
+
+template<>
+inline std::string get_descr<uint8_t>() { return "|u1"; }
+
+template<>
+inline std::string get_descr<float16>() { return "<f2"; }
+
+template<>
+inline std::string get_descr<bfloat16>() { return "|V2"; }
+
+// convert_npy_data copies count entries of the NumPy type descr into dest,
+// the source may be unaligned inside an archive
+template<typename sType, typename dType>
+void convert_npy_data(const char *src, const size_t &count, dType *dest) {
+  if constexpr (std::is_same_v<sType, dType>) {
+    memcpy(dest, src, sizeof(dType) * count);
+  } else if (reinterpret_cast<uintptr_t>(src) % alignof(sType) == 0) {
+    utils::math::convert(count, reinterpret_cast<const sType *>(src), dest);
+  } else {
+    std::vector<sType> aligned(count);
+    memcpy(aligned.data(), src, sizeof(sType) * count);
+    utils::math::convert(count, aligned.data(), dest);
+  }
+}
+
+template<typename dType>
+void convert_npy_data(const std::string &descr, const char *src, const size_t &count, dType *dest) {
+  if (descr == "<f8") {
+    convert_npy_data<double>(src, count, dest);
+  } else if (descr == "<f4") {
+    convert_npy_data<float>(src, count, dest);
+  } else if (descr == "<f2") {
+    convert_npy_data<float16>(src, count, dest);
+  } else if (descr == "|V2") {
+    convert_npy_data<bfloat16>(src, count, dest);
+  } else if (descr == "<i8") {
+    convert_npy_data<int64_t>(src, count, dest);
+  } else if (descr == "<i4") {
+    convert_npy_data<int32_t>(src, count, dest);
+  } else if (descr == "<i2") {
+    convert_npy_data<int16_t>(src, count, dest);
+  } else if (descr == "|i1") {
+    convert_npy_data<int8_t>(src, count, dest);
+  } else if (descr == "<u8") {
+    convert_npy_data<uint64_t>(src, count, dest);
+  } else if (descr == "<u4") {
+    convert_npy_data<uint32_t>(src, count, dest);
+  } else if (descr == "<u2") {
+    convert_npy_data<uint16_t>(src, count, dest);
+  } else if (descr == "|u1" || descr == "|b1") {
+    convert_npy_data<uint8_t>(src, count, dest);
+  } else {
+    throw adg_exception::TensorIOError("TensorIOError >> unsupported numpy type " + descr);
+  }
+}
+
+template<typename dType>
+Tensor<dType> from_npy(const std::shared_ptr<FileBuffer> &buffer, const size_t &offset, const size_t &size) {
+  NpyHeader header = parse_npy_header(buffer->data() + offset, size);
+  size_t count = 1;
+  for (auto dim : header.shape) {
+    count *= dim;
+  }
+  if (count == 0) {
+    throw adg_exception::TensorIOError("TensorIOError >> empty arrays cannot be loaded as tensors");
+  }
+  if (header.data_offset + count * get_descr_size(header.descr) > size) {
+    throw adg_exception::TensorIOError("TensorIOError >> the array data is truncated");
+  }
+
+  // a fortran ordered array is the packed transpose of its shape
+  TensorShape shape = header.shape;
+  if (header.fortran_order) {
+    std::reverse(shape.begin(), shape.end());
+  }
+
+  char *data = buffer->data() + offset + header.data_offset;
+  Tensor<dType> result;
+  if (buffer->is_mapped() && header.descr == get_descr<dType>() &&
+    reinterpret_cast<uintptr_t>(data) % alignof(dType) == 0) {
+    // the storage keeps the mapping alive
+    result = Tensor<dType>::from_storage(shape, Storage<dType>::wrap(reinterpret_cast<dType *>(data), count, buffer));
+  } else {
+    result = Tensor<dType>::uninitialized(shape);
+    convert_npy_data(header.descr, data, count, &*result.get_iterator());
+  }
+
+  if (header.fortran_order && shape.size() > 1) {
+    TensorAxes axes(shape.size());
+    std::iota(axes.rbegin(), axes.rend(), 0);
+    return result.permute(axes);
+  }
+  return result;
+}
+
+template<typename dType>
+void save_npy(const std::string &path, const Tensor<dType> &ts) {
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    throw adg_exception::TensorIOError("TensorIOError >> cannot open " + path + " for writing");
+  }
+
+  Tensor<dType> packed = ts.contiguous();
+  std::string header = make_npy_header(get_descr<dType>(), packed.get_shape());
+  file.write(header.data(), header.size());
+  file.write(reinterpret_cast<const char *>(packed.get_tensor_const_ptr()), sizeof(dType) * packed.get_size());
+  if (!file) {
+    throw adg_exception::TensorIOError("TensorIOError >> failed to write " + path);
+  }
+}
+
+template<typename dType>
+Tensor<dType> load_npy(const std::string &path, bool use_mmap) {
+  std::shared_ptr<FileBuffer> buffer = FileBuffer::open(path, use_mmap);
+  try {
+    return from_npy<dType>(buffer, 0, buffer->size());
+  } catch (const adg_exception::TensorIOError &ex) {
+    throw adg_exception::TensorIOError(std::string(ex.what()) + " in " + path);
+  }
+}
+
+template<typename dType>
+void NpzWriter::add(const std::string &name, const Tensor<dType> &ts) {
+  Tensor<dType> packed = ts.contiguous();
+  add_bytes(name, make_npy_header(get_descr<dType>(), packed.get_shape()),
+            reinterpret_cast<const char *>(packed.get_tensor_const_ptr()), sizeof(dType) * packed.get_size());
+}
+
+template<typename dType>
+Tensor<dType> NpzReader::get(const std::string &name) const {
+  const Entry &entry = get_entry(name);
+  try {
+    return from_npy<dType>(buffer_, entry.offset, entry.size);
+  } catch (const adg_exception::TensorIOError &ex) {
+    throw adg_exception::TensorIOError(std::string(ex.what()) + " in " + path_ + ":" + name);
+  }
+}
+
+template<typename dType>
+void save_npz(const std::string &path, const std::map<std::string, Tensor<dType>> &tensors) {
+  NpzWriter writer(path);
+  for (const auto &[name, ts] : tensors) {
+    writer.add(name, ts);
+  }
+  writer.close();
+}
+
+template<typename dType>
+std::map<std::string, Tensor<dType>> load_npz(const std::string &path, bool use_mmap) {
+  NpzReader reader(path, use_mmap);
+  std::map<std::string, Tensor<dType>> result;
+  for (const auto &name : reader.get_names()) {
+    result.emplace(name, reader.get<dType>(name));
+  }
+  return result;
+}
+
+} // namespace io
+} // namespace tensor
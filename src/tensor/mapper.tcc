@@ -4,7 +4,7 @@ namespace tensor {
 
 template <typename dType>
 Mapper<dType>::Mapper(const std::function<void(dType &)> &func) {
-  task_ = [&func](dType &value, const size_t &index) { func(value); };
+  task_ = [func](dType &value, const size_t &index) { func(value); };
 }
 
 template <typename dType>
@@ -12,24 +12,17 @@ Mapper<dType>::Mapper(const std::function<void(dType &, const size_t &)> &func)
     : task_(func) {}
 
 template <typename dType>
-void Mapper<dType>::run(dType *p_tensor, const size_t &size,
-                        utils::threads::ThreadPool *p_pool) {
-  if (p_pool != nullptr) {
-    for (size_t ix = 0; ix < size; ++ix) {
-      p_pool->submit_job(
-          [this, &p_tensor, ix] { this->task_(*(p_tensor + ix), ix); });
-    }
-    while (true) {
-      if (!p_pool->busy()) {
-        break;
-      }
+void Mapper<dType>::run(dType *p_tensor, const size_t &size, bool parallel) const {
+  auto run_chunk = [this, p_tensor](size_t begin, size_t end) {
+    for (size_t ix = begin; ix < end; ++ix) {
+      task_(*(p_tensor + ix), ix);
     }
+  };
 
-    p_pool->stop();
+  if (parallel) {
+    utils::threads::parallel_for(0, size, MAPPER_MIN_CHUNK, run_chunk);
   } else {
-    for (size_t ix = 0; ix < size; ++ix) {
-      task_(*(p_tensor + ix), ix);
-    }
+    run_chunk(0, size);
   }
 }
 
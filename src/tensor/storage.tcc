@@ -0,0 +1,52 @@
+#include "tensor/storage.h"
+
+namespace tensor {
+
+template<typename dType>
+Storage<dType>::Storage(const size_t &size, UninitializedTag)
+  : size_(size), allocator_(utils::memory::get_allocator()) {
+  data_ = static_cast<dType *>(allocator_->allocate(sizeof(dType) * size_));
+}
+
+template<typename dType>
+Storage<dType>::Storage(dType *data, const size_t &size, std::shared_ptr<void> owner)
+  : data_(data), size_(size), allocator_(nullptr), owner_(std::move(owner)) {}
+
+template<typename dType>
+Storage<dType>::Storage(const size_t &size)
+  : Storage<dType>(size, UninitializedTag()) {
+  memset(data_, 0, sizeof(dType) * size_);
+}
+
+template<typename dType>
+Storage<dType>::Storage(const size_t &size, const dType &value)
+  : Storage<dType>(size, UninitializedTag()) {
+  std::fill(data_, data_ + size_, value);
+}
+
+template<typename dType>
+Storage<dType>::Storage(const size_t &size, const dType *values)
+  : Storage<dType>(size, UninitializedTag()) {
+  memcpy(data_, values, sizeof(dType) * size_);
+}
+
+template<typename dType>
+Storage<dType>::~Storage() {
+  if (allocator_ != nullptr) {
+    allocator_->deallocate(data_, sizeof(dType) * size_);
+  }
+}
+
+template<typename dType>
+std::shared_ptr<Storage<dType>> Storage<dType>::make_uninitialized(const size_t &size) {
+  // make_shared cannot reach the private constructor
+  return std::shared_ptr<Storage<dType>>(new Storage<dType>(size, UninitializedTag()));
+}
+
+template<typename dType>
+std::shared_ptr<Storage<dType>> Storage<dType>::wrap(dType *data, const size_t &size,
+                                                     std::shared_ptr<void> owner) {
+  return std::shared_ptr<Storage<dType>>(new Storage<dType>(data, size, std::move(owner)));
+}
+
+} // namespace tensor
@@ -13,7 +13,7 @@ Tensor<dType>::Tensor(const TensorShape &shape) {
   }
 
   do_shape_update(shape);
-  tensor_ = std::make_shared<std::vector<dType>>(size_);
+  tensor_ = std::make_shared<Storage<dType>>(size_);
 }
 
 template<typename dType>
@@ -24,7 +24,7 @@ Tensor<dType>::Tensor(const TensorShape &&shape) {
   }
 
   do_shape_update(shape);
-  tensor_ = std::make_shared<std::vector<dType>>(size_);
+  tensor_ = std::make_shared<Storage<dType>>(size_);
 }
 
 template<typename dType>
@@ -35,7 +35,7 @@ Tensor<dType>::Tensor(const TensorShape &shape, const dType &single_value) {
   }
 
   do_shape_update(shape);
-  tensor_ = std::make_shared<std::vector<dType>>(size_, single_value);
+  tensor_ = std::make_shared<Storage<dType>>(size_, single_value);
 }
 
 template<typename dType>
@@ -48,8 +48,7 @@ Tensor<dType>::Tensor(const TensorShape &shape, const dType *values) {
   }
 
   do_shape_update(shape);
-  tensor_ = std::make_shared<std::vector<dType>>(size_);
-  memcpy(&(*tensor_->begin()), values, sizeof(dType) * size_);
+  tensor_ = std::make_shared<Storage<dType>>(size_, values);
 }
 
 template<typename dType>
@@ -61,7 +60,7 @@ Tensor<dType>::Tensor(const TensorShape &shape,
   }
 
   do_shape_update(shape, values.size());
-  tensor_ = std::make_shared<std::vector<dType>>(std::move(values));
+  tensor_ = std::make_shared<Storage<dType>>(size_, values.data());
 }
 
 template<typename dType>
@@ -73,26 +72,59 @@ Tensor<dType>::Tensor(const TensorShape &shape,
   }
 
   do_shape_update(shape, values.size());
-  tensor_ = std::make_shared<std::vector<dType>>(values);
+  tensor_ = std::make_shared<Storage<dType>>(size_, values.data());
 }
 
 template<typename dType>
 Tensor<dType>::Tensor(const Tensor<dType> &another)
   : size_(another.size_), dim_(another.dim_), shape_(another.shape_),
-    strides_(another.strides_) {
+    strides_(another.strides_), offset_(another.offset_) {
   tensor_ = another.tensor_;
 }
 
 template<typename dType>
 Tensor<dType>::Tensor(const Tensor<dType> &&another)
   : size_(another.size_), dim_(another.dim_), shape_(another.shape_),
-    strides_(another.strides_) {
+    strides_(another.strides_), offset_(another.offset_) {
   tensor_ = another.tensor_;
 }
 
+template<typename dType>
+Tensor<dType> Tensor<dType>::uninitialized(const TensorShape &shape) {
+  Tensor<dType> result({1});
+  if (!result.is_shape_valid(shape)) {
+    throw adg_exception::InvalidTensorShapeException(
+      "InvalidTensorShapeException; Failed when constructing: " + utils::vector_to_str(shape));
+  }
+
+  result.do_shape_update(shape);
+  result.tensor_ = Storage<dType>::make_uninitialized(result.size_);
+  return result;
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::from_storage(const TensorShape &shape, std::shared_ptr<Storage<dType>> storage,
+                                         const size_t &offset) {
+  Tensor<dType> result({1});
+  if (!result.is_shape_valid(shape)) {
+    throw adg_exception::InvalidTensorShapeException(
+      "InvalidTensorShapeException; Failed when constructing: " + utils::vector_to_str(shape));
+  }
+
+  result.do_shape_update(shape);
+  if (offset + result.size_ > storage->size()) {
+    throw adg_exception::InvalidTensorShapeException(
+      "Tensor >> from_storage: " + utils::vector_to_str(shape) + " does not fit into a storage of " +
+        std::to_string(storage->size()) + " elements at offset " + std::to_string(offset));
+  }
+  result.tensor_ = std::move(storage);
+  result.offset_ = offset;
+  return result;
+}
+
 template<typename dType>
 Tensor<dType> &Tensor<dType>::operator=(const Tensor<dType> &bt) {
-  if (tensor_ == bt.tensor_) {
+  if (this == &bt) {
     // nothing to do
     return *this;
   }
@@ -101,13 +133,15 @@ Tensor<dType> &Tensor<dType>::operator=(const Tensor<dType> &bt) {
   dim_ = bt.dim_;
   strides_ = bt.strides_;
   size_ = bt.size_;
+  offset_ = bt.offset_;
   tensor_ = bt.tensor_;
   return *this;
 }
 
 template<typename dType>
 bool Tensor<dType>::operator==(const Tensor<dType> &bt) const {
-  if (size_ != bt.size_ || shape_ != bt.shape_) {
+  if (size_ != bt.size_ || shape_ != bt.shape_ || offset_ != bt.offset_ ||
+    strides_ != bt.strides_) {
     return false;
   }
   return tensor_ == bt.tensor_;
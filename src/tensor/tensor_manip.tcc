@@ -13,24 +13,16 @@ Tensor<dType> Tensor<dType>::operator[](const size_t &id) const {
   }
 
   if (shape_[0] == 1) {
-    return this->copy();
+    return *this;
   }
 
-  TensorShape result_shape;
   if (dim_ == 1) {
-    result_shape = {1};
-  } else {
-    result_shape = TensorShape(shape_.begin() + 1, shape_.end());
+    return make_view({1}, {1}, offset_ + id * strides_[0]);
   }
-  Tensor<dType> result(std::move(result_shape));
 
-  {
-    dType *dest_ptr = result.get_tensor_ptr();
-    const dType *src_ptr = get_tensor_const_ptr();
-    memcpy(dest_ptr, src_ptr + id * strides_[0], sizeof(dType) * strides_[0]);
-  }
-
-  return result;
+  return make_view(TensorShape(shape_.begin() + 1, shape_.end()),
+                   TensorShape(strides_.begin() + 1, strides_.end()),
+                   offset_ + id * strides_[0]);
 }
 
 template<typename dType>
@@ -38,24 +30,26 @@ Tensor<dType> Tensor<dType>::operator[](const std::vector<size_t> &slice_indice)
   return take(0, slice_indice);
 }
 
+template<typename dType>
+Tensor<dType> Tensor<dType>::operator[](const TensorIndex &slice_indice) const {
+  return take(0, std::vector<size_t>(slice_indice));
+}
+
 template<typename dType>
 TensorIterator<dType> Tensor<dType>::get_iterator(const TensorIndex &index) {
-  size_t address = 0;
-  size_t address_gap = 1; // the address distance between adjacent index
-  for (int ix = index.size() - 1; ix >= 0; ix--) {
-    address += index[ix] * address_gap;
-    address_gap *= shape_[ix];
+  detach();
+  size_t address = offset_;
+  for (size_t ix = 0; ix < index.size(); ++ix) {
+    address += index[ix] * strides_[ix];
   }
   return tensor_->begin() + address;
 }
 
 template<typename dType>
 const TensorIterator<dType> Tensor<dType>::get_const_iterator(const TensorIndex &index) const {
-  size_t address = 0;
-  size_t address_gap = 1; // the address distance between adjacent index
-  for (int ix = index.size() - 1; ix >= 0; ix--) {
-    address += index[ix] * address_gap;
-    address_gap *= shape_[ix];
+  size_t address = offset_;
+  for (size_t ix = 0; ix < index.size(); ++ix) {
+    address += index[ix] * strides_[ix];
   }
   return tensor_->begin() + address;
 }
@@ -118,7 +112,7 @@ dType Tensor<dType>::get_value() const {
       "InvalidTensorIndexException: get_value() expects a tensor with single entry...");
   }
 
-  return *tensor_->begin();
+  return *(tensor_->begin() + offset_);
 }
 
 template<typename dType>
@@ -133,15 +127,10 @@ dType Tensor<dType>::get_value(const TensorIndex &index) const {
 }
 
 /*
-take slices the tensor along a specific axis
-A simpler version :
-  for (int i =0; i < size / strides[axis-1]; ++i) {
-    start = i * strides[axis-1]
-    for (int j : slice) {
-        s = start + j * strides[axis]
-        memcpy(dest, s, s + strides[axis])
-    }
-  }
+take picks the given indices along a specific axis.
+Evenly spaced indices (like {1, 3, 5} or a single index) can be described by
+a stride, so the result is a view. Any other selection is gathered into a new
+packed tensor, one sub-tensor per index.
 */
 template<typename dType>
 Tensor<dType> Tensor<dType>::take(const size_t &axis,
@@ -158,28 +147,41 @@ Tensor<dType> Tensor<dType>::take(const size_t &axis,
   }
 
   size_t slice_len = slice_indices.size();
+  if (slice_len == 0) {
+    throw adg_exception::InvalidTensorSliceException("Tensor >> take: got empty indices");
+  }
+
   TensorShape result_shape = shape_;
   result_shape[axis] = slice_len;
-  Tensor<dType> result(std::move(result_shape));
 
-  std::vector<size_t> indices = slice_indices;
-  for (size_t &index : indices) {
-    index *= strides_[axis];
+  // check whether the indices form an arithmetic progression
+  bool evenly_spaced = true;
+  size_t step = 1;
+  if (slice_len > 1) {
+    evenly_spaced = slice_indices[1] > slice_indices[0];
+    step = slice_indices[1] - slice_indices[0];
+    for (size_t ix = 2; evenly_spaced && ix < slice_len; ++ix) {
+      evenly_spaced = slice_indices[ix] > slice_indices[ix - 1] &&
+        slice_indices[ix] - slice_indices[ix - 1] == step;
+    }
   }
 
+  if (evenly_spaced) {
+    TensorShape result_strides = strides_;
+    result_strides[axis] *= step;
+    return make_view(result_shape, result_strides,
+                     offset_ + slice_indices[0] * strides_[axis]);
+  }
+
+  Tensor<dType> result = uninitialized(result_shape);
+  TensorShape sub_shape = shape_;
+  sub_shape[axis] = 1;
+  const dType *src_ptr = &*tensor_->begin();
   dType *dest_ptr = result.get_tensor_ptr();
-  const dType *src_ptr = get_tensor_const_ptr();
-  size_t max_iter = (axis == 0) ? 1 : size_ / strides_[axis - 1];
-  for (int ix = 0; ix < max_iter; ++ix) {
-    for (size_t &index : indices) {
-      if (axis != dim_ - 1) {
-        memcpy(dest_ptr, src_ptr + index, sizeof(dType) * strides_[axis]);
-      } else {
-        *dest_ptr = *(src_ptr + index);
-      }
-      dest_ptr += strides_[axis];
-      index += strides_[axis - 1];
-    }
+  for (size_t ix = 0; ix < slice_len; ++ix) {
+    utils::math::strided_copy(sub_shape, strides_,
+                              src_ptr + offset_ + slice_indices[ix] * strides_[axis],
+                              result.strides_, dest_ptr + ix * result.strides_[axis]);
   }
 
   return result;
@@ -188,14 +190,12 @@ Tensor<dType> Tensor<dType>::take(const size_t &axis,
 template<typename dType>
 Tensor<dType> Tensor<dType>::slice(const TensorSlice &slice) const {
   // slice is a vector of tuple3 {axis, start_index, end_index};
-  // only support continuous slice
+  // only support continuous slice, the result is a view on the same storage
   TensorShape result_shape = shape_;
-  TensorSlice sorted_slice(slice);
-  std::sort(sorted_slice.begin(), sorted_slice.end(),
-            [](const std::array<size_t, 3> &a, const std::array<size_t, 3> &b) { return a[0] < b[0]; });
+  size_t result_offset = offset_;
 
-  for (auto slice_tuple : sorted_slice) {
-    if (slice_tuple[0] > dim_) {
+  for (auto slice_tuple : slice) {
+    if (slice_tuple[0] >= dim_) {
       throw adg_exception::InvalidTensorSliceException(
         "Tensor >> slice: slice axis out of range: " + std::to_string(slice_tuple[0]));
     }
@@ -205,65 +205,93 @@ Tensor<dType> Tensor<dType>::slice(const TensorSlice &slice) const {
         "Tensor >> slice: slice tuple (axis, start_ix, end_ix) must assure start_ix < end_ix");
     }
 
+    if (slice_tuple[2] > shape_[slice_tuple[0]]) {
+      throw adg_exception::InvalidTensorSliceException(
+        "Tensor >> slice: slice end index out of range: " + std::to_string(slice_tuple[2]));
+    }
+
     result_shape[slice_tuple[0]] = slice_tuple[2] - slice_tuple[1];
+    result_offset += slice_tuple[1] * strides_[slice_tuple[0]];
   }
 
-  Tensor<dType> result(std::move(result_shape));
+  return make_view(result_shape, strides_, result_offset);
+}
+
+// copy returns a deep copy of current tensor, packed in row-major order
+template<typename dType>
+Tensor<dType> Tensor<dType>::copy() const {
+  if (is_contiguous()) {
+    return Tensor<dType>(shape_, get_tensor_const_ptr());
+  }
 
-  size_t dest_index = 0;
-  slice_recursive_copy(0, 0, sorted_slice, get_tensor_const_ptr(),
-                       result.get_tensor_ptr(), dest_index);
+  Tensor<dType> result = uninitialized(shape_);
+  utils::math::strided_copy(shape_, strides_, get_tensor_const_ptr(),
+                            result.strides_, result.get_tensor_ptr());
   return result;
 }
 
+// contiguous returns this tensor itself if its elements are already packed in
+// row-major order, otherwise a packed copy
 template<typename dType>
-void Tensor<dType>::slice_recursive_copy(const size_t &depth,
-                                         const size_t &cur_axis,
-                                         const TensorSlice &slice,
-                                         const dType *src_ptr,
-                                         dType *dest_ptr,
-                                         size_t &dest_index) const {
-  if (depth == slice.size()) {
-    // reach the end of recursion, do the copy without restriction
-    memcpy(dest_ptr + dest_index, src_ptr, sizeof(dType) * strides_[cur_axis - 1]);
-    dest_index += strides_[cur_axis - 1];
-    return;
+Tensor<dType> Tensor<dType>::contiguous() const {
+  if (is_contiguous()) {
+    return *this;
   }
+  return copy();
+}
 
-  // loop over the desired index
-  size_t start_index, end_index;
-  size_t depth_move = 0;
-  if (cur_axis != slice[depth][0]) {
-    start_index = 0;
-    end_index = shape_[cur_axis];
-  } else {
-    // if cur axis equals the slice[depth][0], the depth should move by one slot
-    depth_move = 1;
-    start_index = slice[depth][1];
-    end_index = slice[depth][2];
-  }
-  if (cur_axis == dim_ - 1) {
-    // optimize the slice on the last dim
-    // this part can get removed while the function will run expectedly
-    size_t copy_len = end_index - start_index;
-    memcpy(dest_ptr + dest_index, src_ptr + start_index, sizeof(dType) * copy_len);
-    dest_index += copy_len;
-    return;
+template<typename dType>
+bool Tensor<dType>::is_contiguous() const {
+  size_t expected_stride = 1;
+  for (size_t ix = dim_; ix-- > 0;) {
+    if (strides_[ix] != expected_stride) {
+      return false;
+    }
+    expected_stride *= shape_[ix];
   }
-  for (size_t ix = start_index; ix < end_index; ++ix) {
-    slice_recursive_copy(depth + depth_move,
-                         cur_axis + 1,
-                         slice,
-                         src_ptr + ix * strides_[cur_axis],
-                         dest_ptr,
-                         dest_index);
+  return true;
+}
+
+// make_contiguous repacks a strided view so that its shape can be reinterpreted
+template<typename dType>
+void Tensor<dType>::make_contiguous() {
+  if (!is_contiguous()) {
+    *this = copy();
   }
 }
 
-// copy returns a deep copy of current tensor
+// detach is the copy-on-write point: it is a no-op for a tensor that already
+// owns a packed buffer, otherwise the elements are copied into a new one
 template<typename dType>
-Tensor<dType> Tensor<dType>::copy() const {
-  return Tensor<dType>(shape_, get_tensor_const_ptr());
+void Tensor<dType>::detach() {
+  if (tensor_.use_count() > 1 || !is_contiguous()) {
+    *this = copy();
+  }
+}
+
+// make_view builds a tensor sharing the storage of this tensor
+template<typename dType>
+Tensor<dType> Tensor<dType>::make_view(const TensorShape &shape,
+                                       const TensorShape &strides,
+                                       const size_t &offset) const {
+  Tensor<dType> view(*this);
+  view.do_shape_update(shape);
+  view.offset_ = offset;
+  // axes of length one can take any stride, keep the packed ones for them so
+  // that a view with contiguous elements is reported as contiguous
+  for (size_t ix = 0; ix < view.dim_; ++ix) {
+    if (shape[ix] != 1) {
+      view.strides_[ix] = strides[ix];
+    }
+  }
+  return view;
+}
+
+template<typename dType>
+std::vector<dType> Tensor<dType>::to_vector() const {
+  Tensor<dType> packed = contiguous();
+  const dType *begin = packed.get_tensor_const_ptr();
+  return std::vector<dType>(begin, begin + size_);
 }
 
 template<typename dType>
@@ -294,6 +322,37 @@ void Tensor<dType>::do_shape_update(const TensorShape &shape,
   dim_ = shape.size();
 }
 
+template<typename dType>
+TensorShape Tensor<dType>::get_broadcast_strides(const TensorShape &shape) const {
+  if (shape.size() < dim_) {
+    throw adg_exception::MismatchTensorShapeError(
+      "Tensor >> broadcast: cannot broadcast " + utils::vector_to_str(shape_) +
+        " to " + utils::vector_to_str(shape));
+  }
+
+  // missing leading axes and axes of size 1 are read with stride 0
+  TensorShape strides(shape.size(), 0);
+  size_t lead = shape.size() - dim_;
+  for (size_t ax = 0; ax < dim_; ++ax) {
+    if (shape_[ax] == shape[lead + ax]) {
+      strides[lead + ax] = strides_[ax];
+    } else if (shape_[ax] != 1) {
+      throw adg_exception::MismatchTensorShapeError(
+        "Tensor >> broadcast: cannot broadcast " + utils::vector_to_str(shape_) +
+          " to " + utils::vector_to_str(shape));
+    }
+  }
+  return strides;
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::broadcast_to(const TensorShape &shape) const {
+  if (shape == shape_) {
+    return *this;
+  }
+  return make_view(shape, get_broadcast_strides(shape), offset_);
+}
+
 // reshape changes the shape_, dim_, strides_ of the tensor
 template<typename dType>
 void Tensor<dType>::reshape(const TensorShape &new_shape) {
@@ -305,11 +364,14 @@ void Tensor<dType>::reshape(const TensorShape &new_shape) {
     throw adg_exception::InvalidTensorShapeException("Tensor ==> reshape");
   }
 
+  // a strided view cannot be reinterpreted in place
+  make_contiguous();
+
   // keep same size
   do_shape_update(new_shape, size_);
 }
 
-// helper function for transpose, computes the coordinate of an element on a
+// helper function for reductions, computes the coordinate of an element on a
 // specific axis given its vector index
 template<typename dType>
 size_t Tensor<dType>::get_coordinate_at_axis(const size_t &ind,
@@ -323,41 +385,6 @@ size_t Tensor<dType>::get_coordinate_at_axis(const size_t &ind,
   return (ind % strides[axis - 1]) / strides[axis];
 }
 
-/*
-  This is helper function for transpose, computes the new index after transpose.
-  Suppose c is the vector of coordinates and s is the vector of strides.
-  The conversion equation for multi-array coordinate and the flattened index is
-    ` ind = sum_i {c[i] * s[i]} `
-  After transpose, we should have the new strides ns and only switch the
-  coordinate of axis a and b, then
-    ` new_ind = sum_{i != a, b} {c[i] * ns[i]} + c[a] * ns[b] + c[b] * ns[a] `
-  The `offset` computed in this function is new_ind - ind
-*/
-template<typename dType>
-size_t Tensor<dType>::get_index_after_transpose(
-  const size_t &ind, const size_t &axis_a, const size_t &axis_b,
-  const TensorShape &ori_strides, const TensorShape &new_strides) {
-  int64_t signed_index = ind;
-  int64_t offset = 0;
-  {
-    int64_t coord_a = get_coordinate_at_axis(ind, axis_a, ori_strides);
-    int64_t coord_b = get_coordinate_at_axis(ind, axis_b, ori_strides);
-    offset += coord_a * (new_strides[axis_b] - ori_strides[axis_a]) +
-      coord_b * (new_strides[axis_a] - ori_strides[axis_b]);
-  }
-
-  {
-    int64_t cur_coord;
-    for (size_t ax = axis_a + 1; ax < axis_b; ++ax) {
-      cur_coord = get_coordinate_at_axis(ind, ax, ori_strides);
-      offset += cur_coord * (new_strides[ax] - ori_strides[ax]);
-    }
-  }
-
-  int64_t new_index = signed_index + offset;
-  return static_cast<size_t>(new_index);
-}
-
 template<typename dType>
 size_t Tensor<dType>::get_index_after_concat(
   const size_t &ind, const size_t &axis, const size_t &offset_at_axis,
@@ -385,28 +412,6 @@ size_t Tensor<dType>::get_index_after_concat(
   return static_cast<size_t>(new_index);
 }
 
-// do_transpose impl of transpose
-// maps the index of original tensor to the index of the new tensor
-template<typename dType>
-void Tensor<dType>::do_transpose(const size_t &axis_a, const size_t &axis_b,
-                                 Tensor<dType> &dest_tensor) const {
-
-  auto get_new_index = [&](const size_t &index) {
-    return get_index_after_transpose(index, axis_a, axis_b, this->strides_,
-                                     dest_tensor.strides_);
-  };
-
-  TensorIterator<dType> src_iter = tensor_->begin();
-  TensorIterator<dType> dest_iter = dest_tensor.tensor_->begin();
-  size_t src_index = 0;
-  size_t dest_index;
-  // iterate all elements in tensor
-  while (src_iter != tensor_->end()) {
-    dest_index = get_new_index(src_index++);
-    *(dest_iter + dest_index) = *(src_iter++);
-  }
-}
-
 // transpose will switch the dimension of two axes
 template<typename dType>
 Tensor<dType> Tensor<dType>::transpose(const size_t &axis_ai,
@@ -422,22 +427,36 @@ Tensor<dType> Tensor<dType>::transpose(const size_t &axis_ai,
     throw adg_exception::AxisOutOfRangeError();
   }
 
-  // deep copy
-  Tensor<dType> result = this->copy();
+  // only swap the shape and strides, the data is left untouched
+  TensorShape result_shape = shape_;
+  TensorShape result_strides = strides_;
+  std::iter_swap(result_shape.begin() + axis_a, result_shape.begin() + axis_b);
+  std::iter_swap(result_strides.begin() + axis_a, result_strides.begin() + axis_b);
 
-  // update the shape_ and strides_
-  std::iter_swap(result.shape_.begin() + axis_a,
-                 result.shape_.begin() + axis_b);
+  return make_view(result_shape, result_strides, offset_);
+}
 
-  size_t new_stride = 1;
-  for (int ix = dim_ - 1; ix >= 0; --ix) {
-    result.strides_[ix] = new_stride;
-    new_stride *= result.shape_[ix];
+template<typename dType>
+Tensor<dType> Tensor<dType>::permute(const TensorAxes &axes) const {
+  if (axes.size() != dim_) {
+    throw adg_exception::MismatchTensorDimError(
+      "Tensor >> permute: expect " + std::to_string(dim_) + " axes, get " + utils::vector_to_str(axes));
+  }
+
+  utils::DimMask seen(dim_, false);
+  TensorShape result_shape(dim_), result_strides(dim_);
+  for (size_t ax = 0; ax < dim_; ++ax) {
+    if (axes[ax] >= dim_ || seen[axes[ax]]) {
+      throw adg_exception::AxisOutOfRangeError(
+        "Tensor >> permute: not a permutation of the axes: " + utils::vector_to_str(axes));
+    }
+    seen[axes[ax]] = true;
+    result_shape[ax] = shape_[axes[ax]];
+    result_strides[ax] = strides_[axes[ax]];
   }
 
-  do_transpose(axis_a, axis_b, result);
-
-  return result;
+  // a view as well, the copy happens in contiguous() with tiling
+  return make_view(result_shape, result_strides, offset_);
 }
 
 // by default, we transpose the last two axes for convenient matrix operation
@@ -482,57 +501,67 @@ void Tensor<dType>::fill_diag(const std::vector<dType> &diag_values) {
                              &*diag_values.begin(), get_tensor_ptr());
 }
 
+template<typename dType>
+template<typename oType>
+Tensor<oType> Tensor<dType>::cast() const {
+  if constexpr (std::is_same_v<oType, dType>) {
+    // shares the buffer, like any copy
+    return *this;
+  }
+  Tensor<dType> packed = contiguous();
+  Tensor<oType> result = Tensor<oType>::uninitialized(shape_);
+  utils::math::convert(size_, packed.get_tensor_const_ptr(), result.get_tensor_ptr());
+  return result;
+}
+
 template<typename dType>
 Tensor<int32_t> Tensor<dType>::to_int() const {
-  std::vector<int32_t> values(tensor_->begin(), tensor_->end());
-  return Tensor<int32_t>(shape_, std::move(values));
+  return cast<int32_t>();
+}
+
+template<typename dType>
+Tensor<int8_t> Tensor<dType>::to_int8() const {
+  return cast<int8_t>();
+}
+
+template<typename dType>
+Tensor<uint8_t> Tensor<dType>::to_uint8() const {
+  return cast<uint8_t>();
 }
 
 template<typename dType>
 Tensor<float> Tensor<dType>::to_float() const {
-  std::vector<float> values(tensor_->begin(), tensor_->end());
-  return Tensor<float>(shape_, std::move(values));
+  return cast<float>();
 }
 
 template<typename dType>
 Tensor<double> Tensor<dType>::to_double() const {
-  std::vector<double> values(tensor_->begin(), tensor_->end());
-  return Tensor<double>(shape_, std::move(values));
+  return cast<double>();
+}
+
+template<typename dType>
+Tensor<bfloat16> Tensor<dType>::to_bfloat16() const {
+  return cast<bfloat16>();
+}
+
+template<typename dType>
+Tensor<float16> Tensor<dType>::to_float16() const {
+  return cast<float16>();
 }
 
 template<typename dType>
 void Tensor<dType>::map(Mapper<dType> &mapper) {
-#if ADGC_MULTI_THREADS_NUM_
-  utils::threads::ThreadPool pool;
-  pool.start(ADGC_MULTI_THREADS_NUM_);
-  mapper.run(get_tensor_ptr(), size_, &pool);
-#else
   mapper.run(get_tensor_ptr(), size_);
-#endif
 }
 
 template<typename dType>
 void Tensor<dType>::map(Mapper<dType> &&mapper) {
-#if ADGC_MULTI_THREADS_NUM_
-  utils::threads::ThreadPool pool;
-  pool.start(ADGC_MULTI_THREADS_NUM_);
-  mapper.run(get_tensor_ptr(), size_, &pool);
-#else
   mapper.run(get_tensor_ptr(), size_);
-#endif
 }
 
 template<typename dType>
 void Tensor<dType>::map(const std::function<void(dType &)> &func) {
-  Mapper<dType> mapper(func);
-
-#if ADGC_MULTI_THREADS_NUM_
-  utils::threads::ThreadPool pool;
-  pool.start(ADGC_MULTI_THREADS_NUM_);
-  mapper.run(get_tensor_ptr(), size_, &pool);
-#else
-  mapper.run(get_tensor_ptr(), size_);
-#endif
+  Mapper<dType>(func).run(get_tensor_ptr(), size_);
 }
 
 }
\ No newline at end of file
@@ -14,47 +14,53 @@ Tensor<dType> Tensor<dType>::operator-() const {
 }
 
 template<typename dType>
-Tensor<dType> &Tensor<dType>::operator+=(const Tensor<dType> &bt) {
-  // in-place addition
-  if (bt.get_shape() != shape_) {
-    throw adg_exception::MismatchTensorShapeError(
-      "Tensor >> operator-=: get mismatched shapes: " +
-        utils::vector_to_str(bt.get_shape()) + " and " +
-        utils::vector_to_str(shape_));
+Tensor<dType> Tensor<dType>::operator/(const dType &denom) const {
+  if constexpr (std::is_floating_point_v<dType>) {
+    dType devided = 1 / denom;
+    if (std::abs(devided) < (std::is_same_v<dType, float> ? 1e-15 : 1e-17)) {
+      throw adg_exception::DividingZeroException();
+    }
+    return this->multiply(devided);
+  } else {
+    if (denom == 0) {
+      throw adg_exception::DividingZeroException();
+    }
+    return div(denom);
   }
+}
 
-  utils::math::elementwise_add_inplace(size_, get_tensor_ptr(),
-                                       bt.get_tensor_const_ptr());
-  return *this;
+template<typename dType>
+Tensor<dType> &Tensor<dType>::operator+=(const Tensor<dType> &bt) {
+  return add_(bt);
 }
 
 template<typename dType>
 Tensor<dType> &Tensor<dType>::operator+=(const dType &number) {
-  // in-place addition
-  utils::math::elementwise_addn(size_, get_tensor_ptr(), number);
-  return *this;
+  return add_(number);
 }
 
 template<typename dType>
 Tensor<dType> &Tensor<dType>::operator-=(const Tensor<dType> &bt) {
-  // in-place subtraction
-  if (bt.get_shape() != shape_) {
-    throw adg_exception::MismatchTensorShapeError(
-      "Tensor >> operator-=: get mismatched shapes: " +
-        utils::vector_to_str(bt.get_shape()) + " and " +
-        utils::vector_to_str(shape_));
-  }
-
-  utils::math::elementwise_add_inplace(size_, get_tensor_ptr(),
-                                       bt.get_tensor_const_ptr(), true);
-  return *this;
+  return sub_(bt);
 }
 
 template<typename dType>
 Tensor<dType> &Tensor<dType>::operator-=(const dType &number) {
-  // in-place subtraction
-  utils::math::elementwise_addn(size_, get_tensor_ptr(), number, true);
-  return *this;
+  return sub_(number);
+}
+
+template<typename dType>
+void Tensor<dType>::resize(const TensorShape &shape) {
+  size_t size = 1;
+  for (auto dim : shape) {
+    size *= dim;
+  }
+  if (tensor_.use_count() == 1 && tensor_->size() == size && is_shape_valid(shape)) {
+    offset_ = 0;
+    do_shape_update(shape);
+    return;
+  }
+  *this = uninitialized(shape);
 }
 
 // get_dot_shape returns the shape of result matrix for dot_mul
@@ -114,107 +120,390 @@ TensorShape Tensor<dType>::get_dot_shape(const Tensor<dType> &bt) const {
   return result_shape;
 }
 
-// dot implements the matrix multiplication
+// get_gemm_operand describes the matrices in the last two axes for BLAS,
+// transposed views are read as they are; false when a copy is needed
+template<typename dType>
+bool Tensor<dType>::get_gemm_operand(utils::math::GemmOperand<dType> &operand) const {
+  size_t rows = shape_[dim_ - 2];
+  size_t cols = shape_[dim_ - 1];
+  // the stride of an axis of length one does not matter, take the one that fits
+  size_t row_stride = rows == 1 ? 1 : strides_[dim_ - 2];
+  size_t col_stride = cols == 1 ? 1 : strides_[dim_ - 1];
+
+  operand.data = get_tensor_const_ptr();
+  if (col_stride == 1 && row_stride >= std::max<size_t>(cols, 1)) {
+    operand.trans = false;
+    operand.ld = row_stride;
+  } else if (row_stride == 1 && col_stride >= std::max<size_t>(rows, 1)) {
+    operand.trans = true;
+    operand.ld = col_stride;
+  } else {
+    return false;
+  }
+
+  // the batch axes have to collapse into one with a single stride
+  operand.batch_stride = 0;
+  size_t collapsed_len = 0;
+  for (size_t ax = dim_ - 2; ax-- > 0;) {
+    if (shape_[ax] == 1) {
+      continue;
+    }
+    if (collapsed_len == 0) {
+      operand.batch_stride = strides_[ax];
+    } else if (strides_[ax] != operand.batch_stride * collapsed_len) {
+      return false;
+    }
+    collapsed_len = std::max<size_t>(collapsed_len, 1) * shape_[ax];
+  }
+  return true;
+}
+
+// dot implements the matrix multiplication, transposed operands are passed
+// to BLAS with transpose flags instead of being copied
 template<typename dType>
 Tensor<dType> Tensor<dType>::dot(const Tensor<dType> &bt) const {
+  Tensor<dType> result = uninitialized(get_dot_shape(bt));
+  dot(bt, result);
+  return result;
+}
+
+template<typename dType>
+void Tensor<dType>::dot(const Tensor<dType> &bt, Tensor<dType> &out) const {
   TensorShape result_shape = get_dot_shape(bt);
-  Tensor<dType> result(result_shape);
+
+  utils::math::GemmOperand<dType> lhs, rhs;
+  if (!get_gemm_operand(lhs)) {
+    contiguous().dot(bt, out);
+    return;
+  }
+  if (!bt.get_gemm_operand(rhs)) {
+    dot(bt.contiguous(), out);
+    return;
+  }
+  if (is_operand(out, bt)) {
+    out = dot(bt);
+    return;
+  }
+
+  out.resize(result_shape);
+  if (out.size_ == 0) {
+    return;
+  }
 
   size_t M = shape_[dim_ - 2];
   size_t N = bt.shape_[bt.get_dim() - 1];
   size_t K = shape_[dim_ - 1];
+  size_t n_blocks = out.size_ / (M * N);
+  if (K == 0) {
+    std::fill_n(out.get_tensor_ptr(), out.size_, dType(0));
+    return;
+  }
 
-  utils::math::tensor_gemm(size_, bt.size_, result.size_, M, N, K,
-                           get_tensor_const_ptr(), bt.get_tensor_const_ptr(),
-                           result.get_tensor_ptr());
-  return result;
+  utils::math::tensor_gemm(n_blocks, M, N, K, lhs, rhs, out.get_tensor_ptr());
 }
 
 // multiply implements the element-wise multiplication
 template<typename dType>
 Tensor<dType> Tensor<dType>::multiply(const Tensor<dType> &bt) const {
-  if (bt.shape_ != shape_) {
-    throw adg_exception::MismatchTensorShapeError(
-      "MismatchTensorShapeError >> multiply " + utils::vector_to_str(shape_) +
-        " and " + utils::vector_to_str(bt.shape_));
+  Tensor<dType> result = uninitialized(broadcast_shape(shape_, bt.shape_));
+  multiply(bt, result);
+  return result;
+}
+
+template<typename dType>
+void Tensor<dType>::multiply(const Tensor<dType> &bt, Tensor<dType> &out) const {
+  if (is_operand(out, bt)) {
+    out = multiply(bt);
+    return;
+  }
+  if (bt.shape_ != shape_ || !is_contiguous() || !bt.is_contiguous()) {
+    broadcast_op(bt, std::multiplies<dType>(), out);
+    return;
   }
 
-  Tensor<dType> result = Tensor(shape_);
+  out.resize(shape_);
   utils::math::elementwise_multiply(size_, get_tensor_const_ptr(),
                                     bt.get_tensor_const_ptr(),
-                                    result.get_tensor_ptr());
-  return result;
+                                    out.get_tensor_ptr());
 }
 
 // multiply implements the element-wise multiplication
 template<typename dType>
 Tensor<dType> Tensor<dType>::multiply(const dType &multiplier) const {
-  Tensor<dType> result = Tensor(shape_, multiplier);
-  utils::math::elementwise_multiply(size_, get_tensor_const_ptr(),
-                                    result.get_tensor_const_ptr(),
-                                    result.get_tensor_ptr());
+  Tensor<dType> result = uninitialized(shape_);
+  multiply(multiplier, result);
   return result;
 }
 
+template<typename dType>
+void Tensor<dType>::multiply(const dType &multiplier, Tensor<dType> &out) const {
+  scalar_op(multiplier, std::multiplies<dType>(), out);
+}
+
 template<typename dType>
 Tensor<dType> Tensor<dType>::div(const dType &denom) const {
-  Tensor<dType> result = Tensor(shape_, denom);
-  utils::math::elementwise_divide(size_, get_tensor_const_ptr(),
-                                  result.get_tensor_const_ptr(),
-                                  result.get_tensor_ptr());
+  Tensor<dType> result = uninitialized(shape_);
+  div(denom, result);
   return result;
 }
 
+template<typename dType>
+void Tensor<dType>::div(const dType &denom, Tensor<dType> &out) const {
+  scalar_op(denom, std::divides<dType>(), out);
+}
+
 template<typename dType>
 Tensor<dType> Tensor<dType>::div(const Tensor<dType> &bt) const {
-  if (shape_ != bt.shape_) {
-    throw adg_exception::MismatchTensorShapeError(
-      "Tensor >> div: MismatchTensorShapeError: get shape " +
-        utils::vector_to_str(shape_) + " and " +
-        utils::vector_to_str(bt.shape_));
+  Tensor<dType> result = uninitialized(broadcast_shape(shape_, bt.shape_));
+  div(bt, result);
+  return result;
+}
+
+template<typename dType>
+void Tensor<dType>::div(const Tensor<dType> &bt, Tensor<dType> &out) const {
+  if (is_operand(out, bt)) {
+    out = div(bt);
+    return;
+  }
+  if (bt.shape_ != shape_ || !is_contiguous() || !bt.is_contiguous()) {
+    broadcast_op(bt, std::divides<dType>(), out);
+    return;
   }
 
-  Tensor<dType> result(shape_);
-  utils::math::elementwise_divide(size_, get_tensor_const_ptr(), bt.get_tensor_const_ptr(), result.get_tensor_ptr());
-  return result;
+  out.resize(shape_);
+  utils::math::elementwise_divide(size_, get_tensor_const_ptr(), bt.get_tensor_const_ptr(), out.get_tensor_ptr());
 }
 
 template<typename dType>
 Tensor<dType> Tensor<dType>::add(const Tensor<dType> &bt) const {
-  if (bt.shape_ != shape_) {
-    throw adg_exception::MismatchTensorShapeError(
-      "MismatchTensorShapeError >> add " + utils::vector_to_str(shape_) +
-        " and " + utils::vector_to_str(bt.shape_));
+  Tensor<dType> result = uninitialized(broadcast_shape(shape_, bt.shape_));
+  add(bt, result);
+  return result;
+}
+
+template<typename dType>
+void Tensor<dType>::add(const Tensor<dType> &bt, Tensor<dType> &out) const {
+  if (is_operand(out, bt)) {
+    out = add(bt);
+    return;
+  }
+  if (bt.shape_ != shape_ || !is_contiguous() || !bt.is_contiguous()) {
+    broadcast_op(bt, std::plus<dType>(), out);
+    return;
   }
 
-  Tensor<dType> result = Tensor(std::move(shape_));
+  out.resize(shape_);
   utils::math::elementwise_add(size_, get_tensor_const_ptr(),
                                bt.get_tensor_const_ptr(),
-                               result.get_tensor_ptr());
-  return result;
+                               out.get_tensor_ptr());
 }
 
 template<typename dType>
 Tensor<dType> Tensor<dType>::add(const dType &number) const {
-  Tensor<dType> result = Tensor(shape_, static_cast<dType>(number));
-  utils::math::elementwise_add(size_, get_tensor_const_ptr(),
-                               result.get_tensor_const_ptr(),
-                               result.get_tensor_ptr());
+  Tensor<dType> result = uninitialized(shape_);
+  add(number, result);
   return result;
 }
 
+template<typename dType>
+void Tensor<dType>::add(const dType &number, Tensor<dType> &out) const {
+  scalar_op(number, std::plus<dType>(), out);
+}
+
 template<typename dType>
 Tensor<dType> Tensor<dType>::sub(const Tensor<dType> &bt) const {
-  if (bt.shape_ != shape_) {
-    throw adg_exception::MismatchTensorShapeError(
-      "MismatchTensorShapeError >> sub " + utils::vector_to_str(shape_) +
-        " and " + utils::vector_to_str(bt.shape_));
+  Tensor<dType> result = uninitialized(broadcast_shape(shape_, bt.shape_));
+  sub(bt, result);
+  return result;
+}
+
+template<typename dType>
+void Tensor<dType>::sub(const Tensor<dType> &bt, Tensor<dType> &out) const {
+  if (is_operand(out, bt)) {
+    out = sub(bt);
+    return;
+  }
+  if (bt.shape_ != shape_ || !is_contiguous() || !bt.is_contiguous()) {
+    broadcast_op(bt, std::minus<dType>(), out);
+    return;
   }
 
-  Tensor<dType> result = Tensor(std::move(shape_));
+  out.resize(shape_);
   utils::math::elementwise_add(size_, get_tensor_const_ptr(),
                                bt.get_tensor_const_ptr(),
-                               result.get_tensor_ptr(), true);
+                               out.get_tensor_ptr(), true);
+}
+
+template<typename dType>
+Tensor<dType> &Tensor<dType>::add_(const Tensor<dType> &bt) {
+  if (bt.shape_ != shape_) {
+    broadcast_op_inplace(bt, std::plus<dType>());
+    return *this;
+  }
+
+  // this is detached first, so bt cannot be a view of the buffer written to
+  dType *dest_ptr = get_tensor_ptr();
+  Tensor<dType> rhs = bt.contiguous();
+  utils::math::elementwise_add_inplace(size_, dest_ptr, rhs.get_tensor_const_ptr());
+  return *this;
+}
+
+template<typename dType>
+Tensor<dType> &Tensor<dType>::add_(const dType &number) {
+  utils::math::elementwise_addn(size_, get_tensor_ptr(), number);
+  return *this;
+}
+
+template<typename dType>
+Tensor<dType> &Tensor<dType>::sub_(const Tensor<dType> &bt) {
+  if (bt.shape_ != shape_) {
+    broadcast_op_inplace(bt, std::minus<dType>());
+    return *this;
+  }
+
+  dType *dest_ptr = get_tensor_ptr();
+  Tensor<dType> rhs = bt.contiguous();
+  utils::math::elementwise_add_inplace(size_, dest_ptr, rhs.get_tensor_const_ptr(), true);
+  return *this;
+}
+
+template<typename dType>
+Tensor<dType> &Tensor<dType>::sub_(const dType &number) {
+  utils::math::elementwise_addn(size_, get_tensor_ptr(), number, true);
+  return *this;
+}
+
+template<typename dType>
+Tensor<dType> &Tensor<dType>::multiply_(const Tensor<dType> &bt) {
+  if (bt.shape_ != shape_) {
+    broadcast_op_inplace(bt, std::multiplies<dType>());
+    return *this;
+  }
+
+  dType *dest_ptr = get_tensor_ptr();
+  Tensor<dType> rhs = bt.contiguous();
+  utils::math::elementwise_multiply(size_, dest_ptr, rhs.get_tensor_const_ptr(), dest_ptr);
+  return *this;
+}
+
+template<typename dType>
+Tensor<dType> &Tensor<dType>::multiply_(const dType &multiplier) {
+  scalar_op_inplace(multiplier, std::multiplies<dType>());
+  return *this;
+}
+
+template<typename dType>
+Tensor<dType> &Tensor<dType>::div_(const Tensor<dType> &bt) {
+  if (bt.shape_ != shape_) {
+    broadcast_op_inplace(bt, std::divides<dType>());
+    return *this;
+  }
+
+  dType *dest_ptr = get_tensor_ptr();
+  Tensor<dType> rhs = bt.contiguous();
+  utils::math::elementwise_divide(size_, dest_ptr, rhs.get_tensor_const_ptr(), dest_ptr);
+  return *this;
+}
+
+template<typename dType>
+Tensor<dType> &Tensor<dType>::div_(const dType &denom) {
+  scalar_op_inplace(denom, std::divides<dType>());
+  return *this;
+}
+
+template<typename dType>
+TensorShape Tensor<dType>::broadcast_shape(const TensorShape &lhs, const TensorShape &rhs) {
+  const TensorShape &longer = lhs.size() >= rhs.size() ? lhs : rhs;
+  const TensorShape &shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+  size_t lead = longer.size() - shorter.size();
+
+  TensorShape result = longer;
+  for (size_t ax = 0; ax < shorter.size(); ++ax) {
+    if (shorter[ax] == longer[lead + ax] || shorter[ax] == 1) {
+      continue;
+    }
+    if (longer[lead + ax] != 1) {
+      throw adg_exception::MismatchTensorShapeError(
+        "Tensor >> broadcast_shape: cannot broadcast " + utils::vector_to_str(lhs) +
+          " and " + utils::vector_to_str(rhs));
+    }
+    result[lead + ax] = shorter[ax];
+  }
+  return result;
+}
+
+// broadcast_op applies op between this and bt with the broadcast shape, each
+// operand is read through its own strides so nothing is expanded or repacked
+template<typename dType>
+template<typename BinaryOp>
+void Tensor<dType>::broadcast_op(const Tensor<dType> &bt, BinaryOp op, Tensor<dType> &out) const {
+  TensorShape result_shape = broadcast_shape(shape_, bt.shape_);
+  out.resize(result_shape);
+  utils::math::broadcast_binary(result_shape,
+                                get_broadcast_strides(result_shape), get_tensor_const_ptr(),
+                                bt.get_broadcast_strides(result_shape), bt.get_tensor_const_ptr(),
+                                out.strides_, out.get_tensor_ptr(), op);
+}
+
+template<typename dType>
+template<typename BinaryOp>
+void Tensor<dType>::broadcast_op_inplace(const Tensor<dType> &bt, BinaryOp op) {
+  // the result has to fit into this tensor
+  TensorShape rhs_strides = bt.get_broadcast_strides(shape_);
+  dType *dest_ptr = get_tensor_ptr();
+  utils::math::broadcast_binary(shape_, strides_, dest_ptr,
+                                rhs_strides, bt.get_tensor_const_ptr(),
+                                strides_, dest_ptr, op);
+}
+
+template<typename dType>
+template<typename BinaryOp>
+void Tensor<dType>::scalar_op(const dType &number, BinaryOp op, Tensor<dType> &out) const {
+  if (&out == this) {
+    out.scalar_op_inplace(number, op);
+    return;
+  }
+
+  out.resize(shape_);
+  utils::math::broadcast_binary(shape_, strides_, get_tensor_const_ptr(),
+                                TensorShape(dim_, 0), &number,
+                                out.strides_, out.get_tensor_ptr(), op);
+}
+
+template<typename dType>
+template<typename BinaryOp>
+void Tensor<dType>::scalar_op_inplace(const dType &number, BinaryOp op) {
+  dType *dest_ptr = get_tensor_ptr();
+  utils::math::broadcast_binary(shape_, strides_, dest_ptr,
+                                TensorShape(dim_, 0), &number,
+                                strides_, dest_ptr, op);
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::reduce_to_shape(const TensorShape &shape) const {
+  if (shape == shape_) {
+    return *this;
+  }
+
+  size_t target_size = 1;
+  for (auto dim : shape) {
+    target_size *= dim;
+  }
+  if (target_size == 1) {
+    // a scalar operand, whatever the number of its axes
+    Tensor<dType> result = sum();
+    result.reshape(shape);
+    return result;
+  }
+
+  // walk this tensor once and accumulate into the target, which is read
+  // and written with stride 0 along the broadcast axes
+  Tensor<dType> result(shape);
+  TensorShape dest_strides = result.get_broadcast_strides(shape_);
+  dType *dest_ptr = result.get_tensor_ptr();
+  utils::math::broadcast_binary(shape_, dest_strides, dest_ptr,
+                                strides_, get_tensor_const_ptr(),
+                                dest_strides, dest_ptr, std::plus<dType>());
   return result;
 }
 
@@ -239,6 +528,10 @@ Tensor<dType> Tensor<dType>::kron(const Tensor<dType> &lt,
     }
   }
 
+  if (!lt.is_contiguous() || !rt.is_contiguous()) {
+    return kron(lt.contiguous(), rt.contiguous());
+  }
+
   size_t left_nrow = lt.shape_[lt.dim_ - 2];
   size_t right_nrow = rt.shape_[rt.dim_ - 2];
   size_t left_ncol = lt.shape_[lt.dim_ - 1];
@@ -292,15 +585,16 @@ Tensor<dType> Tensor<dType>::concat(const std::vector<Tensor<dType>> &tensors, c
 
   TensorShape target_shape = src_shape;
   target_shape[axis] = len_after_concat;
-  Tensor<dType> result(std::move(target_shape));
+  Tensor<dType> result = uninitialized(target_shape);
 
   // tensor_offset: the coordinate of the leftmost element of the current tensor on the axis after concat
   size_t tensor_offset = 0, new_index;
   dType *result_tensor_ptr = result.get_tensor_ptr();
   TensorShape result_strides = result.get_strides();
   for (size_t ix = 0; ix < tensors.size(); ++ix) {
-    const dType *src_tensor_ptr = tensors[ix].get_tensor_const_ptr();
-    TensorShape cur_strides = tensors[ix].get_strides();
+    Tensor<dType> src_tensor = tensors[ix].contiguous();
+    const dType *src_tensor_ptr = src_tensor.get_tensor_const_ptr();
+    TensorShape cur_strides = src_tensor.get_strides();
 
     for (size_t index = 0; index < tensors[ix].get_size(); index += cur_strides[axis]) {
       new_index = get_index_after_concat(index, axis, tensor_offset,
@@ -314,126 +608,234 @@ Tensor<dType> Tensor<dType>::concat(const std::vector<Tensor<dType>> &tensors, c
 }
 
 template<typename dType>
-Tensor<dType> Tensor<dType>::mean(const size_t &axis, bool keep_dim) const {
-  Tensor<dType> result = sum(axis, keep_dim);
-  size_t len_at_axis = shape_[axis];
-  result.map([&len_at_axis](dType &val) { val /= len_at_axis; });
-  return result;
+void Tensor<dType>::normal_init(double loc, double scale, size_t seed) {
+  utils::random::fill_normal(size_, utils::random::get_generator(seed), loc, scale, get_tensor_ptr());
 }
 
 template<typename dType>
-Tensor<dType> Tensor<dType>::max(const size_t &axis, bool keep_dim) const {
-  if (axis == SIZE_MAX) {
-    return Tensor<dType>({1}, *std::max_element(tensor_->begin(), tensor_->end()));
+void Tensor<dType>::uniform_init(double low, double high, size_t seed) {
+  utils::random::fill_uniform(size_, utils::random::get_generator(seed), low, high, get_tensor_ptr());
+}
+
+template<typename dType>
+void Tensor<dType>::bernoulli_init(double p, size_t seed) {
+  utils::random::fill_bernoulli(size_, utils::random::get_generator(seed), p, get_tensor_ptr());
+}
+
+template<typename dType>
+utils::DimMask Tensor<dType>::get_reduce_mask(const TensorAxes &axes) const {
+  utils::DimMask reduce_mask(dim_, false);
+  for (auto axis : axes) {
+    if (axis >= dim_) {
+      throw adg_exception::AxisOutOfRangeError(
+        "Tensor >> reduce: axis " + std::to_string(axis) + " out of range for " + utils::vector_to_str(shape_));
+    }
+    reduce_mask[axis] = true;
   }
+  return reduce_mask;
+}
 
-  if (axis >= dim_) {
-    throw adg_exception::AxisOutOfRangeError(
-      "Tensor >> sum: axis out of range");
+template<typename dType>
+TensorShape Tensor<dType>::get_reduced_shape(const utils::DimMask &reduce_mask, bool keep_dim) const {
+  TensorShape result_shape;
+  for (size_t ax = 0; ax < dim_; ++ax) {
+    if (!reduce_mask[ax]) {
+      result_shape.emplace_back(shape_[ax]);
+    } else if (keep_dim) {
+      result_shape.emplace_back(1);
+    }
+  }
+  if (result_shape.empty()) {
+    result_shape.emplace_back(1);
   }
+  return result_shape;
+}
 
-  // only take max along the given axis
-  TensorShape result_shape = shape_;
-  if (!keep_dim) {
-    result_shape.erase(result_shape.begin() + axis);
+template<typename dType>
+template<typename Reducer>
+void Tensor<dType>::reduce(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const {
+  if constexpr (utils::half_precision<dType>) {
+    // accumulated in float, the result is rounded once
+    typedef typename Reducer::template rebind<float> FloatReducer;
+    Tensor<float> result({1});
+    cast<float>().template reduce<FloatReducer>(axes, keep_dim, result);
+    out = result.template cast<dType>();
   } else {
-    result_shape[axis] = 1;
+    if (!is_contiguous()) {
+      contiguous().template reduce<Reducer>(axes, keep_dim, out);
+      return;
+    }
+    if (&out == this) {
+      Tensor<dType> result({1});
+      reduce<Reducer>(axes, keep_dim, result);
+      out = result;
+      return;
+    }
+
+    utils::DimMask reduce_mask = get_reduce_mask(axes);
+    out.resize(get_reduced_shape(reduce_mask, keep_dim));
+    utils::math::reduce<dType, Reducer>(shape_, reduce_mask, get_tensor_const_ptr(), out.get_tensor_ptr());
   }
-  Tensor<dType> result(std::move(result_shape));
+}
 
-  auto dest_ptr = result.get_tensor_ptr();
-  auto src_ptr = get_tensor_const_ptr();
-  size_t src_index = 0;
-  while (src_index < size_) {
-    if (get_coordinate_at_axis(src_index, axis, strides_) == 0) {
-      *(dest_ptr++) =
-        utils::math::max(shape_[axis], src_ptr + src_index, strides_[axis]);
-    }
-    ++src_index;
+// get_axes turns the SIZE_MAX axis into the list of every axis
+template<typename dType>
+TensorAxes Tensor<dType>::get_axes(const size_t &axis) const {
+  if (axis != SIZE_MAX) {
+    return {axis};
   }
+  TensorAxes axes(dim_);
+  std::iota(axes.begin(), axes.end(), 0);
+  return axes;
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::sum(const size_t &axis, bool keep_dim) const {
+  return sum(get_axes(axis), keep_dim);
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::sum(const TensorAxes &axes, bool keep_dim) const {
+  Tensor<dType> result({1});
+  sum(axes, keep_dim, result);
   return result;
 }
 
 template<typename dType>
-Tensor<dType> Tensor<dType>::arg_amax(const size_t &axis, bool keep_dim) const {
-  if (axis == SIZE_MAX) {
-    return Tensor<dType>({1}, static_cast<dType>(utils::math::arg_amax(size_, get_tensor_const_ptr(), 1)));
-  }
+void Tensor<dType>::sum(const size_t &axis, bool keep_dim, Tensor<dType> &out) const {
+  sum(get_axes(axis), keep_dim, out);
+}
 
-  if (axis >= dim_) {
-    throw adg_exception::AxisOutOfRangeError(
-      "Tensor >> sum: axis out of range");
-  }
+template<typename dType>
+void Tensor<dType>::sum(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const {
+  reduce<utils::math::SumReducer<dType>>(axes, keep_dim, out);
+}
 
-  // only take max along the given axis
-  TensorShape result_shape = shape_;
-  if (!keep_dim) {
-    result_shape.erase(result_shape.begin() + axis);
-  } else {
-    result_shape[axis] = 1;
-  }
-  Tensor<dType> result(std::move(result_shape));
+template<typename dType>
+Tensor<dType> Tensor<dType>::mean(const size_t &axis, bool keep_dim) const {
+  return mean(get_axes(axis), keep_dim);
+}
 
-  auto dest_ptr = result.get_tensor_ptr();
-  auto src_ptr = get_tensor_const_ptr();
-  size_t src_index = 0;
-  while (src_index < size_) {
-    if (get_coordinate_at_axis(src_index, axis, strides_) == 0) {
-      *(dest_ptr++) =
-        utils::math::arg_amax(shape_[axis], src_ptr + src_index, strides_[axis]);
-    }
-    ++src_index;
-  }
+template<typename dType>
+Tensor<dType> Tensor<dType>::mean(const TensorAxes &axes, bool keep_dim) const {
+  Tensor<dType> result({1});
+  mean(axes, keep_dim, result);
   return result;
 }
 
 template<typename dType>
-void Tensor<dType>::normal_init(double loc, double scale, size_t seed) {
-  size_t r_seed = seed;
-  if (r_seed == SIZE_MAX) {
-    r_seed = std::chrono::system_clock::now().time_since_epoch().count();
-  }
-  std::default_random_engine eng(r_seed);
-  std::normal_distribution<double> distribution(loc, scale);
+void Tensor<dType>::mean(const size_t &axis, bool keep_dim, Tensor<dType> &out) const {
+  mean(get_axes(axis), keep_dim, out);
+}
 
-  for (auto it = tensor_->begin(); it != tensor_->end(); it++) {
-    double number = distribution(eng);
-    *it = static_cast<dType>(number);
+template<typename dType>
+void Tensor<dType>::mean(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const {
+  // the size is read before out may replace this tensor
+  size_t size = size_;
+  sum(axes, keep_dim, out);
+  dType count = static_cast<dType>(size / out.size_);
+  dType *result_ptr = out.get_tensor_ptr();
+  for (size_t ix = 0; ix < out.size_; ++ix) {
+    result_ptr[ix] /= count;
   }
 }
 
 template<typename dType>
-Tensor<dType> Tensor<dType>::sum(const size_t &axis, bool keep_dim) const {
-  if (axis == SIZE_MAX) {
-    dType res = utils::math::sum(size_, get_tensor_const_ptr(), 1);
-    return Tensor<dType>({1}, res);
-  }
+Tensor<dType> Tensor<dType>::max(const size_t &axis, bool keep_dim) const {
+  return max(get_axes(axis), keep_dim);
+}
 
-  if (axis >= dim_) {
-    throw adg_exception::AxisOutOfRangeError(
-      "Tensor >> sum: axis out of range");
+template<typename dType>
+Tensor<dType> Tensor<dType>::max(const TensorAxes &axes, bool keep_dim) const {
+  Tensor<dType> result({1});
+  max(axes, keep_dim, result);
+  return result;
+}
+
+template<typename dType>
+void Tensor<dType>::max(const size_t &axis, bool keep_dim, Tensor<dType> &out) const {
+  max(get_axes(axis), keep_dim, out);
+}
+
+template<typename dType>
+void Tensor<dType>::max(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const {
+  reduce<utils::math::MaxReducer<dType>>(axes, keep_dim, out);
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::min(const size_t &axis, bool keep_dim) const {
+  return min(get_axes(axis), keep_dim);
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::min(const TensorAxes &axes, bool keep_dim) const {
+  Tensor<dType> result({1});
+  min(axes, keep_dim, result);
+  return result;
+}
+
+template<typename dType>
+void Tensor<dType>::min(const size_t &axis, bool keep_dim, Tensor<dType> &out) const {
+  min(get_axes(axis), keep_dim, out);
+}
+
+template<typename dType>
+void Tensor<dType>::min(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const {
+  reduce<utils::math::MinReducer<dType>>(axes, keep_dim, out);
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::var(const size_t &axis, bool keep_dim) const {
+  return var(get_axes(axis), keep_dim);
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::var(const TensorAxes &axes, bool keep_dim) const {
+  Tensor<dType> result({1});
+  var(axes, keep_dim, result);
+  return result;
+}
+
+template<typename dType>
+void Tensor<dType>::var(const size_t &axis, bool keep_dim, Tensor<dType> &out) const {
+  var(get_axes(axis), keep_dim, out);
+}
+
+// var returns the population variance, mean((x - mean(x))^2), in two passes
+template<typename dType>
+void Tensor<dType>::var(const TensorAxes &axes, bool keep_dim, Tensor<dType> &out) const {
+  Tensor<dType> centered = sub(mean(axes, true));
+  centered.multiply_(centered);
+  centered.mean(axes, keep_dim, out);
+}
+
+template<typename dType>
+Tensor<dType> Tensor<dType>::arg_amax(const size_t &axis, bool keep_dim) const {
+  if (!is_contiguous()) {
+    return contiguous().arg_amax(axis, keep_dim);
   }
 
-  // only sum along the given axis
-  TensorShape result_shape = shape_;
-  if (!keep_dim) {
-    result_shape.erase(result_shape.begin() + axis);
-  } else {
-    result_shape[axis] = 1;
+  if (axis != SIZE_MAX && axis >= dim_) {
+    throw adg_exception::AxisOutOfRangeError(
+      "Tensor >> arg_amax: axis out of range");
   }
-  Tensor<dType> result(std::move(result_shape));
 
-  auto dest_ptr = result.get_tensor_ptr();
-  auto src_ptr = get_tensor_const_ptr();
-  size_t src_index = 0;
-  while (src_index < size_) {
-    if (get_coordinate_at_axis(src_index, axis, strides_) == 0) {
-      *(dest_ptr++) =
-        utils::math::sum(shape_[axis], src_ptr + src_index, strides_[axis]);
+  // the whole tensor is a single line for SIZE_MAX
+  size_t outer = 1, len = size_, inner = 1;
+  TensorShape result_shape = {1};
+  if (axis != SIZE_MAX) {
+    len = shape_[axis];
+    for (size_t ax = 0; ax < axis; ++ax) {
+      outer *= shape_[ax];
     }
-    ++src_index;
+    inner = size_ / outer / len;
+    result_shape = get_reduced_shape(get_reduce_mask({axis}), keep_dim);
   }
+
+  Tensor<dType> result = uninitialized(result_shape);
+  utils::math::arg_reduce(outer, len, inner, get_tensor_const_ptr(), result.get_tensor_ptr(),
+                          [](const dType &lhs, const dType &rhs) { return lhs > rhs; });
   return result;
 }
 
-}
\ No newline at end of file
+}
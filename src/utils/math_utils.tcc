@@ -6,21 +6,196 @@
 namespace utils {
 namespace math {
 
-inline void gemm(const size_t &M, const size_t &N, const size_t &K,
-                 const float *mat_a, const float *mat_b, float *mat_c) {
-  cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K, 1., mat_a, K,
-              mat_b, N, 0., mat_c, N);
+inline CBLAS_TRANSPOSE to_cblas_trans(const bool &trans) {
+  return trans ? CblasTrans : CblasNoTrans;
 }
 
-inline void gemm(const size_t &M, const size_t &N, const size_t &K,
-                 const double *mat_a, const double *mat_b, double *mat_c) {
-  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K, 1., mat_a, K,
-              mat_b, N, 0., mat_c, N);
+// gemm computes C = op(A) * op(B) with row-major operands, op transposes
+// the matrix when trans is set and ld is the distance between two rows
+inline void gemm(const bool &trans_a, const bool &trans_b,
+                 const size_t &M, const size_t &N, const size_t &K,
+                 const float *mat_a, const size_t &lda, const float *mat_b, const size_t &ldb,
+                 float *mat_c, const size_t &ldc) {
+  cblas_sgemm(CblasRowMajor, to_cblas_trans(trans_a), to_cblas_trans(trans_b), M, N, K, 1.,
+              mat_a, lda, mat_b, ldb, 0., mat_c, ldc);
+}
+
+inline void gemm(const bool &trans_a, const bool &trans_b,
+                 const size_t &M, const size_t &N, const size_t &K,
+                 const double *mat_a, const size_t &lda, const double *mat_b, const size_t &ldb,
+                 double *mat_c, const size_t &ldc) {
+  cblas_dgemm(CblasRowMajor, to_cblas_trans(trans_a), to_cblas_trans(trans_b), M, N, K, 1.,
+              mat_a, lda, mat_b, ldb, 0., mat_c, ldc);
+}
+
+// at least this many multiply-adds per thread before an integer gemm is split
+const size_t INT_GEMM_MIN_CHUNK_FLOPS = 1 << 18;
+
+// pack_matrix copies op(mat) into a packed row-major [rows, cols] buffer
+template<typename dType>
+void pack_matrix(const bool &trans, const size_t &rows, const size_t &cols,
+                 const dType *mat, const size_t &ld, dType *packed) {
+  for (size_t ix = 0; ix < rows; ++ix) {
+    for (size_t iy = 0; iy < cols; ++iy) {
+      packed[ix * cols + iy] = trans ? mat[iy * ld + ix] : mat[ix * ld + iy];
+    }
+  }
 }
 
+/*
+  gemm_accumulate is the integer gemm: the products are summed in int32_t
+  whatever the width of the operands, so int8_t inputs do not overflow
+  before the sum is stored. Transposed operands are packed first, then the
+  rows of C are computed with the i-k-j order whose inner loop runs over
+  contiguous rows of B and C and gets vectorized.
+*/
+template<std::integral dType>
+void gemm_accumulate(const bool &trans_a, const bool &trans_b,
+                     const size_t &M, const size_t &N, const size_t &K,
+                     const dType *mat_a, const size_t &lda, const dType *mat_b, const size_t &ldb,
+                     int32_t *mat_c, const size_t &ldc) {
+  std::vector<dType> packed_a, packed_b;
+  if (trans_a) {
+    packed_a.resize(M * K);
+    pack_matrix(true, M, K, mat_a, lda, packed_a.data());
+  }
+  if (trans_b) {
+    packed_b.resize(K * N);
+    pack_matrix(true, K, N, mat_b, ldb, packed_b.data());
+  }
+  const dType *a = trans_a ? packed_a.data() : mat_a;
+  const dType *b = trans_b ? packed_b.data() : mat_b;
+  size_t a_ld = trans_a ? K : lda;
+  size_t b_ld = trans_b ? N : ldb;
+
+  utils::threads::parallel_for(0, M, std::max<size_t>(1, INT_GEMM_MIN_CHUNK_FLOPS / std::max<size_t>(N * K, 1)),
+                               [&](size_t begin, size_t end) {
+    for (size_t ix = begin; ix < end; ++ix) {
+      int32_t *c_row = mat_c + ix * ldc;
+      std::fill_n(c_row, N, 0);
+      for (size_t iz = 0; iz < K; ++iz) {
+        const int32_t a_value = a[ix * a_ld + iz];
+        const dType *b_row = b + iz * b_ld;
+        for (size_t iy = 0; iy < N; ++iy) {
+          c_row[iy] += a_value * static_cast<int32_t>(b_row[iy]);
+        }
+      }
+    }
+  });
+}
+
+template<std::integral dType>
+void gemm(const bool &trans_a, const bool &trans_b,
+          const size_t &M, const size_t &N, const size_t &K,
+          const dType *mat_a, const size_t &lda, const dType *mat_b, const size_t &ldb,
+          dType *mat_c, const size_t &ldc) {
+  if constexpr (std::is_same_v<dType, int32_t>) {
+    gemm_accumulate(trans_a, trans_b, M, N, K, mat_a, lda, mat_b, ldb, mat_c, ldc);
+  } else {
+    // narrower types are accumulated in int32_t and stored back wrapped
+    std::vector<int32_t> accumulated(M * N);
+    gemm_accumulate(trans_a, trans_b, M, N, K, mat_a, lda, mat_b, ldb, accumulated.data(), N);
+    for (size_t ix = 0; ix < M; ++ix) {
+      for (size_t iy = 0; iy < N; ++iy) {
+        mat_c[ix * ldc + iy] = static_cast<dType>(accumulated[ix * N + iy]);
+      }
+    }
+  }
+}
+
+// at least this many entries per thread before a conversion is split
+const size_t CONVERT_MIN_CHUNK = 1 << 15;
+
+// convert casts a run of entries into another element type
+template<typename sType, typename dType>
+void convert(const size_t &size, const sType *src, dType *dest) {
+  utils::threads::parallel_for(0, size, CONVERT_MIN_CHUNK, [&](size_t begin, size_t end) {
+    for (size_t ix = begin; ix < end; ++ix) {
+      dest[ix] = static_cast<dType>(src[ix]);
+    }
+  });
+}
+
+/*
+  The half precision gemm_accumulate sums the products of 16-bit operands
+  in float: bfloat16 goes to MKL's cblas_gemm_bf16bf16f32, float16 operands
+  are widened to float and run through sgemm.
+*/
+inline void gemm_accumulate(const bool &trans_a, const bool &trans_b,
+                            const size_t &M, const size_t &N, const size_t &K,
+                            const bfloat16 *mat_a, const size_t &lda, const bfloat16 *mat_b, const size_t &ldb,
+                            float *mat_c, const size_t &ldc) {
+  cblas_gemm_bf16bf16f32(CblasRowMajor, to_cblas_trans(trans_a), to_cblas_trans(trans_b), M, N, K, 1.f,
+                         reinterpret_cast<const MKL_BF16 *>(mat_a), lda,
+                         reinterpret_cast<const MKL_BF16 *>(mat_b), ldb, 0.f, mat_c, ldc);
+}
+
+inline void gemm_accumulate(const bool &trans_a, const bool &trans_b,
+                            const size_t &M, const size_t &N, const size_t &K,
+                            const float16 *mat_a, const size_t &lda, const float16 *mat_b, const size_t &ldb,
+                            float *mat_c, const size_t &ldc) {
+  // the stored matrices are widened as they are, so the transpose flags still apply
+  size_t rows_a = trans_a ? K : M, cols_a = trans_a ? M : K;
+  size_t rows_b = trans_b ? N : K, cols_b = trans_b ? K : N;
+  std::vector<float> wide_a(rows_a * cols_a), wide_b(rows_b * cols_b);
+  for (size_t ix = 0; ix < rows_a; ++ix) {
+    convert(cols_a, mat_a + ix * lda, wide_a.data() + ix * cols_a);
+  }
+  for (size_t ix = 0; ix < rows_b; ++ix) {
+    convert(cols_b, mat_b + ix * ldb, wide_b.data() + ix * cols_b);
+  }
+  gemm(trans_a, trans_b, M, N, K, wide_a.data(), cols_a, wide_b.data(), cols_b, mat_c, ldc);
+}
+
+template<half_precision dType>
+void gemm(const bool &trans_a, const bool &trans_b,
+          const size_t &M, const size_t &N, const size_t &K,
+          const dType *mat_a, const size_t &lda, const dType *mat_b, const size_t &ldb,
+          dType *mat_c, const size_t &ldc) {
+  // C is rounded once, after the float accumulation
+  std::vector<float> accumulated(M * N);
+  gemm_accumulate(trans_a, trans_b, M, N, K, mat_a, lda, mat_b, ldb, accumulated.data(), N);
+  for (size_t ix = 0; ix < M; ++ix) {
+    convert(N, accumulated.data() + ix * N, mat_c + ix * ldc);
+  }
+}
+
+template<typename dType>
 inline void gemm(const size_t &M, const size_t &N, const size_t &K,
-                 const int32_t *mat_a, const int32_t *mat_b, int32_t *mat_c) {
-  throw adg_exception::NonImplementedException();
+                 const dType *mat_a, const dType *mat_b, dType *mat_c) {
+  gemm(false, false, M, N, K, mat_a, K, mat_b, N, mat_c, N);
+}
+
+// gemm_batch runs n_blocks products at once, the i-th one reading A and B
+// at i * stride_a and i * stride_b and writing C at i * M * N
+inline void gemm_batch(const bool &trans_a, const bool &trans_b,
+                       const size_t &M, const size_t &N, const size_t &K,
+                       const float *mat_a, const size_t &lda, const size_t &stride_a,
+                       const float *mat_b, const size_t &ldb, const size_t &stride_b,
+                       float *mat_c, const size_t &n_blocks) {
+  cblas_sgemm_batch_strided(CblasRowMajor, to_cblas_trans(trans_a), to_cblas_trans(trans_b), M, N, K, 1.,
+                            mat_a, lda, stride_a, mat_b, ldb, stride_b, 0., mat_c, N, M * N, n_blocks);
+}
+
+inline void gemm_batch(const bool &trans_a, const bool &trans_b,
+                       const size_t &M, const size_t &N, const size_t &K,
+                       const double *mat_a, const size_t &lda, const size_t &stride_a,
+                       const double *mat_b, const size_t &ldb, const size_t &stride_b,
+                       double *mat_c, const size_t &n_blocks) {
+  cblas_dgemm_batch_strided(CblasRowMajor, to_cblas_trans(trans_a), to_cblas_trans(trans_b), M, N, K, 1.,
+                            mat_a, lda, stride_a, mat_b, ldb, stride_b, 0., mat_c, N, M * N, n_blocks);
+}
+
+template<loop_kernel_type dType>
+void gemm_batch(const bool &trans_a, const bool &trans_b,
+                const size_t &M, const size_t &N, const size_t &K,
+                const dType *mat_a, const size_t &lda, const size_t &stride_a,
+                const dType *mat_b, const size_t &ldb, const size_t &stride_b,
+                dType *mat_c, const size_t &n_blocks) {
+  for (size_t ix = 0; ix < n_blocks; ++ix) {
+    gemm(trans_a, trans_b, M, N, K, mat_a + ix * stride_a, lda,
+         mat_b + ix * stride_b, ldb, mat_c + ix * M * N, N);
+  }
 }
 
 inline void kron1d(const size_t &size_a, const size_t &size_b,
@@ -37,34 +212,23 @@ inline void kron1d(const size_t &size_a, const size_t &size_b,
              size_b);
 }
 
-inline void kron1d(const size_t &size_a, const size_t &size_b,
-                   const size_t &size_c, const int32_t *mat_a,
-                   const int32_t *mat_b, int32_t *mat_c) {
-  throw adg_exception::NonImplementedException();
-}
-
-inline void kron2d(const size_t &row_a, const size_t &col_a,
-                   const size_t &row_b, const size_t &col_b,
-                   const double *mat_a, const double *mat_b, double *mat_c) {
-  size_t index_a = 0;
-  size_t index_b = 0;
-  size_t index_c = 0;
-  size_t col_c = col_a * col_b;
-  for (size_t ix = 0; ix < row_a; ++ix) {
-    index_b = 0;
-    for (size_t j = 0; j < row_b; ++j) {
-      kron1d(col_a, col_b, col_c, mat_a + index_a, mat_b + index_b,
-             mat_c + index_c);
-      index_b += col_b;
-      index_c += col_c;
+template<loop_kernel_type dType>
+void kron1d(const size_t &size_a, const size_t &size_b,
+            const size_t &size_c, const dType *mat_a,
+            const dType *mat_b, dType *mat_c) {
+  // outer product written into rows of length size_b, size_c apart
+  for (size_t ix = 0; ix < size_a; ++ix) {
+    dType *c_row = mat_c + ix * size_b;
+    for (size_t iy = 0; iy < size_b; ++iy) {
+      c_row[iy] = mat_a[ix] * mat_b[iy];
     }
-    index_a += col_a;
   }
 }
 
-inline void kron2d(const size_t &row_a, const size_t &col_a,
-                   const size_t &row_b, const size_t &col_b, const float *mat_a,
-                   const float *mat_b, float *mat_c) {
+template<typename dType>
+void kron2d(const size_t &row_a, const size_t &col_a,
+            const size_t &row_b, const size_t &col_b,
+            const dType *mat_a, const dType *mat_b, dType *mat_c) {
   size_t index_a = 0;
   size_t index_b = 0;
   size_t index_c = 0;
@@ -81,12 +245,6 @@ inline void kron2d(const size_t &row_a, const size_t &col_a,
   }
 }
 
-inline void kron2d(const size_t &size_a, const size_t &size_b,
-                   const size_t &size_c, const int32_t *mat_a,
-                   const int32_t *mat_b, int32_t *mat_c) {
-  throw adg_exception::NonImplementedException();
-}
-
 // elementwise mult
 inline void elementwise_multiply(const size_t &size, const double *mat_a,
                                  const double *mat_b, double *mat_c) {
@@ -108,9 +266,14 @@ inline void elementwise_multiply(const size_t &size, const float *mat_a,
   vsMul(size, mat_a, mat_b, mat_c);
 }
 
-inline void elementwise_multiply(const size_t &size, const int32_t *mat_a,
-                                 const int32_t *mat_b, int32_t *mat_c) {
-  throw adg_exception::NonImplementedException();
+// the integer and half precision kernels are plain loops left to the
+// auto-vectorizer, half precision values are computed in float
+template<loop_kernel_type dType>
+void elementwise_multiply(const size_t &size, const dType *mat_a,
+                          const dType *mat_b, dType *mat_c) {
+  for (size_t ix = 0; ix < size; ++ix) {
+    mat_c[ix] = mat_a[ix] * mat_b[ix];
+  }
 }
 
 inline void elementwise_divide(const size_t &size, const double *mat_a,
@@ -137,13 +300,22 @@ inline void elementwise_divide(const size_t &size, const float *mat_a,
   vsDiv(size, mat_a, mat_b, mat_c);
 }
 
-inline void elementwise_divide(const size_t &size, const int32_t *mat_a,
-                               const int32_t *mat_b, int32_t *mat_c) {
-  for (int ix = 0; ix < size; ++ix) {
-    if (mat_a[ix] == 0) {
-      mat_c[ix] = 0;
-      continue;
-    }
+template<std::integral dType>
+void elementwise_divide(const size_t &size, const dType *mat_a,
+                        const dType *mat_b, dType *mat_c) {
+  if (std::find(mat_b, mat_b + size, dType(0)) != mat_b + size) {
+    throw adg_exception::DividingZeroException();
+  }
+  for (size_t ix = 0; ix < size; ++ix) {
+    mat_c[ix] = mat_a[ix] / mat_b[ix];
+  }
+}
+
+// half precision divides like float, zero denominators give inf or NaN
+template<half_precision dType>
+void elementwise_divide(const size_t &size, const dType *mat_a,
+                        const dType *mat_b, dType *mat_c) {
+  for (size_t ix = 0; ix < size; ++ix) {
     mat_c[ix] = mat_a[ix] / mat_b[ix];
   }
 }
@@ -183,10 +355,19 @@ inline void elementwise_add(const size_t &size, const float *mat_a,
   }
 }
 
-inline void elementwise_add(const size_t &size, const int32_t *mat_a,
-                            const int32_t *mat_b, int32_t *mat_c,
-                            bool subtract = false) {
-  throw adg_exception::NonImplementedException();
+template<loop_kernel_type dType>
+void elementwise_add(const size_t &size, const dType *mat_a,
+                     const dType *mat_b, dType *mat_c,
+                     bool subtract = false) {
+  if (subtract) {
+    for (size_t ix = 0; ix < size; ++ix) {
+      mat_c[ix] = mat_a[ix] - mat_b[ix];
+    }
+  } else {
+    for (size_t ix = 0; ix < size; ++ix) {
+      mat_c[ix] = mat_a[ix] + mat_b[ix];
+    }
+  }
 }
 
 inline void elementwise_add_inplace(const size_t &size, double *mat_a,
@@ -209,10 +390,11 @@ inline void elementwise_add_inplace(const size_t &size, float *mat_a,
   }
 }
 
-inline void elementwise_add_inplace(const size_t &size, int32_t *mat_a,
-                                    const int32_t *mat_b,
-                                    bool subtract = false) {
-  throw adg_exception::NonImplementedException();
+template<loop_kernel_type dType>
+void elementwise_add_inplace(const size_t &size, dType *mat_a,
+                             const dType *mat_b,
+                             bool subtract = false) {
+  elementwise_add(size, mat_a, mat_b, mat_a, subtract);
 }
 
 inline void elementwise_addn(const size_t &size, double *mat,
@@ -233,9 +415,13 @@ inline void elementwise_addn(const size_t &size, float *mat,
   }
 }
 
-inline void elementwise_addn(const size_t &size, int32_t *mat,
-                             const int32_t &number, bool subtract = false) {
-  throw adg_exception::NonImplementedException();
+template<loop_kernel_type dType>
+void elementwise_addn(const size_t &size, dType *mat,
+                      const dType &number, bool subtract = false) {
+  const dType value = subtract ? dType(-number) : number;
+  for (size_t ix = 0; ix < size; ++ix) {
+    mat[ix] += value;
+  }
 }
 
 inline void elementwise_negative(const size_t &size, double *mat) {
@@ -248,8 +434,30 @@ inline void elementwise_negative(const size_t &size, float *mat) {
   cblas_saxpby(size, 1., &tmp, 0, -1., mat, 1);
 }
 
-inline void elementwise_negative(const size_t &size, const int32_t *mat) {
-  throw ::adg_exception::NonImplementedException();
+template<loop_kernel_type dType>
+void elementwise_negative(const size_t &size, dType *mat) {
+  for (size_t ix = 0; ix < size; ++ix) {
+    mat[ix] = -mat[ix];
+  }
+}
+
+// y = alpha * x + beta * y
+inline void axpby(const size_t &size, const double &alpha, const double *x,
+                  const double &beta, double *y) {
+  cblas_daxpby(size, alpha, x, 1, beta, y, 1);
+}
+
+inline void axpby(const size_t &size, const float &alpha, const float *x,
+                  const float &beta, float *y) {
+  cblas_saxpby(size, alpha, x, 1, beta, y, 1);
+}
+
+template<loop_kernel_type dType>
+void axpby(const size_t &size, const dType &alpha, const dType *x,
+           const dType &beta, dType *y) {
+  for (size_t ix = 0; ix < size; ++ix) {
+    y[ix] = alpha * x[ix] + beta * y[ix];
+  }
 }
 
 inline float sum(const size_t &size, const float *mat_a, const size_t &inc) {
@@ -262,9 +470,13 @@ inline double sum(const size_t &size, const double *mat_a, const size_t &inc) {
   return cblas_ddot(size, mat_a, inc, &constant, 0);
 }
 
-inline int32_t sum(const size_t &size, const int32_t *mat_a,
-                   const size_t &inc) {
-  throw adg_exception::NonImplementedException();
+template<std::integral dType>
+dType sum(const size_t &size, const dType *mat_a, const size_t &inc) {
+  int64_t result = 0;
+  for (size_t ix = 0, index = 0; ix < size; ++ix, index += inc) {
+    result += mat_a[index];
+  }
+  return static_cast<dType>(result);
 }
 
 inline float max(const size_t &size, const float *mat_a, const size_t &inc) {
@@ -283,9 +495,10 @@ inline double max(const size_t &size, const double *mat_a, const size_t &inc) {
   return result;
 }
 
-inline int32_t max(const size_t &size, const int32_t *mat_a, const size_t &inc) {
-  int32_t result = mat_a[0];
-  for (size_t ix = 0, index = inc; ix < size; ++ix, index += inc) {
+template<std::integral dType>
+dType max(const size_t &size, const dType *mat_a, const size_t &inc) {
+  dType result = mat_a[0];
+  for (size_t ix = 1, index = inc; ix < size; ++ix, index += inc) {
     result = mat_a[index] > result ? mat_a[index] : result;
   }
   return result;
@@ -299,8 +512,19 @@ inline size_t arg_amax(const size_t &size, const double *mat_a, const size_t &in
   return cblas_idamax(size, mat_a, inc);
 }
 
-inline size_t arg_amax(const size_t &size, const int32_t *mat_a, const size_t &inc) {
-  throw adg_exception::NonImplementedException();
+// index of the entry with the largest magnitude, like i?amax
+template<std::integral dType>
+size_t arg_amax(const size_t &size, const dType *mat_a, const size_t &inc) {
+  size_t result = 0;
+  int64_t result_abs = -1;
+  for (size_t ix = 0, index = 0; ix < size; ++ix, index += inc) {
+    int64_t value_abs = std::abs(static_cast<int64_t>(mat_a[index]));
+    if (value_abs > result_abs) {
+      result = ix;
+      result_abs = value_abs;
+    }
+  }
+  return result;
 }
 
 inline void fill_diagonal(const size_t &M, const size_t &N,
@@ -313,9 +537,12 @@ inline void fill_diagonal(const size_t &M, const size_t &N, const float *values,
   cblas_scopy(std::min(M, N), values, 1, mat, N + 1);
 }
 
-inline void fill_diagonal(const size_t &M, const int32_t &N,
-                          const int32_t *values, int32_t *mat) {
-  throw adg_exception::NonImplementedException();
+template<loop_kernel_type dType>
+void fill_diagonal(const size_t &M, const size_t &N,
+                   const dType *values, dType *mat) {
+  for (size_t ix = 0; ix < std::min(M, N); ++ix) {
+    mat[ix * (N + 1)] = values[ix];
+  }
 }
 
 // math functions for loss functions
@@ -332,6 +559,251 @@ inline double relu(double x) { return std::max(x, 0.); }
 
 inline float relu(float x) { return std::max(x, (float) 0); }
 
+template<std::floating_point dType>
+inline dType gelu(dType x) {
+  return dType(0.5) * x * (1 + std::erf(x * dType(M_SQRT1_2)));
+}
+
+template<std::floating_point dType>
+inline dType silu(dType x) {
+  return x * sigmoid(x);
+}
+
+// vml kernels, working in place as well
+
+inline void elementwise_exp(const size_t &size, const double *src, double *dest) {
+  vdExp(size, src, dest);
+}
+
+inline void elementwise_exp(const size_t &size, const float *src, float *dest) {
+  vsExp(size, src, dest);
+}
+
+inline void elementwise_log(const size_t &size, const double *src, double *dest) {
+  vdLn(size, src, dest);
+}
+
+inline void elementwise_log(const size_t &size, const float *src, float *dest) {
+  vsLn(size, src, dest);
+}
+
+inline void elementwise_tanh(const size_t &size, const double *src, double *dest) {
+  vdTanh(size, src, dest);
+}
+
+inline void elementwise_tanh(const size_t &size, const float *src, float *dest) {
+  vsTanh(size, src, dest);
+}
+
+inline void elementwise_erf(const size_t &size, const double *src, double *dest) {
+  vdErf(size, src, dest);
+}
+
+inline void elementwise_erf(const size_t &size, const float *src, float *dest) {
+  vsErf(size, src, dest);
+}
+
+// activation kernels go over blocks of this many entries; their outputs may
+// be the same buffer as any of their inputs, so intermediate results are
+// kept in buffers local to the block
+const size_t ACTIVATION_BLOCK_SIZE = 1024;
+// at least this many entries per thread before an activation is split
+const size_t ACTIVATION_MIN_CHUNK = 1 << 14;
+
+// for_each_block calls body(offset, length) on consecutive blocks of [0, size)
+template<typename Func>
+void for_each_block(const size_t &size, const Func &body) {
+  utils::threads::parallel_for(0, size, ACTIVATION_MIN_CHUNK, [&](size_t begin, size_t end) {
+    for (size_t offset = begin; offset < end; offset += ACTIVATION_BLOCK_SIZE) {
+      body(offset, std::min(ACTIVATION_BLOCK_SIZE, end - offset));
+    }
+  });
+}
+
+template<std::floating_point dType>
+void relu_forward(const size_t &size, const dType *x, dType *y) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    for (size_t ix = offset; ix < offset + length; ++ix) {
+      y[ix] = std::max(x[ix], dType(0));
+    }
+  });
+}
+
+template<std::floating_point dType>
+void relu_backward(const size_t &size, const dType *y, const dType *grad, dType *dx) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    for (size_t ix = offset; ix < offset + length; ++ix) {
+      dx[ix] = y[ix] > 0 ? grad[ix] : dType(0);
+    }
+  });
+}
+
+template<std::floating_point dType>
+void leaky_relu_forward(const size_t &size, const dType *x, const dType &alpha, dType *y) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    for (size_t ix = offset; ix < offset + length; ++ix) {
+      y[ix] = x[ix] > 0 ? x[ix] : alpha * x[ix];
+    }
+  });
+}
+
+template<std::floating_point dType>
+void leaky_relu_backward(const size_t &size, const dType *x, const dType *grad, const dType &alpha, dType *dx) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    for (size_t ix = offset; ix < offset + length; ++ix) {
+      dx[ix] = x[ix] > 0 ? grad[ix] : alpha * grad[ix];
+    }
+  });
+}
+
+template<std::floating_point dType>
+void sigmoid_forward(const size_t &size, const dType *x, dType *y) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    dType *y_block = y + offset;
+    for (size_t ix = 0; ix < length; ++ix) {
+      y_block[ix] = std::min(-x[offset + ix], dType(100));
+    }
+    elementwise_exp(length, y_block, y_block);
+    for (size_t ix = 0; ix < length; ++ix) {
+      y_block[ix] = 1 / (1 + y_block[ix]);
+    }
+  });
+}
+
+template<std::floating_point dType>
+void sigmoid_backward(const size_t &size, const dType *y, const dType *grad, dType *dx) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    for (size_t ix = offset; ix < offset + length; ++ix) {
+      dx[ix] = grad[ix] * y[ix] * (1 - y[ix]);
+    }
+  });
+}
+
+template<std::floating_point dType>
+void tanh_forward(const size_t &size, const dType *x, dType *y) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    elementwise_tanh(length, x + offset, y + offset);
+  });
+}
+
+template<std::floating_point dType>
+void tanh_backward(const size_t &size, const dType *y, const dType *grad, dType *dx) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    for (size_t ix = offset; ix < offset + length; ++ix) {
+      dx[ix] = grad[ix] * (1 - y[ix] * y[ix]);
+    }
+  });
+}
+
+template<std::floating_point dType>
+void gelu_forward(const size_t &size, const dType *x, dType *y) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    dType erf_x[ACTIVATION_BLOCK_SIZE];
+    dType *y_block = y + offset;
+    const dType *x_block = x + offset;
+    for (size_t ix = 0; ix < length; ++ix) {
+      erf_x[ix] = x_block[ix] * dType(M_SQRT1_2);
+    }
+    elementwise_erf(length, erf_x, erf_x);
+    for (size_t ix = 0; ix < length; ++ix) {
+      y_block[ix] = dType(0.5) * x_block[ix] * (1 + erf_x[ix]);
+    }
+  });
+}
+
+template<std::floating_point dType>
+void gelu_backward(const size_t &size, const dType *x, const dType *grad, dType *dx) {
+  // gelu'(x) = Φ(x) + x * φ(x), φ(x) = exp(-x^2 / 2) / sqrt(2π)
+  const dType inv_sqrt_2pi = dType(0.5 * M_2_SQRTPI * M_SQRT1_2);
+  for_each_block(size, [&](size_t offset, size_t length) {
+    dType erf_x[ACTIVATION_BLOCK_SIZE];
+    dType density[ACTIVATION_BLOCK_SIZE];
+    dType *dx_block = dx + offset;
+    const dType *x_block = x + offset;
+    for (size_t ix = 0; ix < length; ++ix) {
+      erf_x[ix] = x_block[ix] * dType(M_SQRT1_2);
+      density[ix] = dType(-0.5) * x_block[ix] * x_block[ix];
+    }
+    elementwise_erf(length, erf_x, erf_x);
+    elementwise_exp(length, density, density);
+    for (size_t ix = 0; ix < length; ++ix) {
+      dType cdf = dType(0.5) * (1 + erf_x[ix]);
+      dx_block[ix] = grad[offset + ix] * (cdf + x_block[ix] * density[ix] * inv_sqrt_2pi);
+    }
+  });
+}
+
+template<std::floating_point dType>
+void silu_forward(const size_t &size, const dType *x, dType *y) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    dType exp_x[ACTIVATION_BLOCK_SIZE];
+    dType *y_block = y + offset;
+    const dType *x_block = x + offset;
+    for (size_t ix = 0; ix < length; ++ix) {
+      exp_x[ix] = std::min(-x_block[ix], dType(100));
+    }
+    elementwise_exp(length, exp_x, exp_x);
+    for (size_t ix = 0; ix < length; ++ix) {
+      y_block[ix] = x_block[ix] / (1 + exp_x[ix]);
+    }
+  });
+}
+
+template<std::floating_point dType>
+void silu_backward(const size_t &size, const dType *x, const dType *grad, dType *dx) {
+  // silu'(x) = s + x * s * (1 - s) with s = sigmoid(x)
+  for_each_block(size, [&](size_t offset, size_t length) {
+    dType exp_x[ACTIVATION_BLOCK_SIZE];
+    dType *dx_block = dx + offset;
+    const dType *x_block = x + offset;
+    for (size_t ix = 0; ix < length; ++ix) {
+      exp_x[ix] = std::min(-x_block[ix], dType(100));
+    }
+    elementwise_exp(length, exp_x, exp_x);
+    for (size_t ix = 0; ix < length; ++ix) {
+      dType s = 1 / (1 + exp_x[ix]);
+      dx_block[ix] = grad[offset + ix] * s * (1 + x_block[ix] * (1 - s));
+    }
+  });
+}
+
+template<std::floating_point dType>
+void softmax(const size_t &n_rows, const size_t &n_cols, const dType *x, const dType &epsilon, dType *y) {
+  utils::threads::parallel_for(0, n_rows, std::max<size_t>(1, ACTIVATION_MIN_CHUNK / std::max<size_t>(n_cols, 1)),
+                               [&](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; ++row) {
+      const dType *x_row = x + row * n_cols;
+      dType *y_row = y + row * n_cols;
+      for (size_t ix = 0; ix < n_cols; ++ix) {
+        y_row[ix] = std::min(x_row[ix], dType(100));
+      }
+      elementwise_exp(n_cols, y_row, y_row);
+      dType exp_sum = 0;
+      for (size_t ix = 0; ix < n_cols; ++ix) {
+        exp_sum += y_row[ix];
+      }
+      exp_sum += epsilon;
+      for (size_t ix = 0; ix < n_cols; ++ix) {
+        y_row[ix] /= exp_sum;
+      }
+    }
+  });
+}
+
+template<std::floating_point dType>
+void negative_log(const size_t &size, const dType *x, const dType &epsilon, dType *y) {
+  for_each_block(size, [&](size_t offset, size_t length) {
+    dType *y_block = y + offset;
+    for (size_t ix = 0; ix < length; ++ix) {
+      y_block[ix] = x[offset + ix] + epsilon;
+    }
+    elementwise_log(length, y_block, y_block);
+    for (size_t ix = 0; ix < length; ++ix) {
+      y_block[ix] = -y_block[ix];
+    }
+  });
+}
+
 template<typename dType>
 void tensor_gemm(const size_t &size_a, const size_t &size_b,
                  const size_t &size_c, const size_t &M, const size_t &N,
@@ -340,57 +812,585 @@ void tensor_gemm(const size_t &size_a, const size_t &size_b,
   // shape_a : [..., M, K]
   // shape_b : [..., K, N]
   // shape_c : [..., M, N]
-  size_t inc_a = M * K;
-  size_t inc_b = K * N;
-  size_t inc_c = M * N;
-  size_t n_blocks_a = size_a / inc_a;
-  size_t n_blocks_b = size_b / inc_b;
+  size_t n_blocks_a = size_a / (M * K);
+  size_t n_blocks_b = size_b / (K * N);
   size_t n_blocks = std::max(n_blocks_a, n_blocks_b);
-  if (n_blocks != n_blocks_b) {
-    // tensor_b is a matrix should be repeated
-    inc_b = 0;
+  // a single matrix on either side is repeated for every block
+  GemmOperand<dType> lhs = {mat_a, false, std::max<size_t>(K, 1), n_blocks_a == n_blocks ? M * K : 0};
+  GemmOperand<dType> rhs = {mat_b, false, std::max<size_t>(N, 1), n_blocks_b == n_blocks ? K * N : 0};
+  tensor_gemm(n_blocks, M, N, K, lhs, rhs, mat_c);
+}
+
+template<typename dType>
+void tensor_gemm(const size_t &n_blocks, const size_t &M, const size_t &N, const size_t &K,
+                 const GemmOperand<dType> &lhs, const GemmOperand<dType> &rhs, dType *mat_c) {
+  if (n_blocks == 1) {
+    gemm(lhs.trans, rhs.trans, M, N, K, lhs.data, lhs.ld, rhs.data, rhs.ld, mat_c, N);
+    return;
   }
-  if (n_blocks != n_blocks_a) {
-    inc_a = 0;
+
+  if (rhs.batch_stride == 0 && !lhs.trans && lhs.batch_stride == M * lhs.ld) {
+    // the blocks of lhs stack up into one tall matrix times the same rhs
+    gemm(false, rhs.trans, M * n_blocks, N, K, lhs.data, lhs.ld, rhs.data, rhs.ld, mat_c, N);
+    return;
   }
 
-  if (n_blocks == 1) {
-    gemm(M, N, K, mat_a, mat_b, mat_c);
-  }
-#if USE_MULTI_THREAD_GEMM_BOOL
-    else {
-      auto threads_p = new utils::threads::ThreadPool();
-      threads_p->start(2);
-
-      // split the tensor into blocks of size M*N or N*K
-      // use thread pool to run the gemm concurrently
-      dType *cur_c_p = mat_c;
-      for (size_t ix = 0; ix < n_blocks; ix++) {
-        const dType *cur_a_p = mat_a + inc_a * ix;
-        const dType *cur_b_p = mat_b + inc_b * ix;
-        threads_p->submit_job(
-            [&]() mutable { gemm(M, N, K, cur_a_p, cur_b_p, cur_c_p); });
-        cur_c_p += inc_c;
+  gemm_batch(lhs.trans, rhs.trans, M, N, K,
+             lhs.data, lhs.ld, lhs.batch_stride,
+             rhs.data, rhs.ld, rhs.batch_stride,
+             mat_c, n_blocks);
+}
+
+// copy a 1-d run with arbitrary increments on both sides
+inline void strided_copy_1d(const size_t &size, const double *src, const size_t &inc_src,
+                            double *dest, const size_t &inc_dest) {
+  cblas_dcopy(size, src, inc_src, dest, inc_dest);
+}
+
+inline void strided_copy_1d(const size_t &size, const float *src, const size_t &inc_src,
+                            float *dest, const size_t &inc_dest) {
+  cblas_scopy(size, src, inc_src, dest, inc_dest);
+}
+
+template<typename dType>
+void strided_copy_1d(const size_t &size, const dType *src, const size_t &inc_src,
+                     dType *dest, const size_t &inc_dest) {
+  if (inc_src == 1 && inc_dest == 1) {
+    memcpy(dest, src, sizeof(dType) * size);
+    return;
+  }
+  for (size_t ix = 0; ix < size; ++ix) {
+    dest[ix * inc_dest] = src[ix * inc_src];
+  }
+}
+
+// side of the square blocks a transposing copy is split into, a block of
+// each side stays in L1
+const size_t TRANSPOSE_TILE = 32;
+// side of the micro-tiles inside a block, fixed so the loops get unrolled
+const size_t TRANSPOSE_MICRO_TILE = 8;
+
+/*
+  transpose_block copies a block where dest is contiguous along rows and src
+  is contiguous along cols: dest[row + col * dest_inc] = src[row * src_inc + col].
+  Each micro-tile reads and writes only a few cache lines.
+*/
+template<typename dType>
+void transpose_block(const size_t &rows, const size_t &cols,
+                     const dType *src, const size_t &src_inc,
+                     dType *dest, const size_t &dest_inc) {
+  const size_t micro = TRANSPOSE_MICRO_TILE;
+  size_t col = 0;
+  for (; col + micro <= cols; col += micro) {
+    size_t row = 0;
+    for (; row + micro <= rows; row += micro) {
+      const dType *src_tile = src + row * src_inc + col;
+      dType *dest_tile = dest + row + col * dest_inc;
+      for (size_t ic = 0; ic < micro; ++ic) {
+        for (size_t ir = 0; ir < micro; ++ir) {
+          dest_tile[ir + ic * dest_inc] = src_tile[ir * src_inc + ic];
+        }
       }
+    }
+    for (; row < rows; ++row) {
+      for (size_t ic = 0; ic < micro; ++ic) {
+        dest[row + (col + ic) * dest_inc] = src[row * src_inc + col + ic];
+      }
+    }
+  }
+  for (; col < cols; ++col) {
+    for (size_t row = 0; row < rows; ++row) {
+      dest[row + col * dest_inc] = src[row * src_inc + col];
+    }
+  }
+}
+
+// OuterAxes walks the merged axes that are not handled by the inner loops
+struct OuterAxes {
+  Dims shape, src_strides, dest_strides;
+  size_t count = 1;
+
+  void add(const size_t &dim, const size_t &src_stride, const size_t &dest_stride) {
+    shape.emplace_back(dim);
+    src_strides.emplace_back(src_stride);
+    dest_strides.emplace_back(dest_stride);
+    count *= dim;
+  }
+
+  void get_offsets(size_t index, size_t &src_offset, size_t &dest_offset) const {
+    src_offset = 0;
+    dest_offset = 0;
+    for (size_t ax = shape.size(); ax-- > 0;) {
+      size_t coord = index % shape[ax];
+      src_offset += coord * src_strides[ax];
+      dest_offset += coord * dest_strides[ax];
+      index /= shape[ax];
+    }
+  }
+
+  // calls func(src_offset, dest_offset) for the indices in [begin, end),
+  // only the first one is found by divisions
+  template<typename Func>
+  void for_range(const size_t &begin, const size_t &end, Func func) const {
+    Dims coord(shape.size(), 0);
+    size_t index = begin;
+    for (size_t ax = shape.size(); ax-- > 0;) {
+      coord[ax] = index % shape[ax];
+      index /= shape[ax];
+    }
+    size_t src_offset, dest_offset;
+    get_offsets(begin, src_offset, dest_offset);
 
-      while (true) {
-        if (!threads_p->busy()) {
+    for (size_t ix = begin; ix < end; ++ix) {
+      func(src_offset, dest_offset);
+      for (size_t ax = shape.size(); ax-- > 0;) {
+        if (++coord[ax] < shape[ax]) {
+          src_offset += src_strides[ax];
+          dest_offset += dest_strides[ax];
           break;
         }
+        src_offset -= (shape[ax] - 1) * src_strides[ax];
+        dest_offset -= (shape[ax] - 1) * dest_strides[ax];
+        coord[ax] = 0;
       }
     }
-#else
-  else {
-    // split the tensor into blocks of size M*N or N*K
-    dType *cur_c_p = mat_c;
-    for (size_t ix = 0; ix < n_blocks; ix++) {
-      const dType *cur_a_p = mat_a + inc_a * ix;
-      const dType *cur_b_p = mat_b + inc_b * ix;
-      gemm(M, N, K, cur_a_p, cur_b_p, cur_c_p);
-      cur_c_p += inc_c;
+  }
+};
+
+// at least this many entries per thread before a copy is split
+const size_t COPY_MIN_CHUNK = 1 << 16;
+
+/*
+  strided_copy copies a multi-array with layout (shape, src_strides) into
+  another buffer with layout (shape, dest_strides).
+  Adjacent axes that are contiguous in both layouts get merged first, so a
+  packed source turns into one single run and a sliced one into a few long runs.
+  When the innermost axis of dest is not the contiguous axis of src, as after
+  a transpose or permute, the pair of those two axes is copied in tiles.
+  The outer axes are split across threads.
+*/
+template<typename dType>
+void strided_copy(const Dims &shape,
+                  const Dims &src_strides, const dType *src,
+                  const Dims &dest_strides, dType *dest) {
+  Dims merged_shape, merged_src, merged_dest;
+  for (size_t ax = 0; ax < shape.size(); ++ax) {
+    if (shape[ax] == 1) {
+      continue;
+    }
+    if (!merged_shape.empty() &&
+      merged_src.back() == shape[ax] * src_strides[ax] &&
+      merged_dest.back() == shape[ax] * dest_strides[ax]) {
+      merged_shape.back() *= shape[ax];
+      merged_src.back() = src_strides[ax];
+      merged_dest.back() = dest_strides[ax];
+      continue;
+    }
+    merged_shape.emplace_back(shape[ax]);
+    merged_src.emplace_back(src_strides[ax]);
+    merged_dest.emplace_back(dest_strides[ax]);
+  }
+
+  if (merged_shape.empty()) {
+    // single element
+    *dest = *src;
+    return;
+  }
+
+  size_t n_axes = merged_shape.size();
+  size_t inner = n_axes - 1;
+
+  // look for the axis src is contiguous along, when dest is contiguous along another one
+  size_t tile_axis = n_axes;
+  if (merged_dest[inner] == 1 && merged_src[inner] != 1) {
+    for (size_t ax = 0; ax < inner; ++ax) {
+      if (merged_src[ax] == 1 && merged_shape[ax] >= TRANSPOSE_MICRO_TILE &&
+        merged_shape[inner] >= TRANSPOSE_MICRO_TILE) {
+        tile_axis = ax;
+      }
+    }
+  }
+
+  if (tile_axis < n_axes) {
+    OuterAxes outer;
+    for (size_t ax = 0; ax < inner; ++ax) {
+      if (ax != tile_axis) {
+        outer.add(merged_shape[ax], merged_src[ax], merged_dest[ax]);
+      }
+    }
+
+    size_t rows = merged_shape[inner], cols = merged_shape[tile_axis];
+    size_t src_inc = merged_src[inner], dest_inc = merged_dest[tile_axis];
+    size_t n_col_blocks = (cols + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    size_t block_size = rows * TRANSPOSE_TILE;
+    utils::threads::parallel_for(
+      0, outer.count * n_col_blocks, std::max<size_t>(1, COPY_MIN_CHUNK / block_size),
+      [&](size_t begin, size_t end) {
+        size_t src_offset, dest_offset;
+        for (size_t unit = begin; unit < end; ++unit) {
+          outer.get_offsets(unit / n_col_blocks, src_offset, dest_offset);
+          size_t col = (unit % n_col_blocks) * TRANSPOSE_TILE;
+          size_t n_cols = std::min(TRANSPOSE_TILE, cols - col);
+          for (size_t row = 0; row < rows; row += TRANSPOSE_TILE) {
+            transpose_block(std::min(TRANSPOSE_TILE, rows - row), n_cols,
+                            src + src_offset + row * src_inc + col, src_inc,
+                            dest + dest_offset + row + col * dest_inc, dest_inc);
+          }
+        }
+      });
+    return;
+  }
+
+  OuterAxes outer;
+  for (size_t ax = 0; ax < inner; ++ax) {
+    outer.add(merged_shape[ax], merged_src[ax], merged_dest[ax]);
+  }
+  size_t run_len = merged_shape[inner];
+  size_t run_src_inc = merged_src[inner];
+  size_t run_dest_inc = merged_dest[inner];
+  utils::threads::parallel_for(
+    0, outer.count, std::max<size_t>(1, COPY_MIN_CHUNK / run_len),
+    [&](size_t begin, size_t end) {
+      outer.for_range(begin, end, [&](const size_t &src_offset, const size_t &dest_offset) {
+        strided_copy_1d(run_len, src + src_offset, run_src_inc,
+                        dest + dest_offset, run_dest_inc);
+      });
+    });
+}
+
+// broadcast_binary_1d runs op over one run, the common stride patterns get
+// their own loops so that the compiler can vectorize them
+template<typename dType, typename BinaryOp>
+void broadcast_binary_1d(const size_t &size,
+                         const dType *lhs, const size_t &inc_lhs,
+                         const dType *rhs, const size_t &inc_rhs,
+                         dType *dest, const size_t &inc_dest, BinaryOp &op) {
+  if (inc_dest == 1 && inc_lhs == 1 && inc_rhs == 1) {
+    for (size_t ix = 0; ix < size; ++ix) {
+      dest[ix] = op(lhs[ix], rhs[ix]);
+    }
+  } else if (inc_dest == 1 && inc_lhs == 1 && inc_rhs == 0) {
+    const dType rhs_value = *rhs;
+    for (size_t ix = 0; ix < size; ++ix) {
+      dest[ix] = op(lhs[ix], rhs_value);
+    }
+  } else if (inc_dest == 1 && inc_lhs == 0 && inc_rhs == 1) {
+    const dType lhs_value = *lhs;
+    for (size_t ix = 0; ix < size; ++ix) {
+      dest[ix] = op(lhs_value, rhs[ix]);
+    }
+  } else {
+    // also covers inc_dest == 0, where dest is accumulated in place
+    for (size_t ix = 0; ix < size; ++ix) {
+      dest[ix * inc_dest] = op(lhs[ix * inc_lhs], rhs[ix * inc_rhs]);
+    }
+  }
+}
+
+/*
+  broadcast_binary computes dest = op(lhs, rhs) element by element, with all
+  three operands laid out over the same shape by their own strides.
+  A stride of 0 repeats an operand along that axis, so a bias vector or a
+  scalar is broadcast without ever being expanded in memory; a dest with
+  stride 0 (aliasing lhs) sums into it, which is how gradients get reduced.
+  Axes are merged like in strided_copy before the odometer walk.
+*/
+template<typename dType, typename BinaryOp>
+void broadcast_binary(const Dims &shape,
+                      const Dims &lhs_strides, const dType *lhs,
+                      const Dims &rhs_strides, const dType *rhs,
+                      const Dims &dest_strides, dType *dest,
+                      BinaryOp op) {
+  Dims merged_shape, merged_lhs, merged_rhs, merged_dest;
+  for (size_t ax = 0; ax < shape.size(); ++ax) {
+    if (shape[ax] == 1) {
+      continue;
+    }
+    if (!merged_shape.empty() &&
+      merged_lhs.back() == shape[ax] * lhs_strides[ax] &&
+      merged_rhs.back() == shape[ax] * rhs_strides[ax] &&
+      merged_dest.back() == shape[ax] * dest_strides[ax]) {
+      merged_shape.back() *= shape[ax];
+      merged_lhs.back() = lhs_strides[ax];
+      merged_rhs.back() = rhs_strides[ax];
+      merged_dest.back() = dest_strides[ax];
+      continue;
     }
+    merged_shape.emplace_back(shape[ax]);
+    merged_lhs.emplace_back(lhs_strides[ax]);
+    merged_rhs.emplace_back(rhs_strides[ax]);
+    merged_dest.emplace_back(dest_strides[ax]);
+  }
+
+  if (merged_shape.empty()) {
+    *dest = op(*lhs, *rhs);
+    return;
   }
-#endif
+
+  size_t n_axes = merged_shape.size();
+  size_t n_runs = 1;
+  for (size_t ax = 0; ax + 1 < n_axes; ++ax) {
+    n_runs *= merged_shape[ax];
+  }
+
+  Dims coord(n_axes, 0);
+  size_t lhs_offset = 0, rhs_offset = 0, dest_offset = 0;
+  for (size_t run = 0; run < n_runs; ++run) {
+    broadcast_binary_1d(merged_shape[n_axes - 1],
+                        lhs + lhs_offset, merged_lhs[n_axes - 1],
+                        rhs + rhs_offset, merged_rhs[n_axes - 1],
+                        dest + dest_offset, merged_dest[n_axes - 1], op);
+
+    for (size_t ax = n_axes - 1; ax-- > 0;) {
+      if (++coord[ax] < merged_shape[ax]) {
+        lhs_offset += merged_lhs[ax];
+        rhs_offset += merged_rhs[ax];
+        dest_offset += merged_dest[ax];
+        break;
+      }
+      lhs_offset -= (merged_shape[ax] - 1) * merged_lhs[ax];
+      rhs_offset -= (merged_shape[ax] - 1) * merged_rhs[ax];
+      dest_offset -= (merged_shape[ax] - 1) * merged_dest[ax];
+      coord[ax] = 0;
+    }
+  }
+}
+
+template<typename dType>
+struct SumReducer {
+  template<typename oType> using rebind = SumReducer<oType>;
+  static inline dType identity() { return 0; }
+  static inline void combine(dType &acc, const dType &value) { acc += value; }
+};
+
+template<typename dType>
+struct MaxReducer {
+  template<typename oType> using rebind = MaxReducer<oType>;
+  static inline dType identity() { return std::numeric_limits<dType>::lowest(); }
+  static inline void combine(dType &acc, const dType &value) { acc = value > acc ? value : acc; }
+};
+
+template<typename dType>
+struct MinReducer {
+  template<typename oType> using rebind = MinReducer<oType>;
+  static inline dType identity() { return std::numeric_limits<dType>::max(); }
+  static inline void combine(dType &acc, const dType &value) { acc = value < acc ? value : acc; }
+};
+
+// reduce_run folds a contiguous run into acc, four independent partial
+// results keep the loop free of a single long dependency chain
+template<typename dType, typename Reducer>
+inline void reduce_run(const size_t &size, const dType *src, dType &acc) {
+  dType lanes[4] = {acc, Reducer::identity(), Reducer::identity(), Reducer::identity()};
+  size_t ix = 0;
+  for (; ix + 4 <= size; ix += 4) {
+    Reducer::combine(lanes[0], src[ix]);
+    Reducer::combine(lanes[1], src[ix + 1]);
+    Reducer::combine(lanes[2], src[ix + 2]);
+    Reducer::combine(lanes[3], src[ix + 3]);
+  }
+  for (; ix < size; ++ix) {
+    Reducer::combine(lanes[0], src[ix]);
+  }
+  Reducer::combine(lanes[0], lanes[1]);
+  Reducer::combine(lanes[2], lanes[3]);
+  Reducer::combine(lanes[0], lanes[2]);
+  acc = lanes[0];
+}
+
+// ReduceLayout is a packed shape after dropping axes of size 1 and merging
+// neighbouring axes that are both reduced or both kept
+struct ReduceLayout {
+  Dims kept_shape, kept_strides;
+  Dims reduced_shape, reduced_strides;
+  bool inner_reduced = false; // whether the innermost merged axis is reduced
+  size_t inner_size = 1;
+
+  ReduceLayout(const Dims &shape, const DimMask &reduce_mask) {
+    Dims sizes, strides;
+    DimMask reduced;
+    size_t stride = 1;
+    for (size_t ax = shape.size(); ax-- > 0;) {
+      if (shape[ax] == 1) {
+        continue;
+      }
+      if (!sizes.empty() && reduced.back() == reduce_mask[ax]) {
+        sizes.back() *= shape[ax];
+      } else {
+        sizes.emplace_back(shape[ax]);
+        strides.emplace_back(stride);
+        reduced.emplace_back(reduce_mask[ax]);
+      }
+      stride *= shape[ax];
+    }
+
+    // outermost first
+    for (size_t ix = sizes.size(); ix-- > 0;) {
+      if (reduced[ix]) {
+        reduced_shape.emplace_back(sizes[ix]);
+        reduced_strides.emplace_back(strides[ix]);
+      } else {
+        kept_shape.emplace_back(sizes[ix]);
+        kept_strides.emplace_back(strides[ix]);
+      }
+    }
+    if (!sizes.empty()) {
+      inner_reduced = reduced[0];
+      inner_size = sizes[0];
+    }
+  }
+
+  // offset of a packed index over the kept axes, skipping the innermost n_skip
+  size_t kept_offset(size_t index, const size_t &n_skip = 0) const {
+    size_t offset = 0;
+    for (size_t ax = kept_shape.size() - n_skip; ax-- > 0;) {
+      offset += (index % kept_shape[ax]) * kept_strides[ax];
+      index /= kept_shape[ax];
+    }
+    return offset;
+  }
+
+  // calls func(offset) for the offset of every coordinate of the reduced axes,
+  // skipping the innermost n_skip of them
+  template<typename Func>
+  void for_each_reduced(const size_t &n_skip, Func func) const {
+    size_t n_axes = reduced_shape.size() - n_skip;
+    Dims coord(n_axes, 0);
+    size_t offset = 0;
+    while (true) {
+      func(offset);
+      size_t ax = n_axes;
+      while (ax-- > 0) {
+        if (++coord[ax] < reduced_shape[ax]) {
+          offset += reduced_strides[ax];
+          break;
+        }
+        offset -= (reduced_shape[ax] - 1) * reduced_strides[ax];
+        coord[ax] = 0;
+      }
+      if (ax == SIZE_MAX) {
+        return;
+      }
+    }
+  }
+};
+
+// at least this many source entries per thread before a reduction is split
+const size_t REDUCE_MIN_CHUNK = 1 << 15;
+
+/*
+  reduce folds a packed multi-array along the axes flagged in reduce_mask and
+  writes the kept axes, packed, to dest. After ReduceLayout coalesces the
+  axes there are two strategies:
+  - the innermost axis is reduced: every output folds contiguous runs, the
+    outputs are split across threads;
+  - the innermost axis is kept: every reduced coordinate contributes a
+    contiguous row that is combined elementwise into a row of outputs,
+    threads take disjoint ranges of outputs.
+*/
+template<typename dType, typename Reducer>
+void reduce(const Dims &shape, const DimMask &reduce_mask,
+            const dType *src, dType *dest) {
+  ReduceLayout layout(shape, reduce_mask);
+
+  size_t out_size = 1, reduce_size = 1;
+  for (auto dim : layout.kept_shape) {
+    out_size *= dim;
+  }
+  for (auto dim : layout.reduced_shape) {
+    reduce_size *= dim;
+  }
+  size_t min_chunk = std::max<size_t>(1, REDUCE_MIN_CHUNK / std::max<size_t>(reduce_size, 1));
+
+  if (layout.reduced_shape.empty()) {
+    memcpy(dest, src, sizeof(dType) * out_size);
+    return;
+  }
+
+  if (layout.inner_reduced) {
+    size_t run_size = layout.inner_size;
+    utils::threads::parallel_for(0, out_size, min_chunk, [&](size_t begin, size_t end) {
+      for (size_t out_index = begin; out_index < end; ++out_index) {
+        const dType *base = src + layout.kept_offset(out_index);
+        dType acc = Reducer::identity();
+        layout.for_each_reduced(1, [&](const size_t &offset) {
+          reduce_run<dType, Reducer>(run_size, base + offset, acc);
+        });
+        dest[out_index] = acc;
+      }
+    });
+    return;
+  }
+
+  size_t row_size = layout.inner_size;
+  utils::threads::parallel_for(0, out_size, min_chunk, [&](size_t begin, size_t end) {
+    size_t out_index = begin;
+    while (out_index < end) {
+      // a piece of one output row
+      size_t row = out_index / row_size;
+      size_t col_begin = out_index % row_size;
+      size_t col_end = std::min(row_size, col_begin + end - out_index);
+      const dType *base = src + layout.kept_offset(row, 1) + col_begin;
+      dType *dest_row = dest + out_index;
+      size_t n_cols = col_end - col_begin;
+
+      std::fill(dest_row, dest_row + n_cols, Reducer::identity());
+      layout.for_each_reduced(0, [&](const size_t &offset) {
+        const dType *src_row = base + offset;
+        for (size_t col = 0; col < n_cols; ++col) {
+          Reducer::combine(dest_row[col], src_row[col]);
+        }
+      });
+      out_index += n_cols;
+    }
+  });
+}
+
+/*
+  arg_reduce writes, for every line along the middle axis of a packed
+  [outer, len, inner] array, the index of the entry that is preferred by
+  better(a, b) over all others; ties keep the first index.
+*/
+template<typename dType, typename Compare>
+void arg_reduce(const size_t &outer, const size_t &len, const size_t &inner,
+                const dType *src, dType *dest, Compare better) {
+  size_t min_chunk = std::max<size_t>(1, REDUCE_MIN_CHUNK / std::max<size_t>(len, 1));
+  utils::threads::parallel_for(0, outer * inner, min_chunk, [&](size_t begin, size_t end) {
+    if (inner == 1) {
+      for (size_t out_index = begin; out_index < end; ++out_index) {
+        const dType *line = src + out_index * len;
+        size_t best = 0;
+        for (size_t ix = 1; ix < len; ++ix) {
+          best = better(line[ix], line[best]) ? ix : best;
+        }
+        dest[out_index] = static_cast<dType>(best);
+      }
+      return;
+    }
+
+    std::vector<dType> best_values;
+    size_t out_index = begin;
+    while (out_index < end) {
+      size_t row = out_index / inner;
+      size_t col_begin = out_index % inner;
+      size_t n_cols = std::min(inner, col_begin + end - out_index) - col_begin;
+      const dType *base = src + row * len * inner + col_begin;
+      dType *dest_row = dest + out_index;
+
+      best_values.assign(base, base + n_cols);
+      std::fill(dest_row, dest_row + n_cols, static_cast<dType>(0));
+      for (size_t ix = 1; ix < len; ++ix) {
+        const dType *src_row = base + ix * inner;
+        for (size_t col = 0; col < n_cols; ++col) {
+          if (better(src_row[col], best_values[col])) {
+            best_values[col] = src_row[col];
+            dest_row[col] = static_cast<dType>(ix);
+          }
+        }
+      }
+      out_index += n_cols;
+    }
+  });
 }
 
 template<typename dType>
@@ -414,8 +1414,8 @@ void tensor_kron_product(const size_t &size_a, const size_t &size_b,
     size_t index_a = 0;
     size_t index_b = 0;
     for (size_t ix = 0; ix < n_blocks; ix++) {
-      const dType *cur_a_p = mat_a + inc_a;
-      const dType *cur_b_p = mat_b + inc_b;
+      const dType *cur_a_p = mat_a + index_a;
+      const dType *cur_b_p = mat_b + index_b;
       kron2d(row_a, col_a, row_b, col_b, cur_a_p, cur_b_p, cur_c_p);
       index_a += inc_a;
       index_b += inc_b;
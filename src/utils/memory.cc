@@ -0,0 +1,253 @@
+#include "utils/memory.h"
+
+#include <new>
+#include <string>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace utils {
+namespace memory {
+
+namespace {
+size_t get_default_huge_page_threshold() {
+  const char *env_threshold = std::getenv("ADGC_HUGE_PAGE_THRESHOLD");
+  if (env_threshold != nullptr) {
+    try {
+      return std::stoull(env_threshold);
+    } catch (const std::exception &) {}
+  }
+  return DEFAULT_HUGE_PAGE_THRESHOLD;
+}
+
+std::atomic<size_t> huge_page_threshold = get_default_huge_page_threshold();
+}
+
+size_t get_huge_page_threshold() {
+  return huge_page_threshold.load(std::memory_order_relaxed);
+}
+
+void set_huge_page_threshold(const size_t &bytes) {
+  huge_page_threshold.store(bytes, std::memory_order_relaxed);
+}
+
+void *aligned_malloc(const size_t &bytes) {
+  size_t threshold = get_huge_page_threshold();
+  size_t alignment = threshold != 0 && bytes >= threshold ? HUGE_PAGE_SIZE : MEMORY_ALIGNMENT;
+  // aligned_alloc requires the size to be a multiple of the alignment
+  size_t padded = (bytes + alignment - 1) / alignment * alignment;
+  void *ptr = std::aligned_alloc(alignment, padded == 0 ? alignment : padded);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+#ifdef __linux__
+  if (alignment == HUGE_PAGE_SIZE) {
+    // only advice, the buffer is still usable when THP is disabled
+    madvise(ptr, padded, MADV_HUGEPAGE);
+  }
+#endif
+  return ptr;
+}
+
+void aligned_free(void *ptr) {
+  std::free(ptr);
+}
+
+void *AlignedAllocator::allocate(const size_t &bytes) {
+  ++misses_;
+  bytes_in_use_ += bytes;
+  return aligned_malloc(bytes);
+}
+
+void AlignedAllocator::deallocate(void *ptr, const size_t &bytes) {
+  bytes_in_use_ -= bytes;
+  aligned_free(ptr);
+}
+
+AllocatorStats AlignedAllocator::get_stats() const {
+  AllocatorStats stats;
+  stats.misses = misses_;
+  stats.bytes_in_use = bytes_in_use_;
+  return stats;
+}
+
+namespace {
+std::atomic<size_t> caching_allocator_count = 0;
+// set when the thread local caches are gone, tensors in static storage can
+// still be released after that on the main thread
+thread_local bool thread_caches_destroyed = false;
+}
+
+CachingAllocator::CachingAllocator(const size_t &max_cached_bytes_per_thread)
+  : id_(caching_allocator_count++), max_cached_bytes_(max_cached_bytes_per_thread) {}
+
+CachingAllocator::~CachingAllocator() {
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  for (auto &cache : caches_) {
+    std::lock_guard<std::mutex> cache_lock(cache->mutex);
+    release_blocks(*cache);
+    cache->owner = nullptr;
+  }
+}
+
+size_t CachingAllocator::get_size_class(const size_t &bytes) {
+  size_t shift = MIN_CLASS_SHIFT;
+  while (shift <= MAX_CLASS_SHIFT && (size_t(1) << shift) < bytes) {
+    ++shift;
+  }
+  return shift;
+}
+
+CachingAllocator::ThreadCache *CachingAllocator::get_thread_cache() {
+  // a thread keeps one cache per allocator; the registry holds another
+  // reference so that trim() can reach caches of other threads
+  struct LocalCaches {
+    std::unordered_map<size_t, std::shared_ptr<ThreadCache>> caches;
+    ~LocalCaches() {
+      // give the blocks of a finishing thread back to the system
+      thread_caches_destroyed = true;
+      for (auto &cache_pair : caches) {
+        std::lock_guard<std::mutex> lock(cache_pair.second->mutex);
+        if (cache_pair.second->owner != nullptr) {
+          cache_pair.second->owner->release_blocks(*cache_pair.second);
+        }
+      }
+    }
+  };
+  if (thread_caches_destroyed) {
+    return nullptr;
+  }
+  thread_local LocalCaches local_caches;
+
+  auto cache_iter = local_caches.caches.find(id_);
+  if (cache_iter != local_caches.caches.end()) {
+    return cache_iter->second.get();
+  }
+
+  auto cache = std::make_shared<ThreadCache>();
+  cache->owner = this;
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    caches_.emplace_back(cache);
+  }
+  local_caches.caches[id_] = cache;
+  return cache.get();
+}
+
+void *CachingAllocator::allocate(const size_t &bytes) {
+  size_t size_class = get_size_class(bytes);
+  if (size_class > MAX_CLASS_SHIFT) {
+    ++misses_;
+    bytes_in_use_ += bytes;
+    return aligned_malloc(bytes);
+  }
+
+  size_t class_bytes = size_t(1) << size_class;
+  bytes_in_use_ += class_bytes;
+
+  ThreadCache *cache = get_thread_cache();
+  if (cache != nullptr) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    std::vector<void *> &free_list = cache->free_lists[size_class];
+    if (!free_list.empty()) {
+      void *ptr = free_list.back();
+      free_list.pop_back();
+      cache->bytes_cached -= class_bytes;
+      bytes_cached_ -= class_bytes;
+      ++hits_;
+      return ptr;
+    }
+  }
+
+  ++misses_;
+  return aligned_malloc(class_bytes);
+}
+
+void CachingAllocator::deallocate(void *ptr, const size_t &bytes) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  size_t size_class = get_size_class(bytes);
+  if (size_class > MAX_CLASS_SHIFT) {
+    bytes_in_use_ -= bytes;
+    aligned_free(ptr);
+    return;
+  }
+
+  size_t class_bytes = size_t(1) << size_class;
+  bytes_in_use_ -= class_bytes;
+
+  ThreadCache *cache = get_thread_cache();
+  if (cache != nullptr) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    if (cache->bytes_cached + class_bytes <= max_cached_bytes_) {
+      cache->free_lists[size_class].emplace_back(ptr);
+      cache->bytes_cached += class_bytes;
+      bytes_cached_ += class_bytes;
+      return;
+    }
+  }
+
+  aligned_free(ptr);
+}
+
+void CachingAllocator::release_blocks(ThreadCache &cache) {
+  for (size_t size_class = MIN_CLASS_SHIFT; size_class <= MAX_CLASS_SHIFT; ++size_class) {
+    for (void *ptr : cache.free_lists[size_class]) {
+      aligned_free(ptr);
+    }
+    cache.free_lists[size_class].clear();
+  }
+  bytes_cached_ -= cache.bytes_cached;
+  cache.bytes_cached = 0;
+}
+
+void CachingAllocator::trim() {
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  for (auto &cache : caches_) {
+    std::lock_guard<std::mutex> cache_lock(cache->mutex);
+    release_blocks(*cache);
+  }
+
+  // caches only referenced by the registry belong to finished threads
+  std::erase_if(caches_, [](const std::shared_ptr<ThreadCache> &cache) {
+    return cache.use_count() == 1;
+  });
+}
+
+AllocatorStats CachingAllocator::get_stats() const {
+  AllocatorStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.bytes_cached = bytes_cached_;
+  stats.bytes_in_use = bytes_in_use_;
+  return stats;
+}
+
+namespace {
+Allocator *get_default_allocator() {
+  // never destroyed, tensors in static storage may be freed after main returns
+  static CachingAllocator *default_allocator = new CachingAllocator();
+  return default_allocator;
+}
+
+std::atomic<Allocator *> current_allocator = nullptr;
+}
+
+Allocator *get_allocator() {
+  Allocator *allocator = current_allocator.load(std::memory_order_acquire);
+  if (allocator == nullptr) {
+    return get_default_allocator();
+  }
+  return allocator;
+}
+
+void set_allocator(Allocator *allocator) {
+  current_allocator.store(allocator, std::memory_order_release);
+}
+
+} // namespace memory
+} // namespace utils
@@ -0,0 +1,116 @@
+#include "utils/perf.h"
+
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace utils {
+namespace perf {
+
+namespace {
+#ifdef __linux__
+int open_event(const uint32_t &type, const uint64_t &config) {
+  perf_event_attr attr{};
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // also count the threads started later on, the runtime workers and the
+  // BLAS threads
+  attr.inherit = 1;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+uint64_t get_cache_config(const uint64_t &result) {
+  return PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+}
+#endif
+}
+
+PerfCounters::PerfCounters() {
+  fds_.fill(-1);
+  counts_.fill(0);
+#ifdef __linux__
+  fds_[dtlb_loads] = open_event(PERF_TYPE_HW_CACHE, get_cache_config(PERF_COUNT_HW_CACHE_RESULT_ACCESS));
+  fds_[dtlb_load_misses] = open_event(PERF_TYPE_HW_CACHE, get_cache_config(PERF_COUNT_HW_CACHE_RESULT_MISS));
+  fds_[page_faults] = open_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+void PerfCounters::start() {
+  counts_.fill(0);
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+void PerfCounters::stop() {
+#ifdef __linux__
+  for (size_t ix = 0; ix < n_events; ++ix) {
+    if (fds_[ix] < 0) {
+      continue;
+    }
+    ioctl(fds_[ix], PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t count = 0;
+    if (read(fds_[ix], &count, sizeof(count)) == sizeof(count)) {
+      counts_[ix] = count;
+    }
+  }
+#endif
+}
+
+bool PerfCounters::is_available(const Event &event) const {
+  return fds_[event] >= 0;
+}
+
+uint64_t PerfCounters::get(const Event &event) const {
+  return counts_[event];
+}
+
+double PerfCounters::get_dtlb_miss_rate() const {
+  if (counts_[dtlb_loads] == 0) {
+    return 0;
+  }
+  return 1000. * counts_[dtlb_load_misses] / counts_[dtlb_loads];
+}
+
+std::string PerfCounters::to_string() const {
+  std::stringstream out;
+  if (is_available(dtlb_loads) && is_available(dtlb_load_misses)) {
+    out << "dTLB loads " << get(dtlb_loads) << ", dTLB load misses " << get(dtlb_load_misses)
+        << " (" << get_dtlb_miss_rate() << " per mille), ";
+  } else {
+    out << "dTLB counters unavailable, ";
+  }
+  if (is_available(page_faults)) {
+    out << "page faults " << get(page_faults);
+  } else {
+    out << "page faults unavailable";
+  }
+  return out.str();
+}
+
+} // namespace perf
+} // namespace utils
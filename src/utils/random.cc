@@ -0,0 +1,24 @@
+#include "utils/random.h"
+
+namespace utils {
+namespace random {
+
+namespace {
+std::atomic<uint64_t> global_seed = 0;
+std::atomic<uint64_t> next_stream = 0;
+}
+
+Philox get_generator(const size_t &seed) {
+  if (seed != SIZE_MAX) {
+    return Philox(seed);
+  }
+  return Philox(global_seed.load(std::memory_order_relaxed), next_stream.fetch_add(1, std::memory_order_relaxed) + 1);
+}
+
+void manual_seed(const uint64_t &seed) {
+  global_seed.store(seed, std::memory_order_relaxed);
+  next_stream.store(0, std::memory_order_relaxed);
+}
+
+} // namespace random
+} // namespace utils
@@ -0,0 +1,65 @@
+#ifndef ADGC_UTILS_RANDOM_TCC_
+#define ADGC_UTILS_RANDOM_TCC_
+
+#include "utils/random.h"
+
+namespace utils {
+namespace random {
+
+// at least this many blocks of four per thread before a fill is split
+const size_t RANDOM_MIN_CHUNK = 1 << 13;
+
+// fill_blocks hands the words of every block to transform, which turns them
+// into four values; the last block is cut to the size
+template<typename dType, typename Transform>
+void fill_blocks(const size_t &size, const Philox &generator, dType *dest, Transform transform) {
+  size_t n_blocks = (size + 3) / 4;
+  threads::parallel_for(0, n_blocks, RANDOM_MIN_CHUNK, [&](size_t begin, size_t end) {
+    double values[4];
+    for (size_t block = begin; block < end; ++block) {
+      transform(generator(block), values);
+      size_t offset = block * 4;
+      size_t count = std::min<size_t>(4, size - offset);
+      for (size_t ix = 0; ix < count; ++ix) {
+        dest[offset + ix] = static_cast<dType>(values[ix]);
+      }
+    }
+  });
+}
+
+template<typename dType>
+void fill_uniform(const size_t &size, const Philox &generator, const double &low, const double &high, dType *dest) {
+  double range = high - low;
+  fill_blocks(size, generator, dest, [&](const std::array<uint32_t, 4> &words, double *values) {
+    for (size_t ix = 0; ix < 4; ++ix) {
+      values[ix] = low + range * to_unit(words[ix]);
+    }
+  });
+}
+
+template<typename dType>
+void fill_normal(const size_t &size, const Philox &generator, const double &mean, const double &stddev, dType *dest) {
+  // Box-Muller, every pair of words gives two values
+  fill_blocks(size, generator, dest, [&](const std::array<uint32_t, 4> &words, double *values) {
+    for (size_t ix = 0; ix < 4; ix += 2) {
+      double radius = stddev * std::sqrt(-2. * std::log(to_unit(words[ix])));
+      double angle = 2. * M_PI * to_unit(words[ix + 1]);
+      values[ix] = mean + radius * std::cos(angle);
+      values[ix + 1] = mean + radius * std::sin(angle);
+    }
+  });
+}
+
+template<typename dType>
+void fill_bernoulli(const size_t &size, const Philox &generator, const double &p, dType *dest) {
+  fill_blocks(size, generator, dest, [&](const std::array<uint32_t, 4> &words, double *values) {
+    for (size_t ix = 0; ix < 4; ++ix) {
+      values[ix] = to_unit(words[ix]) < p ? 1. : 0.;
+    }
+  });
+}
+
+} // namespace random
+} // namespace utils
+
+#endif //ADGC_UTILS_RANDOM_TCC_
@@ -1,5 +1,12 @@
 #include "utils/thread.h"
 
+#include <mkl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+
 namespace utils {
 namespace threads {
 
@@ -66,5 +73,290 @@ void ThreadPool::thread_loop() {
   }
 }
 
+namespace {
+// set on the threads running a chunk of parallel_for
+thread_local bool in_parallel_region = false;
+// position of the runtime worker running on this thread, SIZE_MAX elsewhere
+thread_local size_t worker_index = SIZE_MAX;
+
+typedef std::function<void()> Task;
+
+// ChunkScope marks the thread as running a chunk of parallel_for
+class ChunkScope {
+ public:
+  ChunkScope() : previous_(in_parallel_region) { in_parallel_region = true; }
+  ~ChunkScope() { in_parallel_region = previous_; }
+
+ private:
+  bool previous_;
+  MklThreadsScope mkl_scope_{1};
+};
+
+class Runtime {
+ public:
+  void start(const size_t &n_workers);
+  void stop();
+  void push(Task task);
+  // run_one runs a queued task on the calling thread, false if none is found
+  bool run_one();
+  inline size_t get_n_workers() const { return workers_.size(); }
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> n_queued_ = 0;
+  std::atomic<size_t> next_worker_ = 0;
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool should_terminate_ = false;
+
+  bool take(Task &task);
+  void worker_loop(const size_t &index);
+};
+
+void Runtime::start(const size_t &n_workers) {
+  should_terminate_ = false;
+  // all the deques exist before any worker tries to steal from them
+  for (size_t ix = 0; ix < n_workers; ++ix) {
+    workers_.emplace_back(std::make_unique<Worker>());
+  }
+  for (size_t ix = 0; ix < n_workers; ++ix) {
+    threads_.emplace_back(&Runtime::worker_loop, this, ix);
+  }
+}
+
+void Runtime::stop() {
+  {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    should_terminate_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &worker_thread : threads_) {
+    worker_thread.join();
+  }
+  threads_.clear();
+  workers_.clear();
+}
+
+void Runtime::push(Task task) {
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+
+  // a worker keeps the tasks it spawns, others deal them round-robin
+  size_t index = worker_index < workers_.size() ? worker_index : next_worker_++ % workers_.size();
+  {
+    std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+    workers_[index]->tasks.emplace_back(std::move(task));
+  }
+  ++n_queued_;
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+  }
+  wake_.notify_one();
+}
+
+// take pops the newest task of the own deque, or steals the oldest one of another
+bool Runtime::take(Task &task) {
+  size_t n_workers = workers_.size();
+  if (worker_index < n_workers) {
+    Worker &own = *workers_[worker_index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      --n_queued_;
+      return true;
+    }
+  }
+
+  size_t first = worker_index < n_workers ? worker_index + 1 : 0;
+  for (size_t ix = 0; ix < n_workers; ++ix) {
+    Worker &victim = *workers_[(first + ix) % n_workers];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      --n_queued_;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Runtime::run_one() {
+  Task task;
+  if (!take(task)) {
+    return false;
+  }
+  MklThreadsScope mkl_scope(1);
+  task();
+  return true;
+}
+
+void Runtime::worker_loop(const size_t &index) {
+  worker_index = index;
+  mkl_set_num_threads_local(1);
+  while (true) {
+    Task task;
+    if (take(task)) {
+      task();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this] { return n_queued_ > 0 || should_terminate_; });
+    if (should_terminate_ && n_queued_ == 0) {
+      return;
+    }
+  }
+}
+
+size_t get_default_num_threads() {
+  const char *env_threads = std::getenv("ADGC_NUM_THREADS");
+  if (env_threads != nullptr && std::atoi(env_threads) > 0) {
+    return std::atoi(env_threads);
+  }
+#if ADGC_MULTI_THREADS_NUM_
+  size_t system_thread_num = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  return std::min<size_t>(system_thread_num, ADGC_MULTI_THREADS_NUM_);
+#else
+  return 1;
+#endif
+}
+
+// the runtime shared by the whole process, started on first use
+Runtime *get_runtime() {
+  static Runtime *runtime = [] {
+    // never destroyed, so no worker is joined during static destruction
+    auto *shared_runtime = new Runtime();
+    shared_runtime->start(get_default_num_threads() - 1);
+    return shared_runtime;
+  }();
+  return runtime;
+}
+}
+
+MklThreadsScope::MklThreadsScope(const size_t &num_threads) {
+  if (num_threads > 0) {
+    // a previous local setting of 0 stands for the global one
+    previous_ = mkl_set_num_threads_local(static_cast<int>(num_threads));
+  }
+}
+
+MklThreadsScope::~MklThreadsScope() {
+  if (previous_ >= 0) {
+    mkl_set_num_threads_local(previous_);
+  }
+}
+
+size_t get_num_threads() {
+  return get_runtime()->get_n_workers() + 1;
+}
+
+void set_num_threads(const size_t &num_threads) {
+  Runtime *runtime = get_runtime();
+  runtime->stop();
+  runtime->start(std::max<size_t>(num_threads, 1) - 1);
+  mkl_set_num_threads(static_cast<int>(std::max<size_t>(num_threads, 1)));
+}
+
+void schedule(std::function<void()> task) {
+  get_runtime()->push(std::move(task));
+}
+
+TaskGroup::~TaskGroup() {
+  try {
+    wait();
+  } catch (...) {
+    // errors are only reported by an explicit wait()
+  }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+  ++pending_;
+  schedule([this, task = std::move(task)] {
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (error_ == nullptr) {
+        error_ = std::current_exception();
+      }
+    }
+    // notified under the lock, so the group outlives the notification
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_ == 0) {
+      done_.notify_all();
+    }
+  });
+}
+
+void TaskGroup::wait() {
+  Runtime *runtime = get_runtime();
+  while (pending_ > 0) {
+    // help with queued tasks, ours or not, instead of blocking a thread
+    if (runtime->run_one()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait_for(lock, std::chrono::milliseconds(1), [this] { return pending_ == 0; });
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (error_ != nullptr) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void parallel_for(const size_t &begin, const size_t &end, const size_t &min_chunk,
+                  const std::function<void(size_t, size_t)> &body) {
+  if (end <= begin) {
+    return;
+  }
+
+  size_t total = end - begin;
+  size_t n_chunks = std::min(get_num_threads(), (total + min_chunk - 1) / std::max<size_t>(min_chunk, 1));
+  if (n_chunks <= 1 || in_parallel_region) {
+    body(begin, end);
+    return;
+  }
+
+  size_t chunk_size = (total + n_chunks - 1) / n_chunks;
+  n_chunks = (total + chunk_size - 1) / chunk_size;
+
+  auto run_chunk = [&body](size_t chunk_begin, size_t chunk_end) {
+    ChunkScope scope;
+    body(chunk_begin, chunk_end);
+  };
+
+  TaskGroup group;
+  for (size_t chunk = 1; chunk < n_chunks; ++chunk) {
+    size_t chunk_begin = begin + chunk * chunk_size;
+    size_t chunk_end = std::min(end, chunk_begin + chunk_size);
+    group.run([&run_chunk, chunk_begin, chunk_end] { run_chunk(chunk_begin, chunk_end); });
+  }
+
+  std::exception_ptr error = nullptr;
+  try {
+    run_chunk(begin, std::min(end, begin + chunk_size));
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // the other chunks reference body, wait for them before leaving
+  group.wait();
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
 } // namespace threads
-} // namespace utils
\ No newline at end of file
+} // namespace utils
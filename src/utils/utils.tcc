@@ -14,6 +14,15 @@ std::string vector_to_str(const std::vector<T, A> &vec) {
   return ss.str();
 }
 
+template <typename T, size_t N>
+std::string vector_to_str(const SmallVector<T, N> &vec) {
+  std::stringstream ss;
+  for (auto val : vec) {
+    ss << std::to_string(val) << " ";
+  }
+  return ss.str();
+}
+
 // convert a matrix to string
 template <typename T>
 std::string array_to_str(size_t m, size_t n, T *p, std::string name) {
@@ -24,7 +33,8 @@ std::string array_to_str(size_t m, size_t n, T *p, std::string name) {
   for (int i = 0; i < m; i++) {
     ss << "[ ";
     for (int j = 0; j < n; j++) {
-      ss << p[i * n + j];
+      // promoted so that 8-bit integers print as numbers, not characters
+      ss << +p[i * n + j];
       if (j < n - 1) {
         ss << "\t";
       }
@@ -38,7 +48,7 @@ std::string array_to_str(size_t m, size_t n, T *p, std::string name) {
 }
 
 template <typename T>
-std::string multi_array_to_str(const std::vector<size_t> &shape, T *arr_p,
+std::string multi_array_to_str(const Dims &shape, T *arr_p,
                                const std::string &name) {
   std::stringstream ss;
   if (!name.empty()) {
@@ -56,7 +66,7 @@ std::string multi_array_to_str(const std::vector<size_t> &shape, T *arr_p,
   }
 
   {
-    auto strides = std::vector<size_t>(rank, 1);
+    auto strides = Dims(rank, 1);
     for (int ix = rank - 2; ix >= 0; ix--) {
       strides[ix] = strides[ix + 1] * shape[ix + 1];
     }
@@ -71,8 +81,8 @@ std::string multi_array_to_str(const std::vector<size_t> &shape, T *arr_p,
 
 template <typename T>
 void multi_array_to_str_helper(size_t rank, size_t cur_axis,
-                               const std::vector<size_t> &shape,
-                               const std::vector<size_t> &strides, T *p_start,
+                               const Dims &shape,
+                               const Dims &strides, T *p_start,
                                T *p_end, std::stringstream &out) {
   if (cur_axis == rank - 2) {
     out << "[ " << array_to_str(shape[rank - 2], shape[rank - 1], p_start)
@@ -107,31 +117,31 @@ template std::string array_to_str<double>(size_t m, size_t n, double *p,
 // template std::string array_to_str<bool>(size_t m, size_t n, bool *p,
 //                                         std::string name = "");
 template std::string
-multi_array_to_str<int32_t>(const std::vector<size_t> &shape, int32_t *arr_p,
+multi_array_to_str<int32_t>(const Dims &shape, int32_t *arr_p,
                             const std::string &name = "");
 
-template std::string multi_array_to_str<float>(const std::vector<size_t> &shape,
+template std::string multi_array_to_str<float>(const Dims &shape,
                                                float *arr_p,
                                                const std::string &name = "");
 
 template void multi_array_to_str_helper<int32_t>(
-    size_t rank, size_t cur_axis, const std::vector<size_t> &shape,
-    const std::vector<size_t> &axis_inc, int32_t *p_start, int32_t *p_end,
+    size_t rank, size_t cur_axis, const Dims &shape,
+    const Dims &axis_inc, int32_t *p_start, int32_t *p_end,
     std::stringstream &out);
 
 template void multi_array_to_str_helper<float>(
-    size_t rank, size_t cur_axis, const std::vector<size_t> &shape,
-    const std::vector<size_t> &axis_inc, float *p_start, float *p_end,
+    size_t rank, size_t cur_axis, const Dims &shape,
+    const Dims &axis_inc, float *p_start, float *p_end,
     std::stringstream &out);
 
 template void multi_array_to_str_helper<double>(
-    size_t rank, size_t cur_axis, const std::vector<size_t> &shape,
-    const std::vector<size_t> &axis_inc, double *p_start, double *p_end,
+    size_t rank, size_t cur_axis, const Dims &shape,
+    const Dims &axis_inc, double *p_start, double *p_end,
     std::stringstream &out);
 
 // template void multi_array_to_str_helper<bool>(
-//     size_t rank, size_t cur_axis, const std::vector<size_t> &shape,
-//     const std::vector<size_t> &axis_inc, bool *p, std::stringstream &out);
+//     size_t rank, size_t cur_axis, const Dims &shape,
+//     const Dims &axis_inc, bool *p, std::stringstream &out);
 
 } // namespace utils
 
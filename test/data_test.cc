@@ -71,6 +71,28 @@ TEST(DataSetTest, CsvDataSetTest) {
   }
 }
 
+TEST(DataSetTest, NpyDataSetTest) {
+  std::string dir = std::filesystem::temp_directory_path().string();
+  tensor::io::save_npy(dir + "/adgc_features.npy", tensor::Tensor<float>({5, 2}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  tensor::io::save_npy(dir + "/adgc_labels.npy", tensor::Tensor<int32_t>({5}, {0, 1, 2, 1, 0}));
+
+  auto data_set = data::NpyDataset(dir + "/adgc_features.npy", dir + "/adgc_labels.npy", 2, true, false);
+  EXPECT_EQ(data_set.get_label_count(), 3);
+  EXPECT_EQ(data_set.get_data_count(), 5);
+
+  DataPair data_pair = data_set.get_next();
+  EXPECT_THAT(data_pair.first.to_vector(), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(data_pair.second.to_vector(), ElementsAre(1, 0, 0, 0, 1, 0));
+  data_set.get_next();
+  data_pair = data_set.get_next();
+  EXPECT_EQ(data_pair.first.get_shape(), std::vector<size_t>({1, 2}));
+  EXPECT_THAT(data_pair.second.to_vector(), ElementsAre(1, 0, 0));
+  EXPECT_FALSE(data_set.has_next());
+
+  std::filesystem::remove(dir + "/adgc_features.npy");
+  std::filesystem::remove(dir + "/adgc_labels.npy");
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   assert(argc == 2);
@@ -1,12 +1,27 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <iostream>
 
 #include "autodiff/component/functional.h"
 #include "autodiff/component/variable.h"
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::ElementsAre;
+
 typedef auto_diff::Graph g;
 typedef auto_diff::Variable v;
 
+// the gradients summed up in another order differ by a few roundings
+const double GRAD_TOLERANCE = std::max(1e-12, 16. * std::numeric_limits<auto_diff::DScalar>::epsilon());
+
+// a variable too big to share the chunks of the node arena
+struct BigVariable : public v {
+  char payload[32 * 1024];
+  BigVariable(const tensor::TensorShape &shape, g *graph) : v(shape, graph) {}
+};
+
 TEST(GraphTest, ConstructorDestructorTest) {
   g *graph_ptr = new g();
 
@@ -28,6 +43,293 @@ TEST(GraphTest, ConstructorDestructorTest) {
   SUCCEED();
 }
 
+TEST(GraphTest, CompileTest) {
+  g *graph_ptr = new g();
+
+  {
+    v *pv1 = new v({2, 2}, graph_ptr);
+    v *pv2 = new v({2, 1}, graph_ptr);
+    v *pv3 = new v({1}, graph_ptr);
+
+    auto matmul = new auto_diff::functional::MatMul(pv1, pv2, graph_ptr);
+    auto add = new auto_diff::functional::Add(matmul, pv3, graph_ptr);
+    auto relu = new auto_diff::functional::ReLU(add, graph_ptr);
+    // add is reached through two paths
+    auto matsum = new auto_diff::functional::MatSum({add, relu}, graph_ptr);
+    auto target = new auto_diff::functional::ReduceSum(matsum, graph_ptr);
+
+    auto_diff::ExecutionPlan plan = graph_ptr->compile({target});
+    std::vector<auto_diff::Node *> expected = {matmul, add, relu, matsum, target};
+    ASSERT_EQ(plan.get_nodes(), expected);
+
+    pv1->assign_value(auto_diff::DTensor({2, 2}, {1, 2, 3, 4}));
+    pv2->assign_value(auto_diff::DTensor({2, 1}, {1, -1}));
+    pv3->assign_value(auto_diff::DTensor({1}, 0.5));
+    plan.forward();
+    // add : {-0.5, -0.5}, relu : {0, 0}
+    EXPECT_DOUBLE_EQ(target->get_value().get_value(), -1.);
+
+    pv3->assign_value(auto_diff::DTensor({1}, 2.));
+    plan.forward();
+    // add : {1, 1}, relu : {1, 1}
+    EXPECT_DOUBLE_EQ(target->get_value().get_value(), 4.);
+
+    target->forward();
+    EXPECT_DOUBLE_EQ(target->get_value().get_value(), 4.);
+
+    // add gets a gradient of 2 from matsum and relu together
+    plan.backward({pv1, pv2, pv3});
+    EXPECT_THAT(pv1->get_grad().to_vector(), ElementsAre(2., -2., 2., -2.));
+    EXPECT_THAT(pv2->get_grad().to_vector(), ElementsAre(8., 12.));
+    EXPECT_THAT(pv3->get_grad().to_vector(), ElementsAre(4.));
+    EXPECT_THAT(target->get_grad().to_vector(), ElementsAre(1.));
+    // the inner gradients are dropped once they are consumed
+    EXPECT_TRUE(add->is_grad_empty());
+    EXPECT_TRUE(matmul->is_grad_empty());
+
+    // a second sweep starts over instead of adding to the last one
+    plan.backward({pv1, pv2, pv3});
+    EXPECT_THAT(pv2->get_grad().to_vector(), ElementsAre(8., 12.));
+  }
+  graph_ptr->remove_all();
+  delete graph_ptr;
+}
+
+TEST(GraphTest, MemoryPlanTest) {
+  g *graph_ptr = new g();
+
+  {
+    v *pv1 = new v({2, 3}, graph_ptr);
+    v *pv2 = new v({3, 4}, graph_ptr);
+    v *pv3 = new v({1}, graph_ptr);
+
+    auto matmul = new auto_diff::functional::MatMul(pv1, pv2, graph_ptr);
+    auto add = new auto_diff::functional::Add(matmul, pv3, graph_ptr);
+    auto relu = new auto_diff::functional::ReLU(add, graph_ptr);
+    auto target = new auto_diff::functional::ReduceSum(relu, graph_ptr);
+
+    pv1->assign_value(auto_diff::DTensor({2, 3}, {1, -2, 3, -4, 5, -6}));
+    pv2->assign_value(auto_diff::DTensor({3, 4}, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}));
+    pv3->assign_value(auto_diff::DTensor({1}, 0.5));
+
+    auto_diff::ExecutionPlan plan = graph_ptr->compile({target});
+    plan.forward();
+    plan.backward({pv1, pv2, pv3});
+    double expected_value = target->get_value().get_value();
+    std::vector<auto_diff::DScalar> expected_grad_1 = pv1->get_grad().to_vector();
+    std::vector<auto_diff::DScalar> expected_grad_2 = pv2->get_grad().to_vector();
+
+    const auto_diff::MemoryPlan &memory_plan = plan.plan_memory();
+    // relu overwrites the value of add, which nothing else reads
+    ASSERT_EQ(memory_plan.get_num_steps(), 8);
+    ASSERT_EQ(memory_plan.get_blocks().size(), 8);
+    EXPECT_EQ(std::count_if(memory_plan.get_blocks().begin(), memory_plan.get_blocks().end(),
+                            [](const auto_diff::MemoryBlock &block) { return block.in_place; }), 1);
+    // at most five of the 64-byte buffers are live at once
+    EXPECT_EQ(memory_plan.get_total_bytes(), 8 * 64);
+    EXPECT_GE(memory_plan.get_peak_bytes(), 5 * 64);
+    EXPECT_LT(memory_plan.get_peak_bytes(), memory_plan.get_total_bytes());
+
+    for (int run = 0; run < 2; ++run) {
+      plan.forward();
+      EXPECT_DOUBLE_EQ(target->get_value().get_value(), expected_value);
+      // add never reaches the backward pass, matmul only by its shape
+      EXPECT_TRUE(matmul->is_value_empty());
+      EXPECT_TRUE(add->is_value_empty());
+      EXPECT_FALSE(relu->is_value_empty());
+      EXPECT_EQ(matmul->get_value_shape(), tensor::TensorShape({2, 4}));
+      EXPECT_THROW(add->get_value(), adg_exception::NodeValueError);
+
+      plan.backward({pv1, pv2, pv3});
+      EXPECT_EQ(pv1->get_grad().to_vector(), expected_grad_1);
+      EXPECT_EQ(pv2->get_grad().to_vector(), expected_grad_2);
+      EXPECT_TRUE(relu->is_value_empty());
+      EXPECT_FALSE(target->is_value_empty());
+    }
+
+    // without backward the plan drops the values backward reads
+    plan.plan_memory(false);
+    plan.forward();
+    EXPECT_TRUE(relu->is_value_released());
+    EXPECT_THROW(plan.backward({pv1, pv2, pv3}), adg_exception::GradError);
+
+    // relu overwrites add only in the plan that decided so, not in a later
+    // one reading add as an output
+    auto_diff::ExecutionPlan other_plan = graph_ptr->compile({add, target});
+    other_plan.forward();
+    ASSERT_NO_THROW(add->get_value());
+    EXPECT_EQ(add->get_value_shape(), tensor::TensorShape({2, 4}));
+    EXPECT_DOUBLE_EQ(target->get_value().get_value(), expected_value);
+  }
+  graph_ptr->remove_all();
+  delete graph_ptr;
+}
+
+TEST(GraphTest, NodeArenaTest) {
+  g *graph_ptr = new g();
+
+  {
+    v *pv1 = graph_ptr->create<v>(tensor::TensorShape{2}, graph_ptr);
+    v *pv2 = graph_ptr->create<v>(tensor::TensorShape{2}, graph_ptr);
+    auto &add = auto_diff::functional::add(*pv1, *pv2, graph_ptr);
+    // ids follow the order the nodes were added in
+    EXPECT_EQ(pv1->get_id(), 0);
+    EXPECT_EQ(pv2->get_id(), 1);
+    EXPECT_EQ(add.get_id(), 2);
+    EXPECT_EQ(graph_ptr->get_num_nodes(), 3);
+    auto proxy = add;
+    EXPECT_EQ(proxy.get_id(), 2);
+    EXPECT_EQ(graph_ptr->get_ptr_of(add.get_full_name()), &add);
+
+    // a node failing its constructor is taken out of the graph again
+    v *pv3 = graph_ptr->create<v>(tensor::TensorShape{3}, graph_ptr);
+    EXPECT_THROW(auto_diff::functional::add(*pv1, *pv3, graph_ptr), adg_exception::MismatchNodeValueShapeError);
+    EXPECT_EQ(graph_ptr->get_num_nodes(), 4);
+    EXPECT_EQ(pv1->get_children().size(), 1);
+    // also when it fails on its second parent, before being added
+    g *other_graph = new g();
+    v *pw = other_graph->create<v>(tensor::TensorShape{2}, other_graph);
+    EXPECT_THROW(graph_ptr->create<auto_diff::functional::Add>(pv1, pw, graph_ptr),
+                 adg_exception::MismatchRegisterdGraphError);
+    EXPECT_EQ(pv1->get_children().size(), 1);
+    EXPECT_TRUE(pw->get_children().empty());
+    delete other_graph;
+    EXPECT_EQ(auto_diff::functional::add(*pv1, *pv2, graph_ptr).get_id(), 4);
+
+    auto_diff::NodeTable<double> table;
+    table[pv2] = 1.;
+    table.emplace(&add, 2.);
+    EXPECT_FALSE(table.contains(pv1));
+    EXPECT_DOUBLE_EQ(table.at(&proxy), 2.);
+    EXPECT_THROW(table.at(pv1), adg_exception::NodeNotFoundError);
+    table.clear();
+    EXPECT_FALSE(table.contains(pv2));
+  }
+  // the arena nodes, variables included, go along with the graph
+  graph_ptr->remove_all();
+  EXPECT_EQ(graph_ptr->get_num_nodes(), 0);
+  v *pv = graph_ptr->create<v>(tensor::TensorShape{2}, graph_ptr);
+  EXPECT_EQ(pv->get_id(), 0);
+
+  // a big node first does not leave its chunk to the small ones
+  graph_ptr->remove_all();
+  BigVariable *big = graph_ptr->create<BigVariable>(tensor::TensorShape{2}, graph_ptr);
+  v *small = graph_ptr->create<v>(tensor::TensorShape{2}, graph_ptr);
+  char *big_begin = reinterpret_cast<char *>(big);
+  char *small_begin = reinterpret_cast<char *>(small);
+  EXPECT_TRUE(small_begin + sizeof(v) <= big_begin || small_begin >= big_begin + sizeof(BigVariable));
+
+  // only the nodes given a name are registered by it, the given names must
+  // not clash with the generated ones either
+  std::vector<auto_diff::Node *> no_parents;
+  v *named = graph_ptr->create<v>(tensor::TensorShape{2}, no_parents, "named", true, true, graph_ptr);
+  EXPECT_EQ(graph_ptr->get_ptr_of(named->get_full_name()), named);
+  EXPECT_EQ(graph_ptr->get_ptr_of(small->get_full_name()), small);
+  EXPECT_THROW(graph_ptr->get_ptr_of("variable_9"), adg_exception::NodeNotFoundError);
+  EXPECT_THROW(graph_ptr->create<v>(tensor::TensorShape{2}, no_parents, "named", true, true, graph_ptr),
+               adg_exception::DuplicateNodeNameError);
+  EXPECT_THROW(graph_ptr->create<v>(tensor::TensorShape{2}, no_parents, small->get_name(), true, true, graph_ptr),
+               adg_exception::DuplicateNodeNameError);
+  EXPECT_EQ(graph_ptr->get_num_nodes(), 3);
+  delete graph_ptr;
+}
+
+TEST(GraphTest, ParallelPlanTest) {
+  g *graph_ptr = new g();
+
+  {
+    v *px = graph_ptr->create<v>(tensor::TensorShape{2, 3}, graph_ptr);
+    px->assign_value(auto_diff::DTensor({2, 3}, {1, -2, 3, -4, 5, -6}));
+    // four towers on the same input, summed up
+    std::vector<v *> weights;
+    std::vector<auto_diff::Node *> towers;
+    for (int tower = 0; tower < 4; ++tower) {
+      weights.emplace_back(graph_ptr->create<v>(tensor::TensorShape{3, 3}, graph_ptr));
+      std::vector<auto_diff::DScalar> weight(9);
+      for (int ix = 0; ix < 9; ++ix) {
+        weight[ix] = 0.1 * (ix - 4) * (tower + 1);
+      }
+      weights.back()->assign_value(auto_diff::DTensor({3, 3}, weight));
+      auto &matmul = auto_diff::functional::matmul(*px, *weights.back(), graph_ptr);
+      towers.emplace_back(&auto_diff::functional::tanh(matmul, graph_ptr));
+    }
+    auto &matsum = auto_diff::functional::matsum(towers, graph_ptr);
+    auto &target = auto_diff::functional::reduce_sum(matsum, graph_ptr);
+    std::vector<auto_diff::Node *> leaves = {px, weights[0], weights[3]};
+
+    auto_diff::ExecutionPlan plan = graph_ptr->compile({&target});
+    EXPECT_EQ(plan.get_max_width(), 4);
+    plan.forward();
+    plan.backward(leaves);
+    double expected_value = target.get_value().get_value();
+    std::vector<std::vector<auto_diff::DScalar>> expected_grads;
+    for (auto leaf_ptr : leaves) {
+      expected_grads.emplace_back(leaf_ptr->get_grad().to_vector());
+    }
+
+    plan.set_parallel_policy({4, 1});
+    for (int run = 0; run < 3; ++run) {
+      // the last run releases the buffers along a memory plan
+      if (run == 2) {
+        plan.plan_memory();
+      }
+      plan.forward();
+      EXPECT_DOUBLE_EQ(target.get_value().get_value(), expected_value);
+      plan.backward(leaves);
+      for (size_t ix = 0; ix < leaves.size(); ++ix) {
+        std::vector<auto_diff::DScalar> grad = leaves[ix]->get_grad().to_vector();
+        ASSERT_EQ(grad.size(), expected_grads[ix].size());
+        for (size_t jx = 0; jx < grad.size(); ++jx) {
+          EXPECT_NEAR(grad[jx], expected_grads[ix][jx], GRAD_TOLERANCE);
+        }
+      }
+    }
+  }
+  graph_ptr->remove_all();
+
+  {
+    // branches big enough for their kernels to use the runtime as well, so
+    // that the nested waits of the nodes run other queued tasks
+    size_t size = 1 << 18;
+    std::vector<auto_diff::DScalar> value_1(size), value_2(size);
+    for (size_t ix = 0; ix < size; ++ix) {
+      value_1[ix] = 0.001 * static_cast<double>(ix % 2000) - 1.;
+      value_2[ix] = 0.5 - 0.002 * static_cast<double>(ix % 500);
+    }
+    v *px1 = graph_ptr->create<v>(tensor::TensorShape{size}, graph_ptr);
+    v *px2 = graph_ptr->create<v>(tensor::TensorShape{size}, graph_ptr);
+    px1->assign_value(auto_diff::DTensor({size}, value_1));
+    px2->assign_value(auto_diff::DTensor({size}, value_2));
+    auto &branch_1 = auto_diff::functional::sigmoid(auto_diff::functional::tanh(*px1, graph_ptr), graph_ptr);
+    auto &branch_2 = auto_diff::functional::sigmoid(auto_diff::functional::tanh(*px2, graph_ptr), graph_ptr);
+    auto &target = auto_diff::functional::reduce_sum(auto_diff::functional::add(branch_1, branch_2, graph_ptr),
+                                                     graph_ptr);
+
+    auto_diff::ExecutionPlan plan = graph_ptr->compile({&target});
+    plan.forward();
+    plan.backward({px1, px2});
+    double expected_value = target.get_value().get_value();
+    std::vector<auto_diff::DScalar> expected_grad = px2->get_grad().to_vector();
+
+    plan.set_parallel_policy(auto_diff::ParallelPolicy::split(plan.get_max_width()));
+    for (int run = 0; run < 3; ++run) {
+      plan.forward();
+      EXPECT_NEAR(target.get_value().get_value(), expected_value, 1e-9 * std::abs(expected_value));
+      plan.backward({px1, px2});
+      EXPECT_EQ(px2->get_grad().to_vector(), expected_grad);
+    }
+  }
+  graph_ptr->remove_all();
+  delete graph_ptr;
+
+  auto_diff::ParallelPolicy policy = auto_diff::ParallelPolicy::split(3, 8);
+  EXPECT_EQ(policy.inter_op_threads, 3);
+  EXPECT_EQ(policy.intra_op_threads, 2);
+  policy = auto_diff::ParallelPolicy::split(1, 8);
+  EXPECT_EQ(policy.inter_op_threads, 1);
+  EXPECT_EQ(policy.intra_op_threads, 8);
+}
+
 #ifdef ADGC_ENABLE_GRAPHVIZ_
 TEST(GraphTest, GraphVizTest) {
   g *graph_ptr = new g();
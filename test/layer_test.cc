@@ -1,10 +1,18 @@
+#include <algorithm>
+#include <limits>
+
 #include "autodiff/layer/layer.h"
+#include "autodiff/layer/quantization.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
 using namespace testing;
 using namespace auto_diff;
 
+// absolute tolerance of the gradients that cancel out to zero, up to the
+// rounding of DScalar
+const double ZERO_GRAD_TOLERANCE = std::max(1e-6, 1e3 * std::numeric_limits<DScalar>::epsilon());
+
 MATCHER_P(FloatNearPointwise, tol, "Out of range") {
   return (std::get<0>(arg) > std::get<1>(arg) - tol && std::get<0>(arg) < std::get<1>(arg) + tol);
 }
@@ -15,9 +23,9 @@ TEST(LayerTest, DenseLayerTest) {
   try {
     Variable v1 = Variable({2, 2});
 
-    DTensor value_v1 = tensor::Tensor<double>({2, 2}, {1, 2, 3, 4});
-    DTensor weight = tensor::Tensor<double>({2, 1}, {-1, 2});
-    DTensor bias = tensor::Tensor<double>({1}, 2);
+    DTensor value_v1 = DTensor({2, 2}, {1, 2, 3, 4});
+    DTensor weight = DTensor({2, 1}, {-1, 2});
+    DTensor bias = DTensor({1}, 2);
 
     layer::Dense dense_layer(2, 1);
     dense_layer.assign_weight(weight);
@@ -72,7 +80,7 @@ TEST(LayerTest, ConvLayerTest1) {
   try {
     Variable v1 = Variable({2, 1, 7, 7});
 
-    DTensor value_v1 = tensor::Tensor<double>({2, 1, 7, 7},
+    DTensor value_v1 = DTensor({2, 1, 7, 7},
                                               {1., 1., 8., 9., 5., -3., 1., 7., 0., -4., 0., -6., 6., -3., 7., 9., 6.,
                                                8., 9., -9., 1., 5., -3., 0., -9., 8., 9., -8., -1., -8., -3., -4., -2.,
                                                -9., -9., -9., -8., -7., 1., -9., 6., 1., -8., 9., 1., 7., 1., -10., 3.,
@@ -80,11 +88,11 @@ TEST(LayerTest, ConvLayerTest1) {
                                                -3., -7., -9., -1., -4., 6., -8., 6., -10., 8., -4., -4., 2., -7., -1.,
                                                -5., 4., -5., -2., 2., 2., -7., 8., 8., 6., -3., -2., 8., 8., -8., -10.,
                                                9., -9.});
-    DTensor weight = tensor::Tensor<double>({4, 1, 3, 3},
+    DTensor weight = DTensor({4, 1, 3, 3},
                                             {1., -3., 7., 5., -2., -9., -4., 8., -8., 8., -10., -8., -10., 8., 7., 5.,
                                              0., -3., -4., 1., -2., 6., -9., 1., -7., -1., -4., 8., 4., -10., -7., 6.,
                                              -8., 3., 5., -4.});
-    DTensor bias = tensor::Tensor<double>({4}, {-5., 7., -7., -3.});
+    DTensor bias = DTensor({4}, {-5., 7., -7., -3.});
 
     layer::Conv2D conv_layer(1, 4, {3, 3}, {1, 1}, "VALID", "none");
     conv_layer.assign_weight(weight);
@@ -131,7 +139,7 @@ TEST(LayerTest, ConvLayerTest2) {
   try {
     Variable v1 = Variable({2, 3, 9, 9});
 
-    DTensor value_v1 = tensor::Tensor<double>({2, 3, 9, 9},
+    DTensor value_v1 = DTensor({2, 3, 9, 9},
                                               {-6., 3., -8., 9., -1., 8., -1., 3., 8., 4., -8., -7., 2., 0., -6., -10.,
                                                8., -9., 6., 0., -9., -8., 7., -9., 5., -5., 5., -6., 6., 7., -3., 1.,
                                                -9., -5., 4., -6., 0., -2., 7., 1., -9., 7., -9., 7., -4., 4., 0., -5.,
@@ -163,12 +171,12 @@ TEST(LayerTest, ConvLayerTest2) {
                                                -10., -2., 5., 2., 7., 5., 0., -8., -10., 7., -6., -8., -8., -6., 2.,
                                                -1., -2., -3., 0., -7., -2., 3., -3., 8., 8., 7., 8., -6., 5., 6., 9.,
                                                9., 3., -5., -6., -3., 5., -6., -3., 3., 2., 7., -6., 4.});
-    DTensor weight = tensor::Tensor<double>({5, 3, 2, 2},
+    DTensor weight = DTensor({5, 3, 2, 2},
                                             {-10., -6., 8., 6., -6., -8., -6., -3., 2., 6., -2., 0., 5., 3., 8., -9.,
                                              -8., 8., -3., 7., 2., 1., 8., 5., 7., -4., 7., 9., -2., 7., 7., 0., -8.,
                                              6., -2., 7., -2., 6., -1., -5., 4., 9., 7., 1., 4., -8., -9., -4., -6., 0.,
                                              1., -1., 1., -9., 8., 2., 8., -1., 8., 8.});
-    DTensor bias = tensor::Tensor<double>({5}, {0., 0., -2., -6., 1.});
+    DTensor bias = DTensor({5}, {0., 0., -2., -6., 1.});
 
     layer::Conv2D conv_layer(3, 5, {2, 2}, {2, 2}, {1, 1});
     conv_layer.assign_weight(weight);
@@ -232,7 +240,7 @@ TEST(LayerTest, BatchNormTest) {
   try {
     Variable v1 = Variable({3, 5, 4, 4});
 
-    DTensor value_v1 = tensor::Tensor<double>({3, 5, 4, 4},
+    DTensor value_v1 = DTensor({3, 5, 4, 4},
                                               {3.6105729162621527, 8.444973792121944, 2.4677771009841116,
                                                9.107443133998114, 13.149648728093439, 11.478563719349161,
                                                1.5473878568119244, 5.9396393530626606, 4.454656201006301,
@@ -313,10 +321,10 @@ TEST(LayerTest, BatchNormTest) {
                                                4.088599121780496, 1.245889427893377, 11.899644433092439,
                                                6.178589986917198, 10.103946671466286, 7.366022567777222,
                                                4.316598372288227, 5.655805791655958});
-    DTensor weight = tensor::Tensor<double>({5},
+    DTensor weight = DTensor({5},
                                             {206.8220385558213, 211.93932071562458, 200.79338483652177,
                                              207.41006211877448, 194.20772368104411});
-    DTensor bias = tensor::Tensor<double>({5},
+    DTensor bias = DTensor({5},
                                           {3.5521382021746613, -0.9649412508315304, 5.2740295942467785,
                                            6.669372573108524, -2.3164180572411626});
 
@@ -467,8 +475,9 @@ TEST(LayerTest, BatchNormTest) {
         -7.463440452015782e-15,
        });
     std::vector<double> bias_grad_exp({48.0, 48.0, 48.0, 48.0, 48.0,});
-    EXPECT_THAT(v1.get_grad().to_vector(), Pointwise(FloatNearPointwise(1e-6), v1_grad_exp));
-    EXPECT_THAT(bn_layer.get_weight().get_grad().to_vector(), Pointwise(FloatNearPointwise(1e-6), weight_grad_exp));
+    EXPECT_THAT(v1.get_grad().to_vector(), Pointwise(FloatNearPointwise(ZERO_GRAD_TOLERANCE), v1_grad_exp));
+    EXPECT_THAT(bn_layer.get_weight().get_grad().to_vector(),
+                Pointwise(FloatNearPointwise(ZERO_GRAD_TOLERANCE), weight_grad_exp));
     EXPECT_THAT(bn_layer.get_bias().get_grad().to_vector(), Pointwise(FloatNearPointwise(1e-6), bias_grad_exp));
   } catch (const std::exception &ex) {
     FAIL() << "Failed and got this: " << std::endl << ex.what();
@@ -477,7 +486,79 @@ TEST(LayerTest, BatchNormTest) {
   Graph::delete_global_graph();
 }
 
+TEST(LayerTest, WeightInitTest) {
+  Graph *graph = Graph::get_instanceof_global_graph();
+  try {
+    layer::Conv2D conv_layer(16, 32, {3, 3}, {1, 1});
+    conv_layer.init_weight("kaiming_normal", 1);
+    // fan in 16 * 3 * 3
+    DTensor kernel = conv_layer.get_weight().get_value();
+    EXPECT_NEAR(std::sqrt(kernel.var().get_value()), std::sqrt(2. / 144), 0.005);
+
+    layer::Dense dense_layer(300, 100, "tanh");
+    dense_layer.init_weight("xavier_uniform", 2);
+    double bound = std::sqrt(6. / 400);
+    DTensor weight = dense_layer.get_weight().get_value();
+    EXPECT_LE(weight.max().get_value(), bound);
+    EXPECT_GE(weight.min().get_value(), -bound);
+    EXPECT_GT(weight.max().get_value(), 0.9 * bound);
+
+    EXPECT_THROW(dense_layer.init_weight("orthogonal"), adg_exception::InvalidNodeArgumentError);
+    layer::BatchNorm2D norm_layer(4);
+    EXPECT_THROW(norm_layer.init_weight("xavier_normal"), adg_exception::LayerParameterError);
+  } catch (const std::exception &ex) {
+    FAIL() << "Failed and got this: " << std::endl << ex.what();
+  }
+  graph->remove_all();
+  Graph::delete_global_graph();
+}
+
+TEST(LayerTest, QuantizedSequentialTest) {
+  Graph *graph = Graph::get_instanceof_global_graph();
+
+  try {
+    Variable v1 = Variable({4, 2, 6, 6});
+
+    layer::Conv2D conv_layer(2, 3, {3, 3}, {1, 1}, "SAME", "relu");
+    layer::Dense dense_layer(3 * 6 * 6, 5, "none");
+    DTensor kernel({3, 2, 3, 3});
+    kernel.normal_init(0., 0.5, 1);
+    conv_layer.assign_weight(kernel);
+    conv_layer.assign_bias(DTensor({3}, {0.1, -0.2, 0.3}));
+    DTensor weight({3 * 6 * 6, 5});
+    weight.normal_init(0., 0.1, 2);
+    dense_layer.assign_weight(weight);
+    dense_layer.assign_bias(DTensor({1}, 0.5));
+
+    auto &conv_out = conv_layer(v1);
+    auto flattened = new functional::Reshape(&conv_out, {4, 3 * 6 * 6});
+    auto &target = dense_layer(*flattened);
+
+    DTensor value_v1({4, 2, 6, 6});
+    value_v1.normal_init(0., 1., 3);
+    v1.assign_value(value_v1);
+    target.forward();
+
+    layer::Calibrator calibrator({&conv_layer, &dense_layer});
+    calibrator.observe();
+    ASSERT_GT(calibrator.get_input_scale(1), 0.);
+
+    layer::QuantizedSequential quantized(calibrator);
+    DTensor expected = target.get_value();
+    DTensor result = quantized.forward(value_v1);
+    ASSERT_EQ(result.get_shape(), tensor::TensorShape({4, 5}));
+    // within 2% of the output range after two layers of int8 rounding
+    double tolerance = calibrator.get_output_scale(1) * 127 * 0.02;
+    ASSERT_THAT(result.to_vector(), Pointwise(FloatNearPointwise(tolerance), expected.to_vector()));
+    ASSERT_EQ(quantized.get_weight_bytes(), 3 * 18 + 3 * 2 * 4 + 3 * 6 * 6 * 5 + 5 * 2 * 4);
+  } catch (const std::exception &ex) {
+    FAIL() << "Failed and got this: " << std::endl << ex.what();
+  }
+  graph->remove_all();
+  Graph::delete_global_graph();
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
@@ -208,6 +208,64 @@ TEST(AdgcMathUtilsTest, SigmoidTest) {
   delete[] b;
 }
 
+TEST(AdgcMathUtilsTest, ActivationKernelTest) {
+  // more entries than one block, so the block edges are covered
+  const size_t size = 2500;
+  std::vector<double> x(size), grad(size, 1.), y(size), dx(size);
+  for (size_t ix = 0; ix < size; ++ix) {
+    x[ix] = -6. + 12. * ix / size;
+  }
+
+  utils::math::gelu_forward(size, x.data(), y.data());
+  utils::math::gelu_backward(size, x.data(), grad.data(), dx.data());
+  for (size_t ix = 0; ix < size; ix += 97) {
+    EXPECT_NEAR(y[ix], 0.5 * x[ix] * (1 + std::erf(x[ix] / std::sqrt(2.))), 1e-12);
+    double slope = (utils::math::gelu(x[ix] + 1e-6) - utils::math::gelu(x[ix] - 1e-6)) / 2e-6;
+    EXPECT_NEAR(dx[ix], slope, 1e-6);
+  }
+
+  utils::math::silu_forward(size, x.data(), y.data());
+  utils::math::silu_backward(size, x.data(), grad.data(), dx.data());
+  for (size_t ix = 0; ix < size; ix += 97) {
+    EXPECT_NEAR(y[ix], x[ix] / (1 + std::exp(-x[ix])), 1e-12);
+    double slope = (utils::math::silu(x[ix] + 1e-6) - utils::math::silu(x[ix] - 1e-6)) / 2e-6;
+    EXPECT_NEAR(dx[ix], slope, 1e-6);
+  }
+
+  // the output may overwrite an input
+  std::vector<double> expected_y = y, expected_dx = dx, aliased = x;
+  utils::math::silu_forward(size, aliased.data(), aliased.data());
+  EXPECT_EQ(aliased, expected_y);
+  aliased = x;
+  utils::math::silu_backward(size, aliased.data(), grad.data(), aliased.data());
+  EXPECT_EQ(aliased, expected_dx);
+  utils::math::gelu_forward(size, x.data(), expected_y.data());
+  utils::math::gelu_backward(size, x.data(), grad.data(), expected_dx.data());
+  aliased = x;
+  utils::math::gelu_forward(size, aliased.data(), aliased.data());
+  EXPECT_EQ(aliased, expected_y);
+  aliased = x;
+  utils::math::gelu_backward(size, aliased.data(), grad.data(), aliased.data());
+  EXPECT_EQ(aliased, expected_dx);
+  aliased = grad;
+  utils::math::gelu_backward(size, x.data(), aliased.data(), aliased.data());
+  EXPECT_EQ(aliased, expected_dx);
+
+  utils::math::tanh_forward(size, x.data(), y.data());
+  utils::math::tanh_backward(size, y.data(), grad.data(), dx.data());
+  for (size_t ix = 0; ix < size; ix += 97) {
+    EXPECT_NEAR(y[ix], std::tanh(x[ix]), 1e-12);
+    EXPECT_NEAR(dx[ix], 1 - std::tanh(x[ix]) * std::tanh(x[ix]), 1e-12);
+  }
+
+  utils::math::leaky_relu_forward(size, x.data(), 0.1, y.data());
+  utils::math::leaky_relu_backward(size, x.data(), grad.data(), 0.1, dx.data());
+  EXPECT_DOUBLE_EQ(y[0], -0.6);
+  EXPECT_DOUBLE_EQ(dx[0], 0.1);
+  EXPECT_DOUBLE_EQ(y[size - 1], x[size - 1]);
+  EXPECT_DOUBLE_EQ(dx[size - 1], 1.);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -1,4 +1,7 @@
 #include "utils/thread.h"
+
+#include <atomic>
+#include <stdexcept>
 #include "gtest/gtest.h"
 
 TEST(AdgcMuliThreadTest, MultiThreadMap) {
@@ -26,6 +29,78 @@ TEST(AdgcMuliThreadTest, MultiThreadMap) {
   }
 }
 
+TEST(AdgcMuliThreadTest, ParallelFor) {
+  std::vector<int> nums(100000, 0);
+  std::atomic<size_t> n_calls = 0;
+  utils::threads::parallel_for(0, nums.size(), 1000, [&nums, &n_calls](size_t begin, size_t end) {
+    ++n_calls;
+    for (size_t ix = begin; ix < end; ++ix) {
+      nums[ix] += static_cast<int>(ix % 7);
+    }
+    // nested calls run serially inside the chunk
+    utils::threads::parallel_for(begin, end, 1, [&nums](size_t inner_begin, size_t inner_end) {
+      for (size_t ix = inner_begin; ix < inner_end; ++ix) {
+        nums[ix] += 1;
+      }
+    });
+  });
+  for (size_t ix = 0; ix < nums.size(); ++ix) {
+    ASSERT_EQ(nums[ix], ix % 7 + 1) << "Wrong result at index " << ix;
+  }
+  ASSERT_LE(n_calls, utils::threads::get_num_threads());
+
+  ASSERT_THROW(utils::threads::parallel_for(0, 10000, 1, [](size_t /*begin*/, size_t end) {
+    if (end == 10000) {
+      throw std::runtime_error("last chunk");
+    }
+  }), std::runtime_error);
+}
+
+TEST(AdgcMuliThreadTest, Runtime) {
+  size_t default_num_threads = utils::threads::get_num_threads();
+  utils::threads::set_num_threads(3);
+  ASSERT_EQ(utils::threads::get_num_threads(), 3);
+
+  // tasks spawning and waiting for tasks of their own
+  std::vector<int> nums(64, 0);
+  {
+    utils::threads::TaskGroup group;
+    for (size_t ix = 0; ix < 8; ++ix) {
+      group.run([&nums, ix] {
+        utils::threads::TaskGroup inner;
+        for (size_t iy = 0; iy < 8; ++iy) {
+          inner.run([&nums, ix, iy] { nums[ix * 8 + iy] = static_cast<int>(ix * iy); });
+        }
+        inner.wait();
+      });
+    }
+    group.wait();
+  }
+  for (size_t ix = 0; ix < nums.size(); ++ix) {
+    ASSERT_EQ(nums[ix], (ix / 8) * (ix % 8)) << "Wrong result at index " << ix;
+  }
+
+  auto answer = utils::threads::submit([] { return 42; });
+  ASSERT_EQ(answer.get(), 42);
+
+  utils::threads::TaskGroup failing;
+  failing.run([] { throw std::runtime_error("task"); });
+  failing.run([] {});
+  ASSERT_THROW(failing.wait(), std::runtime_error);
+
+  std::atomic<size_t> total = 0;
+  utils::threads::parallel_for(0, 30000, 1000, [&total](size_t begin, size_t end) {
+    total += end - begin;
+  });
+  ASSERT_EQ(total, 30000);
+
+  utils::threads::set_num_threads(1);
+  ASSERT_EQ(utils::threads::get_num_threads(), 1);
+  ASSERT_EQ(utils::threads::submit([] { return 7; }).get(), 7);
+
+  utils::threads::set_num_threads(default_num_threads);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "autodiff/component/functional.h"
 #include "autodiff/component/variable.h"
 #include "gmock/gmock.h"
@@ -6,6 +10,10 @@
 using namespace testing;
 using namespace auto_diff;
 
+// relative tolerance of the softmax gradients, whose terms cancel out and
+// lose digits when DScalar is float
+const double SOFTMAX_GRAD_TOLERANCE = std::max(1e-7, 1e3 * std::numeric_limits<DScalar>::epsilon());
+
 TEST(OpsTest, AddAndReduceSumTest) {
 
   // this block limits the lifetime of all graph nodes
@@ -15,8 +23,8 @@ TEST(OpsTest, AddAndReduceSumTest) {
     Variable v1 = Variable({2, 2});
     Variable v2 = Variable({2, 2});
 
-    DTensor value_v1 = tensor::Tensor<double>({2, 2}, {1, 2, 3, 4});
-    DTensor value_v2 = tensor::Tensor<double>({2, 2}, {5, 6, 7, 8});
+    DTensor value_v1 = DTensor({2, 2}, {1, 2, 3, 4});
+    DTensor value_v2 = DTensor({2, 2}, {5, 6, 7, 8});
 
     v1.assign_value(value_v1);
     v2.assign_value(value_v2);
@@ -56,6 +64,38 @@ TEST(OpsTest, AddAndReduceSumTest) {
   }
 }
 
+TEST(OpsTest, BroadcastAddTest) {
+  Graph *graph = Graph::get_instanceof_global_graph();
+
+  try {
+    Variable v1 = Variable({2, 3});
+    Variable v2 = Variable({2, 1});
+    Variable v3 = Variable({1});
+    v1.assign_value({{2, 3}, {1, 2, 3, 4, 5, 6}});
+    v2.assign_value({{2, 1}, {10, 20}});
+    v3.assign_value({{1}, {100}});
+
+    auto add = functional::Add(&v1, &v2);
+    auto add_scalar = functional::Add(&v3, &add);
+    auto target = functional::ReduceSum(&add_scalar);
+
+    graph->zero_grad();
+    target.forward();
+
+    ASSERT_EQ(add_scalar.get_value_shape(), tensor::TensorShape({2, 3}));
+    ASSERT_THAT(add_scalar.get_value().to_vector(), ElementsAre(111, 112, 113, 124, 125, 126));
+
+    graph->backward(target);
+
+    ASSERT_THAT(v1.get_grad().to_vector(), ElementsAre(1, 1, 1, 1, 1, 1));
+    ASSERT_THAT(v2.get_grad().to_vector(), ElementsAre(3, 3));
+    ASSERT_THAT(v3.get_grad().to_vector(), ElementsAre(6));
+  } catch (const std::exception &ex) {
+    FAIL() << "Failed and got this: " << std::endl << ex.what();
+  }
+  Graph::delete_global_graph();
+}
+
 TEST(OpsTest, VecDotTest) {
   // this block limits the lifetime of all graph nodes
   try {
@@ -64,8 +104,8 @@ TEST(OpsTest, VecDotTest) {
     Variable v1 = Variable({2, 1});
     Variable v2 = Variable({2, 1});
 
-    DTensor value_v1 = tensor::Tensor<double>({2, 1}, {1, 2});
-    DTensor value_v2 = tensor::Tensor<double>({2, 1}, {5, 6});
+    DTensor value_v1 = DTensor({2, 1}, {1, 2});
+    DTensor value_v2 = DTensor({2, 1}, {5, 6});
 
     v1.assign_value(value_v1);
     v2.assign_value(value_v2);
@@ -112,8 +152,8 @@ TEST(OpsTest, MatMulTest) {
     Variable v1 = Variable({2, 2});
     Variable v2 = Variable({2, 2});
 
-    DTensor value_v1 = tensor::Tensor<double>({2, 2}, {1, 2, 3, 4});
-    DTensor value_v2 = tensor::Tensor<double>({2, 2}, {5, 6, 7, 8});
+    DTensor value_v1 = DTensor({2, 2}, {1, 2, 3, 4});
+    DTensor value_v2 = DTensor({2, 2}, {5, 6, 7, 8});
 
     v1.assign_value(value_v1);
     v2.assign_value(value_v2);
@@ -164,9 +204,9 @@ TEST(OpsTest, MatMul3DTest) {
     Variable v1 = Variable({3, 2, 3});
     Variable v2 = Variable({3, 2});
 
-    DTensor value_v1 = tensor::Tensor<double>({3, 2, 3}, {5., 11., 7., -7., -2., 1., 0., 9., 7., -2., -1., 5., 9., 5.,
+    DTensor value_v1 = DTensor({3, 2, 3}, {5., 11., 7., -7., -2., 1., 0., 9., 7., -2., -1., 5., 9., 5.,
                                                           3., 0., -3., -3.});
-    DTensor value_v2 = tensor::Tensor<double>({3, 2}, {-9., 7., -3., -2., -1., -5.});
+    DTensor value_v2 = DTensor({3, 2}, {-9., 7., -3., -2., -1., -5.});
 
     v1.assign_value(value_v1);
     v2.assign_value(value_v2);
@@ -209,10 +249,10 @@ TEST(OpsTest, PointMulReduceMeanTest) {
     Variable v2 = Variable({3, 2, 4});
 
     DTensor value_v1 =
-      tensor::Tensor<double>({3, 2, 4}, {2., 5., 7., 7., 1., 9., 7., 8., 3., 1., 3., 8., 4., 8., 5., 7., 2., 4.,
+      DTensor({3, 2, 4}, {2., 5., 7., 7., 1., 9., 7., 8., 3., 1., 3., 8., 4., 8., 5., 7., 2., 4.,
                                          4., 5., 8., 3., 8., 4.});
     DTensor value_v2 =
-      tensor::Tensor<double>({3, 2, 4}, {7., 0., 5., 6., 4., 3., 3., 7., 9., 8., 0., 8., 5., 2., 3., 3., 1., 8.,
+      DTensor({3, 2, 4}, {7., 0., 5., 6., 4., 3., 3., 7., 9., 8., 0., 8., 5., 2., 3., 3., 1., 8.,
                                          3., 6., 4., 1., 4., 2.});
 
     v1.assign_value(value_v1);
@@ -271,7 +311,7 @@ TEST(OpsTest, Pad2DTest) {
     Variable v1 = Variable({3, 2, 4});
 
     DTensor value_v1 =
-      tensor::Tensor<double>({3, 2, 4}, {3, 16, 18, 3, 16, -2, -10, 5, -4, 16, 4, -9, 13,
+      DTensor({3, 2, 4}, {3, 16, 18, 3, 16, -2, -10, 5, -4, 16, 4, -9, 13,
                                          -5, 19, 10, 8, -6, -10, -10, 19, -7, 14, 14});
 
     v1.assign_value(value_v1);
@@ -324,8 +364,8 @@ TEST(FunctionalTest, SigmoidReluTest) {
     Variable v2 = Variable({2, 1}, graph);
     Variable v3 = Variable({1}, graph);
 
-    DTensor value_v1 = tensor::Tensor<double>({3, 2}, {1, 2, 3, 3, 4, 5});
-    DTensor value_v2 = tensor::Tensor<double>({2, 1}, {2, 1});
+    DTensor value_v1 = DTensor({3, 2}, {1, 2, 3, 3, 4, 5});
+    DTensor value_v2 = DTensor({2, 1}, {2, 1});
 
     v1.assign_value(value_v1);
     v2.assign_value(value_v2);
@@ -383,6 +423,65 @@ TEST(FunctionalTest, SigmoidReluTest) {
   delete graph;
 }
 
+TEST(FunctionalTest, TanhGeluSiluTest) {
+  Graph *graph = Graph::get_instanceof_global_graph();
+
+  try {
+    Variable v1 = Variable({2, 2});
+    v1.assign_value(DTensor({2, 2}, {-1.5, -0.2, 0.7, 2.}));
+
+    auto target = functional::reduce_sum(functional::silu(functional::gelu(functional::tanh(v1))));
+
+    graph->zero_grad();
+    target.forward();
+    ASSERT_FLOAT_EQ(target.get_value().get_value(), 0.7056875869502967);
+
+    graph->backward(target);
+    ASSERT_EQ(v1.get_grad().get_shape(), tensor::TensorShape({2, 2}));
+    double v1_grad_exp[4] = {-0.004305118932515838, 0.15179457452622325,
+                             0.41993781789525403, 0.06541774641141958};
+    auto v1_grad_out = v1.get_grad().to_vector();
+    for (int ix = 0; ix < 4; ++ix) {
+      ASSERT_FLOAT_EQ(v1_grad_out[ix], v1_grad_exp[ix]);
+    }
+  } catch (const std::exception &ex) {
+    FAIL() << "Failed and got this: " << std::endl << ex.what();
+  }
+  graph->remove_all();
+  Graph::delete_global_graph();
+}
+
+TEST(FunctionalTest, MixedPrecisionGeluSiluTest) {
+  Graph *graph = Graph::get_instanceof_global_graph();
+
+  try {
+    graph->set_mixed_precision(true);
+    Variable v1 = Variable({4});
+    std::vector<DScalar> x = {-1., .5, 1., 2.};
+    v1.assign_value(DTensor({4}, x));
+
+    // the parents hand over fresh casts from bfloat16
+    auto &tanh = functional::tanh(v1);
+    auto &silu = functional::silu(tanh);
+    auto &gelu = functional::gelu(tanh);
+    silu.forward();
+    gelu.forward();
+
+    auto silu_out = silu.get_value().to_vector();
+    auto gelu_out = gelu.get_value().to_vector();
+    for (int ix = 0; ix < 4; ++ix) {
+      double t = std::tanh(x[ix]);
+      EXPECT_NEAR(silu_out[ix], t / (1 + std::exp(-t)), 2e-2);
+      EXPECT_NEAR(gelu_out[ix], 0.5 * t * (1 + std::erf(t / std::sqrt(2.))), 2e-2);
+    }
+  } catch (const std::exception &ex) {
+    FAIL() << "Failed and got this: " << std::endl << ex.what();
+  }
+  graph->set_mixed_precision(false);
+  graph->remove_all();
+  Graph::delete_global_graph();
+}
+
 TEST(FunctionalTest, CrossEntropyWithSoftmaxTest) {
   // this block limits the lifetime of all graph nodes
   Graph *graph = Graph::get_instanceof_global_graph();
@@ -393,14 +492,14 @@ TEST(FunctionalTest, CrossEntropyWithSoftmaxTest) {
     Variable v3 = Variable({1});
     Variable label = Variable({3, 3});
 
-    DTensor value_v1 = tensor::Tensor<double>({3, 2}, {1, 2, 3, 3, 4, 5});
-    DTensor value_v2 = tensor::Tensor<double>({2, 3}, {10, 2, 3, 4, 5, 9});
+    DTensor value_v1 = DTensor({3, 2}, {1, 2, 3, 3, 4, 5});
+    DTensor value_v2 = DTensor({2, 3}, {10, 2, 3, 4, 5, 9});
 
     v1.assign_value(value_v1);
     v2.assign_value(value_v2);
-    v3.assign_value(tensor::Tensor<double>({1}, 2));
+    v3.assign_value(DTensor({1}, 2));
     label.assign_value(
-      tensor::Tensor<double>({3, 3}, {1, 0, 0, 1, 0, 0, 1, 0, 0}));
+      DTensor({3, 3}, {1, 0, 0, 1, 0, 0, 1, 0, 0}));
 
     auto matmul_ops = functional::MatMul(&v1, &v2);
     auto add_ops = functional::Add(&matmul_ops, &v3);
@@ -445,14 +544,14 @@ TEST(FunctionalTest, CrossEntropyWithSoftmaxTest) {
                              -0.33198111225669635, 0.23712936588919964};
     auto v1_grad_out = v1.get_grad().to_vector();
     for (int ix = 0; ix < 6; ++ix) {
-      ASSERT_FLOAT_EQ(v1_grad_out[ix], v1_grad_exp[ix]);
+      ASSERT_NEAR(v1_grad_out[ix], v1_grad_exp[ix], SOFTMAX_GRAD_TOLERANCE * std::abs(v1_grad_exp[ix]));
     }
     double v2_grad_exp[6] = {-1.1497010658603544, 0.00011754544465360147,
                              1.1495835204157006, -2.1497066404494545,
                              0.00023508861479254903, 2.149471551834662};
     auto v2_grad_out = v2.get_grad().to_vector();
     for (int ix = 0; ix < 6; ++ix) {
-      ASSERT_FLOAT_EQ(v2_grad_out[ix], v2_grad_exp[ix]);
+      ASSERT_NEAR(v2_grad_out[ix], v2_grad_exp[ix], SOFTMAX_GRAD_TOLERANCE * std::abs(v2_grad_exp[ix]));
     }
 
   } catch (const std::exception &ex) {
@@ -471,14 +570,14 @@ TEST(FunctionalTest, FunctionStyleTest) {
     Variable v3 = Variable({3, 3});
     Variable label = Variable({3, 3});
 
-    DTensor value_v1 = tensor::Tensor<double>({3, 2}, {1, 2, 3, 3, 4, 5});
-    DTensor value_v2 = tensor::Tensor<double>({2, 3}, {10, 2, 3, 4, 5, 9});
+    DTensor value_v1 = DTensor({3, 2}, {1, 2, 3, 3, 4, 5});
+    DTensor value_v2 = DTensor({2, 3}, {10, 2, 3, 4, 5, 9});
 
     v1.assign_value(value_v1);
     v2.assign_value(value_v2);
-    v3.assign_value(tensor::Tensor<double>({3, 3}, 2));
+    v3.assign_value(DTensor({3, 3}, 2));
     label.assign_value(
-      tensor::Tensor<double>({3, 3}, {1, 0, 0, 1, 0, 0, 1, 0, 0}));
+      DTensor({3, 3}, {1, 0, 0, 1, 0, 0, 1, 0, 0}));
 
     auto target = functional::cross_entropy_with_softmax(
       functional::relu(functional::matsum(functional::matmul(v1, v2), v3)), label);
@@ -505,14 +604,14 @@ TEST(FunctionalTest, FunctionStyleTest) {
                              -0.33198111225669635, 0.23712936588919964};
     auto v1_grad_out = v1.get_grad().to_vector();
     for (int ix = 0; ix < 6; ++ix) {
-      ASSERT_FLOAT_EQ(v1_grad_out[ix], v1_grad_exp[ix]);
+      ASSERT_NEAR(v1_grad_out[ix], v1_grad_exp[ix], SOFTMAX_GRAD_TOLERANCE * std::abs(v1_grad_exp[ix]));
     }
     double v2_grad_exp[6] = {-1.1497010658603544, 0.00011754544465360147,
                              1.1495835204157006, -2.1497066404494545,
                              0.00023508861479254903, 2.149471551834662};
     auto v2_grad_out = v2.get_grad().to_vector();
     for (int ix = 0; ix < 6; ++ix) {
-      ASSERT_FLOAT_EQ(v2_grad_out[ix], v2_grad_exp[ix]);
+      ASSERT_NEAR(v2_grad_out[ix], v2_grad_exp[ix], SOFTMAX_GRAD_TOLERANCE * std::abs(v2_grad_exp[ix]));
     }
 
   } catch (const std::exception &ex) {
@@ -647,7 +746,7 @@ TEST(OpsTest, Conv2dTest) {
     Variable v1 = Variable({3, 4, 8, 10}); // [B, C, H, W]
     Parameter v2 = Parameter({6, 4, 2, 2}); // [c_out, c_in, kh, kw]
 
-    DTensor value_v1 = tensor::Tensor<double>({3, 4, 8, 10},
+    DTensor value_v1 = DTensor({3, 4, 8, 10},
                                               {-8., 2., 0., 4., -15., -5., -10., -6., 6., 11., -7., 7.,
                                                -1., -5., -5., -9., 1., 2., 13., 8., -12., -14., -15., -15.,
                                                -5., -14., 12., 6., 6., 1., -3., -7., -15., -8., 9., -11.,
@@ -729,7 +828,7 @@ TEST(OpsTest, Conv2dTest) {
                                                -10., -2., 2., 8., 1., 3., 12., 6., 0., 8., 11., -6.,
                                                -13., -3., -14., 11., -13., 10., -2., 3., -6., 10., -15., 14.});
     DTensor
-      value_v2 = tensor::Tensor<double>({6, 4, 2, 2}, {0., 14., -13., -1., 1., -4., 0., 6., 8., -11., 11., 11.,
+      value_v2 = DTensor({6, 4, 2, 2}, {0., 14., -13., -1., 1., -4., 0., 6., 8., -11., 11., 11.,
                                                        -6., 11., -14., -7., 9., 7., 13., -13., 11., 2., 8., 8.,
                                                        -3., 12., 8., 4., -10., -1., 0., 7., -7., -12., -13., -13.,
                                                        13., 1., 1., -10., -14., 8., 11., 4., -1., -14., 6., 10.,
@@ -785,7 +884,7 @@ TEST(OpsTest, Conv2dTest) {
                                       -306., -15., 74., -359., 98., -583., 491., -214., 90., 353.,
                                       -268., 132., 351., -66., -249., -249., 215., -227., -135., -516.};
     ASSERT_EQ(conv2d.get_value_shape(), tensor::TensorShape({3, 6, 4, 5}));
-    std::vector<double> conv2d_out = conv2d.get_value().to_vector();
+    std::vector<DScalar> conv2d_out = conv2d.get_value().to_vector();
     ASSERT_THAT(conv2d_out,
                 ElementsAreArray(conv2d_exp)) << "\nResult: \n" << conv2d.get_value().to_string();
 
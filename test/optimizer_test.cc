@@ -1,6 +1,8 @@
 #define TENSOR_TESTING true
 #define ENABLE_TENSOR_MULTI_THREAD true
 
+#include <limits>
+
 #include "autodiff/component/node.h"
 #include "autodiff/graph.h"
 #include "autodiff/layer/layer.h"
@@ -17,12 +19,12 @@ TEST(OptimizerTest, AdamTest) {
   try {
     Variable v1 = Variable({2, 2});
 
-    DTensor value1 = tensor::Tensor<double>({2, 2}, {1, 2, 3, 4});
-    DTensor value2 = tensor::Tensor<double>({2, 2}, {-1, 2, -3, 4});
-    DTensor value3 = tensor::Tensor<double>({2, 2}, {3, 3, 0, 3});
+    DTensor value1 = DTensor({2, 2}, {1, 2, 3, 4});
+    DTensor value2 = DTensor({2, 2}, {-1, 2, -3, 4});
+    DTensor value3 = DTensor({2, 2}, {3, 3, 0, 3});
     DTensor values[3] = {value1, value2, value3};
-    DTensor weight = tensor::Tensor<double>({2, 2}, {-1, 2, -1, 2});
-    DTensor bias = tensor::Tensor<double>({1}, 2);
+    DTensor weight = DTensor({2, 2}, {-1, 2, -1, 2});
+    DTensor bias = DTensor({1}, 2);
 
     layer::Dense dense_layer(2, 2);
     dense_layer.assign_weight(weight);
@@ -52,7 +54,7 @@ TEST(OptimizerTest, AdamTest) {
       1.7092878818511963,
     };
 
-    std::vector<double> cur_weight;
+    std::vector<DScalar> cur_weight;
     for (int ix = 0; ix < 3; ix++) {
       v1.assign_value(values[ix]);
       graph->zero_grad();
@@ -77,6 +79,43 @@ TEST(OptimizerTest, AdamTest) {
   Graph::clear_graph();
 }
 
+TEST(OptimizerTest, LossScaleTest) {
+  Graph *graph = Graph::get_instanceof_global_graph();
+
+  try {
+    Variable v1 = Variable({2, 2});
+    layer::Dense dense_layer(2, 2);
+    dense_layer.assign_weight(DTensor({2, 2}, {-1, 2, -1, 2}));
+    dense_layer.assign_bias(DTensor({1}, 2));
+    auto target = functional::reduce_sum(dense_layer(v1));
+
+    // bfloat16 activations leave these gradients exact
+    graph->set_mixed_precision(true);
+    auto optim = optimizer::Adam(target, 0.1);
+    optim.set_requires_grads_for_all();
+    double max_scale = std::numeric_limits<DScalar>::max();
+    optim.set_loss_scale(max_scale / 2);
+
+    // the weight gradients are 4 and 6, the scale halves until they stay finite
+    double scale_expect[3] = {max_scale / 4, max_scale / 8, max_scale / 8};
+    for (int ix = 0; ix < 3; ix++) {
+      v1.assign_value(DTensor({2, 2}, {1, 2, 3, 4}));
+      graph->zero_grad();
+      target.forward();
+      optim.step();
+
+      ASSERT_DOUBLE_EQ(optim.get_loss_scale(), scale_expect[ix]);
+      ASSERT_DOUBLE_EQ(target.get_value().get_value(), 24.);
+    }
+    ASSERT_THAT(dense_layer.get_weight().get_value().to_vector(),
+                Pointwise(DoubleNear(1e-6), {-1.0, 1.9, -1.0, 1.9}));
+    ASSERT_NEAR(dense_layer.get_bias().get_value().get_value(), 1.9, 1e-6);
+  } catch (const std::exception &ex) {
+    FAIL() << "Failed and got this: " << std::endl << ex.what();
+  }
+  Graph::clear_graph();
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -1,9 +1,12 @@
 #define TENSOR_TESTING true
 #define ENABLE_TENSOR_MULTI_THREAD true
 
+#include <filesystem>
+
 #include "tensor/mapper.h"
 #include "tensor/tensor.h"
 #include "tensor/extension.h"
+#include "tensor/io.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -37,10 +40,129 @@ TEST(AdgcTensorTest, ShallowCopyTest) {
   tensor::Tensor<float> tb = ta;
   tensor::Tensor<float> tc(ta);
 
+  // copies share the buffer until one of them is written
+  ASSERT_TRUE(ta.is_shared());
+  ASSERT_EQ(tb.get_tensor_const_ptr(), ta.get_tensor_const_ptr());
+
   ta.set_value({0, 1}, 4);
 
-  ASSERT_FLOAT_EQ(tb.get_value({0, 1}), 4);
-  ASSERT_FLOAT_EQ(tc.get_value({0, 1}), 4);
+  ASSERT_FLOAT_EQ(ta.get_value({0, 1}), 4);
+  ASSERT_FLOAT_EQ(tb.get_value({0, 1}), 2);
+  ASSERT_FLOAT_EQ(tc.get_value({0, 1}), 2);
+  ASSERT_NE(tb.get_tensor_const_ptr(), ta.get_tensor_const_ptr());
+  ASSERT_EQ(tb.get_tensor_const_ptr(), tc.get_tensor_const_ptr());
+}
+
+TEST(AdgcTensorTest, CopyOnWriteTest) {
+  std::vector<double> fa = {1, 2, 3, 4, 5, 6};
+  tensor::Tensor<double> ta({2, 3}, fa);
+
+  // in-place ops on an unshared tensor keep the buffer
+  const double *buffer = ta.get_tensor_const_ptr();
+  ta += 1.;
+  ta.map([](double &val) { val *= 2; });
+  ASSERT_EQ(ta.get_tensor_const_ptr(), buffer);
+  ASSERT_THAT(ta.to_vector(), ElementsAre(4, 6, 8, 10, 12, 14));
+
+  // in-place ops on a shared one detach it first
+  tensor::Tensor<double> tb = ta;
+  tb -= ta;
+  ASSERT_THAT(tb.to_vector(), ElementsAre(0, 0, 0, 0, 0, 0));
+  ASSERT_THAT(ta.to_vector(), ElementsAre(4, 6, 8, 10, 12, 14));
+  ASSERT_FALSE(ta.is_shared());
+
+  // writing to a view does not leak into its base
+  auto row = ta[1];
+  row.set_value({0}, -1.);
+  ASSERT_DOUBLE_EQ(ta.get_value({1, 0}), 10);
+  ASSERT_THAT(row.to_vector(), ElementsAre(-1, 12, 14));
+
+  tensor::Tensor<double> tc = ta;
+  tc.detach();
+  ASSERT_NE(tc.get_tensor_const_ptr(), ta.get_tensor_const_ptr());
+}
+
+TEST(AdgcTensorTest, BroadcastTest) {
+  tensor::Tensor<double> ta({2, 3}, {1, 2, 3, 4, 5, 6});
+  tensor::Tensor<double> row({3}, {10, 20, 30});
+  tensor::Tensor<double> col({2, 1}, {1, 2});
+
+  ASSERT_THAT(ta.add(row).to_vector(), ElementsAre(11, 22, 33, 14, 25, 36));
+  ASSERT_THAT(ta.multiply(col).to_vector(), ElementsAre(1, 2, 3, 8, 10, 12));
+  ASSERT_THAT(row.sub(ta).to_vector(), ElementsAre(9, 18, 27, 6, 15, 24));
+  ASSERT_THAT(ta.div(col).to_vector(), ElementsAre(1, 2, 3, 2, 2.5, 3));
+
+  // [2, 1] with [3] expands both operands
+  tensor::Tensor<double> outer = col.multiply(row);
+  ASSERT_EQ(outer.get_shape(), tensor::TensorShape({2, 3}));
+  ASSERT_THAT(outer.to_vector(), ElementsAre(10, 20, 30, 20, 40, 60));
+
+  // strided operands are read in place
+  ASSERT_THAT(ta.t().add(col.t()).to_vector(), ElementsAre(2, 6, 3, 7, 4, 8));
+
+  tensor::Tensor<double> expanded = row.broadcast_to({4, 3});
+  ASSERT_EQ(expanded.get_strides(), tensor::TensorShape({0, 1}));
+  ASSERT_EQ(expanded.get_tensor_const_ptr(), row.get_tensor_const_ptr());
+  ASSERT_DOUBLE_EQ(expanded.get_value({3, 2}), 30);
+
+  ta += row;
+  ASSERT_THAT(ta.to_vector(), ElementsAre(11, 22, 33, 14, 25, 36));
+  ta -= col;
+  ASSERT_THAT(ta.to_vector(), ElementsAre(10, 21, 32, 12, 23, 34));
+
+  ASSERT_THROW(ta.add(tensor::Tensor<double>({2})), adg_exception::MismatchTensorShapeError);
+  ASSERT_THROW(row += ta, adg_exception::MismatchTensorShapeError);
+}
+
+TEST(AdgcTensorTest, ReduceToShapeTest) {
+  tensor::Tensor<double> grad({2, 2, 3}, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+
+  ASSERT_THAT(grad.reduce_to_shape({3}).to_vector(), ElementsAre(22, 26, 30));
+  ASSERT_THAT(grad.reduce_to_shape({2, 1}).to_vector(), ElementsAre(30, 48));
+  ASSERT_THAT(grad.reduce_to_shape({2, 1, 1}).to_vector(), ElementsAre(21, 57));
+  ASSERT_THAT(grad.reduce_to_shape({1}).to_vector(), ElementsAre(78));
+  ASSERT_EQ(grad.reduce_to_shape({2, 2, 3}), grad);
+  ASSERT_THAT(grad.transpose(1, 2).reduce_to_shape({3, 1}).to_vector(), ElementsAre(22, 26, 30));
+  ASSERT_THROW(grad.reduce_to_shape({2}), adg_exception::MismatchTensorShapeError);
+}
+
+TEST(AdgcTensorTest, LazyExpressionTest) {
+  tensor::Tensor<double> ta({2, 3}, {1, 4, 9, 16, 25, 36});
+  tensor::Tensor<double> tb({2, 3}, {1, 2, 3, 4, 5, 6});
+
+  tensor::Tensor<double> tc = tensor::lazy(ta) * 2. + tensor::lazy(tb) - 1.;
+  ASSERT_EQ(tc.get_shape(), tensor::TensorShape({2, 3}));
+  ASSERT_THAT(tc.to_vector(), ElementsAre(2, 9, 20, 35, 54, 77));
+
+  tensor::Tensor<double> td = tensor::expr::sqrt(tensor::lazy(ta)) / tensor::lazy(tb);
+  ASSERT_THAT(td.to_vector(), ElementsAre(1, 1, 1, 1, 1, 1));
+  ASSERT_THAT(tensor::expr::eval(-tensor::lazy(tb) + 10.).to_vector(), ElementsAre(9, 8, 7, 6, 5, 4));
+
+  // assignment with the same shape writes in place, also when ta is an operand
+  const double *buffer = ta.get_tensor_const_ptr();
+  ta = 1. / (tensor::lazy(ta) + tensor::lazy(tb) * 0.);
+  ASSERT_EQ(ta.get_tensor_const_ptr(), buffer);
+  ASSERT_DOUBLE_EQ(ta.get_value({0, 1}), 0.25);
+
+  // but never into a buffer shared with another tensor
+  tensor::Tensor<double> shared = tb;
+  tb = tensor::lazy(tb) * 0.;
+  ASSERT_THAT(shared.to_vector(), ElementsAre(1, 2, 3, 4, 5, 6));
+  ASSERT_THAT(tb.to_vector(), ElementsAre(0, 0, 0, 0, 0, 0));
+
+  // strided operands
+  tensor::Tensor<double> te = tensor::lazy(shared.t()) + tensor::lazy(shared.t());
+  ASSERT_THAT(te.to_vector(), ElementsAre(2, 8, 4, 10, 6, 12));
+
+  ASSERT_THROW(tensor::lazy(shared) + tensor::lazy(shared.t()), adg_exception::MismatchTensorShapeError);
+}
+
+TEST(AdgcTensorTest, AlignedStorageTest) {
+  tensor::Tensor<double> ta({3, 5}, 1.);
+  tensor::Tensor<float> tb = tensor::Tensor<float>::uninitialized({7});
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ta.get_tensor_const_ptr()) % utils::memory::MEMORY_ALIGNMENT, 0);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(tb.get_tensor_const_ptr()) % utils::memory::MEMORY_ALIGNMENT, 0);
+  ASSERT_EQ(tb.get_size(), 7);
 }
 
 TEST(AdgcTensorTest, DeepCopyTest) {
@@ -194,6 +316,37 @@ TEST(AdgcTensorTest, TransposeAfterReshapeTest) {
   }
 }
 
+TEST(AdgcTensorTest, PermuteTest) {
+  tensor::Ranges<double> ta({2, 3, 4}, 0.);
+  tensor::Tensor<double> tb = ta.permute({2, 0, 1});
+
+  ASSERT_THAT(tb.get_shape(), ElementsAre(4, 2, 3));
+  ASSERT_FLOAT_EQ(tb.get_value({3, 1, 2}), ta.get_value({1, 2, 3}));
+  ASSERT_THAT(tb.to_vector(),
+              ElementsAre(0, 4, 8, 12, 16, 20, 1, 5, 9, 13, 17, 21,
+                          2, 6, 10, 14, 18, 22, 3, 7, 11, 15, 19, 23));
+
+  // large enough for the tiled copy with partial tiles at the borders
+  tensor::Ranges<double> tc({5, 70, 101}, 0.);
+  tensor::Tensor<double> td = tc.permute({2, 0, 1}).contiguous();
+  ASSERT_TRUE(td.is_contiguous());
+  for (size_t ix : {0, 37, 100}) {
+    for (size_t iy : {0, 4}) {
+      for (size_t iz : {0, 33, 69}) {
+        ASSERT_FLOAT_EQ(td.get_value({ix, iy, iz}), tc.get_value({iy, iz, ix}));
+      }
+    }
+  }
+
+  tensor::Tensor<float> te = tensor::Ranges<float>({300, 200}, 0.f).t().contiguous();
+  ASSERT_FLOAT_EQ(te.get_value({199, 299}), 299 * 200 + 199);
+  ASSERT_FLOAT_EQ(te.get_value({17, 3}), 3 * 200 + 17);
+
+  ASSERT_THROW(ta.permute({0, 1}), adg_exception::MismatchTensorDimError);
+  ASSERT_THROW(ta.permute({0, 1, 1}), adg_exception::AxisOutOfRangeError);
+  ASSERT_THROW(ta.permute({0, 1, 3}), adg_exception::AxisOutOfRangeError);
+}
+
 TEST(AdgcTensorTest, TensorMultiplyTest) {
   std::vector<double> fa = {
     0.06070769, 0.73364242, 0.92237306, 0.54659584, 0.64786345, 0.42514575,
@@ -269,6 +422,110 @@ TEST(AdgcTensorTest, TensorDotTest) {
   EXPECT_THROW(ta.dot(tc), adg_exception::MismatchTensorShapeError);
 }
 
+TEST(AdgcTensorTest, TransposedDotTest) {
+  tensor::Tensor<double> ta({3, 4, 5});
+  tensor::Tensor<double> tb({3, 6, 5});
+  tensor::Tensor<double> tm({4, 5});
+  ta.normal_init(0., 1., 1);
+  tb.normal_init(0., 1., 2);
+  tm.normal_init(0., 1., 3);
+
+  auto expect_near = [](const tensor::Tensor<double> &result, const tensor::Tensor<double> &expected) {
+    ASSERT_EQ(result.get_shape(), expected.get_shape());
+    std::vector<double> result_values = result.to_vector(), expected_values = expected.to_vector();
+    for (size_t ix = 0; ix < result_values.size(); ++ix) {
+      ASSERT_NEAR(result_values[ix], expected_values[ix], 1e-10) << "at index " << ix;
+    }
+  };
+
+  // batched operands read transposed, or as a single repeated matrix
+  expect_near(ta.dot(tb.t()), ta.dot(tb.t().contiguous()));
+  expect_near(tb.t().t().dot(ta.t()), tb.dot(ta.t().contiguous()));
+  expect_near(tm.t().dot(ta), tm.t().contiguous().dot(ta));
+  expect_near(ta.dot(tm.t()), ta.dot(tm.t().contiguous()));
+  expect_near(tm.dot(tb.t()), tm.dot(tb.t().contiguous()));
+
+  // a column slice keeps its row stride as leading dimension
+  tensor::Tensor<double> sliced = tm.slice({{1, 1, 4}});
+  expect_near(sliced.t().dot(sliced), sliced.contiguous().t().contiguous().dot(sliced.contiguous()));
+
+  tensor::Tensor<float> tv({1, 5}, 1.f);
+  ASSERT_FLOAT_EQ(tv.dot(tv.t()).get_value(), 5);
+}
+
+TEST(AdgcTensorTest, IntegerTensorTest) {
+  tensor::Tensor<int32_t> ta({2, 3}, {1, -2, 3, 4, 5, -6});
+  tensor::Tensor<int32_t> tb({2, 3}, {2, 2, 2, 3, 3, 3});
+
+  ASSERT_THAT(ta.add(tb).to_vector(), ElementsAre(3, 0, 5, 7, 8, -3));
+  ASSERT_THAT(ta.sub(tb).to_vector(), ElementsAre(-1, -4, 1, 1, 2, -9));
+  ASSERT_THAT(ta.multiply(tb).to_vector(), ElementsAre(2, -4, 6, 12, 15, -18));
+  ASSERT_THAT(ta.div(tb).to_vector(), ElementsAre(0, -1, 1, 1, 1, -2));
+  ASSERT_THAT((ta / 2).to_vector(), ElementsAre(0, -1, 1, 2, 2, -3));
+  ASSERT_THAT((-ta).to_vector(), ElementsAre(-1, 2, -3, -4, -5, 6));
+  ASSERT_THROW(ta / 0, adg_exception::DividingZeroException);
+
+  ASSERT_EQ(ta.sum().get_value(), 5);
+  ASSERT_THAT(ta.max(1).to_vector(), ElementsAre(3, 5));
+  ASSERT_THAT(ta.arg_amax(1).to_vector(), ElementsAre(2, 1));
+
+  // [2, 3] x [3, 2], with the right operand read transposed
+  ASSERT_THAT(ta.dot(tb.t()).to_vector(), ElementsAre(4, 6, 6, 9));
+  ASSERT_THAT(tensor::Tensor<int32_t>::kron(tensor::Tensor<int32_t>({1, 2}, {1, 2}),
+                                            tensor::Tensor<int32_t>({1, 2}, {3, 4})).to_vector(),
+              ElementsAre(3, 4, 6, 8));
+
+  // int8 products are accumulated in int32 before being stored
+  tensor::Tensor<int8_t> tc({1, 4}, {100, 100, -100, -50});
+  tensor::Tensor<int8_t> td({4, 1}, {1, 1, 1, 1});
+  ASSERT_EQ(tc.dot(td).get_value(), 50);
+
+  tensor::Tensor<uint8_t> pixels = tensor::Tensor<double>({2}, {255., 16.}).to_uint8();
+  ASSERT_THAT(pixels.to_vector(), ElementsAre(255, 16));
+  ASSERT_EQ(pixels.to_string(), "[ 255\t16 ]");
+}
+
+TEST(AdgcTensorTest, HalfTensorTest) {
+  // round to nearest even, NaN stays NaN and float16 overflows to inf
+  ASSERT_EQ(float(tensor::bfloat16(1.00390625f)), 1.f);
+  ASSERT_EQ(float(tensor::bfloat16(1.01171875f)), 1.015625f);
+  ASSERT_TRUE(std::isnan(float(tensor::bfloat16(std::nanf("")))));
+  ASSERT_EQ(float(tensor::float16(65504.f)), 65504.f);
+  ASSERT_TRUE(std::isinf(float(tensor::float16(1e5f))));
+  ASSERT_EQ(float(tensor::float16(1e-7f)), 2 * 5.9604644775390625e-08f);
+  ASSERT_EQ(float(tensor::float16(0.1f)), 0.0999755859375f);
+
+  tensor::Tensor<float> ta({2, 3}, {1, -2, 3, 4, 5, -6});
+  tensor::Tensor<tensor::bfloat16> ha = ta.to_bfloat16();
+  tensor::Tensor<tensor::bfloat16> hb = tensor::Tensor<float>({2, 3}, 2.f).to_bfloat16();
+  ASSERT_THAT(ha.add(hb).to_float().to_vector(), ElementsAre(3, 0, 5, 6, 7, -4));
+  ASSERT_THAT(ha.multiply(hb).to_float().to_vector(), ElementsAre(2, -4, 6, 8, 10, -12));
+  ASSERT_THAT((ha / tensor::bfloat16(2)).to_float().to_vector(), ElementsAre(0.5, -1, 1.5, 2, 2.5, -3));
+  ASSERT_THAT(ha.max(1).to_float().to_vector(), ElementsAre(3, 5));
+  ASSERT_EQ(ha.to_string(), "[ [ 1\t-2\t3 ]\n[ 4\t5\t-6 ] ]");
+
+  // 4096 ones: a bfloat16 running sum would stop at 256
+  tensor::Tensor<tensor::bfloat16> ones = tensor::Tensor<float>({1, 4096}, 1.f).to_bfloat16();
+  ASSERT_EQ(float(ones.sum().get_value()), 4096.f);
+  ASSERT_EQ(float(ones.dot(ones.t()).get_value()), 4096.f);
+  tensor::Tensor<tensor::float16> half_ones = tensor::Tensor<float>({1, 4096}, 1.f).to_float16();
+  ASSERT_EQ(float(half_ones.dot(half_ones.t()).get_value()), 4096.f);
+
+  // batched and transposed products agree with float up to the rounding of the result
+  tensor::Tensor<float> tx({3, 4, 5}), ty({3, 6, 5});
+  tx.normal_init(0., 1., 1);
+  ty.normal_init(0., 1., 2);
+  tx = tx.to_bfloat16().to_float();
+  ty = ty.to_bfloat16().to_float();
+  std::vector<float> expected = tx.dot(ty.t()).to_vector();
+  std::vector<float> bf16_result = tx.to_bfloat16().dot(ty.to_bfloat16().t()).to_float().to_vector();
+  std::vector<float> fp16_result = tx.to_float16().dot(ty.to_float16().t()).to_float().to_vector();
+  for (size_t ix = 0; ix < expected.size(); ++ix) {
+    ASSERT_NEAR(bf16_result[ix], expected[ix], 1e-2 * (1 + std::abs(expected[ix]))) << "at index " << ix;
+    ASSERT_NEAR(fp16_result[ix], expected[ix], 1e-3 * (1 + std::abs(expected[ix]))) << "at index " << ix;
+  }
+}
+
 TEST(AdgcTensorTest, TensorAddTest) {
   std::vector<float> fa = {1, 2, 3, 4};
   tensor::Tensor<float> ta({2, 2}, fa);
@@ -313,6 +570,39 @@ TEST(AdgcTensorTest, TensorInitTest) {
   // FAIL() << ta.to_string();
 }
 
+TEST(AdgcTensorTest, RandomInitTest) {
+  // the same seed gives the same values however many threads fill
+  size_t num_threads = utils::threads::get_num_threads();
+  tensor::Tensor<double> ta({512, 300}), tb({512, 300});
+  utils::threads::set_num_threads(1);
+  ta.normal_init(1., 2., 7);
+  utils::threads::set_num_threads(4);
+  tb.normal_init(1., 2., 7);
+  utils::threads::set_num_threads(num_threads);
+  ASSERT_EQ(ta.to_vector(), tb.to_vector());
+  EXPECT_NEAR(ta.mean().get_value(), 1., 0.02);
+  EXPECT_NEAR(std::sqrt(ta.var().get_value()), 2., 0.02);
+
+  tb.normal_init(1., 2., 8);
+  ASSERT_NE(ta.to_vector(), tb.to_vector());
+
+  tensor::Tensor<float> tu({1001});
+  tu.uniform_init(-1., 3.);
+  EXPECT_GE(tu.min().get_value(), -1.f);
+  EXPECT_LT(tu.max().get_value(), 3.f);
+  EXPECT_NEAR(tu.mean().get_value(), 1., 0.15);
+
+  tensor::Tensor<float> tm({1000});
+  tm.bernoulli_init(0.25, 3);
+  EXPECT_NEAR(tm.mean().get_value(), 0.25, 0.05);
+  for (auto value : tm.to_vector()) {
+    ASSERT_TRUE(value == 0.f || value == 1.f);
+  }
+
+  tensor::kaiming_normal_(ta, 50);
+  EXPECT_NEAR(std::sqrt(ta.var().get_value()), 0.2, 0.005);
+}
+
 TEST(AdgcTensorTest, SpecialDoubleMatricesTest) {
   tensor::Eye ta(3);
   auto outa = ta.to_vector();
@@ -403,6 +693,65 @@ TEST(AdgcTensorTest, AxisAlongSliceTest) {
               ElementsAre(29, 28, 62, 62, 8, 64, 0, 82, 76, 58, 47, 61));
 }
 
+TEST(AdgcTensorTest, StridedViewTest) {
+  float fa[24] = {29, 28, 62, 55, 56, 51, 0, 82, 76, 85, 14, 26,
+                  62, 8, 64, 94, 18, 75, 58, 47, 61, 65, 47, 14};
+
+  tensor::Tensor<float> ta({2, 4, 3}, fa);
+
+  // views share the storage and only differ in shape, strides and offset
+  auto tt = ta.transpose(1, 2);
+  ASSERT_EQ(tt.get_shape(), tensor::TensorShape({2, 3, 4}));
+  ASSERT_EQ(tt.get_strides(), tensor::TensorShape({12, 1, 3}));
+  ASSERT_EQ(tt.get_tensor_const_ptr(), ta.get_tensor_const_ptr());
+  ASSERT_FALSE(tt.is_contiguous());
+  ASSERT_FLOAT_EQ(tt.get_value({1, 2, 0}), 64);
+
+  auto sliced = ta.slice({{1, 1, 3}});
+  ASSERT_EQ(sliced.get_offset(), 3);
+  ASSERT_FALSE(sliced.is_contiguous());
+  ASSERT_THAT(sliced.to_vector(), ElementsAre(55, 56, 51, 0, 82, 76, 94, 18, 75, 58, 47, 61));
+
+  auto row = ta[1];
+  ASSERT_TRUE(row.is_contiguous());
+  ASSERT_EQ(row.get_tensor_const_ptr(), ta.get_tensor_const_ptr() + 12);
+
+  auto stepped = ta.take(1, {0, 2});
+  ASSERT_EQ(stepped.get_strides(), tensor::TensorShape({12, 6, 1}));
+  ASSERT_THAT(stepped.to_vector(), ElementsAre(29, 28, 62, 0, 82, 76, 62, 8, 64, 58, 47, 61));
+
+  // views compose, and arithmetic works on them directly
+  auto tts = tt.slice({{2, 1, 3}});
+  ASSERT_THAT(tts.to_vector(), ElementsAre(55, 0, 56, 82, 51, 76, 94, 58, 18, 47, 75, 61));
+  ASSERT_THAT(tts.add(tts).to_vector(),
+              ElementsAre(110, 0, 112, 164, 102, 152, 188, 116, 36, 94, 150, 122));
+}
+
+TEST(AdgcTensorTest, ContiguousTest) {
+  std::vector<double> fa = {1, 2, 3, 4, 5, 6};
+  tensor::Tensor<double> ta({2, 3}, fa);
+
+  auto same = ta.contiguous();
+  ASSERT_EQ(same.get_tensor_const_ptr(), ta.get_tensor_const_ptr());
+
+  auto tt = ta.t();
+  auto packed = tt.contiguous();
+  ASSERT_TRUE(packed.is_contiguous());
+  ASSERT_NE(packed.get_tensor_const_ptr(), ta.get_tensor_const_ptr());
+  ASSERT_EQ(packed.get_strides(), tensor::TensorShape({2, 1}));
+  ASSERT_THAT(packed.to_vector(), ElementsAre(1, 4, 2, 5, 3, 6));
+
+  // reshaping a strided view materializes it first
+  tt.reshape({6});
+  ASSERT_THAT(tt.to_vector(), ElementsAre(1, 4, 2, 5, 3, 6));
+  ASSERT_THAT(ta.to_vector(), ElementsAre(1, 2, 3, 4, 5, 6));
+
+  // non evenly spaced indices are gathered into a new tensor
+  auto gathered = ta.take(1, {2, 0});
+  ASSERT_TRUE(gathered.is_contiguous());
+  ASSERT_THAT(gathered.to_vector(), ElementsAre(3, 1, 6, 4));
+}
+
 TEST(AdgcTensorTest, AxisAlongSumTest) {
   float fa[24] = {2, 18, 13, 17, 2, 3, 7, 14, 17, 3, 15, 0,
                   5, 17, 5, 10, 10, 2, 11, 12, 15, 6, 9, 9};
@@ -463,6 +812,44 @@ TEST(AdgcTensorTest, AxisAlongArgAmaxTest) {
   ASSERT_FLOAT_EQ(res4.get_value(), 1.);
 }
 
+TEST(AdgcTensorTest, MultiAxisReduceTest) {
+  float fa[24] = {2, 18, 13, 17, 2, 3, 7, 14, 17, 3, 15, 0,
+                  5, 17, 5, 10, 10, 2, 11, 12, 15, 6, 9, 9};
+
+  tensor::Tensor<float> ta({3, 2, 4}, fa);
+
+  ASSERT_THAT(ta.sum({0, 2}).to_vector(), ElementsAre(120, 102));
+  ASSERT_THAT(ta.transpose(0, 2).sum({0, 2}).to_vector(), ElementsAre(120, 102));
+  ASSERT_THAT(ta.max({0, 2}).to_vector(), ElementsAre(18, 17));
+  ASSERT_THAT(ta.min(1).to_vector(), ElementsAre(2, 3, 7, 14, 5, 3, 5, 0, 10, 2, 9, 9));
+  ASSERT_FLOAT_EQ(ta.min().get_value(), 0);
+
+  auto res_mean = ta.mean({0, 1}, true);
+  ASSERT_EQ(res_mean.get_shape(), tensor::TensorShape({1, 1, 4}));
+  ASSERT_THAT(res_mean.to_vector(), ElementsAre(FloatEq(8.5), FloatEq(49. / 6), FloatEq(10), FloatEq(62. / 6)));
+  ASSERT_FLOAT_EQ(ta.mean().get_value(), 222. / 24);
+
+  auto res_var = ta.var(2);
+  ASSERT_EQ(res_var.get_shape(), tensor::TensorShape({3, 2}));
+  ASSERT_FLOAT_EQ(res_var.get_value({0, 0}), 40.25);
+
+  ASSERT_THROW(ta.sum({0, 3}), adg_exception::AxisOutOfRangeError);
+
+  // big enough to be split across threads, both reduction strategies
+  tensor::Ranges<double> tb({300, 200}, 0);
+  auto col_sums = tb.sum(0);
+  auto row_sums = tb.sum(1);
+  ASSERT_DOUBLE_EQ(col_sums.get_value({0}), 8970000);
+  ASSERT_DOUBLE_EQ(col_sums.get_value({199}), 8970000 + 300 * 199);
+  ASSERT_DOUBLE_EQ(row_sums.get_value({0}), 19900);
+  ASSERT_DOUBLE_EQ(row_sums.get_value({299}), 40000 * 299 + 19900);
+  ASSERT_THAT(tb.arg_amax(0).to_vector(), Each(199 + 100));
+  ASSERT_THAT(tb.arg_amax(1).to_vector(), Each(199));
+
+  // the largest value, not the largest magnitude
+  ASSERT_DOUBLE_EQ(tensor::Tensor<double>({3}, {-5, 1, 2}).arg_amax().get_value(), 2);
+}
+
 TEST(AdgcTensorTest, MapperTest) {
   float fa[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
 
@@ -485,6 +872,13 @@ TEST(AdgcTensorTest, MapperTest) {
               ElementsAre(FloatEq(-2.79093700e1), FloatEq(1.13311732e2),
                           FloatEq(5.71962350e1), FloatEq(3.39701482e2),
                           FloatEq(-3.24641058e-2), FloatEq(1.34251560e1)));
+
+  // large enough to be split into chunks, every entry is visited once
+  tensor::Tensor<double> tc({300, 400}, 1.);
+  tc.map(tensor::Mapper<double>([](double &entry, const size_t &index) { entry += index; }));
+  ASSERT_DOUBLE_EQ(tc.get_value({0, 0}), 1);
+  ASSERT_DOUBLE_EQ(tc.get_value({299, 399}), 120000);
+  ASSERT_DOUBLE_EQ(tc.sum().get_value(), 120000. * 119999 / 2 + 120000);
 }
 
 TEST(AdgcTensorTest, InplaceAlgoTest) {
@@ -549,6 +943,102 @@ TEST(AdgcTensorTest, ConcatTest) {
                                                2, 12, 4));
 }
 
+TEST(AdgcTensorTest, OutAndInplaceTest) {
+  tensor::Tensor<double> ta({2, 2}, {1, 2, 3, 4});
+  tensor::Tensor<double> tb({2, 2}, {4, 3, 2, 1});
+  tensor::Tensor<double> row({2}, {10, 20});
+
+  // the buffer of out is reused when it has the right size
+  tensor::Tensor<double> out({4});
+  const double *out_ptr = out.get_tensor_const_ptr();
+  ta.add(tb, out);
+  ASSERT_EQ(out.get_shape(), tensor::TensorShape({2, 2}));
+  ASSERT_EQ(out.get_tensor_const_ptr(), out_ptr);
+  ASSERT_THAT(out.to_vector(), ElementsAre(5, 5, 5, 5));
+  ta.dot(tb, out);
+  ASSERT_EQ(out.get_tensor_const_ptr(), out_ptr);
+  ASSERT_THAT(out.to_vector(), ElementsAre(8, 5, 20, 13));
+  ta.sub(row, out);
+  ASSERT_THAT(out.to_vector(), ElementsAre(-9, -18, -7, -16));
+  ta.t().multiply(2., out);
+  ASSERT_THAT(out.to_vector(), ElementsAre(2, 6, 4, 8));
+  ta.sum(0, false, out);
+  ASSERT_THAT(out.to_vector(), ElementsAre(4, 6));
+
+  // a shared out gets a buffer of its own
+  tensor::Tensor<double> shared = out;
+  ta.mean(1, true, out);
+  ASSERT_THAT(shared.to_vector(), ElementsAre(4, 6));
+  ASSERT_THAT(out.to_vector(), ElementsAre(1.5, 3.5));
+
+  // an out that is one of the operands
+  tensor::Tensor<double> tc = ta.copy();
+  tc.dot(tb, tc);
+  ASSERT_THAT(tc.to_vector(), ElementsAre(8, 5, 20, 13));
+  tc.var({0, 1}, false, tc);
+  ASSERT_THAT(tc.to_vector(), ElementsAre(DoubleEq(32.25)));
+
+  tensor::Tensor<double> td = ta.copy();
+  tensor::Tensor<double> view = td;
+  td.add_(row).multiply_(tb).div_(2.).sub_(1.);
+  ASSERT_THAT(td.to_vector(), ElementsAre(21, 32, 12, 11));
+  ASSERT_THAT(view.to_vector(), ElementsAre(1, 2, 3, 4));
+  td.multiply_(td);
+  ASSERT_THAT(td.to_vector(), ElementsAre(441, 1024, 144, 121));
+
+  tensor::sqrt_(td);
+  ASSERT_THAT(td.to_vector(), ElementsAre(21, 32, 12, 11));
+  tensor::add_vec_(td, row, 1);
+  ASSERT_THAT(td.to_vector(), ElementsAre(31, 52, 22, 31));
+  tensor::axpby(2., ta, -1., td);
+  ASSERT_THAT(td.to_vector(), ElementsAre(-29, -48, -16, -23));
+}
+
+TEST(AdgcTensorTest, NpyIOTest) {
+  std::string dir = std::filesystem::temp_directory_path().string();
+  tensor::Tensor<double> ta({2, 3}, {1, 2, 3, 4, 5, 6});
+  tensor::io::save_npy(dir + "/adgc_io_test.npy", ta.t());
+
+  // mapped without a copy, writes stay private to the tensor
+  tensor::Tensor<double> loaded = tensor::io::load_npy<double>(dir + "/adgc_io_test.npy");
+  ASSERT_EQ(loaded.get_shape(), tensor::TensorShape({3, 2}));
+  ASSERT_THAT(loaded.to_vector(), ElementsAre(1, 4, 2, 5, 3, 6));
+  loaded.set_value({0, 0}, 10);
+  ASSERT_DOUBLE_EQ(tensor::io::load_npy<double>(dir + "/adgc_io_test.npy", false).get_value({0, 0}), 1);
+
+  // converted to another element type
+  ASSERT_THAT(tensor::io::load_npy<int32_t>(dir + "/adgc_io_test.npy").to_vector(), ElementsAre(1, 4, 2, 5, 3, 6));
+
+  // a fortran ordered array comes back as a transposed view
+  std::ifstream reader(dir + "/adgc_io_test.npy", std::ios::binary);
+  std::string bytes((std::istreambuf_iterator<char>(reader)), std::istreambuf_iterator<char>());
+  reader.close();
+  bytes.replace(bytes.find("False"), 5, "True ");
+  std::ofstream(dir + "/adgc_io_fortran.npy", std::ios::binary) << bytes;
+  tensor::Tensor<double> fortran = tensor::io::load_npy<double>(dir + "/adgc_io_fortran.npy");
+  ASSERT_EQ(fortran.get_shape(), tensor::TensorShape({3, 2}));
+  ASSERT_FALSE(fortran.is_contiguous());
+  ASSERT_THAT(fortran.to_vector(), ElementsAre(1, 5, 4, 3, 2, 6));
+
+  tensor::Tensor<tensor::bfloat16> half = ta.to_bfloat16();
+  tensor::Tensor<int8_t> bytes_ts({4}, {-1, 2, -3, 4});
+  {
+    tensor::io::NpzWriter writer(dir + "/adgc_io_test.npz");
+    writer.add("weight", half);
+    writer.add("bias", bytes_ts);
+  }
+  tensor::io::NpzReader npz(dir + "/adgc_io_test.npz");
+  ASSERT_THAT(npz.get_names(), ElementsAre("bias", "weight"));
+  ASSERT_EQ(npz.get_descr("weight"), "|V2");
+  ASSERT_THAT(npz.get<int8_t>("bias").to_vector(), ElementsAre(-1, 2, -3, 4));
+  ASSERT_THAT(npz.get<tensor::bfloat16>("weight").to_double().to_vector(), ElementsAre(1, 2, 3, 4, 5, 6));
+  EXPECT_THROW(npz.get<double>("missing"), adg_exception::TensorIOError);
+
+  std::filesystem::remove(dir + "/adgc_io_test.npy");
+  std::filesystem::remove(dir + "/adgc_io_fortran.npy");
+  std::filesystem::remove(dir + "/adgc_io_test.npz");
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
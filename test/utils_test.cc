@@ -1,4 +1,5 @@
 #include "utils/utils.h"
+#include "utils/memory.h"
 
 #include "gtest/gtest.h"
 
@@ -68,6 +69,67 @@ TEST(UtilsTest, MultiArrayPrint3DTest) {
                                       << out;
 }
 
+TEST(UtilsTest, CachingAllocatorTest) {
+  utils::memory::CachingAllocator allocator;
+
+  void *ptr = allocator.allocate(100);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % utils::memory::MEMORY_ALIGNMENT, 0);
+  ASSERT_EQ(allocator.get_stats().misses, 1);
+  ASSERT_EQ(allocator.get_stats().bytes_in_use, 128);
+  allocator.deallocate(ptr, 100);
+  ASSERT_EQ(allocator.get_stats().bytes_cached, 128);
+  ASSERT_EQ(allocator.get_stats().bytes_in_use, 0);
+
+  // same size class is served from the free list
+  void *reused = allocator.allocate(120);
+  ASSERT_EQ(reused, ptr);
+  ASSERT_EQ(allocator.get_stats().hits, 1);
+  ASSERT_EQ(allocator.get_stats().bytes_cached, 0);
+  allocator.deallocate(reused, 120);
+
+  void *other = allocator.allocate(1000);
+  ASSERT_NE(other, ptr);
+  ASSERT_EQ(allocator.get_stats().misses, 2);
+  allocator.deallocate(other, 1000);
+  ASSERT_EQ(allocator.get_stats().bytes_cached, 128 + 1024);
+
+  allocator.trim();
+  ASSERT_EQ(allocator.get_stats().bytes_cached, 0);
+}
+
+TEST(UtilsTest, SmallVectorTest) {
+  utils::Dims dims = {2, 3, 4};
+  ASSERT_EQ(dims.size(), 3);
+  ASSERT_EQ(dims, std::vector<size_t>({2, 3, 4}));
+
+  dims.insert(dims.begin() + 1, 5);
+  dims.emplace_back(6);
+  ASSERT_EQ(dims, utils::Dims({2, 5, 3, 4, 6}));
+  dims.erase(dims.begin(), dims.begin() + 2);
+  ASSERT_EQ(dims, utils::Dims({3, 4, 6}));
+  ASSERT_EQ(std::vector<size_t>(dims.rbegin(), dims.rend()), std::vector<size_t>({6, 4, 3}));
+
+  dims.resize(utils::MAX_RANK, 1);
+  ASSERT_EQ(dims.back(), 1);
+  ASSERT_THROW(dims.push_back(1), std::length_error);
+  ASSERT_THROW(dims.at(utils::MAX_RANK), std::out_of_range);
+}
+
+TEST(UtilsTest, HugePageAllocationTest) {
+  size_t threshold = utils::memory::get_huge_page_threshold();
+  utils::memory::set_huge_page_threshold(size_t(1) << 20);
+
+  void *small = utils::memory::aligned_malloc(1000);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(small) % utils::memory::MEMORY_ALIGNMENT, 0);
+  void *large = utils::memory::aligned_malloc((size_t(3) << 20) + 5);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(large) % utils::memory::HUGE_PAGE_SIZE, 0);
+  static_cast<char *>(large)[(size_t(3) << 20) + 4] = 1;
+  utils::memory::aligned_free(small);
+  utils::memory::aligned_free(large);
+
+  utils::memory::set_huge_page_threshold(threshold);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();